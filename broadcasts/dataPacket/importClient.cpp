@@ -12,7 +12,13 @@ public:
         mCallback(callback)
     {
     }
+    explicit IImportClientImpl(
+        const std::function<void (std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)> &callback) :
+        mBatchCallback(callback)
+    {
+    }
     std::function<void (US8::MessageFormats::Broadcasts::DataPacket &&packets)> mCallback;
+    std::function<void (std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)> mBatchCallback;
 };
 
 IImportClient::IImportClient(
@@ -21,15 +27,36 @@ IImportClient::IImportClient(
 {
 }
 
+IImportClient::IImportClient(
+    const std::function<void (std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)> &callback) :
+    pImpl(std::make_unique<IImportClientImpl> (callback))
+{
+}
+
 IImportClient::~IImportClient() = default;
 
 /// Applies the callback
 void IImportClient::operator()(
     std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)
 {
+    if (packets.empty()){return;}
+    if (pImpl->mBatchCallback)
+    {
+        pImpl->mBatchCallback(std::move(packets));
+        return;
+    }
+    // A bad packet should not cost the rest of the batch
     for (auto &packet : packets)
     {
-        this->operator()(std::move(packet));
+        try
+        {
+            this->operator()(std::move(packet));
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::warn("Failed to propagate packet because "
+                       + std::string {e.what()});
+        }
     }
 }
 
@@ -37,5 +64,12 @@ void IImportClient::operator()(
 void IImportClient::operator()
    (US8::MessageFormats::Broadcasts::DataPacket &&packet)
 {
-   pImpl->mCallback(std::move(packet));
+   if (pImpl->mCallback)
+   {
+       pImpl->mCallback(std::move(packet));
+       return;
+   }
+   std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+   packets.push_back(std::move(packet));
+   pImpl->mBatchCallback(std::move(packets));
 }
@@ -0,0 +1,442 @@
+#include <string>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <functional>
+#include <filesystem>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <libmseed.h>
+#include <spdlog/spdlog.h>
+#include "fileClient.hpp"
+#include "fileClientOptions.hpp"
+#include "unpacker.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/broadcasts/dataPacket/importClient.hpp"
+
+using namespace US8::Broadcasts::DataPacket::MiniSEED;
+
+namespace
+{
+
+/// @brief A read-only memory mapping of a file.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::filesystem::path &path) :
+        mPath(path)
+    {
+        auto fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fileDescriptor < 0)
+        {
+            throw std::runtime_error("Failed to open " + path.string()
+                                   + ": " + std::strerror(errno));
+        }
+        struct stat status{};
+        if (fstat(fileDescriptor, &status) != 0)
+        {
+            close(fileDescriptor);
+            throw std::runtime_error("Failed to stat " + path.string());
+        }
+        mLength = static_cast<size_t> (status.st_size);
+        if (mLength > 0)
+        {
+            auto pointer = mmap(nullptr, mLength, PROT_READ, MAP_PRIVATE,
+                                fileDescriptor, 0);
+            if (pointer == MAP_FAILED)
+            {
+                close(fileDescriptor);
+                throw std::runtime_error("Failed to map " + path.string()
+                                       + ": " + std::strerror(errno));
+            }
+            // Records are mostly read front to back
+            madvise(pointer, mLength, MADV_SEQUENTIAL);
+            mData = static_cast<const char *> (pointer);
+        }
+        // The mapping outlives the descriptor
+        close(fileDescriptor);
+    }
+    ~MappedFile()
+    {
+        if (mData != nullptr)
+        {
+            munmap(const_cast<char *> (mData), mLength);
+        }
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile& operator=(const MappedFile &) = delete;
+    [[nodiscard]] const char *data() const noexcept{return mData;}
+    [[nodiscard]] size_t size() const noexcept{return mLength;}
+    [[nodiscard]] const std::filesystem::path &path() const noexcept
+    {
+        return mPath;
+    }
+private:
+    std::filesystem::path mPath;
+    const char *mData{nullptr};
+    size_t mLength{0};
+};
+
+/// @brief The location and start time of a record in a mapped file.
+struct RecordIndex
+{
+    std::chrono::microseconds startTime{0};
+    uint64_t offset{0};
+    uint32_t length{0};
+};
+
+/// @brief A file's sorted records and the next record to replay.
+struct FileCursor
+{
+    std::unique_ptr<::MappedFile> file;
+    std::vector<::RecordIndex> records;
+    size_t next{0};
+};
+
+/// @brief Finds the start time and length of each record in a file.  The
+///        records are sorted by start time since a day volume is usually
+///        ordered by channel.
+[[nodiscard]] std::vector<::RecordIndex> indexRecords(const ::MappedFile &file)
+{
+    std::vector<::RecordIndex> records;
+    MS3Record *miniSEEDRecord{nullptr};
+    const auto length = static_cast<uint64_t> (file.size());
+    uint64_t offset{0};
+    while (length - offset > MINRECLEN)
+    {
+        constexpr uint32_t flags{0};
+        constexpr int8_t verbose{0};
+        auto returnCode = msr3_parse(file.data() + offset, length - offset,
+                                     &miniSEEDRecord, flags, verbose);
+        if (returnCode != MS_NOERROR || miniSEEDRecord == nullptr ||
+            miniSEEDRecord->reclen <= 0)
+        {
+            spdlog::warn("Stopped reading " + file.path().string()
+                       + " at byte " + std::to_string(offset)
+                       + "; could not parse record");
+            break;
+        }
+        ::RecordIndex record;
+        record.startTime = std::chrono::microseconds
+        {
+            static_cast<int64_t> (std::round(miniSEEDRecord->starttime*1.e-3))
+        };
+        record.offset = offset;
+        record.length = static_cast<uint32_t> (miniSEEDRecord->reclen);
+        records.push_back(record);
+        offset = offset + record.length;
+    }
+    if (miniSEEDRecord){msr3_free(&miniSEEDRecord);}
+    std::stable_sort(records.begin(), records.end(),
+                     [](const ::RecordIndex &lhs, const ::RecordIndex &rhs)
+                     {
+                         return lhs.startTime < rhs.startTime;
+                     });
+    return records;
+}
+
+/// @brief Expands the directories into their regular files.
+[[nodiscard]] std::vector<std::filesystem::path>
+    findFiles(const std::vector<std::filesystem::path> &paths)
+{
+    std::vector<std::filesystem::path> files;
+    for (const auto &path : paths)
+    {
+        if (std::filesystem::is_directory(path))
+        {
+            std::vector<std::filesystem::path> directoryFiles;
+            for (const auto &entry :
+                 std::filesystem::recursive_directory_iterator(path))
+            {
+                if (entry.is_regular_file())
+                {
+                    directoryFiles.push_back(entry.path());
+                }
+            }
+            // Deterministic order
+            std::sort(directoryFiles.begin(), directoryFiles.end());
+            files.insert(files.end(),
+                         directoryFiles.begin(), directoryFiles.end());
+        }
+        else
+        {
+            files.push_back(path);
+        }
+    }
+    return files;
+}
+
+}
+
+class FileClient::FileClientImpl
+{
+public:
+    /// Destructor
+    ~FileClientImpl()
+    {
+        stop();
+        disconnect();
+    }
+    /// Unmaps the files
+    void disconnect()
+    {
+        mConnected = false;
+        mCursors.clear();
+    }
+    /// Maps the files and builds the record index
+    void connect()
+    {
+        stop();
+        disconnect();
+        auto files = ::findFiles(mOptions.getPaths());
+        size_t nRecords{0};
+        for (const auto &path : files)
+        {
+            try
+            {
+                ::FileCursor cursor;
+                cursor.file = std::make_unique<::MappedFile> (path);
+                cursor.records = ::indexRecords(*cursor.file);
+                if (cursor.records.empty())
+                {
+                    spdlog::warn("No records in " + path.string());
+                    continue;
+                }
+                nRecords = nRecords + cursor.records.size();
+                mCursors.push_back(std::move(cursor));
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::warn("Skipping " + path.string() + " because "
+                           + std::string {e.what()});
+            }
+        }
+        if (mCursors.empty())
+        {
+            throw std::runtime_error("No miniSEED records found");
+        }
+        spdlog::info("Indexed " + std::to_string(nRecords)
+                   + " records in " + std::to_string(mCursors.size())
+                   + " files");
+        mConnected = true;
+    }
+    /// Stops the replay
+    void stop()
+    {
+        mKeepRunning = false;
+        if (mReplayThread.joinable()){mReplayThread.join();}
+    }
+    /// Starts the replay
+    void start()
+    {
+        stop();
+        if (!mConnected){connect();}
+        mKeepRunning = true;
+        mReplayThread = std::thread(&FileClientImpl::replay, this);
+    }
+    /// Waits until the given time.  This wakes periodically to check if it
+    /// should quit.
+    void waitUntil(const std::chrono::steady_clock::time_point &time)
+    {
+        constexpr std::chrono::milliseconds maximumWait{100};
+        while (mKeepRunning)
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= time){return;}
+            std::this_thread::sleep_for(
+                std::min<std::chrono::steady_clock::duration>
+                (time - now, maximumWait));
+        }
+    }
+    /// Merges the files' records in time order and passes the unpacked
+    /// packets to the callback
+    void replay()
+    {
+        // Min-heap on each file's next record time
+        using HeapEntry = std::pair<std::chrono::microseconds, size_t>;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>,
+                            std::greater<HeapEntry>> heap;
+        for (size_t i = 0; i < mCursors.size(); ++i)
+        {
+            mCursors[i].next = 0;
+            heap.push({mCursors[i].records.front().startTime, i});
+        }
+        const auto speed = mOptions.getReplaySpeed();
+        const auto firstTime = heap.top().first;
+        const auto wallStartTime = std::chrono::steady_clock::now();
+        std::chrono::microseconds shift{0};
+        if (mOptions.shiftToCurrentTime())
+        {
+            auto now
+                = std::chrono::time_point_cast<std::chrono::microseconds>
+                  (std::chrono::system_clock::now()).time_since_epoch();
+            shift = now - firstTime;
+        }
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+        int64_t nPackets{0};
+        spdlog::info("Thread entering miniSEED file replay");
+        while (mKeepRunning && !heap.empty())
+        {
+            auto [startTime, fileIndex] = heap.top();
+            heap.pop();
+            auto &cursor = mCursors[fileIndex];
+            const auto &record = cursor.records[cursor.next];
+            cursor.next = cursor.next + 1;
+            if (cursor.next < cursor.records.size())
+            {
+                heap.push({cursor.records[cursor.next].startTime, fileIndex});
+            }
+            // Pace the replay
+            if (speed > 0)
+            {
+                auto elapsed
+                    = std::chrono::duration_cast
+                      <std::chrono::steady_clock::duration>
+                      (std::chrono::duration<double, std::micro>
+                       ((startTime - firstTime).count()/speed));
+                waitUntil(wallStartTime + elapsed);
+                if (!mKeepRunning){break;}
+            }
+            try
+            {
+                packets.clear();
+                US8::Broadcasts::DataPacket::MiniSEED::unpack(
+                    cursor.file->data() + record.offset, record.length,
+                    &packets);
+                if (shift.count() != 0)
+                {
+                    for (auto &packet : packets)
+                    {
+                        packet.setStartTime(packet.getStartTime() + shift);
+                    }
+                }
+                nPackets = nPackets + static_cast<int64_t> (packets.size());
+                try
+                {
+                    mAddPacketsFunction(std::move(packets));
+                }
+                catch (const std::exception &e)
+                {
+                    spdlog::warn("Failed to propagate packets because "
+                               + std::string {e.what()});
+                }
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::warn("Skipping record in "
+                           + cursor.file->path().string()
+                           + ".  Unpacking failed with: "
+                           + std::string {e.what()});
+            }
+        }
+        if (heap.empty())
+        {
+            std::chrono::duration<double> duration
+                = std::chrono::steady_clock::now() - wallStartTime;
+            spdlog::info("Replayed " + std::to_string(nPackets)
+                       + " packets in " + std::to_string(duration.count())
+                       + " s");
+            // Nothing left to read
+            mConnected = false;
+        }
+        spdlog::info("Thread leaving miniSEED file replay");
+    }
+    FileClientOptions mOptions;
+    std::function<void(std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)>
+        mAddPacketsFunction;
+    std::thread mReplayThread;
+    std::vector<::FileCursor> mCursors;
+    std::atomic<bool> mKeepRunning{false};
+    std::atomic<bool> mConnected{false};
+    bool mInitialized{false};
+};
+
+/// Constructor
+FileClient::FileClient(
+    const std::function<void (US8::MessageFormats::Broadcasts::DataPacket &&packet)> &callback,
+    const FileClientOptions &options) :
+    IImportClient(callback),
+    pImpl(std::make_unique<FileClientImpl> ())
+{
+    initialize(options);
+}
+
+/// Constructor with a batch callback
+FileClient::FileClient(
+    const std::function<void (std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)> &callback,
+    const FileClientOptions &options) :
+    IImportClient(callback),
+    pImpl(std::make_unique<FileClientImpl> ())
+{
+    initialize(options);
+}
+
+/// Initialize
+void FileClient::initialize(const FileClientOptions &options)
+{
+    if (options.getPaths().empty())
+    {
+        throw std::invalid_argument("No miniSEED files or directories");
+    }
+    // Packets go through IImportClient which handles the per-packet
+    // callback
+    pImpl->mAddPacketsFunction = [this](
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)
+    {
+        IImportClient::operator()(std::move(packets));
+    };
+    pImpl->mOptions = options;
+    pImpl->mInitialized = true;
+}
+
+/// Destructor
+FileClient::~FileClient() = default;
+
+/// Stop the client
+void FileClient::stop()
+{
+    pImpl->stop();
+}
+
+/// Connect
+void FileClient::connect()
+{
+    pImpl->connect();
+}
+
+/// Connected?
+bool FileClient::isConnected() const noexcept
+{
+    return pImpl->mConnected;
+}
+
+/// Start the client
+void FileClient::start()
+{
+    if (!isInitialized())
+    {
+        throw std::runtime_error("miniSEED file client not initialized");
+    }
+    pImpl->start();
+}
+
+/// Initialized
+bool FileClient::isInitialized() const noexcept
+{
+    return pImpl->mInitialized;
+}
+
+/// Type
+US8::Broadcasts::DataPacket::IImportClient::Type FileClient::getType()
+    const noexcept
+{
+    return US8::Broadcasts::DataPacket::IImportClient::Type::MiniSEEDFile;
+}
@@ -0,0 +1,60 @@
+#ifndef US8_BROADCASTS_DATA_PACKET_MINISEED_FILE_CLIENT_HPP
+#define US8_BROADCASTS_DATA_PACKET_MINISEED_FILE_CLIENT_HPP
+#include <vector>
+#include <us8/broadcasts/dataPacket/importClient.hpp>
+namespace US8::MessageFormats::Broadcasts
+{
+ class DataPacket;
+}
+namespace US8::Broadcasts::DataPacket::MiniSEED
+{
+ class FileClientOptions;
+}
+namespace US8::Broadcasts::DataPacket::MiniSEED
+{
+/// @class FileClient "fileClient.hpp"
+/// @brief Replays the records in miniSEED files through the same callback
+///        used by the SEEDLink client.  The files are memory mapped and
+///        their records are merged in time order across files.  The replay
+///        can run in real time, at a multiple of real time, or as fast as the
+///        callback will accept packets.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class FileClient : public US8::Broadcasts::DataPacket::IImportClient
+{
+public:
+    FileClient() = delete;
+    /// @brief Creates a client that replays miniSEED files.
+    /// @param[in] callback  The function to which unpacked packets are sent.
+    /// @param[in] options   The file client options.
+    /// @throws std::invalid_argument if no paths are set in the options.
+    FileClient(const std::function<void (US8::MessageFormats::Broadcasts::DataPacket &&packets)> &callback,
+               const FileClientOptions &options);
+    /// @brief Creates a client that replays miniSEED files and passes all
+    ///        the packets unpacked from a record to the callback in one call.
+    /// @param[in] callback  The function to which batches of unpacked
+    ///                      packets are sent.
+    /// @param[in] options   The file client options.
+    /// @throws std::invalid_argument if no paths are set in the options.
+    FileClient(const std::function<void (std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)> &callback,
+               const FileClientOptions &options);
+    ~FileClient() override;
+    /// @brief Maps the files and indexes their records.
+    /// @throws std::runtime_error if no records are found.
+    void connect() final;
+    /// @brief Starts the replay.  If the client is not yet connected then
+    ///        this will first connect.
+    void start() final;
+    /// @brief Stops the replay.
+    void stop() final;
+    [[nodiscard]] bool isInitialized() const noexcept final;
+    /// @result True indicates the files are mapped and the replay has not
+    ///         finished.
+    [[nodiscard]] bool isConnected() const noexcept final;
+    [[nodiscard]] US8::Broadcasts::DataPacket::IImportClient::Type getType() const noexcept final;
+private:
+    void initialize(const FileClientOptions &options);
+    class FileClientImpl;
+    std::unique_ptr<FileClientImpl> pImpl;
+};
+}
+#endif
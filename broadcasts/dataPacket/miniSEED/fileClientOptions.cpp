@@ -0,0 +1,105 @@
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "fileClientOptions.hpp"
+
+using namespace US8::Broadcasts::DataPacket::MiniSEED;
+
+class FileClientOptions::FileClientOptionsImpl
+{
+public:
+    std::vector<std::filesystem::path> mPaths;
+    double mReplaySpeed{1};
+    bool mShiftToCurrentTime{false};
+};
+
+/// Constructor
+FileClientOptions::FileClientOptions() :
+    pImpl(std::make_unique<FileClientOptionsImpl> ())
+{
+}
+
+/// Copy constructor
+FileClientOptions::FileClientOptions(const FileClientOptions &options)
+{
+    *this = options;
+}
+
+/// Move constructor
+FileClientOptions::FileClientOptions(FileClientOptions &&options) noexcept
+{
+    *this = std::move(options);
+}
+
+/// Copy assignment
+FileClientOptions&
+FileClientOptions::operator=(const FileClientOptions &options)
+{
+    if (&options == this){return *this;}
+    pImpl = std::make_unique<FileClientOptionsImpl> (*options.pImpl);
+    return *this;
+}
+
+/// Move assignment
+FileClientOptions&
+FileClientOptions::operator=(FileClientOptions &&options) noexcept
+{
+    if (&options == this){return *this;}
+    pImpl = std::move(options.pImpl);
+    return *this;
+}
+
+/// Destructor
+FileClientOptions::~FileClientOptions() = default;
+
+/// Reset class
+void FileClientOptions::clear() noexcept
+{
+    pImpl = std::make_unique<FileClientOptionsImpl> ();
+}
+
+/// Paths
+void FileClientOptions::addPath(const std::filesystem::path &path)
+{
+    if (!std::filesystem::exists(path))
+    {
+        throw std::invalid_argument(path.string() + " does not exist");
+    }
+    pImpl->mPaths.push_back(path);
+}
+
+std::vector<std::filesystem::path> FileClientOptions::getPaths() const noexcept
+{
+    return pImpl->mPaths;
+}
+
+void FileClientOptions::clearPaths() noexcept
+{
+    pImpl->mPaths.clear();
+}
+
+/// Replay speed
+void FileClientOptions::setReplaySpeed(const double speed)
+{
+    if (speed < 0)
+    {
+        throw std::invalid_argument("Replay speed cannot be negative");
+    }
+    pImpl->mReplaySpeed = speed;
+}
+
+double FileClientOptions::getReplaySpeed() const noexcept
+{
+    return pImpl->mReplaySpeed;
+}
+
+/// Shift times
+void FileClientOptions::setShiftToCurrentTime(const bool shift) noexcept
+{
+    pImpl->mShiftToCurrentTime = shift;
+}
+
+bool FileClientOptions::shiftToCurrentTime() const noexcept
+{
+    return pImpl->mShiftToCurrentTime;
+}
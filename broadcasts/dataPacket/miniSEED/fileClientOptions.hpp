@@ -0,0 +1,92 @@
+#ifndef US8_BROADCASTS_DATA_PACKET_MINISEED_FILE_CLIENT_OPTIONS_HPP
+#define US8_BROADCASTS_DATA_PACKET_MINISEED_FILE_CLIENT_OPTIONS_HPP
+#include <filesystem>
+#include <vector>
+#include <memory>
+namespace US8::Broadcasts::DataPacket::MiniSEED
+{
+/// @class FileClientOptions "fileClientOptions.hpp"
+/// @brief Defines the options used by the miniSEED file client.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class FileClientOptions
+{
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    FileClientOptions();
+    /// @brief Copy constructor.
+    /// @param[in] options  The options from which to initialize this class.
+    FileClientOptions(const FileClientOptions &options);
+    /// @brief Move constructor.
+    /// @param[in,out] options  The options from which to initialize this class.
+    ///                         On exit, option's behavior is undefined.
+    FileClientOptions(FileClientOptions &&options) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment operator.
+    /// @param[in] options  The options class to copy to this.
+    /// @result A deep copy of the options.
+    FileClientOptions& operator=(const FileClientOptions &options);
+    /// @brief Move assignment operator.
+    /// @param[in,out] options  The options class whose memory will be moved
+    ///                         to this.  On exit, option's behavior is
+    ///                         undefined.
+    /// @result The memory from options moved to this.
+    FileClientOptions& operator=(FileClientOptions &&options) noexcept;
+    /// @}
+
+    /// @name Properties
+    /// @{
+
+    /// @brief Adds a miniSEED file or a directory of miniSEED files, e.g.,
+    ///        a directory of day volumes.  Directories are searched
+    ///        recursively.
+    /// @param[in] path  The file or directory.
+    /// @throws std::invalid_argument if the path does not exist.
+    void addPath(const std::filesystem::path &path);
+    /// @result The files and directories to replay.
+    [[nodiscard]] std::vector<std::filesystem::path> getPaths() const noexcept;
+    /// @brief Removes all files and directories.
+    void clearPaths() noexcept;
+
+    /// @brief Sets the replay speed relative to real time.  For example,
+    ///        1 replays in real time, 10 replays at ten times real time, and
+    ///        0 replays as fast as the callback will accept packets.
+    /// @param[in] speed  The replay speed.
+    /// @throws std::invalid_argument if speed is negative.
+    void setReplaySpeed(double speed);
+    /// @result The replay speed.  By default this is 1.
+    [[nodiscard]] double getReplaySpeed() const noexcept;
+
+    /// @brief When enabled the packets' times are shifted so that the
+    ///        earliest sample in the replay starts when the replay starts.
+    ///        This lets historical data through the publisher's and
+    ///        sanitizer's latency checks.
+    /// @param[in] shift  True enables the shift.
+    /// @note The shift preserves the original spacing of the packets so the
+    ///       shifted times only track the wall clock at a replay speed of 1.
+    void setShiftToCurrentTime(bool shift) noexcept;
+    /// @result True indicates the packet times are shifted.  By default this
+    ///         is false.
+    [[nodiscard]] bool shiftToCurrentTime() const noexcept;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class and releases memory.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~FileClientOptions();
+    /// @}
+private:
+    class FileClientOptionsImpl;
+    std::unique_ptr<FileClientOptionsImpl> pImpl;
+};
+}
+#endif
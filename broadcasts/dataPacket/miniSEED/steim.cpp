@@ -0,0 +1,247 @@
+#include <string>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+// US8_DISABLE_SSE2 forces the scalar path so it can be tested on x86
+#if defined(__SSE2__) && !defined(US8_DISABLE_SSE2)
+#define US8_STEIM_USE_SSE2
+#include <emmintrin.h>
+#endif
+#include <spdlog/spdlog.h>
+#include "steim.hpp"
+
+// Decoding is done in two passes.  The first expands each frame's packed
+// differences into the output buffer and the second integrates them with a
+// prefix sum.  Splitting the passes keeps the serial dependency out of the
+// unpacking and lets the byte-swap and integration run four samples at a time.
+
+namespace
+{
+
+constexpr size_t FRAME_SIZE{64};
+constexpr int WORDS_PER_FRAME{16};
+
+enum class SteimVersion
+{
+    Steim1,
+    Steim2
+};
+
+/// @brief Loads the 16 words in a frame and puts them in host byte order.
+void loadFrame(const char *frame, const bool swapBytes,
+               std::array<uint32_t, WORDS_PER_FRAME> *words)
+{
+#if defined(US8_STEIM_USE_SSE2)
+    for (int i = 0; i < WORDS_PER_FRAME; i = i + 4)
+    {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                 (frame + 4*i));
+        if (swapBytes)
+        {
+            // Swap the 16-bit halves then the bytes within each half
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *> (words->data() + i), v);
+    }
+#else
+    std::memcpy(words->data(), frame, FRAME_SIZE);
+    if (swapBytes)
+    {
+        for (auto &word : *words){word = __builtin_bswap32(word);}
+    }
+#endif
+}
+
+/// @brief Extracts a signed difference of the given width that starts at the
+///        given bit.
+[[nodiscard]] inline int32_t extract(const uint32_t word,
+                                     const int shift, const int bits)
+{
+    return static_cast<int32_t> (word << (32 - shift - bits)) >> (32 - bits);
+}
+
+/// @brief Integrates the differences in place.  On input x[0] is the first
+///        sample and x[1:] are differences.  On exit x holds the samples.
+void integrate(int32_t *x, const int n)
+{
+    int i{0};
+#if defined(US8_STEIM_USE_SSE2)
+    auto carry = _mm_setzero_si128();
+    for (; i + 4 <= n; i = i + 4)
+    {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *> (x + i));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi32(v, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i *> (x + i), v);
+        carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+#endif
+    // Unsigned arithmetic so that wrapping matches the vectorized path
+    uint32_t sum = (i > 0) ? static_cast<uint32_t> (x[i - 1]) : 0;
+    for (; i < n; ++i)
+    {
+        sum = sum + static_cast<uint32_t> (x[i]);
+        x[i] = static_cast<int32_t> (sum);
+    }
+}
+
+template<SteimVersion V>
+void decode(const char *input, const size_t inputLength,
+            const int nSamples, const bool swapBytes, int32_t *output)
+{
+    if (input == nullptr){throw std::invalid_argument("input is NULL");}
+    if (output == nullptr){throw std::invalid_argument("output is NULL");}
+    if (nSamples < 1){return;}
+    const auto nFrames = inputLength/FRAME_SIZE;
+    if (nFrames < 1){throw std::runtime_error("No Steim frames");}
+    std::array<uint32_t, WORDS_PER_FRAME> words;
+    int32_t x0{0};
+    int32_t xn{0};
+    int nDifferences{0};
+    // Saves a difference.  This returns false once all samples are decoded.
+    auto push = [&](const int32_t difference)
+    {
+        if (nDifferences >= nSamples){return false;}
+        output[nDifferences] = difference;
+        nDifferences = nDifferences + 1;
+        return true;
+    };
+    for (size_t iFrame = 0; iFrame < nFrames; ++iFrame)
+    {
+        loadFrame(input + iFrame*FRAME_SIZE, swapBytes, &words);
+        const auto nibbles = words[0];
+        int firstWord{1};
+        if (iFrame == 0)
+        {
+            // The integration constants are the first and last sample
+            x0 = static_cast<int32_t> (words[1]);
+            xn = static_cast<int32_t> (words[2]);
+            firstWord = 3;
+        }
+        for (int iWord = firstWord; iWord < WORDS_PER_FRAME; ++iWord)
+        {
+            const auto word = words[iWord];
+            const auto nibble = (nibbles >> (30 - 2*iWord)) & 0x3;
+            if (nibble == 0){continue;}
+            if (nibble == 1)
+            {
+                // Four 8-bit differences
+                if (!push(extract(word, 24, 8))){break;}
+                if (!push(extract(word, 16, 8))){break;}
+                if (!push(extract(word,  8, 8))){break;}
+                if (!push(extract(word,  0, 8))){break;}
+                continue;
+            }
+            if constexpr (V == SteimVersion::Steim1)
+            {
+                if (nibble == 2)
+                {
+                    if (!push(extract(word, 16, 16))){break;}
+                    if (!push(extract(word,  0, 16))){break;}
+                }
+                else
+                {
+                    if (!push(static_cast<int32_t> (word))){break;}
+                }
+            }
+            else
+            {
+                const auto dnib = word >> 30;
+                if (nibble == 2)
+                {
+                    if (dnib == 1)
+                    {
+                        if (!push(extract(word, 0, 30))){break;}
+                    }
+                    else if (dnib == 2)
+                    {
+                        if (!push(extract(word, 15, 15))){break;}
+                        if (!push(extract(word,  0, 15))){break;}
+                    }
+                    else if (dnib == 3)
+                    {
+                        if (!push(extract(word, 20, 10))){break;}
+                        if (!push(extract(word, 10, 10))){break;}
+                        if (!push(extract(word,  0, 10))){break;}
+                    }
+                    else
+                    {
+                        throw std::runtime_error(
+                            "Invalid Steim2 dnib 0 for nibble 2");
+                    }
+                }
+                else
+                {
+                    if (dnib == 0)
+                    {
+                        for (int shift = 24; shift >= 0; shift = shift - 6)
+                        {
+                            if (!push(extract(word, shift, 6))){break;}
+                        }
+                    }
+                    else if (dnib == 1)
+                    {
+                        for (int shift = 25; shift >= 0; shift = shift - 5)
+                        {
+                            if (!push(extract(word, shift, 5))){break;}
+                        }
+                    }
+                    else if (dnib == 2)
+                    {
+                        for (int shift = 24; shift >= 0; shift = shift - 4)
+                        {
+                            if (!push(extract(word, shift, 4))){break;}
+                        }
+                    }
+                    else
+                    {
+                        throw std::runtime_error(
+                            "Invalid Steim2 dnib 3 for nibble 3");
+                    }
+                }
+            }
+            if (nDifferences >= nSamples){break;}
+        }
+        if (nDifferences >= nSamples){break;}
+    }
+    if (nDifferences < nSamples)
+    {
+        throw std::runtime_error("Decoded "
+                               + std::to_string(nDifferences)
+                               + " Steim samples but expected "
+                               + std::to_string(nSamples));
+    }
+    // The first difference is relative to the previous record so the
+    // forward integration constant replaces it
+    output[0] = x0;
+    integrate(output, nSamples);
+    if (output[nSamples - 1] != xn)
+    {
+        spdlog::warn("Steim integrity check failed; last sample is "
+                   + std::to_string(output[nSamples - 1])
+                   + " but Xn is " + std::to_string(xn));
+    }
+}
+
+}
+
+/// Steim1
+void US8::Broadcasts::DataPacket::MiniSEED::decodeSteim1(
+    const char *input, const size_t inputLength,
+    const int nSamples, const bool swapBytes, int32_t *output)
+{
+    ::decode<::SteimVersion::Steim1> (input, inputLength,
+                                      nSamples, swapBytes, output);
+}
+
+/// Steim2
+void US8::Broadcasts::DataPacket::MiniSEED::decodeSteim2(
+    const char *input, const size_t inputLength,
+    const int nSamples, const bool swapBytes, int32_t *output)
+{
+    ::decode<::SteimVersion::Steim2> (input, inputLength,
+                                      nSamples, swapBytes, output);
+}
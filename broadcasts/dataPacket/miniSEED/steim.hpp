@@ -0,0 +1,34 @@
+#ifndef US8_BROADCASTS_DATA_PACKET_MINISEED_STEIM_HPP
+#define US8_BROADCASTS_DATA_PACKET_MINISEED_STEIM_HPP
+#include <cstdint>
+#include <cstddef>
+namespace US8::Broadcasts::DataPacket::MiniSEED
+{
+/// @brief Decodes Steim1 compressed samples.
+/// @param[in] input        The Steim1 frames.  Each frame is 64 bytes.
+/// @param[in] inputLength  The number of bytes in input.
+/// @param[in] nSamples     The number of samples to decode.
+/// @param[in] swapBytes    True indicates the frames' byte order differs from
+///                         the host's.  Steim data is nominally big endian.
+/// @param[out] output      The decoded samples.  This must have space for at
+///                         least nSamples values.
+/// @throws std::invalid_argument if input or output is NULL.
+/// @throws std::runtime_error if the frames are corrupt or contain fewer
+///         than nSamples samples.
+void decodeSteim1(const char *input, size_t inputLength,
+                  int nSamples, bool swapBytes, int32_t *output);
+/// @brief Decodes Steim2 compressed samples.
+/// @param[in] input        The Steim2 frames.  Each frame is 64 bytes.
+/// @param[in] inputLength  The number of bytes in input.
+/// @param[in] nSamples     The number of samples to decode.
+/// @param[in] swapBytes    True indicates the frames' byte order differs from
+///                         the host's.  Steim data is nominally big endian.
+/// @param[out] output      The decoded samples.  This must have space for at
+///                         least nSamples values.
+/// @throws std::invalid_argument if input or output is NULL.
+/// @throws std::runtime_error if the frames are corrupt or contain fewer
+///         than nSamples samples.
+void decodeSteim2(const char *input, size_t inputLength,
+                  int nSamples, bool swapBytes, int32_t *output);
+}
+#endif
@@ -0,0 +1,478 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <bit>
+#include <algorithm>
+#include <iterator>
+#ifndef NDEBUG
+#include <cassert>
+#endif
+#include <libmseed.h>
+#include <spdlog/spdlog.h>
+#include "unpacker.hpp"
+#include "steim.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+
+namespace
+{
+
+/// @brief Keeps a libmseed record around for the life of the thread so the
+///        header parsing does not allocate.
+struct ThreadLocalRecord
+{
+    ~ThreadLocalRecord()
+    {
+        if (record){msr3_free(&record);}
+    }
+    MS3Record *record{nullptr};
+};
+
+thread_local ThreadLocalRecord threadLocalRecord;
+
+/// @brief The parts of a record's header needed to fill a packet.
+struct RecordHeader
+{
+    std::array<char, LM_SIDLEN> sid{};
+    int64_t nSamples{0};
+    uint32_t payloadOffset{0};
+    uint32_t payloadLength{0};
+    int32_t recordLength{0};
+    int16_t encoding{0};
+    int8_t swapFlag{0};
+};
+
+/// @brief Reads a value from a record in the given byte order.
+template<typename T>
+[[nodiscard]] T readValue(const char *field, const bool swap) noexcept
+{
+    T value;
+    std::memcpy(&value, field, sizeof(T));
+    if (swap)
+    {
+        if constexpr (sizeof(T) == 2)
+        {
+            value = std::bit_cast<T> (__builtin_bswap16(
+                        std::bit_cast<uint16_t> (value)));
+        }
+        else if constexpr (sizeof(T) == 4)
+        {
+            value = std::bit_cast<T> (__builtin_bswap32(
+                        std::bit_cast<uint32_t> (value)));
+        }
+    }
+    return value;
+}
+
+/// @brief Copies a fixed width header code dropping the spaces as
+///        ms_strncpclean does.
+[[nodiscard]] std::string toCode(const char *field, const size_t width)
+{
+    std::string code;
+    code.reserve(width);
+    for (size_t i = 0; i < width; ++i)
+    {
+        if (field[i] != ' ' && field[i] != '\0'){code.push_back(field[i]);}
+    }
+    return code;
+}
+
+/// @brief Parses a miniSEED2 header without libmseed.  msr3_parse converts
+///        the flags and informational blockettes to JSON extra headers which
+///        allocates on every record even though none of it ends up in the
+///        packet.
+/// @result False indicates the record is not something this handles - e.g.,
+///         it is miniSEED3 or lacks a blockette 1000 - and it should go
+///         through msr3_parse instead.
+[[nodiscard]] bool parseMiniSEED2(
+    const char *record, const uint64_t recordLength,
+    ::RecordHeader *header,
+    US8::MessageFormats::Broadcasts::DataPacket *packet)
+{
+    constexpr uint64_t fixedHeaderLength{48};
+    if (recordLength < fixedHeaderLength + 8){return false;}
+    // The sequence number is digits, spaces, or NULLs which also rules out
+    // miniSEED3
+    for (int i = 0; i < 6; ++i)
+    {
+        if ((record[i] < '0' || record[i] > '9') &&
+            record[i] != ' ' && record[i] != '\0')
+        {
+            return false;
+        }
+    }
+    auto quality = record[6];
+    if (quality != 'D' && quality != 'R' && quality != 'Q' && quality != 'M')
+    {
+        return false;
+    }
+    // The start year and day of year establish the header's byte order
+    auto isValidYearDay = [](const uint16_t year, const uint16_t day)
+    {
+        return year >= 1900 && year <= 2100 && day >= 1 && day <= 366;
+    };
+    bool swap{false};
+    if (!isValidYearDay(::readValue<uint16_t> (record + 20, false),
+                        ::readValue<uint16_t> (record + 22, false)))
+    {
+        swap = true;
+        if (!isValidYearDay(::readValue<uint16_t> (record + 20, true),
+                            ::readValue<uint16_t> (record + 22, true)))
+        {
+            return false;
+        }
+    }
+    // Blockettes
+    int encoding{-1};
+    int wordOrder{-1};
+    int32_t blockette1000RecordLength{0};
+    int microSeconds{0};
+    double blockette100SamplingRate{0};
+    bool haveBlockette100{false};
+    auto nBlockettes = static_cast<int> (static_cast<uint8_t> (record[39]));
+    auto blocketteOffset
+        = static_cast<uint64_t> (::readValue<uint16_t> (record + 46, swap));
+    for (int i = 0; i < nBlockettes && blocketteOffset != 0; ++i)
+    {
+        if (blocketteOffset < fixedHeaderLength ||
+            blocketteOffset + 8 > recordLength)
+        {
+            return false;
+        }
+        const auto blockette = record + blocketteOffset;
+        auto type = ::readValue<uint16_t> (blockette, swap);
+        auto nextOffset
+            = static_cast<uint64_t> (::readValue<uint16_t> (blockette + 2,
+                                                            swap));
+        if (type == 1000)
+        {
+            encoding = static_cast<uint8_t> (blockette[4]);
+            wordOrder = static_cast<uint8_t> (blockette[5]);
+            auto exponent = static_cast<uint8_t> (blockette[6]);
+            if (exponent < 6 || exponent > 20){return false;}
+            blockette1000RecordLength = int32_t {1} << exponent;
+        }
+        else if (type == 1001)
+        {
+            microSeconds = static_cast<int8_t> (blockette[5]);
+        }
+        else if (type == 100)
+        {
+            blockette100SamplingRate = ::readValue<float> (blockette + 4, swap);
+            haveBlockette100 = true;
+        }
+        // Blockettes must be in order
+        if (nextOffset != 0 && nextOffset <= blocketteOffset){return false;}
+        blocketteOffset = nextOffset;
+    }
+    if (blockette1000RecordLength == 0 ||
+        static_cast<uint64_t> (blockette1000RecordLength) > recordLength)
+    {
+        return false;
+    }
+    // Start time with the corrections libmseed applies
+    auto year = ::readValue<uint16_t> (record + 20, swap);
+    auto day = ::readValue<uint16_t> (record + 22, swap);
+    auto hour = static_cast<uint8_t> (record[24]);
+    auto minute = static_cast<uint8_t> (record[25]);
+    auto second = static_cast<uint8_t> (record[26]);
+    auto fraction = ::readValue<uint16_t> (record + 28, swap);
+    nstime_t startTime
+        = ms_time2nstime(year, day, hour, minute, second,
+                         static_cast<uint32_t> (fraction)*100000);
+    if (startTime == NSTERROR){return false;}
+    auto timeCorrection = ::readValue<int32_t> (record + 40, swap);
+    auto activityFlags = static_cast<uint8_t> (record[36]);
+    if (timeCorrection != 0 && (activityFlags & 0x02) == 0)
+    {
+        startTime = startTime + static_cast<nstime_t> (timeCorrection)*100000;
+    }
+    startTime = startTime + static_cast<nstime_t> (microSeconds)*1000;
+    // Sampling rate
+    double samplingRate{blockette100SamplingRate};
+    if (!haveBlockette100)
+    {
+        samplingRate
+            = ms_nomsamprate(::readValue<int16_t> (record + 32, swap),
+                             ::readValue<int16_t> (record + 34, swap));
+    }
+    // Data payload
+    header->nSamples = ::readValue<uint16_t> (record + 30, swap);
+    header->recordLength = blockette1000RecordLength;
+    header->encoding = static_cast<int16_t> (encoding);
+    header->payloadOffset = 0;
+    header->payloadLength = 0;
+    if (header->nSamples > 0)
+    {
+        auto dataOffset = ::readValue<uint16_t> (record + 44, swap);
+        if (dataOffset < fixedHeaderLength ||
+            dataOffset >= blockette1000RecordLength)
+        {
+            return false;
+        }
+        header->payloadOffset = dataOffset;
+        header->payloadLength = static_cast<uint32_t>
+                                (blockette1000RecordLength - dataOffset);
+    }
+    if (encoding == DE_STEIM1 || encoding == DE_STEIM2)
+    {
+        header->swapFlag = ms_bigendianhost() ? 0 : 1;
+    }
+    else
+    {
+        header->swapFlag = ((wordOrder == 1) != (ms_bigendianhost() != 0)) ?
+                           1 : 0;
+    }
+    // Fill in the packet
+    auto network = ::toCode(record + 18, 2);
+    auto station = ::toCode(record + 8, 5);
+    auto location = ::toCode(record + 13, 2);
+    auto channel = ::toCode(record + 15, 3);
+    // libmseed only uses the identifier in messages
+    snprintf(header->sid.data(), header->sid.size(), "%s.%s.%s.%s",
+             network.c_str(), station.c_str(), location.c_str(),
+             channel.c_str());
+    if (location.empty()){location = "--";}
+    packet->setNetwork(std::move(network));
+    packet->setStation(std::move(station));
+    packet->setChannel(std::move(channel));
+    packet->setLocationCode(std::move(location));
+    packet->setSamplingRate(samplingRate);
+    packet->setStartTime(std::chrono::microseconds
+                         {static_cast<int64_t> (std::round(startTime*1.e-3))});
+    return true;
+}
+
+/// @brief Breaks the source identifier, e.g., FDSN:UU_FORK_01_H_H_Z, into
+///        its network, station, location, and channel.  This mirrors
+///        ms_sid2nslc but does not make intermediate copies.
+void setNSLC(const std::string_view sid,
+             US8::MessageFormats::Broadcasts::DataPacket *packet)
+{
+    constexpr std::string_view prefix{"FDSN:"};
+    auto work = sid;
+    if (work.substr(0, prefix.size()) != prefix)
+    {
+        throw std::runtime_error("Unhandled source identifier "
+                               + std::string {sid});
+    }
+    work.remove_prefix(prefix.size());
+    std::array<std::string_view, 3> codes;
+    for (auto &code : codes)
+    {
+        auto delimiter = work.find('_');
+        if (delimiter == std::string_view::npos)
+        {
+            throw std::runtime_error("Failed to unpack SNCL from "
+                                   + std::string {sid});
+        }
+        code = work.substr(0, delimiter);
+        work.remove_prefix(delimiter + 1);
+    }
+    // The band, source, and subsource collapse to a SEED channel code when
+    // each is a single character, i.e., H_H_Z -> HHZ
+    std::string channel;
+    if (work.size() == 5 && work[1] == '_' && work[3] == '_')
+    {
+        channel = {work[0], work[2], work[4]};
+    }
+    else
+    {
+        channel = std::string {work};
+    }
+    std::string location{codes[2]};
+    if (location.empty() || location.substr(0, 2) == "  ")
+    {
+        location = "--";
+    }
+    packet->setNetwork(std::string {codes[0]});
+    packet->setStation(std::string {codes[1]});
+    packet->setChannel(std::move(channel));
+    packet->setLocationCode(std::move(location));
+}
+
+/// @brief Decodes the samples into a vector which is then given to the
+///        packet.
+template<typename T>
+void setData(const ::RecordHeader &header,
+             const char *payload,
+             US8::MessageFormats::Broadcasts::DataPacket *packet)
+{
+    constexpr int8_t verbose{0};
+    std::vector<T> data(static_cast<size_t> (header.nSamples));
+    char sampleType{'\0'};
+    auto nSamples = ms_decode_data(payload, header.payloadLength,
+                                   static_cast<uint8_t> (header.encoding),
+                                   static_cast<uint64_t> (header.nSamples),
+                                   data.data(), data.size()*sizeof(T),
+                                   &sampleType, header.swapFlag,
+                                   header.sid.data(), verbose);
+    if (nSamples < 0)
+    {
+        throw std::runtime_error("Failed to decode data for "
+                               + std::string {header.sid.data()});
+    }
+#ifndef NDEBUG
+    assert(nSamples <= header.nSamples);
+#endif
+    data.resize(static_cast<size_t> (nSamples));
+    packet->setData(std::move(data));
+}
+
+/// @brief Decodes Steim compressed data with the vectorized decoder.
+void setSteimData(const ::RecordHeader &header,
+                  const char *payload,
+                  US8::MessageFormats::Broadcasts::DataPacket *packet)
+{
+    namespace UMS = US8::Broadcasts::DataPacket::MiniSEED;
+    const auto nSamples = static_cast<int> (header.nSamples);
+    std::vector<int> data(static_cast<size_t> (nSamples));
+    if (header.encoding == DE_STEIM1)
+    {
+        UMS::decodeSteim1(payload, header.payloadLength, nSamples,
+                          header.swapFlag != 0, data.data());
+    }
+    else
+    {
+        UMS::decodeSteim2(payload, header.payloadLength, nSamples,
+                          header.swapFlag != 0, data.data());
+    }
+    packet->setData(std::move(data));
+}
+
+/// @brief Parses a record's header with libmseed.
+void parseRecord(const char *record, const uint64_t recordLength,
+                 ::RecordHeader *header,
+                 US8::MessageFormats::Broadcasts::DataPacket *packet)
+{
+    auto &miniSEEDRecord = threadLocalRecord.record;
+    constexpr int8_t verbose{0};
+    // Only parse the header.  The data are decoded directly into the
+    // packet's storage.
+    constexpr uint32_t flags{0};
+    auto returnCode = msr3_parse(record, recordLength,
+                                 &miniSEEDRecord, flags, verbose);
+    if (returnCode != MS_NOERROR || miniSEEDRecord == nullptr)
+    {
+        if (returnCode < 0)
+        {
+            throw std::runtime_error("libmseed error detected");
+        }
+        throw std::runtime_error(
+             "Insufficient data.  Number of additional bytes estimated is "
+            + std::to_string(returnCode));
+    }
+    const auto &msRecord = *miniSEEDRecord;
+    // SNCL
+    ::setNSLC(std::string_view {msRecord.sid}, packet);
+    // Sampling rate
+    packet->setSamplingRate(msRecord.samprate);
+    // Start time (convert from nanoseconds to microseconds)
+    packet->setStartTime(std::chrono::microseconds
+                         {static_cast<int64_t>
+                          (std::round(msRecord.starttime*1.e-3))});
+    std::copy(std::begin(msRecord.sid), std::end(msRecord.sid),
+              header->sid.begin());
+    header->nSamples = msRecord.samplecnt;
+    header->recordLength = msRecord.reclen;
+    header->encoding = msRecord.encoding;
+    header->payloadOffset = 0;
+    header->payloadLength = 0;
+    if (msRecord.samplecnt > 0)
+    {
+        if (msr3_data_bounds(&msRecord, &header->payloadOffset,
+                             &header->payloadLength) != 0)
+        {
+            throw std::runtime_error("Could not find data payload for "
+                                   + std::string {msRecord.sid});
+        }
+    }
+    // Steim is always big endian.  Otherwise, miniSEED3 is little endian
+    // and miniSEED2 follows the record's byte order.
+    header->swapFlag = 0;
+    if (msRecord.encoding == DE_STEIM1 || msRecord.encoding == DE_STEIM2)
+    {
+        header->swapFlag = ms_bigendianhost() ? 0 : 1;
+    }
+    else if (msRecord.formatversion == 3)
+    {
+        header->swapFlag = ms_bigendianhost() ? 1 : 0;
+    }
+    else
+    {
+        header->swapFlag = (msRecord.swapflag & MSSWAP_PAYLOAD) ? 1 : 0;
+    }
+}
+
+}
+
+/// Unpacks the records
+void US8::Broadcasts::DataPacket::MiniSEED::unpack(
+    const char *buffer,
+    const uint64_t bufferLength,
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> *packets)
+{
+    if (buffer == nullptr){throw std::invalid_argument("buffer is NULL");}
+    if (packets == nullptr){throw std::invalid_argument("packets is NULL");}
+    uint64_t offset{0};
+    const auto nPacketsIn = packets->size();
+    while (bufferLength - offset > MINRECLEN)
+    {
+        US8::MessageFormats::Broadcasts::DataPacket dataPacket;
+        ::RecordHeader header;
+        if (!::parseMiniSEED2(buffer + offset, bufferLength - offset,
+                              &header, &dataPacket))
+        {
+            ::parseRecord(buffer + offset, bufferLength - offset,
+                          &header, &dataPacket);
+        }
+        // Data
+        if (header.nSamples > 0)
+        {
+            uint8_t sampleSize{0};
+            char sampleType{'\0'};
+            if (ms_encoding_sizetype(static_cast<uint8_t> (header.encoding),
+                                     &sampleSize, &sampleType) != 0)
+            {
+                throw std::runtime_error("Unhandled encoding "
+                                       + std::to_string(header.encoding));
+            }
+            const auto payload = buffer + offset + header.payloadOffset;
+            if (header.encoding == DE_STEIM1 || header.encoding == DE_STEIM2)
+            {
+                ::setSteimData(header, payload, &dataPacket);
+            }
+            else if (sampleType == 'i')
+            {
+                ::setData<int> (header, payload, &dataPacket);
+            }
+            else if (sampleType == 'f')
+            {
+                ::setData<float> (header, payload, &dataPacket);
+            }
+            else if (sampleType == 'd')
+            {
+                ::setData<double> (header, payload, &dataPacket);
+            }
+            else
+            {
+                throw std::runtime_error("Unhandled sample type");
+            }
+        } // End check on nSamples
+        packets->push_back(std::move(dataPacket));
+        offset = offset + static_cast<uint64_t> (header.recordLength);
+    }
+    const auto nUnpacked = packets->size() - nPacketsIn;
+    if (nUnpacked > 1)
+    {
+        spdlog::warn("Multiple mseed packets received");
+    }
+    else if (nUnpacked == 0)
+    {
+        spdlog::warn("No mseed packets unpacked");
+    }
+}
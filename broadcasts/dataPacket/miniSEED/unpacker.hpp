@@ -0,0 +1,25 @@
+#ifndef US8_BROADCASTS_DATA_PACKET_MINISEED_UNPACKER_HPP
+#define US8_BROADCASTS_DATA_PACKET_MINISEED_UNPACKER_HPP
+#include <vector>
+#include <cstdint>
+namespace US8::MessageFormats::Broadcasts
+{
+ class DataPacket;
+}
+namespace US8::Broadcasts::DataPacket::MiniSEED
+{
+/// @brief Unpacks the miniSEED2 or miniSEED3 records in a buffer to data
+///        packets.
+/// @param[in] buffer        The buffer containing one or more records.
+/// @param[in] bufferLength  The number of bytes in the buffer.
+/// @param[in,out] packets   The unpacked packets are appended to this.
+/// @throws std::invalid_argument if buffer is NULL or packets is NULL.
+/// @throws std::runtime_error if a record cannot be unpacked.
+/// @note miniSEED2 headers are read directly and other records reuse a
+///       per-thread libmseed structure so this does not allocate beyond the
+///       packets themselves.  The samples are decoded directly into the
+///       packet's storage.
+void unpack(const char *buffer, uint64_t bufferLength,
+            std::vector<US8::MessageFormats::Broadcasts::DataPacket> *packets);
+}
+#endif
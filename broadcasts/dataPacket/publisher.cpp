@@ -1,4 +1,6 @@
 #include <string>
+#include <vector>
+#include <cstdint>
 #ifndef NDEBUG
 #include <cassert>
 #endif
@@ -7,10 +9,33 @@
 #include <zmq_addon.hpp>
 #include "us8/broadcasts/dataPacket/publisher.hpp"
 #include "us8/broadcasts/dataPacket/publisherOptions.hpp"
+#include "us8/messageFormats/message.hpp"
 #include "us8/messageFormats/broadcasts/dataPacket.hpp"
 
 using namespace US8::Broadcasts::DataPacket;
 
+namespace
+{
+/// Tracks whether the publisher socket has a live connection to its peer.
+class ConnectionMonitor : public zmq::monitor_t
+{
+public:
+    void on_event_connected(const zmq_event_t &, const char *) override
+    {
+        mConnected = true;
+    }
+    void on_event_disconnected(const zmq_event_t &, const char *) override
+    {
+        mConnected = false;
+    }
+    void on_event_closed(const zmq_event_t &, const char *) override
+    {
+        mConnected = false;
+    }
+    bool mConnected{false};
+};
+}
+
 class Publisher::PublisherImpl
 {   
 public:
@@ -30,6 +55,14 @@ public:
             }
             mPublisherSocket.set(zmq::sockopt::sndtimeo,
                                   timeOutMilliSeconds);
+            // The monitor must be attached before connecting so that the
+            // first connection event is seen
+            auto monitorAddress
+                = "inproc://us8-publisher-monitor-"
+                + std::to_string(reinterpret_cast<uintptr_t> (this));
+            mMonitor.init(mPublisherSocket, monitorAddress,
+                          ZMQ_EVENT_CONNECTED | ZMQ_EVENT_DISCONNECTED |
+                          ZMQ_EVENT_CLOSED);
             spdlog::info("Publisher connecting to "
                        + mOptions.getEndPoint());
             mPublisherSocket.connect(mOptions.getEndPoint());
@@ -44,16 +77,16 @@ public:
         mInitialized = true;
     }
     /// Sends a message
-    void send(const US8::MessageFormats::Broadcasts::DataPacket &dataPacket)
+    void send(const US8::MessageFormats::IMessage &message)
     {
-        auto messageType = dataPacket.getMessageType(); // Throws
+        auto messageType = message.getMessageType(); // Throws
 #ifndef NDEBUG
         if (messageType.empty())
         {
-            throw std::runtime_error("Message type for data packet is empty");
+            throw std::runtime_error("Message type for message is empty");
         }
 #endif
-        auto messagePayload = dataPacket.serialize();
+        auto messagePayload = message.serialize();
         std::array<zmq::const_buffer, 2> messages{
             zmq::const_buffer {messageType.data(),
                                messageType.size()},
@@ -72,6 +105,7 @@ public:
     PublisherOptions mOptions;
     zmq::context_t mPublisherContext{1};
     zmq::socket_t mPublisherSocket{mPublisherContext, zmq::socket_type::pub};
+    ::ConnectionMonitor mMonitor;
     bool mInitialized{false};
 };
 
@@ -92,6 +126,53 @@ void Publisher::send(
     pImpl->send(dataPacket);
 }
 
+/// Send a batch.  Subscribers expect one packet per message so this is
+/// one send per packet.
+int Publisher::send(
+    const std::vector<US8::MessageFormats::Broadcasts::DataPacket> &dataPackets)
+{
+    if (!pImpl->mInitialized)
+    {
+        throw std::invalid_argument("Publisher not initialized");
+    }
+    int nSent{0};
+    for (const auto &dataPacket : dataPackets)
+    {
+        try
+        {
+            pImpl->send(dataPacket);
+            nSent = nSent + 1;
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::debug("Failed to send packet because "
+                        + std::string {e.what()});
+        }
+    }
+    return nSent;
+}
+
+/// Send a message
+void Publisher::send(const US8::MessageFormats::IMessage &message)
+{
+    if (!pImpl->mInitialized)
+    {
+        throw std::invalid_argument("Publisher not initialized");
+    }
+    pImpl->send(message);
+}
+
+/// Connected?
+bool Publisher::isConnected()
+{
+    if (!pImpl->mInitialized){return false;}
+    // Process all pending events without waiting
+    while (pImpl->mMonitor.check_event(0))
+    {
+    }
+    return pImpl->mMonitor.mConnected;
+}
+
 void Publisher::operator()(
     const US8::MessageFormats::Broadcasts::DataPacket &dataPacket)
 {
@@ -0,0 +1,305 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <nlohmann/json.hpp>
+#include "availabilityIndex.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "toName.hpp"
+
+using namespace US8::Broadcasts::DataPacket::Sanitizer;
+
+namespace
+{
+
+using Segments = std::map<std::chrono::microseconds, std::chrono::microseconds>;
+
+struct Stream
+{
+    // Merged spans with data keyed on start time.  The value is the end time.
+    ::Segments segments;
+    // Merged spans for which data arrived more than once
+    ::Segments overlaps;
+    // Start of the earliest data seen
+    std::chrono::microseconds firstStartTime{0};
+    // Spans separated by less than this are contiguous (half a sample)
+    std::chrono::microseconds tolerance{0};
+};
+
+/// Merges the span into the segments.  The portions of the span that were
+/// already present are appended to overlaps.
+void merge(::Segments *segments,
+           const std::chrono::microseconds &startTime,
+           const std::chrono::microseconds &endTime,
+           const std::chrono::microseconds &tolerance,
+           std::vector<AvailabilityIndex::Segment> *overlaps = nullptr)
+{
+    auto mergedStartTime = startTime;
+    auto mergedEndTime = endTime;
+    // Only the segment before the span's start can reach into it
+    auto it = segments->upper_bound(startTime);
+    if (it != segments->begin())
+    {
+        auto previous = std::prev(it);
+        if (previous->second + tolerance >= startTime){it = previous;}
+    }
+    while (it != segments->end() && it->first <= endTime + tolerance)
+    {
+        if (overlaps)
+        {
+            auto overlapStartTime = std::max(startTime, it->first);
+            auto overlapEndTime = std::min(endTime, it->second);
+            if (overlapEndTime - overlapStartTime > tolerance)
+            {
+                overlaps->push_back(AvailabilityIndex::Segment
+                                    {overlapStartTime, overlapEndTime});
+            }
+        }
+        mergedStartTime = std::min(mergedStartTime, it->first);
+        mergedEndTime = std::max(mergedEndTime, it->second);
+        it = segments->erase(it);
+    }
+    segments->insert(std::pair {mergedStartTime, mergedEndTime});
+}
+
+/// Forgets the segments that end before the given time
+void prune(::Segments *segments, const std::chrono::microseconds &time)
+{
+    while (!segments->empty() && segments->begin()->second <= time)
+    {
+        segments->erase(segments->begin());
+    }
+}
+
+/// The segments clipped to the window
+std::vector<AvailabilityIndex::Segment>
+    clip(const ::Segments &segments,
+         const std::chrono::microseconds &startTime,
+         const std::chrono::microseconds &endTime)
+{
+    std::vector<AvailabilityIndex::Segment> result;
+    auto it = segments.upper_bound(startTime);
+    if (it != segments.begin() && std::prev(it)->second > startTime)
+    {
+        it = std::prev(it);
+    }
+    for ( ; it != segments.end() && it->first < endTime; ++it)
+    {
+        result.push_back(AvailabilityIndex::Segment
+                         {std::max(it->first, startTime),
+                          std::min(it->second, endTime)});
+    }
+    return result;
+}
+
+AvailabilityIndex::Availability
+    summarize(const std::string &name,
+              const ::Stream &stream,
+              const std::chrono::microseconds &startTime,
+              const std::chrono::microseconds &endTime)
+{
+    AvailabilityIndex::Availability availability;
+    availability.stream = name;
+    availability.window = AvailabilityIndex::Segment {startTime, endTime};
+    std::chrono::microseconds covered{0};
+    auto cursor = startTime;
+    for (const auto &segment : ::clip(stream.segments, startTime, endTime))
+    {
+        if (segment.startTime > cursor)
+        {
+            availability.gaps.push_back(AvailabilityIndex::Segment
+                                        {cursor, segment.startTime});
+        }
+        covered = covered + (segment.endTime - segment.startTime);
+        cursor = std::max(cursor, segment.endTime);
+    }
+    if (cursor < endTime)
+    {
+        availability.gaps.push_back(AvailabilityIndex::Segment
+                                    {cursor, endTime});
+    }
+    for (const auto &gap : availability.gaps)
+    {
+        availability.largestGap
+            = std::max(availability.largestGap, gap.endTime - gap.startTime);
+    }
+    availability.overlaps = ::clip(stream.overlaps, startTime, endTime);
+    availability.percentComplete
+        = 100.*static_cast<double> (covered.count())
+         /static_cast<double> ((endTime - startTime).count());
+    return availability;
+}
+
+}
+
+class AvailabilityIndex::AvailabilityIndexImpl
+{
+public:
+    mutable std::mutex mMutex;
+    std::map<std::string, ::Stream> mStreams;
+    std::chrono::seconds mWindow{3600};
+};
+
+/// Constructor
+AvailabilityIndex::AvailabilityIndex(const std::chrono::seconds &window) :
+    pImpl(std::make_unique<AvailabilityIndexImpl> ())
+{
+    if (window.count() <= 0)
+    {
+        throw std::invalid_argument("Window must be positive");
+    }
+    pImpl->mWindow = window;
+}
+
+/// Destructor
+AvailabilityIndex::~AvailabilityIndex() = default;
+
+/// Update
+void AvailabilityIndex::update(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet,
+    const std::chrono::microseconds &now)
+{
+    if (packet.getNumberOfSamples() < 1)
+    {
+        throw std::invalid_argument("No samples in packet");
+    }
+    auto name = ::toName(packet);
+    std::chrono::microseconds samplingPeriod
+    {
+        static_cast<int64_t> (std::round(1.e6/packet.getSamplingRate()))
+    };
+    // A packet covers through the start of the sample after its last sample
+    auto startTime = packet.getStartTime();
+    auto endTime = packet.getEndTime() + samplingPeriod; // Throws
+    auto windowStartTime
+        = now - std::chrono::duration_cast<std::chrono::microseconds>
+                (pImpl->mWindow);
+    if (endTime <= windowStartTime){return;}
+    std::lock_guard<std::mutex> lockGuard(pImpl->mMutex);
+    auto [streamIndex, inserted] = pImpl->mStreams.try_emplace(name);
+    auto &stream = streamIndex->second;
+    if (inserted || startTime < stream.firstStartTime)
+    {
+        stream.firstStartTime = startTime;
+    }
+    stream.tolerance = samplingPeriod/2;
+    std::vector<AvailabilityIndex::Segment> overlaps;
+    ::merge(&stream.segments, startTime, endTime, stream.tolerance,
+            &overlaps);
+    for (const auto &overlap : overlaps)
+    {
+        ::merge(&stream.overlaps, overlap.startTime, overlap.endTime,
+                stream.tolerance);
+    }
+}
+
+/// Query a stream
+AvailabilityIndex::Availability AvailabilityIndex::getAvailability(
+    const std::string &name,
+    const std::chrono::microseconds &startTime,
+    const std::chrono::microseconds &endTime) const
+{
+    if (endTime <= startTime)
+    {
+        throw std::invalid_argument("End time must exceed start time");
+    }
+    std::lock_guard<std::mutex> lockGuard(pImpl->mMutex);
+    auto streamIndex = pImpl->mStreams.find(name);
+    if (streamIndex == pImpl->mStreams.end())
+    {
+        throw std::invalid_argument(name + " is not tracked");
+    }
+    return ::summarize(name, streamIndex->second, startTime, endTime);
+}
+
+/// Summarize the rolling window
+std::vector<AvailabilityIndex::Availability>
+    AvailabilityIndex::getAvailability(const std::chrono::microseconds &now)
+{
+    std::vector<AvailabilityIndex::Availability> result;
+    auto windowStartTime
+        = now - std::chrono::duration_cast<std::chrono::microseconds>
+                (pImpl->mWindow);
+    std::lock_guard<std::mutex> lockGuard(pImpl->mMutex);
+    result.reserve(pImpl->mStreams.size());
+    for (auto it = pImpl->mStreams.begin(); it != pImpl->mStreams.end(); )
+    {
+        auto &stream = it->second;
+        ::prune(&stream.segments, windowStartTime);
+        ::prune(&stream.overlaps, windowStartTime);
+        if (stream.segments.empty())
+        {
+            it = pImpl->mStreams.erase(it);
+            continue;
+        }
+        // A stream is not penalized for the time before it was first seen
+        // or for the data that has yet to arrive
+        auto startTime = std::max(windowStartTime, stream.firstStartTime);
+        auto endTime = std::min(now, stream.segments.rbegin()->second);
+        if (startTime < endTime)
+        {
+            auto availability
+                = ::summarize(it->first, stream, startTime, endTime);
+            availability.latency = now - endTime;
+            result.push_back(std::move(availability));
+        }
+        ++it;
+    }
+    return result;
+}
+
+/// Streams
+std::vector<std::string> AvailabilityIndex::getStreams() const
+{
+    std::vector<std::string> result;
+    std::lock_guard<std::mutex> lockGuard(pImpl->mMutex);
+    result.reserve(pImpl->mStreams.size());
+    for (const auto &[name, stream] : pImpl->mStreams)
+    {
+        result.push_back(name);
+    }
+    return result;
+}
+
+/// Window
+std::chrono::seconds AvailabilityIndex::getWindow() const noexcept
+{
+    return pImpl->mWindow;
+}
+
+/// Serialize
+std::string US8::Broadcasts::DataPacket::Sanitizer::toJSON(
+    const std::vector<AvailabilityIndex::Availability> &availability,
+    const std::chrono::microseconds &now)
+{
+    auto toPairs = [](const std::vector<AvailabilityIndex::Segment> &segments)
+    {
+        auto pairs = nlohmann::json::array();
+        for (const auto &segment : segments)
+        {
+            pairs.push_back({segment.startTime.count(),
+                             segment.endTime.count()});
+        }
+        return pairs;
+    };
+    nlohmann::json obj;
+    obj["time"] = now.count();
+    obj["streams"] = nlohmann::json::array();
+    for (const auto &summary : availability)
+    {
+        nlohmann::json stream;
+        stream["stream"] = summary.stream;
+        stream["startTime"] = summary.window.startTime.count();
+        stream["endTime"] = summary.window.endTime.count();
+        stream["percentComplete"] = summary.percentComplete;
+        stream["largestGap"] = summary.largestGap.count();
+        stream["latency"] = summary.latency.count();
+        stream["gaps"] = toPairs(summary.gaps);
+        stream["overlaps"] = toPairs(summary.overlaps);
+        obj["streams"].push_back(std::move(stream));
+    }
+    return obj.dump();
+}
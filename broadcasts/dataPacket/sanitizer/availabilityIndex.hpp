@@ -0,0 +1,114 @@
+#ifndef US8_BROADCASTS_SANITIZER_AVAILABILITY_INDEX_HPP
+#define US8_BROADCASTS_SANITIZER_AVAILABILITY_INDEX_HPP
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+namespace US8::MessageFormats::Broadcasts
+{
+class DataPacket;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+/// @brief Maintains the data availability of each stream over a rolling
+///        window.  Each packet's time span is merged into the stream's
+///        contiguous segments as it arrives, so queries never scan the
+///        individual packets.  Data that arrives more than once, e.g.,
+///        duplicates or timing slips, is additionally recorded as an overlap.
+/// @note This is thread-safe.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class AvailabilityIndex
+{
+public:
+    /// @brief A time span.  The start is inclusive and the end is exclusive.
+    struct Segment
+    {
+        /// The UTC start time in microseconds from the epoch.
+        std::chrono::microseconds startTime{0};
+        /// The UTC end time in microseconds from the epoch.
+        std::chrono::microseconds endTime{0};
+    };
+    /// @brief The availability of a stream in a query window.
+    struct Availability
+    {
+        /// The stream's name - e.g., UU.FORK.HHZ.01.
+        std::string stream;
+        /// The query window.
+        Segment window;
+        /// The spans in the window with no data.
+        std::vector<Segment> gaps;
+        /// The spans in the window for which data arrived more than once.
+        std::vector<Segment> overlaps;
+        /// The duration of the longest gap.
+        std::chrono::microseconds largestGap{0};
+        /// The percentage of the window covered by data.
+        double percentComplete{0};
+        /// For the rolling window, the time from the end of the stream's
+        /// latest data to now.  This is not counted as a gap.
+        std::chrono::microseconds latency{0};
+    };
+public:
+    /// @brief Constructor.
+    /// @param[in] window  The duration of the rolling window.  Data that
+    ///                    ends before the window is forgotten.
+    /// @throws std::invalid_argument if window is not positive.
+    explicit AvailabilityIndex(const std::chrono::seconds &window);
+
+    /// @brief Adds a packet's time span to its stream.
+    /// @param[in] packet  The packet.
+    /// @param[in] now     The current UTC time in microseconds from the epoch.
+    /// @throws std::invalid_argument if the packet lacks a name, sampling
+    ///         rate, or samples.
+    void update(const US8::MessageFormats::Broadcasts::DataPacket &packet,
+                const std::chrono::microseconds &now);
+
+    /// @param[in] stream     The stream's name - e.g., UU.FORK.HHZ.01.
+    /// @param[in] startTime  The UTC start time of the query window in
+    ///                       microseconds from the epoch.
+    /// @param[in] endTime    The UTC end time of the query window in
+    ///                       microseconds from the epoch.
+    /// @result The stream's availability in the query window.
+    /// @throws std::invalid_argument if the stream is not tracked or the
+    ///         end time does not exceed the start time.
+    [[nodiscard]] Availability getAvailability(const std::string &stream,
+                                               const std::chrono::microseconds &startTime,
+                                               const std::chrono::microseconds &endTime) const;
+    /// @brief Forgets data that ended before the rolling window then
+    ///        summarizes each stream over the rolling window.
+    /// @param[in] now  The current UTC time in microseconds from the epoch.
+    /// @result The availability of each stream over the rolling window.
+    ///         Each stream's window ends at its latest data so that data
+    ///         still in transit does not appear as a gap.  The time from
+    ///         the latest data to now is reported as the latency.
+    [[nodiscard]] std::vector<Availability> getAvailability(const std::chrono::microseconds &now);
+    /// @result The tracked streams.
+    [[nodiscard]] std::vector<std::string> getStreams() const;
+    /// @result The rolling window's duration.
+    [[nodiscard]] std::chrono::seconds getWindow() const noexcept;
+
+    /// @brief Destructor.
+    ~AvailabilityIndex();
+
+    AvailabilityIndex() = delete;
+    AvailabilityIndex(const AvailabilityIndex &) = delete;
+    AvailabilityIndex(AvailabilityIndex &&) noexcept = delete;
+    AvailabilityIndex& operator=(const AvailabilityIndex &) = delete;
+    AvailabilityIndex& operator=(AvailabilityIndex &&) noexcept = delete;
+private:
+    class AvailabilityIndexImpl;
+    std::unique_ptr<AvailabilityIndexImpl> pImpl;
+};
+
+/// @brief Serializes availability summaries so that dashboards and scripts
+///        outside of the sanitizer can read them.
+/// @param[in] availability  The availability summaries.
+/// @param[in] now           The UTC time in microseconds from the epoch at
+///                          which the summaries were computed.
+/// @result A JSON object with the time and a streams array.  Each stream
+///         has its window, percent complete, largest gap, latency, and
+///         its gaps and overlaps as [start, end] pairs.  Times and
+///         durations are in microseconds.
+[[nodiscard]] std::string toJSON(const std::vector<AvailabilityIndex::Availability> &availability,
+                                 const std::chrono::microseconds &now);
+}
+#endif
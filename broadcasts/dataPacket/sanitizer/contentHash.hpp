@@ -0,0 +1,139 @@
+#ifndef CONTENT_HASH_HPP
+#define CONTENT_HASH_HPP
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+
+namespace
+{
+
+/// Implements the 64-bit xxHash (XXH64) of a block of bytes.
+[[nodiscard]] inline uint64_t xxHash64(const void *input, const size_t length,
+                                       const uint64_t seed = 0) noexcept
+{
+    constexpr uint64_t PRIME1{0x9E3779B185EBCA87ULL};
+    constexpr uint64_t PRIME2{0xC2B2AE3D27D4EB4FULL};
+    constexpr uint64_t PRIME3{0x165667B19E3779F9ULL};
+    constexpr uint64_t PRIME4{0x85EBCA77C2B2AE63ULL};
+    constexpr uint64_t PRIME5{0x27D4EB2F165667C5ULL};
+    auto rotateLeft = [](const uint64_t x, const int r) -> uint64_t
+    {
+        return (x << r) | (x >> (64 - r));
+    };
+    auto read64 = [](const unsigned char *p) -> uint64_t
+    {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(uint64_t));
+        return value;
+    };
+    auto read32 = [](const unsigned char *p) -> uint64_t
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(uint32_t));
+        return value;
+    };
+    auto round = [&](uint64_t accumulator, const uint64_t lane) -> uint64_t
+    {
+        accumulator = accumulator + lane*PRIME2;
+        accumulator = rotateLeft(accumulator, 31);
+        return accumulator*PRIME1;
+    };
+    auto mergeRound = [&](uint64_t accumulator, const uint64_t value)
+        -> uint64_t
+    {
+        accumulator = accumulator ^ round(0, value);
+        return accumulator*PRIME1 + PRIME4;
+    };
+    const auto *p = static_cast<const unsigned char *> (input);
+    const auto *end = p + length;
+    uint64_t hash{0};
+    if (length >= 32)
+    {
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        const auto *limit = end - 32;
+        do
+        {
+            v1 = round(v1, read64(p));      p = p + 8;
+            v2 = round(v2, read64(p));      p = p + 8;
+            v3 = round(v3, read64(p));      p = p + 8;
+            v4 = round(v4, read64(p));      p = p + 8;
+        } while (p <= limit);
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7)
+             + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    }
+    else
+    {
+        hash = seed + PRIME5;
+    }
+    hash = hash + static_cast<uint64_t> (length);
+    while (p + 8 <= end)
+    {
+        hash = hash ^ round(0, read64(p));
+        hash = rotateLeft(hash, 27)*PRIME1 + PRIME4;
+        p = p + 8;
+    }
+    if (p + 4 <= end)
+    {
+        hash = hash ^ (read32(p)*PRIME1);
+        hash = rotateLeft(hash, 23)*PRIME2 + PRIME3;
+        p = p + 4;
+    }
+    while (p < end)
+    {
+        hash = hash ^ (static_cast<uint64_t> (*p)*PRIME5);
+        hash = rotateLeft(hash, 11)*PRIME1;
+        p = p + 1;
+    }
+    hash = hash ^ (hash >> 33);
+    hash = hash*PRIME2;
+    hash = hash ^ (hash >> 29);
+    hash = hash*PRIME3;
+    hash = hash ^ (hash >> 32);
+    return hash;
+}
+
+/// @result The hash of the packet's samples.  The data type seeds the hash
+///         so identical bits with different types hash differently.
+/// @throws std::runtime_error if the packet's data type is unknown.
+[[nodiscard]] inline uint64_t
+toContentHash(const US8::MessageFormats::Broadcasts::DataPacket &packet)
+{
+    using DataType = US8::MessageFormats::Broadcasts::DataPacket::DataType;
+    auto dataType = packet.getDataType();
+    size_t sampleSize{0};
+    if (dataType == DataType::Integer32)
+    {
+        sampleSize = sizeof(int32_t);
+    }
+    else if (dataType == DataType::Integer64)
+    {
+        sampleSize = sizeof(int64_t);
+    }
+    else if (dataType == DataType::Float)
+    {
+        sampleSize = sizeof(float);
+    }
+    else if (dataType == DataType::Double)
+    {
+        sampleSize = sizeof(double);
+    }
+    else
+    {
+        throw std::runtime_error("Cannot hash packet with unknown data type");
+    }
+    auto nSamples = static_cast<size_t> (std::max(0, packet.getNumberOfSamples()));
+    return ::xxHash64(packet.getDataPointer(), nSamples*sampleSize,
+                      static_cast<uint64_t> (dataType));
+}
+
+}
+#endif
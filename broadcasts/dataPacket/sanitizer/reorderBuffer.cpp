@@ -0,0 +1,315 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cassert>
+#include <spdlog/spdlog.h>
+#include "reorderBuffer.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "toName.hpp"
+
+using namespace US8::Broadcasts::DataPacket::Sanitizer;
+
+namespace
+{
+
+/// The held packets of a stream and where the stream's released packets end
+struct Stream
+{
+    std::map<std::chrono::microseconds,
+             US8::MessageFormats::Broadcasts::DataPacket> held;
+    // Expected start time of the next contiguous packet
+    std::chrono::microseconds nextStartTime{0};
+    // Half a sample interval
+    std::chrono::microseconds tolerance{0};
+    // This stream's position in the recently used list
+    std::list<std::string>::iterator recentlyUsed;
+    std::chrono::microseconds lastUpdate{0};
+    // Timers in the wheel that point to this stream
+    int64_t nTimers{0};
+    bool haveNextStartTime{false};
+};
+
+/// A hold deadline.  Released packets leave their timers in the wheel; these
+/// are ignored when they expire.
+struct Timer
+{
+    ::Stream *stream{nullptr};
+    std::chrono::microseconds startTime{0};
+};
+
+}
+
+class ReorderBuffer::ReorderBufferImpl
+{
+public:
+    explicit ReorderBufferImpl(const std::chrono::milliseconds &maximumHoldLatency) :
+        mMaximumHoldLatency(maximumHoldLatency)
+    {
+        // Every deadline fits within one revolution of the wheel
+        mResolution = std::max(std::chrono::milliseconds {1},
+                               mMaximumHoldLatency/256);
+        mHoldTicks = (mMaximumHoldLatency.count() + mResolution.count() - 1)
+                    /mResolution.count();
+        mWheel.resize(static_cast<size_t> (mHoldTicks + 1));
+    }
+    [[nodiscard]] int64_t toTick(const std::chrono::microseconds &now)
+    {
+        if (!mHaveOrigin)
+        {
+            mOrigin = now;
+            mHaveOrigin = true;
+        }
+        return std::max(int64_t {0}, static_cast<int64_t> ((now - mOrigin)/mResolution));
+    }
+    [[nodiscard]] std::vector<::Timer> &toSlot(const int64_t tick)
+    {
+        return mWheel[static_cast<size_t> (tick % static_cast<int64_t> (mWheel.size()))];
+    }
+    /// Moves the packet to the output and advances the stream
+    void releasePacket(
+        ::Stream &stream,
+        US8::MessageFormats::Broadcasts::DataPacket &&packet,
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released)
+    {
+        try
+        {
+            auto samplingPeriod
+                = std::chrono::microseconds
+                  {static_cast<int64_t> (std::round(1.e6/packet.getSamplingRate()))};
+            auto nextStartTime = packet.getEndTime() + samplingPeriod; // Throws
+            if (!stream.haveNextStartTime ||
+                nextStartTime > stream.nextStartTime)
+            {
+                stream.nextStartTime = nextStartTime;
+            }
+            stream.tolerance = samplingPeriod/2;
+            stream.haveNextStartTime = true;
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::debug("Cannot compute next start time because "
+                        + std::string {e.what()});
+        }
+        released->push_back(std::move(packet));
+    }
+    /// Releases held packets that continue the stream
+    void releaseContiguous(
+        ::Stream &stream,
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released)
+    {
+        while (!stream.held.empty() &&
+               stream.held.begin()->first <=
+               stream.nextStartTime + stream.tolerance)
+        {
+            auto node = stream.held.extract(stream.held.begin());
+            mNumberOfHeldPackets = mNumberOfHeldPackets - 1;
+            releasePacket(stream, std::move(node.mapped()), released);
+        }
+    }
+    /// Gives up on the gap preceding the packet
+    void expire(
+        const ::Timer &timer,
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released)
+    {
+        auto &stream = *timer.stream;
+        stream.nTimers = stream.nTimers - 1;
+        // The packet may have already been released
+        if (!stream.held.contains(timer.startTime)){return;}
+        while (!stream.held.empty() &&
+               stream.held.begin()->first <= timer.startTime)
+        {
+            auto node = stream.held.extract(stream.held.begin());
+            mNumberOfHeldPackets = mNumberOfHeldPackets - 1;
+            releasePacket(stream, std::move(node.mapped()), released);
+        }
+        releaseContiguous(stream, released);
+    }
+    /// Forgets the streams that have been idle too long.  A stream is only
+    /// forgotten once it holds no packets and no timer refers to it; its
+    /// next packet is then released as though it were the first.  Since
+    /// streams are forgotten in least recently used order this can delay
+    /// the eviction of other idle streams by up to the hold latency.
+    void evictStreams(const std::chrono::microseconds &now)
+    {
+        if (mStreamTimeToLive.count() <= 0){return;}
+        while (!mRecentlyUsed.empty())
+        {
+            auto streamIndex = mStreams.find(mRecentlyUsed.back());
+#ifndef NDEBUG
+            assert(streamIndex != mStreams.end());
+#endif
+            const auto &stream = streamIndex->second;
+            if (now - stream.lastUpdate <= mStreamTimeToLive){break;}
+            if (!stream.held.empty() || stream.nTimers > 0){break;}
+            mStreams.erase(streamIndex);
+            mRecentlyUsed.pop_back();
+        }
+    }
+    /// Expires the timers up to now
+    void advance(
+        const std::chrono::microseconds &now,
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released)
+    {
+        auto nowTick = toTick(now);
+        if (nowTick <= mCurrentTick){return;}
+        // Each slot need only be visited once
+        auto firstTick
+            = std::max(mCurrentTick + 1,
+                       nowTick - static_cast<int64_t> (mWheel.size()) + 1);
+        for (auto tick = firstTick; tick <= nowTick; ++tick)
+        {
+            auto &slot = toSlot(tick);
+            if (slot.empty()){continue;}
+            mExpiredTimers.clear();
+            std::swap(mExpiredTimers, slot);
+            for (const auto &timer : mExpiredTimers)
+            {
+                expire(timer, released);
+            }
+        }
+        mCurrentTick = nowTick;
+        evictStreams(now);
+    }
+    void push(US8::MessageFormats::Broadcasts::DataPacket &&packet,
+              const std::chrono::microseconds &now,
+              std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released)
+    {
+        advance(now, released);
+        auto name = ::toName(packet);
+        auto [streamIndex, isNew] = mStreams.try_emplace(name);
+        auto &stream = streamIndex->second;
+        // Mark the stream as the most recently used
+        if (isNew)
+        {
+            mRecentlyUsed.push_front(name);
+            stream.recentlyUsed = mRecentlyUsed.begin();
+        }
+        else
+        {
+            mRecentlyUsed.splice(mRecentlyUsed.begin(), mRecentlyUsed,
+                                 stream.recentlyUsed);
+        }
+        stream.lastUpdate = now;
+        auto startTime = packet.getStartTime();
+        // The first packet, a packet that continues the stream, or a late
+        // packet is released
+        if (!stream.haveNextStartTime ||
+            startTime <= stream.nextStartTime + stream.tolerance)
+        {
+            releasePacket(stream, std::move(packet), released);
+            releaseContiguous(stream, released);
+            return;
+        }
+        // There is a gap so hold the packet
+        auto [it, inserted]
+            = stream.held.insert_or_assign(startTime, std::move(packet));
+        if (!inserted){return;} // Replaced a held packet; its timer stands
+        mNumberOfHeldPackets = mNumberOfHeldPackets + 1;
+        toSlot(mCurrentTick + mHoldTicks).push_back(::Timer {&stream, startTime});
+        stream.nTimers = stream.nTimers + 1;
+    }
+    void flush(std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released)
+    {
+        for (auto &[name, stream] : mStreams)
+        {
+            for (auto &[startTime, packet] : stream.held)
+            {
+                releasePacket(stream, std::move(packet), released);
+            }
+            stream.held.clear();
+        }
+        for (auto &slot : mWheel)
+        {
+            slot.clear();
+        }
+        for (auto &[name, stream] : mStreams)
+        {
+            stream.nTimers = 0;
+        }
+        mNumberOfHeldPackets = 0;
+    }
+    std::unordered_map<std::string, ::Stream> mStreams;
+    // Stream names from most to least recently used
+    std::list<std::string> mRecentlyUsed;
+    std::vector<std::vector<::Timer>> mWheel;
+    std::vector<::Timer> mExpiredTimers;
+    std::chrono::microseconds mOrigin{0};
+    std::chrono::milliseconds mMaximumHoldLatency{1000};
+    std::chrono::milliseconds mResolution{10};
+    std::chrono::seconds mStreamTimeToLive{0};
+    int64_t mHoldTicks{100};
+    int64_t mCurrentTick{0};
+    size_t mNumberOfHeldPackets{0};
+    bool mHaveOrigin{false};
+};
+
+/// Constructor
+ReorderBuffer::ReorderBuffer(
+    const std::chrono::milliseconds &maximumHoldLatency)
+{
+    if (maximumHoldLatency.count() <= 0)
+    {
+        throw std::invalid_argument("Maximum hold latency must be positive");
+    }
+    pImpl = std::make_unique<ReorderBufferImpl> (maximumHoldLatency);
+}
+
+/// Destructor
+ReorderBuffer::~ReorderBuffer() = default;
+
+/// Add a packet
+void ReorderBuffer::push(
+    US8::MessageFormats::Broadcasts::DataPacket &&packet,
+    const std::chrono::microseconds &now,
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released)
+{
+    if (released == nullptr){throw std::invalid_argument("released is NULL");}
+    pImpl->push(std::move(packet), now, released);
+}
+
+/// Release expired packets
+void ReorderBuffer::release(
+    const std::chrono::microseconds &now,
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released)
+{
+    if (released == nullptr){throw std::invalid_argument("released is NULL");}
+    pImpl->advance(now, released);
+}
+
+/// Release everything
+void ReorderBuffer::flush(
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released)
+{
+    if (released == nullptr){throw std::invalid_argument("released is NULL");}
+    pImpl->flush(released);
+}
+
+/// Number of held packets
+size_t ReorderBuffer::size() const noexcept
+{
+    return pImpl->mNumberOfHeldPackets;
+}
+
+/// Stream time to live
+void ReorderBuffer::setStreamTimeToLive(
+    const std::chrono::seconds &timeToLive) noexcept
+{
+    pImpl->mStreamTimeToLive = timeToLive;
+}
+
+/// Number of streams
+int ReorderBuffer::getNumberOfStreams() const noexcept
+{
+    return static_cast<int> (pImpl->mStreams.size());
+}
+
+/// Maximum hold latency
+std::chrono::milliseconds ReorderBuffer::getMaximumHoldLatency() const noexcept
+{
+    return pImpl->mMaximumHoldLatency;
+}
@@ -0,0 +1,87 @@
+#ifndef US8_BROADCASTS_SANITIZER_REORDER_BUFFER_HPP
+#define US8_BROADCASTS_SANITIZER_REORDER_BUFFER_HPP
+#include <chrono>
+#include <vector>
+#include <memory>
+namespace US8::MessageFormats::Broadcasts
+{
+class DataPacket;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+/// @brief Restores the start time order of each stream's packets.  A packet
+///        that continues its stream is released immediately along with any
+///        held packets that it makes contiguous.  A packet that follows a
+///        gap is held until the gap is filled or until it has been held for
+///        the maximum hold latency.  In the latter case, the gap is presumed
+///        lost and the stream's held packets up to and including the expired
+///        packet are released in start time order.  Packets that precede
+///        the stream's released packets are late and are released
+///        immediately.
+///
+///        The hold deadlines are kept in a timer wheel so the cost of adding
+///        a packet and of expiring held packets does not depend on the
+///        number of streams.
+/// @note This is not thread-safe.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class ReorderBuffer
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] maximumHoldLatency  The maximum time a packet is held
+    ///                                while waiting for a gap to be filled.
+    /// @throws std::invalid_argument if maximumHoldLatency is not positive.
+    explicit ReorderBuffer(const std::chrono::milliseconds &maximumHoldLatency);
+
+    /// @brief Adds a packet.
+    /// @param[in,out] packet  The packet to add.  On exit, packet's behavior
+    ///                        is undefined.
+    /// @param[in] now         The current UTC time in microseconds from the
+    ///                        epoch.
+    /// @param[out] released   Packets that may now be published, including
+    ///                        those whose hold expired, are appended to this.
+    /// @throws std::invalid_argument if released is NULL.
+    void push(US8::MessageFormats::Broadcasts::DataPacket &&packet,
+              const std::chrono::microseconds &now,
+              std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released);
+    /// @brief Releases the packets whose hold expired.  This should be called
+    ///        periodically.
+    /// @param[in] now         The current UTC time in microseconds from the
+    ///                        epoch.
+    /// @param[out] released   The released packets are appended to this.
+    /// @throws std::invalid_argument if released is NULL.
+    void release(const std::chrono::microseconds &now,
+                 std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released);
+    /// @brief Releases all held packets - e.g., at shutdown.
+    /// @param[out] released   The released packets are appended to this.
+    /// @throws std::invalid_argument if released is NULL.
+    void flush(std::vector<US8::MessageFormats::Broadcasts::DataPacket> *released);
+
+    /// @brief Streams that have not sent a packet for this long are
+    ///        forgotten once their held packets are released.  By default
+    ///        streams are never forgotten.
+    /// @param[in] timeToLive  The idle time.  If this is not positive then
+    ///                        idle streams are retained.
+    void setStreamTimeToLive(const std::chrono::seconds &timeToLive) noexcept;
+    /// @result The number of tracked streams.
+    [[nodiscard]] int getNumberOfStreams() const noexcept;
+
+    /// @result The number of held packets.
+    [[nodiscard]] size_t size() const noexcept;
+    /// @result The maximum hold latency.
+    [[nodiscard]] std::chrono::milliseconds getMaximumHoldLatency() const noexcept;
+
+    /// @brief Destructor.
+    ~ReorderBuffer();
+
+    ReorderBuffer() = delete;
+    ReorderBuffer(const ReorderBuffer &) = delete;
+    ReorderBuffer(ReorderBuffer &&) noexcept = delete;
+    ReorderBuffer& operator=(const ReorderBuffer &) = delete;
+    ReorderBuffer& operator=(ReorderBuffer &&) noexcept = delete;
+private:
+    class ReorderBufferImpl;
+    std::unique_ptr<ReorderBufferImpl> pImpl;
+};
+}
+#endif
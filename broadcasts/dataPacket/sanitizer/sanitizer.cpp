@@ -10,10 +10,25 @@
 #include <boost/program_options.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <vector>
 #include <readerwriterqueue.h>
+#include <concurrentqueue.h>
+#include <opentelemetry/nostd/shared_ptr.h>
+#include <opentelemetry/metrics/meter.h>
+#include <opentelemetry/metrics/meter_provider.h>
+#include <opentelemetry/metrics/provider.h>
+#include <opentelemetry/exporters/prometheus/exporter_factory.h>
+#include <opentelemetry/exporters/prometheus/exporter_options.h>
+#include <opentelemetry/sdk/metrics/meter_provider.h>
+#include <opentelemetry/sdk/metrics/meter_provider_factory.h>
+#include <opentelemetry/sdk/metrics/provider.h>
 //#include <zmq.hpp>
 //#include <zmq_addon.hpp>
 #include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/messageFormats/broadcasts/streamWatermarks.hpp"
 #include "us8/broadcasts/dataPacket/publisher.hpp"
 #include "us8/broadcasts/dataPacket/publisherOptions.hpp"
 #include "us8/broadcasts/dataPacket/subscriber.hpp"
@@ -21,11 +36,23 @@
 #include "testFutureDataPacket.hpp"
 #include "testExpiredDataPacket.hpp"
 #include "testDuplicateDataPacket.hpp"
+#include "reorderBuffer.hpp"
+#include "watermarkTracker.hpp"
+#include "availabilityIndex.hpp"
+#include "waveformStatistics.hpp"
+#include "testFlatLinedDataPacket.hpp"
+#include "testClippedDataPacket.hpp"
+#include "testSpikedDataPacket.hpp"
+#include "us8/utilities/clock.hpp"
+#include "us8/utilities/writeAtomically.hpp"
+#include "toName.hpp"
 
 #define RAW_DATA_PACKET_BROADCAST_BACKEND_ADDRESS "tcp://127.0.0.1:5551"
 #define SANITIZED_DATA_PACKET_BROADCAST_FRONTEND_ADDRESS "tcp://127.0.0.1:5552"
 
 #define MAX_QUEUE_SIZE 256
+#define APPLICATION_NAME "data_packet_sanitizer"
+#define OTEL_VERSION "1.2.0"
 
 namespace
 {
@@ -33,8 +60,21 @@ std::atomic<bool> mInterrupted{false};
 }
 namespace USanitizer = US8::Broadcasts::DataPacket::Sanitizer;
 
+/// The source of the current time for the testers
+enum class ClockType
+{
+    Wall,      // Read the system clock for every packet
+    Coarse,    // Read a system time cached by a ticker thread
+    Simulated  // Packet times drive the clock, e.g., to replay archived data
+};
+
 struct ProgramOptions
 {
+    // Metrics are only exported when this is set.  The publisher already
+    // serves localhost:9090 which is also Prometheus's own port.
+    std::string prometheusURL;
+    std::string applicationName{APPLICATION_NAME};
+    std::string openTelemetryVersion{OTEL_VERSION};
     std::string inputBroadcastAddress{
         RAW_DATA_PACKET_BROADCAST_BACKEND_ADDRESS};
     std::string outputBroadcastAddress{
@@ -45,45 +85,317 @@ struct ProgramOptions
     std::chrono::seconds maximumLatency{120};
     std::chrono::seconds circularBufferDuration{120};
     std::chrono::seconds logBadDataInterval{60};
+    // The duplicate tester's state is saved here so that a restarted
+    // sanitizer can immediately detect duplicates.  Empty disables this.
+    std::filesystem::path stateFile;
+    std::chrono::seconds stateFileUpdateInterval{60};
+    // Streams that are idle this long are forgotten by the duplicate tester
+    // and the reorder buffer
+    std::chrono::seconds streamTimeToLive{3600};
+    // Approximate memory budget for the duplicate tester.  0 is unlimited.
+    int64_t maximumStateMemory{0};
+    // Identical, overlapping packets are duplicates regardless of timing
+    bool useContentHash{false};
+    // Packets following a gap are held this long so that each stream is
+    // published in start time order.  0 disables reordering.
+    std::chrono::milliseconds maximumReorderLatency{0};
+    // Stream watermarks are published at this interval.  0 disables this.
+    std::chrono::milliseconds watermarkInterval{0};
+    // A watermark waits this long for a gap to be filled
+    std::chrono::milliseconds watermarkMaximumGapLatency{30000};
+    // Each stream's data availability is tracked over this rolling window.
+    // 0 disables this.
+    std::chrono::seconds availabilityWindow{0};
+    // Each stream's availability is written to this JSON file when the
+    // metrics are published.  Empty disables this.
+    std::filesystem::path availabilityFile;
+    // Packets with a run of identical samples lasting this long are
+    // flat-lined.  0 disables this.
+    std::chrono::milliseconds maximumFlatLineDuration{0};
+    // Packets with a sample at or beyond +/- this level are clipped.
+    // 0 disables this.
+    double clipLevel{0};
+    // Packets with a sample this many standard deviations from the others
+    // are spiked.  0 disables this.
+    double spikeThreshold{0};
+    // Flat-lined, clipped, and spiked packets are dropped.  Otherwise, they
+    // are only counted and logged.
+    bool dropBadWaveforms{true};
+    // The testers read the current time from this clock
+    ::ClockType clock{::ClockType::Wall};
+    std::chrono::milliseconds coarseClockResolution{1};
     int receiveHighWaterMark{4096};
     int sendHighWaterMark{4096};
+    // Streams are divided among this many tester threads
+    int numberOfShards{1};
     int verbosity{3};
 };
 
 std::pair<std::string, bool> parseCommandLineOptions(int argc, char *argv[]);
 ::ProgramOptions parseIniFile(const std::filesystem::path &iniFile);
 
-class Process
+namespace
 {
-public:
-    explicit Process(const ::ProgramOptions &programOptions) 
+void initializeMetrics(const ProgramOptions &options)
+{
+    if (options.prometheusURL.empty())
+    {
+        spdlog::info("Metrics are disabled; set General.prometheusURL to export them");
+        return;
+    }
+    spdlog::info("Starting metrics on " + options.prometheusURL);
+    opentelemetry::exporter::metrics::PrometheusExporterOptions
+        prometheusOptions;
+    prometheusOptions.url = options.prometheusURL;
+    auto prometheusExporter
+        = opentelemetry::exporter::metrics::PrometheusExporterFactory::Create(
+              prometheusOptions);
+
+    // Initialize and set the global MeterProvider
+    auto providerInstance 
+        = opentelemetry::sdk::metrics::MeterProviderFactory::Create();
+    auto *meterProvider
+        = static_cast<opentelemetry::sdk::metrics::MeterProvider *>
+          (providerInstance.get());
+    meterProvider->AddMetricReader(std::move(prometheusExporter));
+
+    std::shared_ptr<opentelemetry::metrics::MeterProvider>
+        provider(std::move(providerInstance));
+    opentelemetry::sdk::metrics::Provider::SetMeterProvider(provider);
+}
+
+void cleanupMetrics()
+{
+     std::shared_ptr<opentelemetry::metrics::MeterProvider> none;
+     opentelemetry::sdk::metrics::Provider::SetMeterProvider(none);
+}
+}
+
+/// A shard owns the tester state for its streams so that shards never
+/// share state.
+struct Shard
+{
+    Shard(const ::ProgramOptions &programOptions,
+          const std::shared_ptr<const US8::Utilities::IClock> &clock)
     {
-        // Create the testers
         if (programOptions.maximumFutureTime.count() >= 0)
         {
-            spdlog::info("Will test for future data");
+            // The coarse clock can lag the system clock by its resolution
+            auto maximumFutureTime
+                = std::chrono::duration_cast<std::chrono::microseconds>
+                  (programOptions.maximumFutureTime);
+            if (programOptions.clock == ::ClockType::Coarse)
+            {
+                maximumFutureTime = maximumFutureTime
+                                  + programOptions.coarseClockResolution;
+            }
             mFutureDataPacketTester
                 = std::make_unique<USanitizer::TestFutureDataPacket>
-                  (programOptions.maximumFutureTime,
+                  (maximumFutureTime,
                    programOptions.logBadDataInterval);
+            mFutureDataPacketTester->setClock(clock);
         }
         if (programOptions.maximumLatency.count() > 0)
         {
-            spdlog::info("Will test for latent data older than "
-                       + std::to_string(programOptions.maximumLatency.count())
-                       + " seconds");
             mExpiredDataPacketTester
                 = std::make_unique<USanitizer::TestExpiredDataPacket>
                   (programOptions.maximumLatency,
                    programOptions.logBadDataInterval);
-        } 
+            mExpiredDataPacketTester->setClock(clock);
+        }
         if (programOptions.circularBufferDuration.count() > 0)
         {
-            spdlog::info("Will test for duplicate data");
             mDuplicateDataPacketTester
                 = std::make_unique<USanitizer::TestDuplicateDataPacket>
                   (programOptions.circularBufferDuration,
                    programOptions.logBadDataInterval); 
+            mDuplicateDataPacketTester->setStreamTimeToLive(
+                programOptions.streamTimeToLive);
+            // The budget is split evenly among the shards
+            mDuplicateDataPacketTester->setMaximumMemoryUsage(
+                programOptions.maximumStateMemory
+               /std::max(1, programOptions.numberOfShards));
+            mDuplicateDataPacketTester->setUseContentHash(
+                programOptions.useContentHash);
+            mDuplicateDataPacketTester->setClock(clock);
+        }
+        if (programOptions.availabilityWindow.count() > 0)
+        {
+            mAvailabilityIndex
+                = std::make_unique<USanitizer::AvailabilityIndex>
+                  (programOptions.availabilityWindow);
+        }
+        if (programOptions.maximumReorderLatency.count() > 0)
+        {
+            mReorderBuffer
+                = std::make_unique<USanitizer::ReorderBuffer>
+                  (programOptions.maximumReorderLatency);
+            mReorderBuffer->setStreamTimeToLive(
+                programOptions.streamTimeToLive);
+        }
+        if (programOptions.maximumFlatLineDuration.count() > 0)
+        {
+            mFlatLinedDataPacketTester
+                = std::make_unique<USanitizer::TestFlatLinedDataPacket>
+                  (programOptions.maximumFlatLineDuration,
+                   programOptions.logBadDataInterval);
+            mFlatLinedDataPacketTester->setClock(clock);
+        }
+        if (programOptions.clipLevel > 0)
+        {
+            mClippedDataPacketTester
+                = std::make_unique<USanitizer::TestClippedDataPacket>
+                  (programOptions.clipLevel,
+                   programOptions.logBadDataInterval);
+            mClippedDataPacketTester->setClock(clock);
+        }
+        if (programOptions.spikeThreshold > 0)
+        {
+            mSpikedDataPacketTester
+                = std::make_unique<USanitizer::TestSpikedDataPacket>
+                  (programOptions.spikeThreshold,
+                   programOptions.logBadDataInterval);
+            mSpikedDataPacketTester->setClock(clock);
+        }
+        mDropBadWaveforms = programOptions.dropBadWaveforms;
+    }
+    std::thread mThread;
+    std::unique_ptr<USanitizer::TestFutureDataPacket>
+        mFutureDataPacketTester;
+    std::unique_ptr<USanitizer::TestExpiredDataPacket>
+        mExpiredDataPacketTester;
+    std::unique_ptr<USanitizer::TestDuplicateDataPacket>
+        mDuplicateDataPacketTester;
+    std::unique_ptr<USanitizer::ReorderBuffer> mReorderBuffer;
+    std::unique_ptr<USanitizer::AvailabilityIndex> mAvailabilityIndex;
+    std::unique_ptr<USanitizer::TestFlatLinedDataPacket>
+        mFlatLinedDataPacketTester;
+    std::unique_ptr<USanitizer::TestClippedDataPacket>
+        mClippedDataPacketTester;
+    std::unique_ptr<USanitizer::TestSpikedDataPacket>
+        mSpikedDataPacketTester;
+    moodycamel::ReaderWriterQueue<US8::MessageFormats::Broadcasts::DataPacket>
+        mPacketsToCheckQueue{MAX_QUEUE_SIZE};
+    bool mDropBadWaveforms{true};
+};
+
+class Process
+{
+public:
+    explicit Process(const ::ProgramOptions &programOptions) 
+    {
+        // Create the testers.  Each shard gets its own.
+        if (programOptions.maximumFutureTime.count() >= 0)
+        {
+            spdlog::info("Will test for future data");
+        }
+        if (programOptions.maximumLatency.count() > 0)
+        {
+            spdlog::info("Will test for latent data older than "
+                       + std::to_string(programOptions.maximumLatency.count())
+                       + " seconds");
+        } 
+        if (programOptions.circularBufferDuration.count() > 0)
+        {
+            spdlog::info("Will test for duplicate data");
+        }
+        if (programOptions.availabilityWindow.count() > 0)
+        {
+            spdlog::info("Will track data availability over the last "
+                  + std::to_string(programOptions.availabilityWindow.count())
+                  + " seconds");
+            if (!programOptions.availabilityFile.empty())
+            {
+                spdlog::info("Will write data availability to "
+                           + programOptions.availabilityFile.string());
+            }
+        }
+        if (programOptions.maximumReorderLatency.count() > 0)
+        {
+            spdlog::info("Will reorder packets held for up to "
+                  + std::to_string(programOptions.maximumReorderLatency.count())
+                  + " milliseconds");
+        }
+        if (programOptions.maximumFlatLineDuration.count() > 0)
+        {
+            spdlog::info("Will test for data flat-lined for "
+                  + std::to_string(programOptions.maximumFlatLineDuration.count())
+                  + " milliseconds");
+        }
+        if (programOptions.clipLevel > 0)
+        {
+            spdlog::info("Will test for data clipped at "
+                       + std::to_string(programOptions.clipLevel));
+        }
+        if (programOptions.spikeThreshold > 0)
+        {
+            spdlog::info("Will test for spikes "
+                       + std::to_string(programOptions.spikeThreshold)
+                       + " standard deviations from the other samples");
+        }
+        if (!programOptions.dropBadWaveforms &&
+            (programOptions.maximumFlatLineDuration.count() > 0 ||
+             programOptions.clipLevel > 0 ||
+             programOptions.spikeThreshold > 0))
+        {
+            spdlog::info("Flat-lined, clipped, and spiked data will be flagged but not dropped");
+        }
+        if (programOptions.numberOfShards > 1)
+        {
+            spdlog::info("Dividing streams among "
+                       + std::to_string(programOptions.numberOfShards)
+                       + " tester threads");
+        }
+        // The testers use the data's clock while the logging and
+        // metrics intervals are always measured in real time
+        if (programOptions.clock == ::ClockType::Simulated)
+        {
+            spdlog::info("Will use packet times as the current time");
+            mSimulatedClock = std::make_shared<US8::Utilities::SimulatedClock> ();
+            mClock = mSimulatedClock;
+            mProcessClock = std::make_shared<US8::Utilities::WallClock> ();
+        }
+        else if (programOptions.clock == ::ClockType::Coarse)
+        {
+            spdlog::info("Will read the time at a resolution of "
+                  + std::to_string(programOptions.coarseClockResolution.count())
+                  + " milliseconds");
+            mClock = std::make_shared<US8::Utilities::CoarseClock>
+                     (programOptions.coarseClockResolution);
+            mProcessClock = mClock;
+        }
+        else
+        {
+            mClock = std::make_shared<US8::Utilities::WallClock> ();
+            mProcessClock = mClock;
+        }
+        for (int i = 0; i < programOptions.numberOfShards; ++i)
+        {
+            mShards.push_back(std::make_unique<::Shard> (programOptions,
+                                                         mClock));
+        }
+        mApplicationName = programOptions.applicationName;
+        mOpenTelemetryVersion = programOptions.openTelemetryVersion;
+        mStateFile = programOptions.stateFile;
+        mStateFileUpdateInterval = programOptions.stateFileUpdateInterval;
+        if (programOptions.availabilityWindow.count() > 0)
+        {
+            mAvailabilityFile = programOptions.availabilityFile;
+        }
+        if (programOptions.watermarkInterval.count() > 0)
+        {
+            spdlog::info("Will publish stream watermarks every "
+                  + std::to_string(programOptions.watermarkInterval.count())
+                  + " milliseconds");
+            mWatermarkInterval = programOptions.watermarkInterval;
+            mWatermarkTracker
+                = std::make_unique<USanitizer::WatermarkTracker>
+                  (programOptions.watermarkMaximumGapLatency);
+        }
+        if (!mStateFile.empty() &&
+            programOptions.circularBufferDuration.count() > 0)
+        {
+            loadState();
         }
 
         // Initialize ZMQ subscriber
@@ -96,6 +408,7 @@ public:
                 programOptions.receiveHighWaterMark);
             subscriberOptions.setTimeOut(
                 programOptions.receiveTimeOut);
+            subscriberOptions.setClock(mProcessClock);
     
             mPacketSubscriber
                 = std::make_unique<US8::Broadcasts::DataPacket::Subscriber>
@@ -137,8 +450,13 @@ public:
 #endif
         stop();
         mKeepRunning = true;
+        mPublisherKeepRunning = true;
         mPublisherThread = std::thread(&::Process::publishGoodPackets, this);
-        mTesterThread = std::thread(&::Process::checkPackets, this);
+        for (size_t i = 0; i < mShards.size(); ++i)
+        {
+            mShards[i]->mThread
+                = std::thread(&::Process::checkPackets, this, i);
+        }
         //mSubscriberThread = std::thread(&::Process::getInputPackets, this);
         mPacketSubscriber->start();
     }
@@ -148,35 +466,182 @@ public:
         mKeepRunning = false; 
         if (mPacketSubscriber){mPacketSubscriber->stop();}
         //if (mSubscriberThread.joinable()){mSubscriberThread.join();}
-        if (mTesterThread.joinable()){mTesterThread.join();}
+        for (auto &shard : mShards)
+        {
+            if (shard->mThread.joinable()){shard->mThread.join();}
+        }
+        // The shards have flushed their held packets so the publisher can
+        // drain the queue then exit
+        mPublisherKeepRunning = false;
         if (mPublisherThread.joinable()){mPublisherThread.join();}
     }   
-    /// Callback for the packet subscriber
+    /// @result The shard that checks the given stream.
+    [[nodiscard]] size_t toShardIndex(const std::string &name) const
+    {
+        if (mShards.size() == 1){return 0;}
+        return std::hash<std::string> {}(name) % mShards.size();
+    }
+    /// @result The state file for the given shard.
+    [[nodiscard]] std::filesystem::path
+        toStateFile(const size_t shardIndex) const
+    {
+        if (mShards.size() == 1){return mStateFile;}
+        return mStateFile.string() + "." + std::to_string(shardIndex);
+    }
+    /// Saves the duplicate tester's state for a shard
+    void saveState(const size_t shardIndex)
+    {
+        const auto &shard = *mShards.at(shardIndex);
+        if (mStateFile.empty() || !shard.mDuplicateDataPacketTester){return;}
+        try
+        {
+            shard.mDuplicateDataPacketTester->save(toStateFile(shardIndex));
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::warn("Failed to save duplicate tester state because "
+                       + std::string {e.what()});
+        }
+    }
+    /// Loads the duplicate tester's state.  The files may have been written
+    /// with a different number of shards so every file is offered to every
+    /// shard which keeps only its own streams.
+    void loadState()
+    {
+        std::vector<std::filesystem::path> stateFiles;
+        if (std::filesystem::exists(mStateFile))
+        {
+            stateFiles.push_back(mStateFile);
+        }
+        for (int i = 0; i < 1024; ++i)
+        {
+            std::filesystem::path stateFile{mStateFile.string() + "."
+                                          + std::to_string(i)};
+            if (std::filesystem::exists(stateFile))
+            {
+                stateFiles.push_back(stateFile);
+            }
+        }
+        if (stateFiles.empty()){return;}
+        for (const auto &stateFile : stateFiles)
+        {
+            for (size_t i = 0; i < mShards.size(); ++i)
+            {
+                try
+                {
+                    auto nStreams
+                        = mShards[i]->mDuplicateDataPacketTester->load(
+                             stateFile,
+                             [this, i](const std::string &name)
+                             {
+                                 return toShardIndex(name) == i;
+                             });
+                    spdlog::debug("Loaded " + std::to_string(nStreams)
+                                + " streams from " + stateFile.string());
+                }
+                catch (const std::exception &e)
+                {
+                    spdlog::warn("Failed to load " + stateFile.string()
+                               + " because " + std::string {e.what()});
+                }
+            }
+        }
+        spdlog::info("Loaded duplicate tester state from "
+                   + std::to_string(stateFiles.size()) + " files");
+        // Rewrite the state for the current shards then remove the rest
+        std::vector<std::filesystem::path> currentStateFiles;
+        for (size_t i = 0; i < mShards.size(); ++i)
+        {
+            saveState(i);
+            currentStateFiles.push_back(toStateFile(i));
+        }
+        for (const auto &stateFile : stateFiles)
+        {
+            if (std::find(currentStateFiles.begin(), currentStateFiles.end(),
+                          stateFile) == currentStateFiles.end())
+            {
+                std::error_code error;
+                std::filesystem::remove(stateFile, error);
+            }
+        }
+    }
+    /// Advances the simulated clock to the end of the packet.  Archived data
+    /// never ends after the present so a packet that does is not trusted
+    /// to move the clock.
+    void advanceSimulatedClock(
+        const US8::MessageFormats::Broadcasts::DataPacket &dataPacket)
+    {
+        try
+        {
+            auto endTime = dataPacket.getEndTime(); // Throws
+            if (endTime <= mProcessClock->now())
+            {
+                mSimulatedClock->advance(endTime);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::debug("Failed to advance clock because "
+                        + std::string {e.what()});
+        }
+    }
+    /// Callback for the packet subscriber.  A stream always goes to the
+    /// same shard which preserves its packet order.
     void inputPacketsToQueueCallback(
         US8::MessageFormats::Broadcasts::DataPacket &&dataPacket)
     {
-        mPacketsToCheckQueue.try_enqueue(std::move(dataPacket));
+        if (mSimulatedClock){advanceSimulatedClock(dataPacket);}
+        size_t shardIndex{0};
+        if (mShards.size() > 1)
+        {
+            try
+            {
+                shardIndex = toShardIndex(::toName(dataPacket));
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::warn("Failed to route packet because "
+                           + std::string {e.what()});
+                return;
+            }
+        }
+        mShards[shardIndex]->mPacketsToCheckQueue.try_enqueue(
+            std::move(dataPacket));
     }
-    /// Checks the packets
-    void checkPackets()
+    /// Checks the packets in a shard
+    void checkPackets(const size_t shardIndex)
     {
-        spdlog::debug("Thread entering checkPackets");
+        spdlog::debug("Thread entering checkPackets for shard "
+                    + std::to_string(shardIndex));
+        auto &shard = *mShards.at(shardIndex);
+        // Packets from this shard leave in the order they were checked
+        moodycamel::ProducerToken producerToken(mMessagesToPublishQueue);
         constexpr std::chrono::milliseconds sleepTime{5};
-        auto nowMuSeconds
-           = std::chrono::time_point_cast<std::chrono::microseconds>
-             (std::chrono::high_resolution_clock::now()).time_since_epoch();
+        auto nowMuSeconds = mProcessClock->now();
         auto lastLogTime
             = std::chrono::duration_cast<std::chrono::seconds> (nowMuSeconds);
         int64_t nNotCheckedPackets{0};
         int64_t nCheckedPackets{0};
+        auto lastStateFileUpdate
+            = std::chrono::duration_cast<std::chrono::seconds> (nowMuSeconds);
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> releasedPackets;
+        auto enqueueReleasedPackets = [&]()
+        {
+            for (auto &releasedPacket : releasedPackets)
+            {
+                mMessagesToPublishQueue.enqueue(producerToken,
+                                                std::move(releasedPacket));
+            }
+            releasedPackets.clear();
+        };
         while (mKeepRunning)
         {
-            if (mPacketsToCheckQueue.size_approx() > MAX_QUEUE_SIZE)
+            if (shard.mPacketsToCheckQueue.size_approx() > MAX_QUEUE_SIZE)
             {
                 int nDeleted{0};
-                while (mPacketsToCheckQueue.size_approx() > MAX_QUEUE_SIZE)
+                while (shard.mPacketsToCheckQueue.size_approx() > MAX_QUEUE_SIZE)
                 {
-                    if (!mPacketsToCheckQueue.pop()){break;}
+                    if (!shard.mPacketsToCheckQueue.pop()){break;}
                     nDeleted = nDeleted + 1;
                 }
                 spdlog::warn("Overfull input queue - deleted "
@@ -184,26 +649,47 @@ public:
                 nNotCheckedPackets = nNotCheckedPackets + nDeleted;
             }
             US8::MessageFormats::Broadcasts::DataPacket packet;
-            if (mPacketsToCheckQueue.try_dequeue(packet))
+            if (shard.mPacketsToCheckQueue.try_dequeue(packet))
             {
                 bool allow{false};
                 try
                 {
-                    if (mFutureDataPacketTester)
+                    if (shard.mFutureDataPacketTester)
+                    {
+                        allow = shard.mFutureDataPacketTester->allow(packet);
+                    }
+                    if (allow && shard.mExpiredDataPacketTester)
+                    {
+                        allow = shard.mExpiredDataPacketTester->allow(packet);
+                    }
+                    // Duplicates are indexed so that they appear as overlaps
+                    if (allow && shard.mAvailabilityIndex)
                     {
-                        allow = mFutureDataPacketTester->allow(packet);
+                        updateAvailability(shard, packet);
                     }
-                    if (allow && mExpiredDataPacketTester)
+                    if (allow && shard.mDuplicateDataPacketTester)
                     {
-                        allow = mExpiredDataPacketTester->allow(packet);
+                        allow = shard.mDuplicateDataPacketTester->allow(packet);
                     }
-                    if (allow && mDuplicateDataPacketTester)
+                    if (allow &&
+                        (shard.mFlatLinedDataPacketTester ||
+                         shard.mClippedDataPacketTester ||
+                         shard.mSpikedDataPacketTester))
                     {
-                        allow = mDuplicateDataPacketTester->allow(packet);
+                        allow = testWaveform(shard, packet);
                     }
-                    if (allow)
+                    if (allow && shard.mReorderBuffer)
                     {
-                        mMessagesToPublishQueue.try_enqueue(std::move(packet));
+                        shard.mReorderBuffer->push(
+                            std::move(packet),
+                            mClock->now(),
+                            &releasedPackets);
+                        enqueueReleasedPackets();
+                    }
+                    else if (allow)
+                    {
+                        mMessagesToPublishQueue.enqueue(producerToken,
+                                                        std::move(packet));
                     }
                     nCheckedPackets = nCheckedPackets + 1;
                 }
@@ -217,15 +703,30 @@ public:
             {
                 std::this_thread::sleep_for(sleepTime);
             }
-            nowMuSeconds
-                = std::chrono::time_point_cast<std::chrono::microseconds>
-                 (std::chrono::high_resolution_clock::now()).time_since_epoch();
+            // Release the packets that have been held too long
+            if (shard.mReorderBuffer)
+            {
+                try
+                {
+                    shard.mReorderBuffer->release(
+                        mClock->now(), &releasedPackets);
+                    enqueueReleasedPackets();
+                }
+                catch (const std::exception &e)
+                {
+                    spdlog::warn("Failed to release held packets because "
+                               + std::string {e.what()});
+                }
+            }
+            nowMuSeconds = mProcessClock->now();
             auto nowSeconds
                 = std::chrono::duration_cast<std::chrono::seconds>
                   (nowMuSeconds);
             if (nowSeconds >= lastLogTime + mLogPublishingPerformanceInterval)
             {
-                spdlog::info("Checked " 
+                spdlog::info((mShards.size() > 1 ?
+                              "Shard " + std::to_string(shardIndex) + " checked " :
+                              std::string {"Checked "})
                     + std::to_string(nCheckedPackets)
                     + " packets in last "
                     + std::to_string(mLogPublishingPerformanceInterval.count())
@@ -235,8 +736,111 @@ public:
                 nNotCheckedPackets = 0;
                 lastLogTime = nowSeconds;
             }
+            if (nowSeconds >= lastStateFileUpdate + mStateFileUpdateInterval)
+            {
+                saveState(shardIndex);
+                lastStateFileUpdate = nowSeconds;
+            }
+        }
+        // Don't strand the held packets
+        if (shard.mReorderBuffer)
+        {
+            shard.mReorderBuffer->flush(&releasedPackets);
+            enqueueReleasedPackets();
+        }
+        // Keep the latest state for the next start
+        saveState(shardIndex);
+        spdlog::debug("Thread leaving checkPackets for shard "
+                    + std::to_string(shardIndex));
+    }
+    /// Tests the packet's samples.  The samples are summarized once and the
+    /// summary is shared by the waveform testers.
+    static bool testWaveform(
+        const ::Shard &shard,
+        const US8::MessageFormats::Broadcasts::DataPacket &packet)
+    {
+        auto statistics
+            = USanitizer::computeWaveformStatistics(packet); // Throws
+        // Run every tester so that each stream's state is updated
+        bool allow{true};
+        if (shard.mFlatLinedDataPacketTester)
+        {
+            allow = shard.mFlatLinedDataPacketTester->allow(packet, statistics)
+                 && allow;
+        }
+        if (shard.mClippedDataPacketTester)
+        {
+            allow = shard.mClippedDataPacketTester->allow(packet, statistics)
+                 && allow;
+        }
+        if (shard.mSpikedDataPacketTester)
+        {
+            allow = shard.mSpikedDataPacketTester->allow(packet, statistics)
+                 && allow;
+        }
+        return allow || !shard.mDropBadWaveforms;
+    }
+    /// Adds the packet to the shard's availability index
+    void updateAvailability(
+        ::Shard &shard,
+        const US8::MessageFormats::Broadcasts::DataPacket &packet) const
+    {
+        try
+        {
+            shard.mAvailabilityIndex->update(packet, mClock->now());
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::debug("Failed to index packet availability because "
+                        + std::string {e.what()});
+        }
+    }
+    /// Records each stream's availability and, if requested, writes it
+    /// to the availability file for readers outside of this process
+    void recordAvailability(
+        opentelemetry::metrics::Gauge<double> &percentCompleteGauge,
+        opentelemetry::metrics::Gauge<double> &largestGapGauge,
+        opentelemetry::metrics::Gauge<double> &latencyGauge,
+        const opentelemetry::context::Context &context)
+    {
+        auto now = mClock->now();
+        std::vector<USanitizer::AvailabilityIndex::Availability> summaries;
+        for (const auto &shard : mShards)
+        {
+            if (!shard->mAvailabilityIndex){continue;}
+            auto shardSummaries
+                = shard->mAvailabilityIndex->getAvailability(now);
+            for (auto &availability : shardSummaries)
+            {
+                std::map<std::string, std::string> attributes
+                {
+                    {"stream", availability.stream}
+                };
+                percentCompleteGauge.Record(availability.percentComplete,
+                                            attributes, context);
+                largestGapGauge.Record(
+                    availability.largestGap.count()*1.e-6, attributes,
+                    context);
+                latencyGauge.Record(
+                    availability.latency.count()*1.e-6, attributes, context);
+                if (!mAvailabilityFile.empty())
+                {
+                    summaries.push_back(std::move(availability));
+                }
+            }
+        }
+        if (mAvailabilityFile.empty()){return;}
+        try
+        {
+            // Readers never see a partially written file
+            US8::Utilities::writeAtomically(
+                mAvailabilityFile, USanitizer::toJSON(summaries, now));
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::warn("Failed to write " + mAvailabilityFile.string()
+                       + " because " + std::string {e.what()});
         }
-        spdlog::debug("Thread leaving checkPackets");
     }
     /// Publishes the good packets
     void publishGoodPackets()
@@ -245,46 +849,101 @@ public:
         assert(mPacketPublisher != nullptr);
 #endif
         spdlog::debug("Thread entering publishGoodPackets");
+        // Get my monitoring stuff
+        auto provider = opentelemetry::metrics::Provider::GetMeterProvider();
+        opentelemetry::nostd::shared_ptr<opentelemetry::metrics::Meter>
+            meter = provider->GetMeter(mApplicationName,
+                                       mOpenTelemetryVersion);
+        auto trackedStreamsGauge
+            = meter->CreateInt64Gauge(
+                 mApplicationName + "-tracked_streams_gauge",
+                 "Number of streams tracked by the duplicate tester",
+                 "streams");
+        auto stateMemoryGauge
+            = meter->CreateInt64Gauge(
+                 mApplicationName + "-state_memory_gauge",
+                 "Approximate memory used by the duplicate tester",
+                 "bytes");
+        auto percentCompleteGauge
+            = meter->CreateDoubleGauge(
+                 mApplicationName + "-percent_complete_gauge",
+                 "Percentage of the availability window with data",
+                 "percent");
+        auto largestGapGauge
+            = meter->CreateDoubleGauge(
+                 mApplicationName + "-largest_gap_gauge",
+                 "Longest gap in the availability window",
+                 "s");
+        auto latencyGauge
+            = meter->CreateDoubleGauge(
+                 mApplicationName + "-data_latency_gauge",
+                 "Time from the end of a stream's latest data to now",
+                 "s");
+        auto flatLinedPacketsGauge
+            = meter->CreateInt64Gauge(
+                 mApplicationName + "-flat_lined_packets_gauge",
+                 "Number of packets flagged as flat-lined",
+                 "packets");
+        auto clippedPacketsGauge
+            = meter->CreateInt64Gauge(
+                 mApplicationName + "-clipped_packets_gauge",
+                 "Number of packets flagged as clipped",
+                 "packets");
+        auto spikedPacketsGauge
+            = meter->CreateInt64Gauge(
+                 mApplicationName + "-spiked_packets_gauge",
+                 "Number of packets flagged as spiked",
+                 "packets");
+        auto context = opentelemetry::context::Context{};
         constexpr std::chrono::milliseconds sleepTime{5};
-        auto nowMuSeconds
-           = std::chrono::time_point_cast<std::chrono::microseconds>
-             (std::chrono::high_resolution_clock::now()).time_since_epoch();
+        auto nowMuSeconds = mProcessClock->now();
         auto lastLogTime
             = std::chrono::duration_cast<std::chrono::seconds> (nowMuSeconds);
+        auto nextSendMetricTime = lastLogTime + std::chrono::seconds {60};
+        auto nextWatermarkTime = nowMuSeconds + mWatermarkInterval;
         int64_t nSentPackets{0};
         int64_t nNotSentPackets{0};
-        while (mKeepRunning)
+        // The shards merge into this queue
+        const size_t maximumPublishQueueSize{MAX_QUEUE_SIZE*mShards.size()};
+        US8::MessageFormats::Broadcasts::DataPacket packet;
+        auto publishPacket = [&]()
         {
-            if (mMessagesToPublishQueue.size_approx() > MAX_QUEUE_SIZE)
+            try
+            {
+                mPacketPublisher->send(packet);
+                nSentPackets = nSentPackets + 1;
+                // Watermarks only cover what was actually published
+                if (mWatermarkTracker)
+                {
+                    mWatermarkTracker->update(
+                        packet, mClock->now());
+                }
+            }
+            catch (const std::exception &e) 
+            {
+                spdlog::warn("Failed to send message because "
+                           + std::string {e.what()});
+                 nNotSentPackets = nNotSentPackets + 1;
+            }
+        };
+        while (mPublisherKeepRunning)
+        {
+            if (mMessagesToPublishQueue.size_approx() > maximumPublishQueueSize)
             {
                 int nDeleted{0};
-                while (mMessagesToPublishQueue.size_approx() > MAX_QUEUE_SIZE)
+                while (mMessagesToPublishQueue.size_approx() >
+                       maximumPublishQueueSize)
                 {
-                    if (!mMessagesToPublishQueue.pop()){break;}
+                    if (!mMessagesToPublishQueue.try_dequeue(packet)){break;}
                     nDeleted = nDeleted + 1;
                 }
                 spdlog::warn("Overfull publisher queue - deleted "
                            + std::to_string(nDeleted) + " packets");
                 nNotSentPackets = nNotSentPackets + nDeleted;
             }
-            auto packet = mMessagesToPublishQueue.peek();
-            if (packet)
+            if (mMessagesToPublishQueue.try_dequeue(packet))
             {
-                try
-                {
-                    mPacketPublisher->send(*packet);
-                    nSentPackets = nSentPackets + 1;
-                }
-                catch (const std::exception &e) 
-                {
-                    spdlog::warn("Failed to send message because "
-                               + std::string {e.what()});
-                     nNotSentPackets = nNotSentPackets + 1;
-                }
-                if (!mMessagesToPublishQueue.pop())
-                {
-                    spdlog::warn("Publisher queue appears to be empty");
-                }
+                publishPacket();
 /*
                 std::string messageType;
                 std::string messagePayload;
@@ -335,9 +994,28 @@ public:
             {   
                 std::this_thread::sleep_for(sleepTime);
             }
-            nowMuSeconds
-                = std::chrono::time_point_cast<std::chrono::microseconds>
-                 (std::chrono::high_resolution_clock::now()).time_since_epoch();
+            if (mWatermarkTracker &&
+                mProcessClock->now() >= nextWatermarkTime)
+            {
+                try
+                {
+                    // Gaps are abandoned in the data's time
+                    auto watermarks
+                        = mWatermarkTracker->getAdvancedWatermarks(
+                             mClock->now());
+                    if (!watermarks.empty())
+                    {
+                        mPacketPublisher->send(watermarks);
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    spdlog::warn("Failed to send watermarks because "
+                               + std::string {e.what()});
+                }
+                nextWatermarkTime = mProcessClock->now() + mWatermarkInterval;
+            }
+            nowMuSeconds = mProcessClock->now();
             auto nowSeconds
                 = std::chrono::duration_cast<std::chrono::seconds>
                   (nowMuSeconds);
@@ -353,6 +1031,69 @@ public:
                 nNotSentPackets = 0;
                 lastLogTime = nowSeconds;
             }
+            if (nowSeconds >= nextSendMetricTime)
+            {
+                int64_t nStreams{0};
+                int64_t memoryUsage{0};
+                int64_t nFlatLinedPackets{0};
+                int64_t nClippedPackets{0};
+                int64_t nSpikedPackets{0};
+                for (const auto &shard : mShards)
+                {
+                    if (shard->mFlatLinedDataPacketTester)
+                    {
+                        nFlatLinedPackets = nFlatLinedPackets
+                           + shard->mFlatLinedDataPacketTester->getNumberOfFlaggedPackets();
+                    }
+                    if (shard->mClippedDataPacketTester)
+                    {
+                        nClippedPackets = nClippedPackets
+                           + shard->mClippedDataPacketTester->getNumberOfFlaggedPackets();
+                    }
+                    if (shard->mSpikedDataPacketTester)
+                    {
+                        nSpikedPackets = nSpikedPackets
+                           + shard->mSpikedDataPacketTester->getNumberOfFlaggedPackets();
+                    }
+                    if (shard->mDuplicateDataPacketTester)
+                    {
+                        nStreams = nStreams
+                           + shard->mDuplicateDataPacketTester->getNumberOfStreams();
+                        memoryUsage = memoryUsage
+                           + shard->mDuplicateDataPacketTester->getMemoryUsage();
+                    }
+                }
+                try
+                {
+                    trackedStreamsGauge->Record(nStreams, context);
+                    stateMemoryGauge->Record(memoryUsage, context);
+                    flatLinedPacketsGauge->Record(nFlatLinedPackets, context);
+                    clippedPacketsGauge->Record(nClippedPackets, context);
+                    spikedPacketsGauge->Record(nSpikedPackets, context);
+                    recordAvailability(*percentCompleteGauge,
+                                       *largestGapGauge,
+                                       *latencyGauge, context);
+                }
+                catch (const std::exception &e)
+                {
+                    spdlog::warn("Failed to publish metrics because "
+                               + std::string {e.what()});
+                }
+                nextSendMetricTime = nowSeconds + std::chrono::seconds {60};
+            }
+        }
+        // The shards have exited so this empties the queue
+        nSentPackets = 0;
+        nNotSentPackets = 0;
+        while (mMessagesToPublishQueue.try_dequeue(packet))
+        {
+            publishPacket();
+        }
+        if (nSentPackets + nNotSentPackets > 0)
+        {
+            spdlog::info("Sent " + std::to_string(nSentPackets)
+                       + " remaining packets while stopping.  (Failed to send "
+                       + std::to_string(nNotSentPackets) + " packets.)");
         }
         spdlog::debug("Thread exiting publishGoodPackets");
     } 
@@ -401,7 +1142,6 @@ public:
     Process& operator=(const Process &) = delete;
 ///private:
     //std::thread mSubscriberThread;
-    std::thread mTesterThread;
     std::thread mPublisherThread;
     std::unique_ptr<US8::Broadcasts::DataPacket::Subscriber>
         mPacketSubscriber{nullptr};
@@ -419,18 +1159,26 @@ public:
     zmq::socket_t mSubscriberSocket{mSubscriberContext, zmq::socket_type::sub};
     zmq::socket_t mPublisherSocket{mPublisherContext, zmq::socket_type::pub}; 
 */
-    std::unique_ptr<USanitizer::TestFutureDataPacket>
-        mFutureDataPacketTester;
-    std::unique_ptr<USanitizer::TestExpiredDataPacket>
-        mExpiredDataPacketTester;
-    std::unique_ptr<USanitizer::TestDuplicateDataPacket>
-        mDuplicateDataPacketTester;
-    moodycamel::ReaderWriterQueue<US8::MessageFormats::Broadcasts::DataPacket>
-        mPacketsToCheckQueue{MAX_QUEUE_SIZE};
-    moodycamel::ReaderWriterQueue<US8::MessageFormats::Broadcasts::DataPacket>
+    std::vector<std::unique_ptr<::Shard>> mShards;
+    // The testers' clock
+    std::shared_ptr<const US8::Utilities::IClock> mClock{nullptr};
+    // Set when packet times drive the testers' clock
+    std::shared_ptr<US8::Utilities::SimulatedClock> mSimulatedClock{nullptr};
+    // Times the logging and metrics
+    std::shared_ptr<const US8::Utilities::IClock> mProcessClock{nullptr};
+    moodycamel::ConcurrentQueue<US8::MessageFormats::Broadcasts::DataPacket>
         mMessagesToPublishQueue{MAX_QUEUE_SIZE};
+    std::string mApplicationName{APPLICATION_NAME};
+    std::string mOpenTelemetryVersion{OTEL_VERSION};
+    std::filesystem::path mStateFile;
+    std::filesystem::path mAvailabilityFile;
+    std::chrono::seconds mStateFileUpdateInterval{60};
     std::chrono::seconds mLogPublishingPerformanceInterval{3600};
+    std::unique_ptr<USanitizer::WatermarkTracker> mWatermarkTracker{nullptr};
+    std::chrono::milliseconds mWatermarkInterval{0};
     std::atomic<bool> mKeepRunning{true};
+    // The publisher outlives the shards so that it sends what they release
+    std::atomic<bool> mPublisherKeepRunning{true};
     bool mStopRequested{false};
 };
 
@@ -471,6 +1219,8 @@ int main(int argc, char *argv[])
     if (programOptions.verbosity == 3){spdlog::set_level(spdlog::level::info);}
     if (programOptions.verbosity >= 4){spdlog::set_level(spdlog::level::debug);}
 
+    initializeMetrics(programOptions);
+
     std::unique_ptr<::Process> process;
     try
     {   
@@ -480,6 +1230,7 @@ int main(int argc, char *argv[])
     {
         spdlog::error("Failed to create proxy process because "
                     + std::string {e.what()});
+        cleanupMetrics();
         return EXIT_FAILURE;
     }
 
@@ -491,10 +1242,13 @@ int main(int argc, char *argv[])
     {
         spdlog::error("Failed to start proxy process because "
                     + std::string {e.what()});
+        cleanupMetrics();
         return EXIT_FAILURE;
     }   
 
     process->handleMainThread();
+    process.reset();
+    cleanupMetrics();
     return EXIT_SUCCESS;
 }
 
@@ -613,5 +1367,177 @@ Allowed options)""");
     options.logBadDataInterval
         = std::chrono::seconds {logBadDataIntervalInSeconds};
 
+    // Duplicate tester state
+    options.stateFile
+        = propertyTree.get<std::string> ("Sanitizer.stateFile",
+                                         options.stateFile.string());
+    auto stateFileUpdateIntervalInSeconds
+        = static_cast<int> (options.stateFileUpdateInterval.count());
+    stateFileUpdateIntervalInSeconds
+        = propertyTree.get<int> ("Sanitizer.stateFileUpdateIntervalInSeconds",
+                                 stateFileUpdateIntervalInSeconds);
+    if (stateFileUpdateIntervalInSeconds < 1)
+    {
+        throw std::invalid_argument(
+            "Sanitizer.stateFileUpdateIntervalInSeconds must be positive");
+    }
+    options.stateFileUpdateInterval
+        = std::chrono::seconds {stateFileUpdateIntervalInSeconds};
+
+    // Stream eviction
+    auto streamTimeToLiveInSeconds
+        = static_cast<int> (options.streamTimeToLive.count());
+    streamTimeToLiveInSeconds
+        = propertyTree.get<int> ("Sanitizer.streamTimeToLiveInSeconds",
+                                 streamTimeToLiveInSeconds);
+    options.streamTimeToLive = std::chrono::seconds {streamTimeToLiveInSeconds};
+    auto maximumStateMemoryInMegaBytes
+        = propertyTree.get<int64_t> ("Sanitizer.maximumStateMemoryInMegaBytes",
+                                     options.maximumStateMemory/(1024*1024));
+    if (maximumStateMemoryInMegaBytes < 0){maximumStateMemoryInMegaBytes = 0;}
+    options.maximumStateMemory = maximumStateMemoryInMegaBytes*1024*1024;
+
+    // Content hashing
+    options.useContentHash
+        = propertyTree.get<bool> ("Sanitizer.useContentHash",
+                                  options.useContentHash);
+
+    // Reordering
+    auto maximumReorderLatencyInMilliSeconds
+        = static_cast<int> (options.maximumReorderLatency.count());
+    maximumReorderLatencyInMilliSeconds
+        = propertyTree.get<int> (
+             "Sanitizer.maximumReorderLatencyInMilliSeconds",
+             maximumReorderLatencyInMilliSeconds);
+    if (maximumReorderLatencyInMilliSeconds < 0)
+    {
+        maximumReorderLatencyInMilliSeconds = 0;
+    }
+    options.maximumReorderLatency
+        = std::chrono::milliseconds {maximumReorderLatencyInMilliSeconds};
+
+    // Availability
+    auto availabilityWindowInSeconds
+        = static_cast<int> (options.availabilityWindow.count());
+    availabilityWindowInSeconds
+        = propertyTree.get<int> ("Sanitizer.availabilityWindowInSeconds",
+                                 availabilityWindowInSeconds);
+    if (availabilityWindowInSeconds < 0){availabilityWindowInSeconds = 0;}
+    options.availabilityWindow
+        = std::chrono::seconds {availabilityWindowInSeconds};
+    options.availabilityFile
+        = propertyTree.get<std::string> ("Sanitizer.availabilityFile",
+                                         options.availabilityFile.string());
+
+    // Waveform quality
+    auto maximumFlatLineDurationInSeconds
+        = static_cast<int> (std::chrono::duration_cast<std::chrono::seconds>
+                            (options.maximumFlatLineDuration).count());
+    maximumFlatLineDurationInSeconds
+        = propertyTree.get<int> ("Sanitizer.maximumFlatLineDurationInSeconds",
+                                 maximumFlatLineDurationInSeconds);
+    if (maximumFlatLineDurationInSeconds < 0)
+    {
+        maximumFlatLineDurationInSeconds = 0;
+    }
+    options.maximumFlatLineDuration
+        = std::chrono::seconds {maximumFlatLineDurationInSeconds};
+    options.clipLevel
+        = propertyTree.get<double> ("Sanitizer.clipLevel", options.clipLevel);
+    if (options.clipLevel < 0)
+    {
+        throw std::invalid_argument("Sanitizer.clipLevel cannot be negative");
+    }
+    options.spikeThreshold
+        = propertyTree.get<double> ("Sanitizer.spikeThreshold",
+                                    options.spikeThreshold);
+    if (options.spikeThreshold < 0)
+    {
+        throw std::invalid_argument(
+            "Sanitizer.spikeThreshold cannot be negative");
+    }
+    options.dropBadWaveforms
+        = propertyTree.get<bool> ("Sanitizer.dropBadWaveforms",
+                                  options.dropBadWaveforms);
+
+    // Clock
+    auto clock
+        = propertyTree.get<std::string> ("Sanitizer.clock", "wall");
+    boost::algorithm::to_lower(clock);
+    if (clock == "wall")
+    {
+        options.clock = ::ClockType::Wall;
+    }
+    else if (clock == "coarse")
+    {
+        options.clock = ::ClockType::Coarse;
+    }
+    else if (clock == "simulated")
+    {
+        options.clock = ::ClockType::Simulated;
+    }
+    else
+    {
+        throw std::invalid_argument(
+           "Sanitizer.clock must be wall, coarse, or simulated");
+    }
+    auto coarseClockResolutionInMilliSeconds
+        = static_cast<int> (options.coarseClockResolution.count());
+    coarseClockResolutionInMilliSeconds
+        = propertyTree.get<int> (
+             "Sanitizer.coarseClockResolutionInMilliSeconds",
+             coarseClockResolutionInMilliSeconds);
+    if (coarseClockResolutionInMilliSeconds <= 0)
+    {
+        throw std::invalid_argument(
+           "Sanitizer.coarseClockResolutionInMilliSeconds must be positive");
+    }
+    options.coarseClockResolution
+        = std::chrono::milliseconds {coarseClockResolutionInMilliSeconds};
+
+    // Watermarks.  When reordering, a gap has already been waited on.
+    auto watermarkIntervalInMilliSeconds
+        = static_cast<int> (options.watermarkInterval.count());
+    watermarkIntervalInMilliSeconds
+        = propertyTree.get<int> ("Sanitizer.watermarkIntervalInMilliSeconds",
+                                 watermarkIntervalInMilliSeconds);
+    if (watermarkIntervalInMilliSeconds < 0)
+    {
+        watermarkIntervalInMilliSeconds = 0;
+    }
+    options.watermarkInterval
+        = std::chrono::milliseconds {watermarkIntervalInMilliSeconds};
+    if (options.maximumReorderLatency.count() > 0)
+    {
+        options.watermarkMaximumGapLatency = options.maximumReorderLatency;
+    }
+    auto watermarkMaximumGapLatencyInMilliSeconds
+        = static_cast<int> (options.watermarkMaximumGapLatency.count());
+    watermarkMaximumGapLatencyInMilliSeconds
+        = propertyTree.get<int> (
+             "Sanitizer.watermarkMaximumGapLatencyInMilliSeconds",
+             watermarkMaximumGapLatencyInMilliSeconds);
+    if (watermarkMaximumGapLatencyInMilliSeconds < 0)
+    {
+        throw std::invalid_argument(
+          "Sanitizer.watermarkMaximumGapLatencyInMilliSeconds cannot be negative");
+    }
+    options.watermarkMaximumGapLatency
+        = std::chrono::milliseconds {watermarkMaximumGapLatencyInMilliSeconds};
+
+    // Metrics
+    options.prometheusURL
+        = propertyTree.get<std::string> ("General.prometheusURL",
+                                         options.prometheusURL);
+
+    // Tester threads
+    options.numberOfShards
+        = propertyTree.get<int> ("Sanitizer.numberOfShards",
+                                 options.numberOfShards);
+    if (options.numberOfShards < 1)
+    {
+        throw std::invalid_argument("Sanitizer.numberOfShards must be positive");
+    }
+
     return options;
 }
@@ -0,0 +1,206 @@
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <atomic>
+#include <spdlog/spdlog.h>
+#include "testClippedDataPacket.hpp"
+#include "waveformStatistics.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/utilities/clock.hpp"
+#include "toName.hpp"
+
+using namespace US8::Broadcasts::DataPacket::Sanitizer;
+
+class TestClippedDataPacket::TestClippedDataPacketImpl
+{
+public:
+    TestClippedDataPacketImpl(const TestClippedDataPacketImpl &impl)
+    {
+        *this = impl;
+    }
+    TestClippedDataPacketImpl(const double clipLevel,
+                              const std::chrono::seconds &logBadDataInterval) :
+        mClipLevel(clipLevel),
+        mLogBadDataInterval(logBadDataInterval)
+    {
+        if (mClipLevel <= 0)
+        {
+            throw std::invalid_argument("Clip level must be positive");
+        }
+        if (mLogBadDataInterval.count() >= 0)
+        {
+            mLogBadData = true;
+        }
+        else
+        {
+            mLogBadData = false;
+        }
+    }
+    /// Logs the bad events
+    void logBadData(const bool allow,
+                    const US8::MessageFormats::Broadcasts::DataPacket &packet,
+                    const std::chrono::microseconds &nowMuSec)
+    {
+        if (!mLogBadData){return;}
+        std::string name;
+        try
+        {
+            if (!allow){name = ::toName(packet);}
+        }
+        catch (...)
+        {
+            spdlog::warn("Could not extract name of packet");
+        }
+        auto nowSeconds
+            = std::chrono::duration_cast<std::chrono::seconds> (nowMuSec);
+        {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        try
+        {
+            if (!name.empty() && !mClippedChannels.contains(name))
+            {
+                mClippedChannels.insert(name);
+            }
+        }
+        catch (...)
+        {
+            spdlog::warn("Failed to add " + name + " to set");
+        }
+        if (nowSeconds >= mLastLogTime + mLogBadDataInterval)
+        {
+            if (!mClippedChannels.empty())
+            {
+                std::string message{"Clipped data detected for: "};
+                for (const auto &channel : mClippedChannels)
+                {
+                    message = message + " " + channel;
+                }
+                spdlog::info(message);
+                mClippedChannels.clear();
+                mLastLogTime = nowSeconds;
+            }
+        }
+        }
+    }
+    TestClippedDataPacketImpl& operator=(const TestClippedDataPacketImpl &impl)
+    {
+        if (&impl == this){return *this;}
+        {
+        std::lock_guard<std::mutex> lockGuard(impl.mMutex);
+        mClippedChannels = impl.mClippedChannels;
+        mLastLogTime = impl.mLastLogTime;
+        }
+        mFlaggedPackets = impl.mFlaggedPackets.load();
+        mClipLevel = impl.mClipLevel;
+        mLogBadDataInterval = impl.mLogBadDataInterval;
+        mClock = impl.mClock;
+        mLogBadData = impl.mLogBadData;
+        return *this;
+    }
+//private:
+    mutable std::mutex mMutex;
+    std::shared_ptr<const US8::Utilities::IClock> mClock{
+        std::make_shared<US8::Utilities::WallClock> ()};
+    std::set<std::string> mClippedChannels;
+    std::atomic<int64_t> mFlaggedPackets{0};
+    double mClipLevel{8388607};
+    std::chrono::seconds mLastLogTime{0};
+    std::chrono::seconds mLogBadDataInterval{3600};
+    bool mLogBadData{true};
+};
+
+/// Constructor
+TestClippedDataPacket::TestClippedDataPacket() :
+    pImpl(std::make_unique<TestClippedDataPacketImpl>
+          (8388607, std::chrono::seconds {3600}))
+{
+}
+
+/// Constructor with options
+TestClippedDataPacket::TestClippedDataPacket(
+    const double clipLevel,
+    const std::chrono::seconds &logBadDataInterval) :
+    pImpl(std::make_unique<TestClippedDataPacketImpl> (clipLevel,
+                                                       logBadDataInterval))
+{
+}
+
+/// Copy constructor
+TestClippedDataPacket::TestClippedDataPacket(
+    const TestClippedDataPacket &testClippedDataPacket)
+{
+    *this = testClippedDataPacket;
+}
+
+/// Move constructor
+TestClippedDataPacket::TestClippedDataPacket(
+    TestClippedDataPacket &&testClippedDataPacket) noexcept
+{
+    *this = std::move(testClippedDataPacket);
+}
+
+/// Copy assignment
+TestClippedDataPacket&
+TestClippedDataPacket::operator=(const TestClippedDataPacket &testClippedDataPacket)
+{
+    if (&testClippedDataPacket == this){return *this;}
+    pImpl = std::make_unique<TestClippedDataPacketImpl>
+            (*testClippedDataPacket.pImpl);
+    return *this;
+}
+
+/// Move assignment
+TestClippedDataPacket&
+TestClippedDataPacket::operator=(TestClippedDataPacket &&testClippedDataPacket) noexcept
+{
+    if (&testClippedDataPacket == this){return *this;}
+    pImpl = std::move(testClippedDataPacket.pImpl);
+    return *this;
+}
+
+/// Destructor
+TestClippedDataPacket::~TestClippedDataPacket() = default;
+
+/// Does the work
+bool TestClippedDataPacket::allow(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet) const
+{
+    return allow(packet, computeWaveformStatistics(packet)); // Throws
+}
+
+/// Does the work with precomputed statistics
+bool TestClippedDataPacket::allow(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet,
+    const WaveformStatistics &statistics) const
+{
+    bool allow = (statistics.maximum < pImpl->mClipLevel &&
+                  statistics.minimum > -pImpl->mClipLevel) ? true : false;
+    if (!allow){pImpl->mFlaggedPackets.fetch_add(1);}
+    // (Safely) handle logging
+    try
+    {
+        auto nowMuSeconds = pImpl->mClock->now();
+        pImpl->logBadData(allow, packet, nowMuSeconds);
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::warn("Error detect in logBadData: "
+                   + std::string {e.what()});
+    }
+    return allow;
+}
+
+/// Number of flagged packets
+int64_t TestClippedDataPacket::getNumberOfFlaggedPackets() const noexcept
+{
+    return pImpl->mFlaggedPackets.load();
+}
+
+/// Clock
+void TestClippedDataPacket::setClock(
+    std::shared_ptr<const US8::Utilities::IClock> clock)
+{
+    if (clock == nullptr){throw std::invalid_argument("Clock is null");}
+    pImpl->mClock = std::move(clock);
+}
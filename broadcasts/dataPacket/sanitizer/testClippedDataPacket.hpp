@@ -0,0 +1,75 @@
+#ifndef US8_BROADCASTS_SANITIZER_TEST_CLIPPED_DATA_PACKET_HPP
+#define US8_BROADCASTS_SANITIZER_TEST_CLIPPED_DATA_PACKET_HPP
+#include <chrono>
+#include <string>
+#include <memory>
+#include <cstdint>
+namespace US8::MessageFormats::Broadcasts
+{
+class DataPacket;
+}
+namespace US8::Utilities
+{
+class IClock;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+struct WaveformStatistics;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+/// @brief Tests whether or not a packet is clipped, i.e., a sample reached
+///        the digitizer's full scale.  The amplitudes of such packets
+///        cannot be trusted.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class TestClippedDataPacket
+{
+public:
+    /// @brief Constructs a clipping checker with a default clip level of
+    ///        8388607 counts, i.e., the full scale of a 24-bit digitizer.
+    ///        Clipped sensors will be logged every hour.
+    TestClippedDataPacket();
+    /// @param[in] clipLevel  If the absolute value of a sample is at least
+    ///                       this then the packet is flagged.
+    /// @param[in] logBadDataInterval  If this is positive then this will
+    ///                                log flagged channels at approximately
+    ///                                this interval.
+    /// @throws std::invalid_argument if clipLevel is not positive.
+    TestClippedDataPacket(double clipLevel,
+                          const std::chrono::seconds &logBadDataInterval);
+    /// @brief Copy constructor.
+    TestClippedDataPacket(const TestClippedDataPacket &testClippedDataPacket);
+    /// @brief Move constructor.
+    TestClippedDataPacket(TestClippedDataPacket &&testClippedDataPacket) noexcept;
+
+    /// @result True indicates the data packet does not appear to be clipped.
+    /// @throws std::invalid_argument if the packet has no samples.
+    [[nodiscard]] bool allow(const US8::MessageFormats::Broadcasts::DataPacket &packet) const;
+    /// @param[in] statistics  The statistics of the packet's samples.  This
+    ///                        allows several testers to share one pass over
+    ///                        the samples.
+    /// @result True indicates the data packet does not appear to be clipped.
+    [[nodiscard]] bool allow(const US8::MessageFormats::Broadcasts::DataPacket &packet,
+                             const WaveformStatistics &statistics) const;
+    /// @result The number of packets that have been flagged.
+    [[nodiscard]] int64_t getNumberOfFlaggedPackets() const noexcept;
+
+    /// @brief Sets the clock from which the current time is read.  By
+    ///        default this is the wall clock.
+    /// @param[in] clock  The clock - e.g., a simulated clock for replaying
+    ///                   archived data.
+    /// @throws std::invalid_argument if clock is null.
+    void setClock(std::shared_ptr<const US8::Utilities::IClock> clock);
+
+    /// @brief Destructor.
+    ~TestClippedDataPacket();
+    /// @brief Copy assignment.
+    TestClippedDataPacket& operator=(const TestClippedDataPacket &testClippedDataPacket);
+    /// @brief Move assignment.
+    TestClippedDataPacket& operator=(TestClippedDataPacket &&testClippedDataPacket) noexcept;
+private:
+    class TestClippedDataPacketImpl;
+    std::unique_ptr<TestClippedDataPacketImpl> pImpl;
+};
+}
+#endif
@@ -1,18 +1,28 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <list>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <cstring>
 #ifndef NDEBUG
 #include <cassert>
 #endif
-#include <boost/circular_buffer.hpp>
 #include <spdlog/spdlog.h>
 #include "testDuplicateDataPacket.hpp"
 #include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/utilities/clock.hpp"
+#include "us8/utilities/writeAtomically.hpp"
 #include "toName.hpp"
+#include "contentHash.hpp"
 
 using namespace US8::Broadcasts::DataPacket::Sanitizer;
 
@@ -23,8 +33,9 @@ struct DataPacketHeader
 {
 public:
     DataPacketHeader() = default;
-    explicit DataPacketHeader(
-        const US8::MessageFormats::Broadcasts::DataPacket &packet)
+    DataPacketHeader(
+        const US8::MessageFormats::Broadcasts::DataPacket &packet,
+        const bool computeContentHash)
     {
         name = ::toName(packet);
 #ifndef NDEBUG
@@ -42,6 +53,12 @@ public:
         {
             throw std::invalid_argument("No samples in packet");
         }
+        // Fingerprint of the samples
+        if (computeContentHash)
+        {
+            contentHash = ::toContentHash(packet); // Throws
+            hasContentHash = true;
+        }
     } 
     bool operator<(const ::DataPacketHeader &rhs) const
     {
@@ -61,34 +78,46 @@ public:
             //return false;
         }
         if (rhs.nSamples != nSamples){return false;}
+        // Different samples means this is a different packet
+        if (hasContentHash && rhs.hasContentHash &&
+            contentHash != rhs.contentHash)
+        {
+            return false;
+        }
         auto dStartTime = std::abs(rhs.startTime.count() - startTime.count());
+        return (dStartTime < getStartTimeTolerance().count());
+    } 
+    /// Start times closer than this are considered the same
+    [[nodiscard]] std::chrono::microseconds getStartTimeTolerance() const
+    {
         if (samplingRate < 105)
         {
-            return (dStartTime < std::chrono::microseconds {15000}.count());
+            return std::chrono::microseconds {15000};
         }
         else if (samplingRate < 255)
         {
-            return (dStartTime < std::chrono::microseconds {4500}.count());
+            return std::chrono::microseconds {4500};
         }
         else if (samplingRate < 505)
         {
-            return (dStartTime < std::chrono::microseconds {2500}.count());
+            return std::chrono::microseconds {2500};
         }
         else if (samplingRate < 1005)
         {
-            return (dStartTime < std::chrono::microseconds {1500}.count());
+            return std::chrono::microseconds {1500};
         }
         throw std::runtime_error(
             "Could not classify sampling rate: " + std::to_string(samplingRate)
           + " for " + name);
-        //return false;
-    } 
+    }
     std::string name; // Packet name NETWORK.STATION.CHANNEL.LOCATION
     std::chrono::microseconds startTime{0}; // UTC time of first sample
     std::chrono::microseconds endTime{0}; // UTC time of last sample
     // Typically `observed' sampling rates wobble around a nominal sampling rate
     int samplingRate{100};
     int nSamples{0}; // Number of samples in packet
+    uint64_t contentHash{0}; // Hash of the samples
+    bool hasContentHash{false};
 };
 
 [[nodiscard]] int estimateCapacity(const ::DataPacketHeader &header,
@@ -102,6 +131,162 @@ public:
     return std::max(10, static_cast<int> (1.5*memory.count()/duration)) + 1;
 }
 
+/// Snapshot file layout (native byte order):
+///   magic, version, number of streams
+///   for each stream:
+///     name length, name, capacity, number of headers
+///     for each header: start time, end time, sampling rate, number of samples,
+///                      has content hash, content hash
+/// Version 1 snapshots lack the content hash.
+constexpr std::string_view SNAPSHOT_MAGIC{"US8DUPLI"};
+constexpr uint32_t SNAPSHOT_VERSION{2};
+
+template<typename T>
+void pack(const T value, std::string *buffer)
+{
+    buffer->append(reinterpret_cast<const char *> (&value), sizeof(T));
+}
+
+template<typename T>
+[[nodiscard]] T unpack(const std::string &buffer, size_t *offset)
+{
+    if (*offset + sizeof(T) > buffer.size())
+    {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+    T value;
+    std::memcpy(&value, buffer.data() + *offset, sizeof(T));
+    *offset = *offset + sizeof(T);
+    return value;
+}
+
+/// The previously processed packets for a stream ordered by start time.
+/// Lookups only visit the packets near the query time so duplicate, overlap,
+/// and insert operations are logarithmic in the number of packets.
+struct StreamIndex
+{
+    explicit StreamIndex(const size_t capacityIn) :
+        capacity(capacityIn)
+    {
+    }
+    [[nodiscard]] bool full() const noexcept
+    {
+        return headers.size() >= capacity;
+    }
+    [[nodiscard]] const ::DataPacketHeader &front() const
+    {
+        return headers.begin()->second;
+    }
+    [[nodiscard]] const ::DataPacketHeader &back() const
+    {
+        return headers.rbegin()->second;
+    }
+    /// @result True if a packet with (approximately) this start time and
+    ///         number of samples was already processed.
+    [[nodiscard]] bool containsDuplicate(const ::DataPacketHeader &header) const
+    {
+        auto tolerance = header.getStartTimeTolerance();
+        for (auto it = headers.upper_bound(header.startTime - tolerance);
+             it != headers.end() && it->first < header.startTime + tolerance;
+             ++it)
+        {
+            if (it->second == header){return true;}
+        }
+        return false;
+    }
+    /// @result True if a previously processed packet overlapping this one
+    ///         has identical samples.  Requiring the overlap prevents
+    ///         consecutive packets with identical samples, e.g., from a
+    ///         flat-lined sensor, from being flagged.
+    [[nodiscard]] bool containsContentHash(const ::DataPacketHeader &header) const
+    {
+        if (!header.hasContentHash){return false;}
+        auto duration = header.endTime - header.startTime;
+        auto [first, last] = hashes.equal_range(header.contentHash);
+        for (auto it = first; it != last; ++it)
+        {
+            auto dStartTime = it->second - header.startTime;
+            if (std::chrono::abs(dStartTime) <= duration){return true;}
+        }
+        return false;
+    }
+    /// @result True if the given time is in a previously processed packet.
+    [[nodiscard]] bool contains(const std::chrono::microseconds &time) const
+    {
+        // Only packets starting within the longest packet duration of the
+        // time can contain it
+        for (auto it = headers.lower_bound(time - maximumDuration);
+             it != headers.end() && it->first <= time;
+             ++it)
+        {
+            if (time <= it->second.endTime){return true;}
+        }
+        return false;
+    }
+    /// Adds the header.  When full, the earliest packet is evicted.
+    void insert(const ::DataPacketHeader &header)
+    {
+        auto existing = headers.find(header.startTime);
+        if (existing != headers.end())
+        {
+            eraseContentHash(existing->second);
+        }
+        else if (full())
+        {
+            eraseContentHash(headers.begin()->second);
+            headers.erase(headers.begin());
+        }
+        maximumDuration = std::max(maximumDuration,
+                                   header.endTime - header.startTime);
+        headers.insert_or_assign(header.startTime, header);
+        if (header.hasContentHash)
+        {
+            hashes.insert(std::pair {header.contentHash, header.startTime});
+        }
+    }
+    /// Removes the header's entry from the hash index
+    void eraseContentHash(const ::DataPacketHeader &header)
+    {
+        if (!header.hasContentHash){return;}
+        auto [first, last] = hashes.equal_range(header.contentHash);
+        for (auto it = first; it != last; ++it)
+        {
+            if (it->second == header.startTime)
+            {
+                hashes.erase(it);
+                return;
+            }
+        }
+    }
+    /// @result The approximate number of bytes used by this stream.
+    [[nodiscard]] int64_t getMemoryUsage(const std::string &name) const noexcept
+    {
+        // A map node holds the key-value pair, three pointers, and a color
+        constexpr int64_t nodeSize
+        {
+            sizeof(std::pair<const std::chrono::microseconds,
+                             ::DataPacketHeader>) + 4*sizeof(void *)
+        };
+        // A hash node holds the key-value pair and a pointer plus a bucket
+        constexpr int64_t hashNodeSize
+        {
+            sizeof(std::pair<const uint64_t, std::chrono::microseconds>)
+          + 2*sizeof(void *)
+        };
+        return static_cast<int64_t> (sizeof(StreamIndex) + 2*name.capacity())
+             + static_cast<int64_t> (headers.size())*nodeSize
+             + static_cast<int64_t> (hashes.size())*hashNodeSize;
+    }
+    std::map<std::chrono::microseconds, ::DataPacketHeader> headers;
+    // Content hash to start time of the packets in headers
+    std::unordered_multimap<uint64_t, std::chrono::microseconds> hashes;
+    // This stream's position in the recently used list
+    std::list<std::string>::iterator recentlyUsed;
+    std::chrono::steady_clock::time_point lastUpdate;
+    std::chrono::microseconds maximumDuration{0};
+    size_t capacity{100};
+};
+
 }
 
 class TestDuplicateDataPacket::TestDuplicateDataPacketImpl
@@ -115,10 +300,7 @@ public:
     void logBadData()
     {
         if (!mLogBadData){return;}
-        auto now = std::chrono::high_resolution_clock::now();
-        auto nowMuSeconds
-           = std::chrono::time_point_cast<std::chrono::microseconds>
-             (now).time_since_epoch();
+        auto nowMuSeconds = mClock->now();
         auto nowSeconds
             = std::chrono::duration_cast<std::chrono::seconds> (nowMuSeconds);
         {
@@ -150,16 +332,101 @@ public:
         }
         }
     }
+    /// Marks the stream as the most recently used
+    void touch(std::map<std::string, ::StreamIndex>::iterator streamIndex,
+               const std::chrono::steady_clock::time_point &now) const
+    {
+        auto &stream = streamIndex->second;
+        stream.lastUpdate = now;
+        mRecentlyUsed.splice(mRecentlyUsed.begin(), mRecentlyUsed,
+                             stream.recentlyUsed);
+    }
+    /// Adds a new stream as the most recently used
+    void track(std::map<std::string, ::StreamIndex>::iterator streamIndex,
+               const std::chrono::steady_clock::time_point &now) const
+    {
+        auto &stream = streamIndex->second;
+        mRecentlyUsed.push_front(streamIndex->first);
+        stream.recentlyUsed = mRecentlyUsed.begin();
+        stream.lastUpdate = now;
+        mMemoryUsage = mMemoryUsage
+                     + stream.getMemoryUsage(streamIndex->first);
+    }
+    /// Forgets the least recently used stream
+    void evictLeastRecentlyUsed() const
+    {
+        auto streamIndex = mStreams.find(mRecentlyUsed.back());
+#ifndef NDEBUG
+        assert(streamIndex != mStreams.end());
+#endif
+        mMemoryUsage = mMemoryUsage
+                     - streamIndex->second.getMemoryUsage(streamIndex->first);
+        mStreams.erase(streamIndex);
+        mRecentlyUsed.pop_back();
+    }
+    /// Forgets the streams that have been idle too long then the least
+    /// recently used streams until the state is within budget.  The most
+    /// recently used stream is always retained.
+    void evictStreams(const std::chrono::steady_clock::time_point &now) const
+    {
+        if (mStreamTimeToLive.count() > 0)
+        {
+            while (mRecentlyUsed.size() > 1)
+            {
+                const auto &stream = mStreams.at(mRecentlyUsed.back());
+                if (now - stream.lastUpdate <= mStreamTimeToLive){break;}
+                spdlog::info("Evicting idle stream " + mRecentlyUsed.back());
+                evictLeastRecentlyUsed();
+            }
+        }
+        if (mMaximumMemoryUsage > 0)
+        {
+            while (mRecentlyUsed.size() > 1 &&
+                   mMemoryUsage > mMaximumMemoryUsage)
+            {
+                spdlog::debug("Evicting least recently used stream "
+                            + mRecentlyUsed.back());
+                evictLeastRecentlyUsed();
+            }
+        }
+        mNumberOfStreamsView = static_cast<int> (mStreams.size());
+        mMemoryUsageView = mMemoryUsage;
+    }
+    /// Rebuilds the recently used list and memory usage after the streams
+    /// are replaced
+    void rebuildRecentlyUsed() const
+    {
+        std::vector<std::map<std::string, ::StreamIndex>::iterator> streams;
+        streams.reserve(mStreams.size());
+        for (auto it = mStreams.begin(); it != mStreams.end(); ++it)
+        {
+            streams.push_back(it);
+        }
+        std::stable_sort(streams.begin(), streams.end(),
+                         [](const auto &lhs, const auto &rhs)
+                         {
+                             return lhs->second.lastUpdate <
+                                    rhs->second.lastUpdate;
+                         });
+        mRecentlyUsed.clear();
+        mMemoryUsage = 0;
+        for (auto &streamIndex : streams)
+        {
+            track(streamIndex, streamIndex->second.lastUpdate);
+        }
+        mNumberOfStreamsView = static_cast<int> (mStreams.size());
+        mMemoryUsageView = mMemoryUsage;
+    }
     [[nodiscard]] bool allow(const ::DataPacketHeader &header) const
     {
 #ifndef NDEBUG
         assert(!header.name.empty());
         assert(header.nSamples > 0);
 #endif
+        auto now = std::chrono::steady_clock::now();
         // Does this channel exist?
-        auto circularBufferIndex = mCircularBuffers.find(header.name);
-        bool firstExample{false};
-        if (circularBufferIndex == mCircularBuffers.end())
+        auto streamIndex = mStreams.find(header.name);
+        if (streamIndex == mStreams.end())
         {
             int capacity = mCircularBufferSize;
             if (mEstimateCapacity)
@@ -168,33 +435,39 @@ public:
                     = ::estimateCapacity(header,
                                          mCircularBufferDuration);
             }
-            spdlog::info("Creating new circular buffer for: "
+            spdlog::info("Creating new packet index for: "
                        + header.name + " with capacity: "
                        + std::to_string(capacity));
-            boost::circular_buffer<::DataPacketHeader>
-                newCircularBuffer(capacity);
-            newCircularBuffer.push_back(header);
-            mCircularBuffers.insert(std::pair{header.name,
-                                              std::move(newCircularBuffer)});
+            ::StreamIndex newStreamIndex(static_cast<size_t> (capacity));
+            newStreamIndex.insert(header);
+            auto newIndex
+                = mStreams.insert(std::pair{header.name,
+                                            std::move(newStreamIndex)}).first;
+            track(newIndex, now);
+            evictStreams(now);
             // Can't be a a duplicate because its the first one
             return true;
         }
-        // Now we should definitely be able to find the appropriate circular
-        // buffer for this stream 
-        circularBufferIndex = mCircularBuffers.find(header.name);
-        if (circularBufferIndex == mCircularBuffers.end())
-        {
-            spdlog::warn(
-                "Algorithm error - circular buffer doesn't exist for: "
-               + header.name);
-            return false;
-        }
-        // See if this header exists (exactly)
-        auto headerIndex
-            = std::find(circularBufferIndex->second.begin(),
-                        circularBufferIndex->second.end(),
-                        header);
-        if (headerIndex != circularBufferIndex->second.end())
+        touch(streamIndex, now);
+        auto &stream = streamIndex->second;
+        auto memoryUsage = stream.getMemoryUsage(streamIndex->first);
+        auto allow = check(stream, header);
+        mMemoryUsage = mMemoryUsage
+                     + stream.getMemoryUsage(streamIndex->first) - memoryUsage;
+        evictStreams(now);
+        return allow;
+    }
+    /// Checks the header against the stream's previously processed packets
+    [[nodiscard]] bool check(::StreamIndex &stream,
+                             const ::DataPacketHeader &header) const
+    {
+#ifndef NDEBUG
+        assert(!stream.headers.empty());
+#endif
+        // An identical, overlapping packet is a duplicate.  Otherwise, see if
+        // this header exists (approximately).
+        if (stream.containsContentHash(header) ||
+            stream.containsDuplicate(header))
         {
             if (mLogBadData)
             {
@@ -211,77 +484,151 @@ public:
             return false;
         }
         // Insert it (typically new stuff shows up)
-        if (header.startTime > circularBufferIndex->second.back().endTime)
+        if (header.startTime > stream.back().endTime)
         {
             spdlog::debug("Inserting " + header.name
-                        + " at end of circular buffer");
-            circularBufferIndex->second.push_back(header);
+                        + " at end of packet index");
+            stream.insert(header);
             return true;
         }
-        // If it is is really old and there's space then push to front
-        if (header.endTime < circularBufferIndex->second.front().startTime)
+        // If it is is really old and there's space then remember it
+        if (header.endTime < stream.front().startTime)
         {
-            if (!circularBufferIndex->second.full())
+            if (!stream.full())
             {
                 spdlog::debug("Inserting " + header.name 
-                            + " at front of circular buffer");
-                circularBufferIndex->second.push_front(header);
-#ifndef NDEBUG
-                assert(std::is_sorted(circularBufferIndex->second.begin(),
-                                      circularBufferIndex->second.end(),
-                       [](const ::DataPacketHeader &lhs, const ::DataPacketHeader &rhs)
-                       {
-                          return lhs.startTime < rhs.startTime;
-                       }));
-#endif
+                            + " at front of packet index");
+                stream.insert(header);
             }
-            // Note, if the buffer is full then this packet is expired in the
-            // eyes of the circular buffer.  
+            // Note, if the index is full then this packet is expired in the
+            // eyes of the index.
             return false;
         }
         // The packet is old.  We have to check for a GPS slip.
-        for (const auto &streamHeader : circularBufferIndex->second)
+        if (stream.contains(header.startTime) ||
+            stream.contains(header.endTime))
         {
-            if ((header.startTime >= streamHeader.startTime &&
-                 header.startTime <= streamHeader.endTime) ||
-                (header.endTime >= streamHeader.startTime &&
-                 header.endTime <= streamHeader.endTime))
+            if (mLogBadData)
             {
-                //std::cout << std::setprecision(16) << header.name << " " << streamHeader.name << " | " << header.startTime.count()*1.e-6 << " " << streamHeader.startTime.count()*1.e-6 << " | " 
-                //<< header.endTime.count()*1.e-6 << " " << streamHeader.endTime.count()*1.e-6 << std::endl;
-                if (mLogBadData)
+                spdlog::info("Detected possible timing slip for: "
+                           + header.name);
                 {
-                    spdlog::info("Detected possible timing slip for: "
-                               + header.name);
-                    {
-                    std::lock_guard<std::mutex> lockGuard(mMutex);
-                    if (!mBadTimingChannels.contains(header.name))
-                    {
-                        mBadTimingChannels.insert(header.name);
-                    }
-                    }
+                std::lock_guard<std::mutex> lockGuard(mMutex);
+                if (!mBadTimingChannels.contains(header.name))
+                {
+                    mBadTimingChannels.insert(header.name);
+                }
                 }
-                return false;
             }
+            return false;
         }
         // This appears to be a valid (out-of-order) back-fill
-        spdlog::debug("Inserting " + header.name
-                    + " in circular buffer then sorting...");
-        circularBufferIndex->second.push_back(header);
-        std::sort(circularBufferIndex->second.begin(),
-                  circularBufferIndex->second.end(),
-                  [](const ::DataPacketHeader &lhs, const ::DataPacketHeader &rhs)
-                  {
-                      return lhs.startTime < rhs.startTime;
-                  });
+        spdlog::debug("Inserting " + header.name + " in packet index");
+        stream.insert(header);
         return true;
     }
+    /// Packs the streams into a snapshot
+    [[nodiscard]] std::string createSnapshot() const
+    {
+        std::string buffer{SNAPSHOT_MAGIC};
+        ::pack<uint32_t> (SNAPSHOT_VERSION, &buffer);
+        ::pack<uint32_t> (static_cast<uint32_t> (mStreams.size()), &buffer);
+        for (const auto &[name, stream] : mStreams)
+        {
+            ::pack<uint32_t> (static_cast<uint32_t> (name.size()), &buffer);
+            buffer.append(name);
+            ::pack<uint32_t> (static_cast<uint32_t> (stream.capacity),
+                              &buffer);
+            ::pack<uint32_t> (static_cast<uint32_t> (stream.headers.size()),
+                              &buffer);
+            for (const auto &[startTime, header] : stream.headers)
+            {
+                ::pack<int64_t> (header.startTime.count(), &buffer);
+                ::pack<int64_t> (header.endTime.count(), &buffer);
+                ::pack<int32_t> (header.samplingRate, &buffer);
+                ::pack<int32_t> (header.nSamples, &buffer);
+                ::pack<uint8_t> (header.hasContentHash ? 1 : 0, &buffer);
+                ::pack<uint64_t> (header.contentHash, &buffer);
+            }
+        }
+        return buffer;
+    }
+    /// Unpacks a snapshot.  Nothing is modified if the snapshot is corrupt.
+    int loadSnapshot(const std::string &buffer,
+                     const std::function<bool (const std::string &)> &keep)
+    {
+        if (!buffer.starts_with(SNAPSHOT_MAGIC))
+        {
+            throw std::runtime_error("Not a duplicate packet snapshot");
+        }
+        size_t offset{SNAPSHOT_MAGIC.size()};
+        auto version = ::unpack<uint32_t> (buffer, &offset);
+        if (version < 1 || version > SNAPSHOT_VERSION)
+        {
+            throw std::runtime_error("Unhandled snapshot version "
+                                   + std::to_string(version));
+        }
+        std::map<std::string, ::StreamIndex> streams;
+        auto nStreams = ::unpack<uint32_t> (buffer, &offset);
+        for (uint32_t iStream = 0; iStream < nStreams; ++iStream)
+        {
+            auto nameLength = ::unpack<uint32_t> (buffer, &offset);
+            if (offset + nameLength > buffer.size())
+            {
+                throw std::runtime_error("Snapshot is truncated");
+            }
+            ::DataPacketHeader header;
+            header.name = buffer.substr(offset, nameLength);
+            offset = offset + nameLength;
+            auto capacity = ::unpack<uint32_t> (buffer, &offset);
+            auto nHeaders = ::unpack<uint32_t> (buffer, &offset);
+            if (capacity < 1)
+            {
+                throw std::runtime_error("Invalid capacity for "
+                                       + header.name);
+            }
+            ::StreamIndex stream(capacity);
+            for (uint32_t iHeader = 0; iHeader < nHeaders; ++iHeader)
+            {
+                header.startTime
+                    = std::chrono::microseconds
+                      {::unpack<int64_t> (buffer, &offset)};
+                header.endTime
+                    = std::chrono::microseconds
+                      {::unpack<int64_t> (buffer, &offset)};
+                header.samplingRate = ::unpack<int32_t> (buffer, &offset);
+                header.nSamples = ::unpack<int32_t> (buffer, &offset);
+                if (version >= 2)
+                {
+                    header.hasContentHash
+                        = (::unpack<uint8_t> (buffer, &offset) != 0);
+                    header.contentHash = ::unpack<uint64_t> (buffer, &offset);
+                }
+                stream.insert(header);
+            }
+            if (stream.headers.empty()){continue;}
+            if (keep && !keep(header.name)){continue;}
+            streams.insert_or_assign(header.name, std::move(stream));
+        }
+        auto nLoaded = static_cast<int> (streams.size());
+        // Streams already in use take precedence
+        auto now = std::chrono::steady_clock::now();
+        for (auto &[name, stream] : streams)
+        {
+            stream.lastUpdate = now;
+        }
+        mStreams.merge(streams);
+        rebuildRecentlyUsed();
+        evictStreams(now);
+        return nLoaded;
+    }
     TestDuplicateDataPacketImpl& operator=(const TestDuplicateDataPacketImpl &impl)
     {
         if (&impl == this){return *this;}
         {
         std::lock_guard<std::mutex> lockGuard(impl.mMutex);
-        mCircularBuffers = impl.mCircularBuffers;
+        mStreams = impl.mStreams;
+        rebuildRecentlyUsed();
         mDuplicateChannels = impl.mDuplicateChannels;
         mBadTimingChannels = impl.mBadTimingChannels;
         mLastLogTime = impl.mLastLogTime; 
@@ -289,14 +636,27 @@ public:
         mLogBadDataInterval = impl.mLogBadDataInterval;
         mCircularBufferDuration = impl.mCircularBufferDuration;
         mCircularBufferSize = impl.mCircularBufferSize;
+        mClock = impl.mClock;
         mLogBadData = impl.mLogBadData;
         mEstimateCapacity = impl.mEstimateCapacity;
+        mStreamTimeToLive = impl.mStreamTimeToLive;
+        mMaximumMemoryUsage = impl.mMaximumMemoryUsage;
+        mUseContentHash = impl.mUseContentHash;
         return *this;
     }
 //private:
     mutable std::mutex mMutex;
-    mutable std::map<std::string, boost::circular_buffer<::DataPacketHeader>>
-        mCircularBuffers;
+    std::shared_ptr<const US8::Utilities::IClock> mClock{
+        std::make_shared<US8::Utilities::WallClock> ()};
+    mutable std::map<std::string, ::StreamIndex> mStreams;
+    // Stream names from most to least recently used
+    mutable std::list<std::string> mRecentlyUsed;
+    mutable int64_t mMemoryUsage{0};
+    // Copies that are safe to read from other threads
+    mutable std::atomic<int64_t> mMemoryUsageView{0};
+    mutable std::atomic<int> mNumberOfStreamsView{0};
+    std::chrono::seconds mStreamTimeToLive{0};
+    int64_t mMaximumMemoryUsage{0};
     mutable std::set<std::string> mDuplicateChannels;
     mutable std::set<std::string> mBadTimingChannels;
     std::chrono::seconds mLogBadDataInterval{3600};
@@ -305,6 +665,7 @@ public:
     int mCircularBufferSize{100}; // ~3s packets 
     bool mLogBadData{true};
     bool mEstimateCapacity{false};
+    bool mUseContentHash{false};
 };
 
 /// Constructor
@@ -393,11 +754,11 @@ TestDuplicateDataPacket::~TestDuplicateDataPacket() = default;
 bool TestDuplicateDataPacket::allow(
     const US8::MessageFormats::Broadcasts::DataPacket &packet) const
 {
-    // Construct the trace header for the circular buffer
+    // Construct the trace header for the packet index
     ::DataPacketHeader header;
     try
     {
-        header = ::DataPacketHeader {packet}; // Copy elision
+        header = ::DataPacketHeader {packet, pImpl->mUseContentHash}; // Copy elision
     }
     catch (const std::exception &e)
     {
@@ -427,3 +788,65 @@ bool TestDuplicateDataPacket::allow(
     }
     return allow;
 }
+
+/// Save the state
+void TestDuplicateDataPacket::save(const std::filesystem::path &fileName) const
+{
+    US8::Utilities::writeAtomically(fileName, pImpl->createSnapshot());
+}
+
+/// Load the state
+int TestDuplicateDataPacket::load(
+    const std::filesystem::path &fileName,
+    const std::function<bool (const std::string &)> &keep)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + fileName.string());
+    }
+    std::string buffer{std::istreambuf_iterator<char> (file),
+                       std::istreambuf_iterator<char> ()};
+    return pImpl->loadSnapshot(buffer, keep);
+}
+
+/// Idle stream time to live
+void TestDuplicateDataPacket::setStreamTimeToLive(
+    const std::chrono::seconds &timeToLive) noexcept
+{
+    pImpl->mStreamTimeToLive = timeToLive;
+}
+
+/// Memory budget
+void TestDuplicateDataPacket::setMaximumMemoryUsage(
+    const int64_t maximumMemoryUsage) noexcept
+{
+    pImpl->mMaximumMemoryUsage = maximumMemoryUsage;
+}
+
+/// Content hashing
+void TestDuplicateDataPacket::setUseContentHash(
+    const bool useContentHash) noexcept
+{
+    pImpl->mUseContentHash = useContentHash;
+}
+
+/// Number of streams
+int TestDuplicateDataPacket::getNumberOfStreams() const noexcept
+{
+    return pImpl->mNumberOfStreamsView.load();
+}
+
+/// Memory usage
+int64_t TestDuplicateDataPacket::getMemoryUsage() const noexcept
+{
+    return pImpl->mMemoryUsageView.load();
+}
+
+/// Clock
+void TestDuplicateDataPacket::setClock(
+    std::shared_ptr<const US8::Utilities::IClock> clock)
+{
+    if (clock == nullptr){throw std::invalid_argument("Clock is null");}
+    pImpl->mClock = std::move(clock);
+}
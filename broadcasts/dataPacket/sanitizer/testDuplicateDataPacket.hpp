@@ -1,23 +1,31 @@
 #ifndef US8_BROADCASTS_SANITIZER_TEST_DUPLICATE_DATA_PACKET_HPP
 #define US8_BROADCASTS_SANITIZER_TEST_DUPLICATE_DATA_PACKET_HPP
 #include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <string>
 #include <memory>
 namespace US8::MessageFormats::Broadcasts
 {
 class DataPacket;
 }
+namespace US8::Utilities
+{
+class IClock;
+}
 namespace US8::Broadcasts::DataPacket::Sanitizer
 {
 /// @brief Tests whether or not this packet may have been previously processed
 ///        This works by comparing the packet's header (start and end time)
-///        to previous packets collected in a circular buffer.  Additionally,
-///        it can detect GPS slips.  For example, if an older packet arrives
-///        with times contained between earlier process packets then it is also
-///        rejected.
+///        to previous packets collected in a bounded, time-ordered index.
+///        Additionally, it can detect GPS slips.  For example, if an older
+///        packet arrives with times contained between earlier process packets
+///        then it is also rejected.  Since the index is ordered by start time,
+///        these checks are logarithmic in the number of retained packets.
 ///
 ///        Note, if the packet is very old then it's previously processed
-///        counterpart may have been purged from the circular buffer.  The
+///        counterpart may have been purged from the index.  The
 ///        packet will then be allowed.  In this instance, this is okay
 ///        because the database will detect a conflict on the start time
 ///        and default to an earlier packet.
@@ -56,6 +64,58 @@ public:
     /// @result True indicates the data does not appear to have been processed.
     [[nodiscard]] bool allow(const US8::MessageFormats::Broadcasts::DataPacket &packet) const;
 
+    /// @brief Writes a binary snapshot of the previously processed packets
+    ///        so that a restarted process can detect duplicates immediately.
+    ///        The snapshot is written to a temporary file then renamed so a
+    ///        crash leaves the previous snapshot intact.
+    /// @param[in] fileName  The snapshot file.
+    /// @throws std::runtime_error if the file cannot be written.
+    /// @note This should be called from the thread calling \c allow().
+    void save(const std::filesystem::path &fileName) const;
+    /// @brief Loads a snapshot written by \c save().
+    /// @param[in] fileName  The snapshot file.
+    /// @param[in] keep      If set then only streams, e.g., UU.FORK.HHZ.01,
+    ///                      for which this returns true are loaded.
+    /// @result The number of streams loaded.
+    /// @throws std::runtime_error if the file cannot be read or is corrupt.
+    ///         In this case the tester's state is unchanged.
+    int load(const std::filesystem::path &fileName,
+             const std::function<bool (const std::string &)> &keep = nullptr);
+
+    /// @brief Streams that have not sent a packet for this long are
+    ///        forgotten.  By default streams are never forgotten.
+    /// @param[in] timeToLive  The idle time.  If this is not positive then
+    ///                        idle streams are retained.
+    void setStreamTimeToLive(const std::chrono::seconds &timeToLive) noexcept;
+    /// @brief Limits the memory used to track streams.  When exceeded, the
+    ///        least recently used streams are forgotten.
+    /// @param[in] maximumMemoryUsage  The approximate budget in bytes.  If
+    ///                                this is not positive then the memory
+    ///                                is not limited.
+    void setMaximumMemoryUsage(int64_t maximumMemoryUsage) noexcept;
+    /// @brief When enabled, a 64-bit hash of each packet's samples is
+    ///        retained.  A packet whose samples hash to those of an
+    ///        overlapping, previously processed packet is a duplicate
+    ///        regardless of timing jitter.  Conversely, packets with the
+    ///        same start time but different samples are not treated as
+    ///        duplicates (they are then subject to the timing slip check).
+    ///        By default this is disabled.
+    /// @param[in] useContentHash  True enables content hashing.
+    void setUseContentHash(bool useContentHash) noexcept;
+    /// @result The number of tracked streams.
+    /// @note This is safe to call from any thread.
+    [[nodiscard]] int getNumberOfStreams() const noexcept;
+    /// @result The approximate number of bytes used to track the streams.
+    /// @note This is safe to call from any thread.
+    [[nodiscard]] int64_t getMemoryUsage() const noexcept;
+
+    /// @brief Sets the clock from which the current time is read.  By
+    ///        default this is the wall clock.
+    /// @param[in] clock  The clock - e.g., a simulated clock for replaying
+    ///                   archived data.
+    /// @throws std::invalid_argument if clock is null.
+    void setClock(std::shared_ptr<const US8::Utilities::IClock> clock);
+
     /// @brief Destructor.
     ~TestDuplicateDataPacket();
     /// @brief Copy assignment.
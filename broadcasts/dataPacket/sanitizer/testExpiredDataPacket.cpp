@@ -8,6 +8,7 @@
 //#include "us8/broadcasts/dataPacket/sanitizer/testExpiredDataPacket.hpp"
 #include "testExpiredDataPacket.hpp"
 #include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/utilities/clock.hpp"
 #include "toName.hpp"
 
 using namespace US8::Broadcasts::DataPacket::Sanitizer;
@@ -93,11 +94,14 @@ public:
         }
         mMaxExpiredTime = impl.mMaxExpiredTime;
         mLogBadDataInterval = impl.mLogBadDataInterval;
+        mClock = impl.mClock;
         mLogBadData = impl.mLogBadData;
         return *this;
     }
 //private:
     mutable std::mutex mMutex;
+    std::shared_ptr<const US8::Utilities::IClock> mClock{
+        std::make_shared<US8::Utilities::WallClock> ()};
     std::set<std::string> mExpiredChannels;
     std::chrono::microseconds mMaxExpiredTime{std::chrono::seconds{180}};
     std::chrono::seconds mLastLogTime{0};
@@ -164,10 +168,7 @@ bool TestExpiredDataPacket::allow(
     const US8::MessageFormats::Broadcasts::DataPacket &packet) const
 {
     auto packetStartTime = packet.getStartTime(); // Throws
-    auto now = std::chrono::high_resolution_clock::now();
-    auto nowMuSeconds
-        = std::chrono::time_point_cast<std::chrono::microseconds>
-          (now).time_since_epoch();
+    auto nowMuSeconds = pImpl->mClock->now();
     auto earliestTime  = nowMuSeconds - pImpl->mMaxExpiredTime;
     // Packet contains data after max allowable time?
     bool allow = (packetStartTime >= earliestTime) ? true : false;
@@ -183,3 +184,11 @@ bool TestExpiredDataPacket::allow(
     }
     return allow;
 }
+
+/// Clock
+void TestExpiredDataPacket::setClock(
+    std::shared_ptr<const US8::Utilities::IClock> clock)
+{
+    if (clock == nullptr){throw std::invalid_argument("Clock is null");}
+    pImpl->mClock = std::move(clock);
+}
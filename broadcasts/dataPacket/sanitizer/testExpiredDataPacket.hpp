@@ -7,6 +7,10 @@ namespace US8::MessageFormats::Broadcasts
 {
 class DataPacket;
 }
+namespace US8::Utilities
+{
+class IClock;
+}
 namespace US8::Broadcasts::DataPacket::Sanitizer
 {
 /// @brief Tests whether or not a packet contains data that has expired.  This
@@ -40,6 +44,13 @@ public:
     ///         data.
     [[nodiscard]] bool allow(const US8::MessageFormats::Broadcasts::DataPacket &packet) const;
 
+    /// @brief Sets the clock from which the current time is read.  By
+    ///        default this is the wall clock.
+    /// @param[in] clock  The clock - e.g., a simulated clock for replaying
+    ///                   archived data.
+    /// @throws std::invalid_argument if clock is null.
+    void setClock(std::shared_ptr<const US8::Utilities::IClock> clock);
+
     /// @brief Destructor.
     ~TestExpiredDataPacket();
     /// @brief Copy assignment.
@@ -0,0 +1,268 @@
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <map>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <spdlog/spdlog.h>
+#include "testFlatLinedDataPacket.hpp"
+#include "waveformStatistics.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/utilities/clock.hpp"
+#include "toName.hpp"
+
+using namespace US8::Broadcasts::DataPacket::Sanitizer;
+
+namespace
+{
+
+struct Stream
+{
+    // The stream's last sample
+    double last{0};
+    // The number of identical samples ending the stream
+    int64_t trailingRun{0};
+    // The start time of the sample after the stream's last sample
+    std::chrono::microseconds nextStartTime{0};
+};
+
+}
+
+class TestFlatLinedDataPacket::TestFlatLinedDataPacketImpl
+{
+public:
+    TestFlatLinedDataPacketImpl(const TestFlatLinedDataPacketImpl &impl)
+    {
+        *this = impl;
+    }
+    TestFlatLinedDataPacketImpl(
+        const std::chrono::milliseconds &maximumFlatLineDuration,
+        const std::chrono::seconds &logBadDataInterval) :
+        mMaximumFlatLineDuration(maximumFlatLineDuration),
+        mLogBadDataInterval(logBadDataInterval)
+    {
+        if (mMaximumFlatLineDuration.count() <= 0)
+        {
+            throw std::invalid_argument(
+                "Maximum flat-line duration must be positive");
+        }
+        if (mLogBadDataInterval.count() >= 0)
+        {
+            mLogBadData = true;
+        }
+        else
+        {
+            mLogBadData = false;
+        }
+    }
+    /// Updates the stream's run and determines its length.  A run is only
+    /// carried over from the previous packet when this packet starts where
+    /// the previous packet ended; a gap or out-of-order packet resets it.
+    int64_t updateRun(const std::string &name,
+                      const WaveformStatistics &statistics,
+                      const std::chrono::microseconds &startTime,
+                      const std::chrono::microseconds &samplingPeriod)
+    {
+        int64_t longestRun = statistics.longestRun;
+        auto nextStartTime = startTime + statistics.nSamples*samplingPeriod;
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        auto [streamIndex, inserted] = mStreams.try_emplace(name);
+        auto &stream = streamIndex->second;
+        auto contiguous
+            = !inserted &&
+              std::chrono::abs(startTime - stream.nextStartTime)
+                  <= samplingPeriod/2;
+        stream.nextStartTime = nextStartTime;
+        if (contiguous && stream.last == statistics.first)
+        {
+            // The run continues from the previous packet
+            longestRun = std::max(longestRun,
+                                  stream.trailingRun + statistics.leadingRun);
+            if (statistics.leadingRun == statistics.nSamples)
+            {
+                stream.trailingRun = stream.trailingRun + statistics.nSamples;
+                return longestRun;
+            }
+        }
+        stream.last = statistics.last;
+        stream.trailingRun = statistics.trailingRun;
+        return longestRun;
+    }
+    /// Logs the bad events
+    void logBadData(const bool allow,
+                    const std::string &name,
+                    const std::chrono::microseconds &nowMuSec)
+    {
+        if (!mLogBadData){return;}
+        auto nowSeconds
+            = std::chrono::duration_cast<std::chrono::seconds> (nowMuSec);
+        {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        try
+        {
+            if (!allow && !mFlatLinedChannels.contains(name))
+            {
+                mFlatLinedChannels.insert(name);
+            }
+        }
+        catch (...)
+        {
+            spdlog::warn("Failed to add " + name + " to set");
+        }
+        if (nowSeconds >= mLastLogTime + mLogBadDataInterval)
+        {
+            if (!mFlatLinedChannels.empty())
+            {
+                std::string message{"Flat-lined data detected for: "};
+                for (const auto &channel : mFlatLinedChannels)
+                {
+                    message = message + " " + channel;
+                }
+                spdlog::info(message);
+                mFlatLinedChannels.clear();
+                mLastLogTime = nowSeconds;
+            }
+        }
+        }
+    }
+    TestFlatLinedDataPacketImpl& operator=(const TestFlatLinedDataPacketImpl &impl)
+    {
+        if (&impl == this){return *this;}
+        {
+        std::lock_guard<std::mutex> lockGuard(impl.mMutex);
+        mStreams = impl.mStreams;
+        mFlatLinedChannels = impl.mFlatLinedChannels;
+        mLastLogTime = impl.mLastLogTime;
+        }
+        mFlaggedPackets = impl.mFlaggedPackets.load();
+        mMaximumFlatLineDuration = impl.mMaximumFlatLineDuration;
+        mLogBadDataInterval = impl.mLogBadDataInterval;
+        mClock = impl.mClock;
+        mLogBadData = impl.mLogBadData;
+        return *this;
+    }
+//private:
+    mutable std::mutex mMutex;
+    std::shared_ptr<const US8::Utilities::IClock> mClock{
+        std::make_shared<US8::Utilities::WallClock> ()};
+    std::map<std::string, ::Stream> mStreams;
+    std::set<std::string> mFlatLinedChannels;
+    std::atomic<int64_t> mFlaggedPackets{0};
+    std::chrono::milliseconds mMaximumFlatLineDuration{60000};
+    std::chrono::seconds mLastLogTime{0};
+    std::chrono::seconds mLogBadDataInterval{3600};
+    bool mLogBadData{true};
+};
+
+/// Constructor
+TestFlatLinedDataPacket::TestFlatLinedDataPacket() :
+    pImpl(std::make_unique<TestFlatLinedDataPacketImpl>
+          (std::chrono::milliseconds {60000},
+           std::chrono::seconds {3600}))
+{
+}
+
+/// Constructor with options
+TestFlatLinedDataPacket::TestFlatLinedDataPacket(
+    const std::chrono::milliseconds &maximumFlatLineDuration,
+    const std::chrono::seconds &logBadDataInterval) :
+    pImpl(std::make_unique<TestFlatLinedDataPacketImpl>
+          (maximumFlatLineDuration, logBadDataInterval))
+{
+}
+
+/// Copy constructor
+TestFlatLinedDataPacket::TestFlatLinedDataPacket(
+    const TestFlatLinedDataPacket &testFlatLinedDataPacket)
+{
+    *this = testFlatLinedDataPacket;
+}
+
+/// Move constructor
+TestFlatLinedDataPacket::TestFlatLinedDataPacket(
+    TestFlatLinedDataPacket &&testFlatLinedDataPacket) noexcept
+{
+    *this = std::move(testFlatLinedDataPacket);
+}
+
+/// Copy assignment
+TestFlatLinedDataPacket&
+TestFlatLinedDataPacket::operator=(
+    const TestFlatLinedDataPacket &testFlatLinedDataPacket)
+{
+    if (&testFlatLinedDataPacket == this){return *this;}
+    pImpl = std::make_unique<TestFlatLinedDataPacketImpl>
+            (*testFlatLinedDataPacket.pImpl);
+    return *this;
+}
+
+/// Move assignment
+TestFlatLinedDataPacket&
+TestFlatLinedDataPacket::operator=(
+    TestFlatLinedDataPacket &&testFlatLinedDataPacket) noexcept
+{
+    if (&testFlatLinedDataPacket == this){return *this;}
+    pImpl = std::move(testFlatLinedDataPacket.pImpl);
+    return *this;
+}
+
+/// Destructor
+TestFlatLinedDataPacket::~TestFlatLinedDataPacket() = default;
+
+/// Does the work
+bool TestFlatLinedDataPacket::allow(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet) const
+{
+    return allow(packet, computeWaveformStatistics(packet)); // Throws
+}
+
+/// Does the work with precomputed statistics
+bool TestFlatLinedDataPacket::allow(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet,
+    const WaveformStatistics &statistics) const
+{
+    auto name = ::toName(packet); // Throws
+    auto samplingRate = packet.getSamplingRate(); // Throws
+    // A run of n samples lasts (n - 1) sampling periods
+    auto maximumRun
+        = std::max(static_cast<int64_t> (2),
+                   static_cast<int64_t>
+                   (std::ceil(pImpl->mMaximumFlatLineDuration.count()
+                             *1.e-3*samplingRate)) + 1);
+    std::chrono::microseconds samplingPeriod
+    {
+        static_cast<int64_t> (std::round(1.e6/samplingRate))
+    };
+    auto longestRun = pImpl->updateRun(name, statistics,
+                                       packet.getStartTime(), samplingPeriod);
+    bool allow = (longestRun < maximumRun) ? true : false;
+    if (!allow){pImpl->mFlaggedPackets.fetch_add(1);}
+    // (Safely) handle logging
+    try
+    {
+        auto nowMuSeconds = pImpl->mClock->now();
+        pImpl->logBadData(allow, name, nowMuSeconds);
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::warn("Error detect in logBadData: "
+                   + std::string {e.what()});
+    }
+    return allow;
+}
+
+/// Number of flagged packets
+int64_t TestFlatLinedDataPacket::getNumberOfFlaggedPackets() const noexcept
+{
+    return pImpl->mFlaggedPackets.load();
+}
+
+/// Clock
+void TestFlatLinedDataPacket::setClock(
+    std::shared_ptr<const US8::Utilities::IClock> clock)
+{
+    if (clock == nullptr){throw std::invalid_argument("Clock is null");}
+    pImpl->mClock = std::move(clock);
+}
@@ -0,0 +1,84 @@
+#ifndef US8_BROADCASTS_SANITIZER_TEST_FLAT_LINED_DATA_PACKET_HPP
+#define US8_BROADCASTS_SANITIZER_TEST_FLAT_LINED_DATA_PACKET_HPP
+#include <chrono>
+#include <string>
+#include <memory>
+#include <cstdint>
+namespace US8::MessageFormats::Broadcasts
+{
+class DataPacket;
+}
+namespace US8::Utilities
+{
+class IClock;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+struct WaveformStatistics;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+/// @brief Tests whether or not a packet is flat-lined, i.e., its samples
+///        repeat the same value for longer than a sensor reasonably should.
+///        This typically indicates a dead channel or a stuck digitizer.
+///        A stream's trailing run is carried over to its next packet so runs
+///        spanning many short packets are detected.  The run is only carried
+///        over when the next packet starts where the previous one ended;
+///        a gap or an out-of-order packet starts a new run.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class TestFlatLinedDataPacket
+{
+public:
+    /// @brief Constructs a flat-line checker with a default maximum
+    ///        flat-line duration of 60 seconds.  Flat-lined sensors will be
+    ///        logged every hour.
+    TestFlatLinedDataPacket();
+    /// @param[in] maximumFlatLineDuration  If a run of identical samples
+    ///                                     lasts at least this long then the
+    ///                                     packet is flagged.
+    /// @param[in] logBadDataInterval  If this is positive then this will
+    ///                                log flagged channels at approximately
+    ///                                this interval.
+    /// @throws std::invalid_argument if maximumFlatLineDuration is not
+    ///         positive.
+    TestFlatLinedDataPacket(const std::chrono::milliseconds &maximumFlatLineDuration,
+                            const std::chrono::seconds &logBadDataInterval);
+    /// @brief Copy constructor.
+    TestFlatLinedDataPacket(const TestFlatLinedDataPacket &testFlatLinedDataPacket);
+    /// @brief Move constructor.
+    TestFlatLinedDataPacket(TestFlatLinedDataPacket &&testFlatLinedDataPacket) noexcept;
+
+    /// @result True indicates the data packet does not appear to be flat-lined.
+    /// @throws std::invalid_argument if the packet lacks a name, sampling
+    ///         rate, or samples.
+    [[nodiscard]] bool allow(const US8::MessageFormats::Broadcasts::DataPacket &packet) const;
+    /// @param[in] statistics  The statistics of the packet's samples.  This
+    ///                        allows several testers to share one pass over
+    ///                        the samples.
+    /// @result True indicates the data packet does not appear to be flat-lined.
+    /// @throws std::invalid_argument if the packet lacks a name or
+    ///         sampling rate.
+    [[nodiscard]] bool allow(const US8::MessageFormats::Broadcasts::DataPacket &packet,
+                             const WaveformStatistics &statistics) const;
+    /// @result The number of packets that have been flagged.
+    [[nodiscard]] int64_t getNumberOfFlaggedPackets() const noexcept;
+
+    /// @brief Sets the clock from which the current time is read.  By
+    ///        default this is the wall clock.
+    /// @param[in] clock  The clock - e.g., a simulated clock for replaying
+    ///                   archived data.
+    /// @throws std::invalid_argument if clock is null.
+    void setClock(std::shared_ptr<const US8::Utilities::IClock> clock);
+
+    /// @brief Destructor.
+    ~TestFlatLinedDataPacket();
+    /// @brief Copy assignment.
+    TestFlatLinedDataPacket& operator=(const TestFlatLinedDataPacket &testFlatLinedDataPacket);
+    /// @brief Move assignment.
+    TestFlatLinedDataPacket& operator=(TestFlatLinedDataPacket &&testFlatLinedDataPacket) noexcept;
+private:
+    class TestFlatLinedDataPacketImpl;
+    std::unique_ptr<TestFlatLinedDataPacketImpl> pImpl;
+};
+}
+#endif
@@ -7,6 +7,7 @@
 //#include "us8/broadcasts/dataPacket/sanitizer/testFutureDataPacket.hpp"
 #include "testFutureDataPacket.hpp"
 #include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/utilities/clock.hpp"
 #include "toName.hpp"
 
 using namespace US8::Broadcasts::DataPacket::Sanitizer;
@@ -94,11 +95,14 @@ public:
         }
         mMaxFutureTime = impl.mMaxFutureTime;
         mLogBadDataInterval = impl.mLogBadDataInterval;
+        mClock = impl.mClock;
         mLogBadData = impl.mLogBadData;
         return *this;
     }
 //private:
     mutable std::mutex mMutex;
+    std::shared_ptr<const US8::Utilities::IClock> mClock{
+        std::make_shared<US8::Utilities::WallClock> ()};
     std::set<std::string> mFutureChannels;
     std::chrono::microseconds mMaxFutureTime{0};
     std::chrono::seconds mLastLogTime{0};
@@ -167,10 +171,7 @@ bool TestFutureDataPacket::allow(
     // conservative.  Basically, when the max future time is zero,
     // this allows for a zero-latency, 1 sample packet, to be
     // successfully passed through.
-    auto now = std::chrono::high_resolution_clock::now();
-    auto nowMuSeconds
-        = std::chrono::time_point_cast<std::chrono::microseconds>
-          (now).time_since_epoch();
+    auto nowMuSeconds = pImpl->mClock->now();
     auto latestTime  = nowMuSeconds + pImpl->mMaxFutureTime;
     // Packet contains data after max allowable time?
     bool allow = (packetEndTime <= latestTime) ? true : false;
@@ -186,3 +187,11 @@ bool TestFutureDataPacket::allow(
     }
     return allow;
 }
+
+/// Clock
+void TestFutureDataPacket::setClock(
+    std::shared_ptr<const US8::Utilities::IClock> clock)
+{
+    if (clock == nullptr){throw std::invalid_argument("Clock is null");}
+    pImpl->mClock = std::move(clock);
+}
@@ -7,6 +7,10 @@ namespace US8::MessageFormats::Broadcasts
 {
 class DataPacket;
 }
+namespace US8::Utilities
+{
+class IClock;
+}
 namespace US8::Broadcasts::DataPacket::Sanitizer
 {
 /// @brief Tests whether or not a packet contains data from the future.  This
@@ -38,6 +42,13 @@ public:
     /// @result True indicates the data packet does not appear to have any future data.
     [[nodiscard]] bool operator()(const US8::MessageFormats::Broadcasts::DataPacket &packet) const;
 
+    /// @brief Sets the clock from which the current time is read.  By
+    ///        default this is the wall clock.
+    /// @param[in] clock  The clock - e.g., a simulated clock for replaying
+    ///                   archived data.
+    /// @throws std::invalid_argument if clock is null.
+    void setClock(std::shared_ptr<const US8::Utilities::IClock> clock);
+
     /// @brief Destructor.
     ~TestFutureDataPacket();
     /// @brief Copy assignment.
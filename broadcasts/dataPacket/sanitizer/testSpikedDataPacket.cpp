@@ -0,0 +1,281 @@
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <map>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <spdlog/spdlog.h>
+#include "testSpikedDataPacket.hpp"
+#include "waveformStatistics.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/utilities/clock.hpp"
+#include "toName.hpp"
+
+using namespace US8::Broadcasts::DataPacket::Sanitizer;
+
+namespace
+{
+
+// A stream's first packets only establish its noise floor
+constexpr int64_t WARM_UP_PACKETS{5};
+// Weight of the latest packet in the running standard deviation
+constexpr double RUNNING_WEIGHT{0.1};
+
+struct Stream
+{
+    // Exponentially weighted standard deviation of the unflagged packets
+    double standardDeviation{0};
+    // The number of unflagged packets
+    int64_t nPackets{0};
+};
+
+/// The most extreme sample's distance from the other samples and the
+/// standard deviation of the other samples
+struct Excursion
+{
+    double deviation{0};
+    double standardDeviation{0};
+};
+
+/// Removes the most extreme sample from the packet's sums.  This only needs
+/// the summary so it costs nothing per sample.
+[[nodiscard]] ::Excursion computeExcursion(const WaveformStatistics &statistics)
+{
+    auto n = static_cast<double> (statistics.nSamples);
+    auto extreme = (statistics.maximum - statistics.mean >=
+                    statistics.mean - statistics.minimum) ?
+                   statistics.maximum : statistics.minimum;
+    auto sum = statistics.mean*n - extreme;
+    auto sumSquared = statistics.rms*statistics.rms*n - extreme*extreme;
+    auto mean = sum/(n - 1);
+    // Round-off can make a tiny variance negative
+    auto variance = std::max(0.0, sumSquared/(n - 1) - mean*mean);
+    return ::Excursion {std::abs(extreme - mean), std::sqrt(variance)};
+}
+
+}
+
+class TestSpikedDataPacket::TestSpikedDataPacketImpl
+{
+public:
+    TestSpikedDataPacketImpl(const TestSpikedDataPacketImpl &impl)
+    {
+        *this = impl;
+    }
+    TestSpikedDataPacketImpl(const double spikeThreshold,
+                             const std::chrono::seconds &logBadDataInterval) :
+        mSpikeThreshold(spikeThreshold),
+        mLogBadDataInterval(logBadDataInterval)
+    {
+        if (mSpikeThreshold <= 0)
+        {
+            throw std::invalid_argument("Spike threshold must be positive");
+        }
+        if (mLogBadDataInterval.count() >= 0)
+        {
+            mLogBadData = true;
+        }
+        else
+        {
+            mLogBadData = false;
+        }
+    }
+    /// Compares the excursion with the stream's noise floor and, if the
+    /// packet is not flagged, updates the stream's running statistics
+    bool update(const std::string &name, const ::Excursion &excursion)
+    {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        auto &stream = mStreams[name];
+        auto scale = std::max(excursion.standardDeviation,
+                              stream.standardDeviation);
+        // A constant signal has no scale; that is the flat-line test's job
+        if (stream.nPackets >= ::WARM_UP_PACKETS &&
+            scale > 0 &&
+            excursion.deviation >= mSpikeThreshold*scale)
+        {
+            return false;
+        }
+        if (stream.nPackets == 0)
+        {
+            stream.standardDeviation = excursion.standardDeviation;
+        }
+        else
+        {
+            stream.standardDeviation = stream.standardDeviation
+               + ::RUNNING_WEIGHT*(excursion.standardDeviation
+                                 - stream.standardDeviation);
+        }
+        stream.nPackets = stream.nPackets + 1;
+        return true;
+    }
+    /// Logs the bad events
+    void logBadData(const bool allow,
+                    const std::string &name,
+                    const std::chrono::microseconds &nowMuSec)
+    {
+        if (!mLogBadData){return;}
+        auto nowSeconds
+            = std::chrono::duration_cast<std::chrono::seconds> (nowMuSec);
+        {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        try
+        {
+            if (!allow && !mSpikedChannels.contains(name))
+            {
+                mSpikedChannels.insert(name);
+            }
+        }
+        catch (...)
+        {
+            spdlog::warn("Failed to add " + name + " to set");
+        }
+        if (nowSeconds >= mLastLogTime + mLogBadDataInterval)
+        {
+            if (!mSpikedChannels.empty())
+            {
+                std::string message{"Spikes detected for: "};
+                for (const auto &channel : mSpikedChannels)
+                {
+                    message = message + " " + channel;
+                }
+                spdlog::info(message);
+                mSpikedChannels.clear();
+                mLastLogTime = nowSeconds;
+            }
+        }
+        }
+    }
+    TestSpikedDataPacketImpl& operator=(const TestSpikedDataPacketImpl &impl)
+    {
+        if (&impl == this){return *this;}
+        {
+        std::lock_guard<std::mutex> lockGuard(impl.mMutex);
+        mStreams = impl.mStreams;
+        mSpikedChannels = impl.mSpikedChannels;
+        mLastLogTime = impl.mLastLogTime;
+        }
+        mFlaggedPackets = impl.mFlaggedPackets.load();
+        mSpikeThreshold = impl.mSpikeThreshold;
+        mLogBadDataInterval = impl.mLogBadDataInterval;
+        mClock = impl.mClock;
+        mLogBadData = impl.mLogBadData;
+        return *this;
+    }
+//private:
+    mutable std::mutex mMutex;
+    std::shared_ptr<const US8::Utilities::IClock> mClock{
+        std::make_shared<US8::Utilities::WallClock> ()};
+    std::map<std::string, ::Stream> mStreams;
+    std::set<std::string> mSpikedChannels;
+    std::atomic<int64_t> mFlaggedPackets{0};
+    double mSpikeThreshold{50};
+    std::chrono::seconds mLastLogTime{0};
+    std::chrono::seconds mLogBadDataInterval{3600};
+    bool mLogBadData{true};
+};
+
+/// Constructor
+TestSpikedDataPacket::TestSpikedDataPacket() :
+    pImpl(std::make_unique<TestSpikedDataPacketImpl>
+          (50, std::chrono::seconds {3600}))
+{
+}
+
+/// Constructor with options
+TestSpikedDataPacket::TestSpikedDataPacket(
+    const double spikeThreshold,
+    const std::chrono::seconds &logBadDataInterval) :
+    pImpl(std::make_unique<TestSpikedDataPacketImpl> (spikeThreshold,
+                                                      logBadDataInterval))
+{
+}
+
+/// Copy constructor
+TestSpikedDataPacket::TestSpikedDataPacket(
+    const TestSpikedDataPacket &testSpikedDataPacket)
+{
+    *this = testSpikedDataPacket;
+}
+
+/// Move constructor
+TestSpikedDataPacket::TestSpikedDataPacket(
+    TestSpikedDataPacket &&testSpikedDataPacket) noexcept
+{
+    *this = std::move(testSpikedDataPacket);
+}
+
+/// Copy assignment
+TestSpikedDataPacket&
+TestSpikedDataPacket::operator=(const TestSpikedDataPacket &testSpikedDataPacket)
+{
+    if (&testSpikedDataPacket == this){return *this;}
+    pImpl = std::make_unique<TestSpikedDataPacketImpl>
+            (*testSpikedDataPacket.pImpl);
+    return *this;
+}
+
+/// Move assignment
+TestSpikedDataPacket&
+TestSpikedDataPacket::operator=(TestSpikedDataPacket &&testSpikedDataPacket) noexcept
+{
+    if (&testSpikedDataPacket == this){return *this;}
+    pImpl = std::move(testSpikedDataPacket.pImpl);
+    return *this;
+}
+
+/// Destructor
+TestSpikedDataPacket::~TestSpikedDataPacket() = default;
+
+/// Does the work
+bool TestSpikedDataPacket::allow(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet) const
+{
+    return allow(packet, computeWaveformStatistics(packet)); // Throws
+}
+
+/// Does the work with precomputed statistics
+bool TestSpikedDataPacket::allow(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet,
+    const WaveformStatistics &statistics) const
+{
+    auto name = ::toName(packet); // Throws
+    // Too few samples to tell a spike from the signal
+    if (statistics.nSamples < 3){return true;}
+    bool allow = pImpl->update(name, ::computeExcursion(statistics));
+    if (!allow){pImpl->mFlaggedPackets.fetch_add(1);}
+    // (Safely) handle logging
+    try
+    {
+        auto nowMuSeconds = pImpl->mClock->now();
+        pImpl->logBadData(allow, name, nowMuSeconds);
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::warn("Error detect in logBadData: "
+                   + std::string {e.what()});
+    }
+    return allow;
+}
+
+/// Number of flagged packets
+int64_t TestSpikedDataPacket::getNumberOfFlaggedPackets() const noexcept
+{
+    return pImpl->mFlaggedPackets.load();
+}
+
+/// Number of streams
+int TestSpikedDataPacket::getNumberOfStreams() const noexcept
+{
+    std::lock_guard<std::mutex> lockGuard(pImpl->mMutex);
+    return static_cast<int> (pImpl->mStreams.size());
+}
+
+/// Clock
+void TestSpikedDataPacket::setClock(
+    std::shared_ptr<const US8::Utilities::IClock> clock)
+{
+    if (clock == nullptr){throw std::invalid_argument("Clock is null");}
+    pImpl->mClock = std::move(clock);
+}
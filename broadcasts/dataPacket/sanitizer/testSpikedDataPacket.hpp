@@ -0,0 +1,87 @@
+#ifndef US8_BROADCASTS_SANITIZER_TEST_SPIKED_DATA_PACKET_HPP
+#define US8_BROADCASTS_SANITIZER_TEST_SPIKED_DATA_PACKET_HPP
+#include <chrono>
+#include <string>
+#include <memory>
+#include <cstdint>
+namespace US8::MessageFormats::Broadcasts
+{
+class DataPacket;
+}
+namespace US8::Utilities
+{
+class IClock;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+struct WaveformStatistics;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+/// @brief Tests whether or not a packet contains a spike, i.e., a single
+///        sample far from its neighbors.  Such glitches are typically
+///        telemetry or digitizer errors.
+///
+///        The packet's most extreme sample is compared with the mean and
+///        standard deviation of the remaining samples.  Since an earthquake
+///        raises the standard deviation of many samples it is not mistaken
+///        for a spike.  Each stream also keeps a running standard deviation
+///        of its unflagged packets which serves as the noise floor, so a
+///        nearly constant packet with a small step is not flagged.  A
+///        stream's first few packets only update its running statistics.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class TestSpikedDataPacket
+{
+public:
+    /// @brief Constructs a spike checker that flags samples 50 standard
+    ///        deviations from the others.  Spiked channels will be logged
+    ///        every hour.
+    TestSpikedDataPacket();
+    /// @param[in] spikeThreshold  If the most extreme sample is at least this
+    ///                            many standard deviations from the others
+    ///                            then the packet is flagged.
+    /// @param[in] logBadDataInterval  If this is positive then this will
+    ///                                log flagged channels at approximately
+    ///                                this interval.
+    /// @throws std::invalid_argument if spikeThreshold is not positive.
+    TestSpikedDataPacket(double spikeThreshold,
+                         const std::chrono::seconds &logBadDataInterval);
+    /// @brief Copy constructor.
+    TestSpikedDataPacket(const TestSpikedDataPacket &testSpikedDataPacket);
+    /// @brief Move constructor.
+    TestSpikedDataPacket(TestSpikedDataPacket &&testSpikedDataPacket) noexcept;
+
+    /// @result True indicates the data packet does not appear to have a spike.
+    /// @throws std::invalid_argument if the packet lacks a name or samples.
+    [[nodiscard]] bool allow(const US8::MessageFormats::Broadcasts::DataPacket &packet) const;
+    /// @param[in] statistics  The statistics of the packet's samples.  This
+    ///                        allows several testers to share one pass over
+    ///                        the samples.
+    /// @result True indicates the data packet does not appear to have a spike.
+    /// @throws std::invalid_argument if the packet lacks a name.
+    [[nodiscard]] bool allow(const US8::MessageFormats::Broadcasts::DataPacket &packet,
+                             const WaveformStatistics &statistics) const;
+    /// @result The number of packets that have been flagged.
+    [[nodiscard]] int64_t getNumberOfFlaggedPackets() const noexcept;
+    /// @result The number of streams with running statistics.
+    [[nodiscard]] int getNumberOfStreams() const noexcept;
+
+    /// @brief Sets the clock from which the current time is read.  By
+    ///        default this is the wall clock.
+    /// @param[in] clock  The clock - e.g., a simulated clock for replaying
+    ///                   archived data.
+    /// @throws std::invalid_argument if clock is null.
+    void setClock(std::shared_ptr<const US8::Utilities::IClock> clock);
+
+    /// @brief Destructor.
+    ~TestSpikedDataPacket();
+    /// @brief Copy assignment.
+    TestSpikedDataPacket& operator=(const TestSpikedDataPacket &testSpikedDataPacket);
+    /// @brief Move assignment.
+    TestSpikedDataPacket& operator=(TestSpikedDataPacket &&testSpikedDataPacket) noexcept;
+private:
+    class TestSpikedDataPacketImpl;
+    std::unique_ptr<TestSpikedDataPacketImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,168 @@
+#include <string>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "watermarkTracker.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/messageFormats/broadcasts/streamWatermarks.hpp"
+#include "toName.hpp"
+
+using namespace US8::Broadcasts::DataPacket::Sanitizer;
+
+namespace
+{
+
+/// Limits the memory used by a stream with many gaps
+constexpr size_t MAXIMUM_PENDING_SEGMENTS{1024};
+
+struct Stream
+{
+    // Data after the gap keyed on start time.  The value is the end time.
+    std::map<std::chrono::microseconds, std::chrono::microseconds> pending;
+    // When the current gap was first seen
+    std::chrono::microseconds gapDetected{0};
+    // Time of the last sample in the contiguous data
+    std::chrono::microseconds completeThrough{0};
+    std::chrono::microseconds samplingPeriod{0};
+    bool advanced{false};
+};
+
+}
+
+class WatermarkTracker::WatermarkTrackerImpl
+{
+public:
+    /// @result True if data starting at this time continues the stream
+    [[nodiscard]] static bool continues(const ::Stream &stream,
+                                        const std::chrono::microseconds &startTime)
+    {
+        return startTime <= stream.completeThrough
+                          + stream.samplingPeriod
+                          + stream.samplingPeriod/2;
+    }
+    /// Advances the watermark over the pending data that is now contiguous.
+    /// Data that only narrows the leading gap does not restart its clock.
+    static void absorb(::Stream &stream,
+                       const std::chrono::microseconds &now)
+    {
+        bool closedGap{false};
+        while (!stream.pending.empty() &&
+               continues(stream, stream.pending.begin()->first))
+        {
+            stream.completeThrough
+                = std::max(stream.completeThrough,
+                           stream.pending.begin()->second);
+            stream.pending.erase(stream.pending.begin());
+            closedGap = true;
+        }
+        // The clock restarts for the next gap
+        if (closedGap && !stream.pending.empty()){stream.gapDetected = now;}
+    }
+    /// Advances the watermark over the stream's first gap
+    static void abandonGap(::Stream &stream,
+                           const std::chrono::microseconds &now)
+    {
+        if (stream.pending.empty()){return;}
+        stream.completeThrough
+            = std::max(stream.completeThrough,
+                       stream.pending.begin()->second);
+        stream.pending.erase(stream.pending.begin());
+        stream.advanced = true;
+        stream.gapDetected = now;
+        absorb(stream, now);
+    }
+    std::map<std::string, ::Stream> mStreams;
+    std::chrono::milliseconds mMaximumGapLatency{0};
+};
+
+/// Constructor
+WatermarkTracker::WatermarkTracker(
+    const std::chrono::milliseconds &maximumGapLatency) :
+    pImpl(std::make_unique<WatermarkTrackerImpl> ())
+{
+    if (maximumGapLatency.count() < 0)
+    {
+        throw std::invalid_argument("Maximum gap latency cannot be negative");
+    }
+    pImpl->mMaximumGapLatency = maximumGapLatency;
+}
+
+/// Destructor
+WatermarkTracker::~WatermarkTracker() = default;
+
+/// Update
+void WatermarkTracker::update(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet,
+    const std::chrono::microseconds &now)
+{
+    if (packet.getNumberOfSamples() < 1)
+    {
+        throw std::invalid_argument("No samples in packet");
+    }
+    auto name = ::toName(packet);
+    auto startTime = packet.getStartTime();
+    auto endTime = packet.getEndTime(); // Throws
+    std::chrono::microseconds samplingPeriod
+    {
+        static_cast<int64_t> (std::round(1.e6/packet.getSamplingRate()))
+    };
+    auto streamIndex = pImpl->mStreams.find(name);
+    if (streamIndex == pImpl->mStreams.end())
+    {
+        ::Stream stream;
+        stream.completeThrough = endTime;
+        stream.samplingPeriod = samplingPeriod;
+        stream.advanced = true;
+        pImpl->mStreams.insert(std::pair {name, std::move(stream)});
+        return;
+    }
+    auto &stream = streamIndex->second;
+    stream.samplingPeriod = samplingPeriod;
+    // Already covered
+    if (endTime <= stream.completeThrough){return;}
+    if (WatermarkTrackerImpl::continues(stream, startTime))
+    {
+        stream.completeThrough = endTime;
+        stream.advanced = true;
+        WatermarkTrackerImpl::absorb(stream, now);
+        return;
+    }
+    // There is a gap
+    if (stream.pending.empty()){stream.gapDetected = now;}
+    auto [it, inserted] = stream.pending.try_emplace(startTime, endTime);
+    if (!inserted){it->second = std::max(it->second, endTime);}
+    if (stream.pending.size() > MAXIMUM_PENDING_SEGMENTS)
+    {
+        WatermarkTrackerImpl::abandonGap(stream, now);
+    }
+}
+
+/// Advanced watermarks
+US8::MessageFormats::Broadcasts::StreamWatermarks
+WatermarkTracker::getAdvancedWatermarks(
+    const std::chrono::microseconds &now)
+{
+    US8::MessageFormats::Broadcasts::StreamWatermarks watermarks;
+    for (auto &[name, stream] : pImpl->mStreams)
+    {
+        // Abandoning a gap restarts the clock for the next gap
+        while (!stream.pending.empty() &&
+               now - stream.gapDetected >= pImpl->mMaximumGapLatency)
+        {
+            WatermarkTrackerImpl::abandonGap(stream, now);
+        }
+        if (stream.advanced)
+        {
+            watermarks.addWatermark(name, stream.completeThrough);
+            stream.advanced = false;
+        }
+    }
+    return watermarks;
+}
+
+/// Number of streams
+int WatermarkTracker::getNumberOfStreams() const noexcept
+{
+    return static_cast<int> (pImpl->mStreams.size());
+}
@@ -0,0 +1,64 @@
+#ifndef US8_BROADCASTS_SANITIZER_WATERMARK_TRACKER_HPP
+#define US8_BROADCASTS_SANITIZER_WATERMARK_TRACKER_HPP
+#include <chrono>
+#include <memory>
+namespace US8::MessageFormats::Broadcasts
+{
+class DataPacket;
+class StreamWatermarks;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+/// @brief Tracks, for each stream, the time through which the stream's
+///        published data is contiguous.  Packets that follow a gap are
+///        remembered and, once the gap is filled, the watermark advances
+///        past them.  A gap that is not filled within the maximum gap
+///        latency is presumed lost and the watermark advances over it so
+///        that a dead telemetry link cannot stall a stream indefinitely.
+///        A gap's latency is measured from when it became the stream's
+///        leading gap; data that narrows the gap without closing it does
+///        not restart the clock.  A stream remembers at most 1024 segments
+///        after its gaps; beyond that its leading gap is abandoned.
+/// @note This is not thread-safe.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class WatermarkTracker
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] maximumGapLatency  The time to wait for a gap to be filled.
+    /// @throws std::invalid_argument if maximumGapLatency is negative.
+    explicit WatermarkTracker(const std::chrono::milliseconds &maximumGapLatency);
+
+    /// @brief Updates the packet's stream with a published packet.
+    /// @param[in] packet  The published packet.
+    /// @param[in] now     The current UTC time in microseconds from the
+    ///                    epoch.
+    /// @throws std::invalid_argument if the packet lacks a name, sampling
+    ///         rate, or samples.
+    void update(const US8::MessageFormats::Broadcasts::DataPacket &packet,
+                const std::chrono::microseconds &now);
+    /// @brief Abandons the expired gaps then collects the watermarks that
+    ///        have advanced since the last call.
+    /// @param[in] now  The current UTC time in microseconds from the epoch.
+    /// @result The advanced watermarks.  This is empty if no watermark
+    ///         advanced.
+    [[nodiscard]] US8::MessageFormats::Broadcasts::StreamWatermarks
+        getAdvancedWatermarks(const std::chrono::microseconds &now);
+
+    /// @result The number of tracked streams.
+    [[nodiscard]] int getNumberOfStreams() const noexcept;
+
+    /// @brief Destructor.
+    ~WatermarkTracker();
+
+    WatermarkTracker() = delete;
+    WatermarkTracker(const WatermarkTracker &) = delete;
+    WatermarkTracker(WatermarkTracker &&) noexcept = delete;
+    WatermarkTracker& operator=(const WatermarkTracker &) = delete;
+    WatermarkTracker& operator=(WatermarkTracker &&) noexcept = delete;
+private:
+    class WatermarkTrackerImpl;
+    std::unique_ptr<WatermarkTrackerImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "waveformStatistics.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+
+using namespace US8::Broadcasts::DataPacket::Sanitizer;
+
+// The statistics are accumulated in a single pass.  The vectorized loops
+// compare each block of four samples with the same block shifted back by one
+// sample; the resulting equality masks drive the run-length bookkeeping so
+// that runs are only examined sample-by-sample where they start or end.
+
+namespace
+{
+
+/// Tracks the longest run of equal, consecutive sample pairs
+struct RunTracker
+{
+    void update(const bool equal) noexcept
+    {
+        if (equal)
+        {
+            current = current + 1;
+        }
+        else
+        {
+            longest = std::max(longest, current);
+            current = 0;
+        }
+    }
+    /// Consumes a mask of width comparisons; bit j is set if sample j
+    /// equals its predecessor
+    void update(const int mask, const int width) noexcept
+    {
+        const int all = (1 << width) - 1;
+        if (mask == all)
+        {
+            current = current + width;
+        }
+        else if (mask == 0)
+        {
+            longest = std::max(longest, current);
+            current = 0;
+        }
+        else
+        {
+            for (int j = 0; j < width; ++j)
+            {
+                update(((mask >> j) & 1) == 1);
+            }
+        }
+    }
+    /// @result The number of samples in the longest run
+    [[nodiscard]] int getLongestRun() const noexcept
+    {
+        return std::max(longest, current) + 1;
+    }
+    int current{0};
+    int longest{0};
+};
+
+/// Accumulates the samples from i to n
+template<typename T>
+void accumulate(const T *x, int i, const int n,
+                double *minimum, double *maximum,
+                double *sum, double *sumSquared,
+                ::RunTracker *runs)
+{
+    for (; i < n; ++i)
+    {
+        auto value = static_cast<double> (x[i]);
+        *minimum = std::min(*minimum, value);
+        *maximum = std::max(*maximum, value);
+        *sum = *sum + value;
+        *sumSquared = *sumSquared + value*value;
+        runs->update(x[i] == x[i - 1]);
+    }
+}
+
+#if defined(__SSE2__)
+/// Accumulates the samples four at a time.  On exit, i is the first sample
+/// that was not processed.
+void accumulate(const int32_t *x, int *i, const int n,
+                double *minimum, double *maximum,
+                double *sum, double *sumSquared,
+                ::RunTracker *runs)
+{
+    if (*i + 4 > n){return;}
+    auto vMinimum = _mm_set1_epi32(x[0]);
+    auto vMaximum = vMinimum;
+    auto vSumLow = _mm_setzero_pd();
+    auto vSumHigh = _mm_setzero_pd();
+    auto vSumSquaredLow = _mm_setzero_pd();
+    auto vSumSquaredHigh = _mm_setzero_pd();
+    for (; *i + 4 <= n; *i = *i + 4)
+    {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *> (x + *i));
+        auto vPrevious
+            = _mm_loadu_si128(reinterpret_cast<const __m128i *> (x + *i - 1));
+        // SSE2 lacks a 32-bit integer min/max so select with the comparison
+        auto greater = _mm_cmpgt_epi32(v, vMaximum);
+        vMaximum = _mm_or_si128(_mm_and_si128(greater, v),
+                                _mm_andnot_si128(greater, vMaximum));
+        auto less = _mm_cmplt_epi32(v, vMinimum);
+        vMinimum = _mm_or_si128(_mm_and_si128(less, v),
+                                _mm_andnot_si128(less, vMinimum));
+        // Sums are accumulated in double precision to avoid overflow
+        auto low = _mm_cvtepi32_pd(v);
+        auto high = _mm_cvtepi32_pd(_mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        vSumLow = _mm_add_pd(vSumLow, low);
+        vSumHigh = _mm_add_pd(vSumHigh, high);
+        vSumSquaredLow = _mm_add_pd(vSumSquaredLow, _mm_mul_pd(low, low));
+        vSumSquaredHigh = _mm_add_pd(vSumSquaredHigh, _mm_mul_pd(high, high));
+        auto equal = _mm_cmpeq_epi32(v, vPrevious);
+        runs->update(_mm_movemask_ps(_mm_castsi128_ps(equal)), 4);
+    }
+    std::array<int32_t, 4> minima;
+    std::array<int32_t, 4> maxima;
+    _mm_storeu_si128(reinterpret_cast<__m128i *> (minima.data()), vMinimum);
+    _mm_storeu_si128(reinterpret_cast<__m128i *> (maxima.data()), vMaximum);
+    *minimum = std::min(*minimum, static_cast<double>
+                        (*std::min_element(minima.begin(), minima.end())));
+    *maximum = std::max(*maximum, static_cast<double>
+                        (*std::max_element(maxima.begin(), maxima.end())));
+    std::array<double, 2> sums;
+    _mm_storeu_pd(sums.data(), _mm_add_pd(vSumLow, vSumHigh));
+    *sum = *sum + sums[0] + sums[1];
+    _mm_storeu_pd(sums.data(), _mm_add_pd(vSumSquaredLow, vSumSquaredHigh));
+    *sumSquared = *sumSquared + sums[0] + sums[1];
+}
+
+/// Accumulates the samples four at a time.  On exit, i is the first sample
+/// that was not processed.
+void accumulate(const float *x, int *i, const int n,
+                double *minimum, double *maximum,
+                double *sum, double *sumSquared,
+                ::RunTracker *runs)
+{
+    if (*i + 4 > n){return;}
+    auto vMinimum = _mm_set1_ps(x[0]);
+    auto vMaximum = vMinimum;
+    auto vSumLow = _mm_setzero_pd();
+    auto vSumHigh = _mm_setzero_pd();
+    auto vSumSquaredLow = _mm_setzero_pd();
+    auto vSumSquaredHigh = _mm_setzero_pd();
+    for (; *i + 4 <= n; *i = *i + 4)
+    {
+        auto v = _mm_loadu_ps(x + *i);
+        auto vPrevious = _mm_loadu_ps(x + *i - 1);
+        vMinimum = _mm_min_ps(vMinimum, v);
+        vMaximum = _mm_max_ps(vMaximum, v);
+        auto low = _mm_cvtps_pd(v);
+        auto high = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+        vSumLow = _mm_add_pd(vSumLow, low);
+        vSumHigh = _mm_add_pd(vSumHigh, high);
+        vSumSquaredLow = _mm_add_pd(vSumSquaredLow, _mm_mul_pd(low, low));
+        vSumSquaredHigh = _mm_add_pd(vSumSquaredHigh, _mm_mul_pd(high, high));
+        runs->update(_mm_movemask_ps(_mm_cmpeq_ps(v, vPrevious)), 4);
+    }
+    std::array<float, 4> minima;
+    std::array<float, 4> maxima;
+    _mm_storeu_ps(minima.data(), vMinimum);
+    _mm_storeu_ps(maxima.data(), vMaximum);
+    *minimum = std::min(*minimum, static_cast<double>
+                        (*std::min_element(minima.begin(), minima.end())));
+    *maximum = std::max(*maximum, static_cast<double>
+                        (*std::max_element(maxima.begin(), maxima.end())));
+    std::array<double, 2> sums;
+    _mm_storeu_pd(sums.data(), _mm_add_pd(vSumLow, vSumHigh));
+    *sum = *sum + sums[0] + sums[1];
+    _mm_storeu_pd(sums.data(), _mm_add_pd(vSumSquaredLow, vSumSquaredHigh));
+    *sumSquared = *sumSquared + sums[0] + sums[1];
+}
+#endif
+
+/// Widths without a vectorized kernel fall through to the scalar loop
+template<typename T>
+void accumulate(const T *, int *, const int,
+                double *, double *, double *, double *, ::RunTracker *)
+{
+}
+
+template<typename T>
+[[nodiscard]] WaveformStatistics compute(const T *x, const int n)
+{
+    WaveformStatistics statistics;
+    statistics.nSamples = n;
+    statistics.first = static_cast<double> (x[0]);
+    statistics.last = static_cast<double> (x[n - 1]);
+    int leadingRun{1};
+    while (leadingRun < n && x[leadingRun] == x[0])
+    {
+        leadingRun = leadingRun + 1;
+    }
+    int trailingRun{1};
+    while (trailingRun < n && x[n - 1 - trailingRun] == x[n - 1])
+    {
+        trailingRun = trailingRun + 1;
+    }
+    statistics.leadingRun = leadingRun;
+    statistics.trailingRun = trailingRun;
+    double minimum = statistics.first;
+    double maximum = statistics.first;
+    double sum = statistics.first;
+    double sumSquared = statistics.first*statistics.first;
+    ::RunTracker runs;
+    // The first sample has no predecessor so start on the second
+    int i{1};
+    ::accumulate(x, &i, n, &minimum, &maximum, &sum, &sumSquared, &runs);
+    ::accumulate(x, i, n, &minimum, &maximum, &sum, &sumSquared, &runs);
+    statistics.minimum = minimum;
+    statistics.maximum = maximum;
+    statistics.mean = sum/n;
+    statistics.rms = std::sqrt(sumSquared/n);
+    statistics.longestRun = runs.getLongestRun();
+    return statistics;
+}
+
+}
+
+/// Statistics
+WaveformStatistics
+US8::Broadcasts::DataPacket::Sanitizer::computeWaveformStatistics(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet)
+{
+    using DataType = US8::MessageFormats::Broadcasts::DataPacket::DataType;
+    auto n = packet.getNumberOfSamples();
+    if (n < 1){throw std::invalid_argument("No samples in packet");}
+    auto data = packet.getDataPointer();
+    auto dataType = packet.getDataType();
+    if (dataType == DataType::Integer32)
+    {
+        return ::compute(static_cast<const int32_t *> (data), n);
+    }
+    else if (dataType == DataType::Float)
+    {
+        return ::compute(static_cast<const float *> (data), n);
+    }
+    else if (dataType == DataType::Integer64)
+    {
+        return ::compute(static_cast<const int64_t *> (data), n);
+    }
+    else if (dataType == DataType::Double)
+    {
+        return ::compute(static_cast<const double *> (data), n);
+    }
+    throw std::invalid_argument("Unhandled data type");
+}
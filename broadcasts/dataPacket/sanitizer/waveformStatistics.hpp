@@ -0,0 +1,40 @@
+#ifndef US8_BROADCASTS_SANITIZER_WAVEFORM_STATISTICS_HPP
+#define US8_BROADCASTS_SANITIZER_WAVEFORM_STATISTICS_HPP
+namespace US8::MessageFormats::Broadcasts
+{
+class DataPacket;
+}
+namespace US8::Broadcasts::DataPacket::Sanitizer
+{
+/// @brief Summarizes the samples in a packet.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+struct WaveformStatistics
+{
+    double minimum{0};  ///< The smallest sample.
+    double maximum{0};  ///< The largest sample.
+    double mean{0};     ///< The average sample.
+    double rms{0};      ///< The root-mean-square of the samples.
+    double first{0};    ///< The first sample.
+    double last{0};     ///< The last sample.
+    /// The number of samples in the longest run of identical, consecutive
+    /// samples.
+    int longestRun{0};
+    /// The number of samples at the start of the packet equal to the first
+    /// sample.
+    int leadingRun{0};
+    /// The number of samples at the end of the packet equal to the last
+    /// sample.
+    int trailingRun{0};
+    int nSamples{0};    ///< The number of samples.
+};
+
+/// @brief Computes the statistics of the packet's samples in a single pass.
+///        Integer32 and Float samples are processed four at a time with SSE2
+///        when it is available.
+/// @param[in] packet  The packet.
+/// @result The statistics of the packet's samples.
+/// @throws std::invalid_argument if the packet has no samples.
+[[nodiscard]] WaveformStatistics
+    computeWaveformStatistics(const US8::MessageFormats::Broadcasts::DataPacket &packet);
+}
+#endif
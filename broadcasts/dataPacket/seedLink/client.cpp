@@ -1,152 +1,350 @@
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <array>
 #include <cstring>
-#include <cmath>
+#include <cerrno>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <functional>
-#include <libslink.h>
-#include <libmseed.h>
+#include <map>
+#include <set>
+#include <chrono>
+#include <numeric>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <readerwriterqueue.h>
 #include <spdlog/spdlog.h>
 #include "client.hpp"
 #include "clientOptions.hpp"
+#include "connection.hpp"
 #include "streamSelector.hpp"
+#include "stateFileWriter.hpp"
+#include "broadcasts/dataPacket/miniSEED/unpacker.hpp"
 #include "us8/messageFormats/broadcasts/dataPacket.hpp"
 #include "us8/broadcasts/dataPacket/importClient.hpp"
 #include "us8/version.hpp"
+#include "us8/utilities/writeAtomically.hpp"
 
 using namespace US8::Broadcasts::DataPacket::SEEDLink;
 
 namespace
 {
-/// @brief Unpacks a miniSEED record.
-[[nodiscard]]
-std::vector<US8::MessageFormats::Broadcasts::DataPacket>
-    miniSEEDToDataPackets(char *msRecord, const int bufferSize)
-    //                     const int seedLinkRecordSize = 512)
+/// @brief The epoll user data for the wake-up eventfd.
+constexpr uint64_t WAKE_UP_EVENT{std::numeric_limits<uint64_t>::max()};
+
+/// @brief Low-rate channels pack many minutes into a record and a station's
+///        channels are interleaved, so a station has only finished its time
+///        window once it sends a record starting this long after the end.
+constexpr std::chrono::minutes END_TIME_GRACE_PERIOD{15};
+
+/// @brief A raw record copied off the SEEDLink connection.
+struct SEEDLinkRecord
+{
+    std::vector<char> payload;
+    /// Acknowledged once the record has been through the callback so the
+    /// state file never gets ahead of the delivered data.
+    Connection::Checkpoint checkpoint;
+    int connection{0};
+};
+
+/// @brief Hashes a station name.  This must not change between runs since
+///        it determines which state file partition holds a station.
+[[nodiscard]] uint32_t stationHash(const std::string &name)
+{
+    // FNV-1a
+    uint32_t hash{2166136261u};
+    for (const auto c : name)
+    {
+        hash = (hash ^ static_cast<uint8_t> (c))*16777619u;
+    }
+    return hash;
+}
+
+/// @result The state file of a connection when a server's stations are
+///        partitioned over nConnections connections.
+[[nodiscard]] std::filesystem::path
+    toStateFile(const std::string &stateFile,
+                const int nConnections, const int connection)
 {
-    std::vector<US8::MessageFormats::Broadcasts::DataPacket> dataPackets;
-    auto bufferLength = static_cast<uint64_t> (bufferSize);
-    uint64_t offset{0};
-    while (bufferLength - offset > MINRECLEN)
-    {
-        constexpr int8_t verbose{0};
-        constexpr uint32_t flags{MSF_UNPACKDATA};
-        US8::MessageFormats::Broadcasts::DataPacket dataPacket;
-        MS3Record *miniSEEDRecord{nullptr};
-        auto returnCode = msr3_parse(msRecord + offset,
-                                     static_cast<uint64_t> (bufferSize) - offset,
-                                     &miniSEEDRecord, flags,
-                                     verbose);
-        if (returnCode == MS_NOERROR && miniSEEDRecord)
-        {   
-            // SNCL
-            std::array<char, 64> networkWork;
-            std::array<char, 64> stationWork;
-            std::array<char, 64> channelWork;
-            std::array<char, 64> locationWork;
-            std::fill(networkWork.begin(),  networkWork.end(), '\0');
-            std::fill(stationWork.begin(),  stationWork.end(), '\0');
-            std::fill(channelWork.begin(),  channelWork.end(), '\0'); 
-            std::fill(locationWork.begin(), locationWork.end(), '\0');
-#ifdef USE_MS_VERSION_315
-            returnCode = ms_sid2nslc_n(miniSEEDRecord->sid,
-                                       networkWork.data(), networkWork.size(),
-                                       stationWork.data(), stationWork.size(),
-                                       locationWork.data(), locationWork.size(),
-                                       channelWork.data(), channelWork.size());
-#else
-            returnCode = ms_sid2nslc(miniSEEDRecord->sid,
-                                     networkWork.data(), stationWork.data(),
-                                     locationWork.data(), channelWork.data());
-#endif
-            std::string network{networkWork.data()};
-            std::string station{stationWork.data()};
-            std::string channel{channelWork.data()};
-            std::string location{locationWork.data()};
-            if (locationWork[0] == '\0'){location = "--";}
-            if (std::string {"  "} == location.substr(0, 2)){location = "--";}
-            if (returnCode == MS_NOERROR)
+    if (nConnections == 1){return stateFile;}
+    return stateFile + "." + std::to_string(connection);
+}
+
+/// @brief A station's partition is determined by the number of connections
+///        so changing that number would silently lose every station's resume
+///        point.  This re-partitions the lines of any state files left by a
+///        different number of connections.
+void migrateStateFiles(const std::string &stateFile, const int nConnections)
+{
+    const std::filesystem::path basePath{stateFile};
+    const auto baseName = basePath.filename().string();
+    auto directory = basePath.parent_path();
+    if (directory.empty()){directory = ".";}
+    std::map<std::filesystem::path, int> currentFiles;
+    for (int i = 0; i < nConnections; ++i)
+    {
+        currentFiles.insert({::toStateFile(stateFile, nConnections, i), i});
+    }
+    // The base file and the numbered files are the possible partitions.
+    // Keep the furthest resume point of each station.
+    std::vector<std::filesystem::path> existingFiles;
+    std::map<std::string, std::pair<uint64_t, std::string>> lines;
+    bool needsMigration{false};
+    std::error_code error;
+    for (const auto &entry :
+         std::filesystem::directory_iterator(directory, error))
+    {
+        auto fileName = entry.path().filename().string();
+        bool isPartition{fileName == baseName};
+        if (!isPartition &&
+            fileName.size() > baseName.size() + 1 &&
+            fileName.starts_with(baseName + "."))
+        {
+            auto suffix = fileName.substr(baseName.size() + 1);
+            isPartition = std::all_of(suffix.begin(), suffix.end(),
+                                      [](const char c)
+                                      {
+                                          return std::isdigit(c) != 0;
+                                      });
+        }
+        if (!isPartition || !entry.is_regular_file()){continue;}
+        // Compare paths the way they were spelled in the options
+        auto path = basePath.parent_path().empty() ?
+                    entry.path().filename() : entry.path();
+        existingFiles.push_back(path);
+        auto partition = currentFiles.find(path);
+        if (partition == currentFiles.end()){needsMigration = true;}
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream stream(line);
+            std::string stationID;
+            uint64_t sequenceNumber{0};
+            if (!(stream >> stationID >> sequenceNumber)){continue;}
+            // A station in the wrong file was written with another layout
+            if (partition != currentFiles.end() &&
+                static_cast<int> (::stationHash(stationID)
+                                 %static_cast<uint32_t> (nConnections))
+                != partition->second)
             {
-                dataPacket.setNetwork(network);
-                dataPacket.setStation(station);
-                dataPacket.setChannel(channel);
-                dataPacket.setLocationCode(location);
+                needsMigration = true;
             }
-            else
+            // The unset sequence number is the largest value
+            if (sequenceNumber == std::numeric_limits<uint64_t>::max())
             {
-                msr3_free(&miniSEEDRecord);
-                throw std::runtime_error("Failed to unpack SNCL");
+                sequenceNumber = 0;
             }
-            // Sampling rate
-            dataPacket.setSamplingRate(miniSEEDRecord->samprate);
-            // Start time (convert from nanoseconds to microseconds)
-            std::chrono::microseconds startTime
+            auto [item, inserted]
+                = lines.insert({stationID, {sequenceNumber, line}});
+            if (!inserted && sequenceNumber > item->second.first)
             {
-                static_cast<int64_t> 
-                    (std::round(miniSEEDRecord->starttime*1.e-3))
-            };
-            dataPacket.setStartTime(startTime);
-            // Data
-            auto nSamples = static_cast<int> (miniSEEDRecord->numsamples);
-            if (nSamples > 0)
-            {
-                if (miniSEEDRecord->sampletype == 'i')
-                {
-                    const auto data
-                        = reinterpret_cast<const int *>
-                          (miniSEEDRecord->datasamples);
-                    dataPacket.setData(nSamples, data);
-                }
-                else if (miniSEEDRecord->sampletype == 'f')
-                {
-                    const auto data
-                       = reinterpret_cast<const float *>
-                          (miniSEEDRecord->datasamples);
-                    dataPacket.setData(nSamples, data);
-                }
-                else if (miniSEEDRecord->sampletype == 'd')
-                {
-                    const auto data
-                        = reinterpret_cast<const double *>
-                          (miniSEEDRecord->datasamples);
-                    dataPacket.setData(nSamples, data);
-                }
-                else
-                {
-                    msr3_free(&miniSEEDRecord);
-                    throw std::runtime_error("Unhandled sample type");
-                }
-            } // End check on nSamples
-            dataPackets.push_back(std::move(dataPacket));
-            offset = offset + miniSEEDRecord->reclen;
-            msr3_free(&miniSEEDRecord);
+                item->second = {sequenceNumber, line};
+            }
         }
-        else
+    }
+    if (!needsMigration){return;}
+    spdlog::warn("The number of connections for " + stateFile
+               + " changed; moving the resume points to "
+               + std::to_string(nConnections) + " state file(s)");
+    std::vector<std::string> contents(nConnections);
+    for (const auto &[stationID, line] : lines)
+    {
+        auto index = ::stationHash(stationID)
+                    %static_cast<uint32_t> (nConnections);
+        contents[index] = contents[index] + line.second + "\n";
+    }
+    for (int i = 0; i < nConnections; ++i)
+    {
+        if (!contents[i].empty())
+        {
+            US8::Utilities::writeAtomically(
+                ::toStateFile(stateFile, nConnections, i), contents[i]);
+        }
+    }
+    // Remove what wasn't just rewritten
+    for (const auto &path : existingFiles)
+    {
+        auto partition = currentFiles.find(path);
+        if (partition == currentFiles.end() ||
+            contents[partition->second].empty())
+        {
+            std::filesystem::remove(path, error);
+        }
+    }
+}
+
+/// @brief Splits a server's selectors over the requested number of
+///        connections.
+[[nodiscard]] std::vector<ClientOptions>
+    shardOptions(const ClientOptions &options)
+{
+    auto nConnections = options.getNumberOfConnections();
+    auto selectors = options.getStreamSelectors();
+    if (nConnections > 1 && selectors.empty())
+    {
+        spdlog::warn("Cannot split a uni-station connection to "
+                   + options.getAddress() + "; using one connection");
+        nConnections = 1;
+    }
+    if (options.haveStateFile())
+    {
+        try
+        {
+            ::migrateStateFiles(options.getStateFile(), nConnections);
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::warn("Failed to migrate state files because "
+                       + std::string {e.what()});
+        }
+    }
+    if (nConnections == 1){return std::vector<ClientOptions> {options};}
+    std::vector<ClientOptions> shards(nConnections, options);
+    for (int i = 0; i < nConnections; ++i)
+    {
+        shards[i].clearStreamSelectors();
+        if (options.haveStateFile())
+        {
+            shards[i].setStateFile(
+                ::toStateFile(options.getStateFile(), nConnections, i));
+        }
+    }
+    for (const auto &selector : selectors)
+    {
+        auto name = selector.getNetwork() + "_" + selector.getStation();
+        auto index = ::stationHash(name)%static_cast<uint32_t> (nConnections);
+        shards[index].addStreamSelector(selector);
+    }
+    // Don't open connections with nothing to do
+    std::vector<ClientOptions> result;
+    for (auto &shard : shards)
+    {
+        if (!shard.getStreamSelectors().empty())
         {
-            if (returnCode != MS_NOERROR)
+            result.push_back(std::move(shard));
+        }
+    }
+    // The server's back-fill budget is shared by the connections that open
+    auto nShards = static_cast<double> (result.size());
+    for (auto &shard : result)
+    {
+        shard.setMaximumBackFillRate(options.getMaximumBackFillRate()/nShards);
+    }
+    spdlog::info("Split " + std::to_string(selectors.size())
+               + " selectors for " + options.getAddress()
+               + " over " + std::to_string(result.size())
+               + " connections");
+    return result;
+}
+
+/// @brief Paces the back-fill packets from a connection.  Tokens accrue at
+///        the maximum rate up to a one second burst.  The decoders charge
+///        the back-fill packets they unpack and the reader stops reading the
+///        connection while it is in debt, so nothing waits in a decoder.
+class BackFillThrottle
+{
+public:
+    BackFillThrottle(const double packetsPerSecond,
+                     const std::chrono::seconds &threshold) :
+        mThreshold(threshold),
+        mRate(packetsPerSecond),
+        mTokens(packetsPerSecond)
+    {
+    }
+    /// @result True indicates the packet is back-fill.
+    [[nodiscard]] bool isBackFill(
+        const US8::MessageFormats::Broadcasts::DataPacket &packet,
+        const std::chrono::microseconds &now) const
+    {
+        return now - packet.getEndTime() > mThreshold;
+    }
+    /// @brief Charges the back-fill packets unpacked from a record.  The
+    ///        connection is back-filling until a record without back-fill
+    ///        arrives.
+    void charge(const int nBackFillPackets)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBackFilling = nBackFillPackets > 0;
+        if (mRate <= 0){return;}
+        refill();
+        mTokens = mTokens - nBackFillPackets;
+    }
+    /// @param[in] isBackedUp  If set and this returns true then the consumer
+    ///                        cannot take more back-fill.
+    /// @result The time to wait before reading the connection again.  This
+    ///         is zero if the connection may be read now.
+    [[nodiscard]] std::chrono::milliseconds getWaitTime(
+        const std::function<bool ()> &isBackedUp)
+    {
+        // Checked while the consumer is backed up
+        constexpr std::chrono::milliseconds backedUpWaitTime{10};
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mBackFilling){return std::chrono::milliseconds {0};}
+        if (mRate > 0)
+        {
+            refill();
+            if (mTokens < 0)
             {
-                if (miniSEEDRecord){msr3_free(&miniSEEDRecord);}
-                throw std::runtime_error("libmseed error detected");
+                return std::chrono::milliseconds
+                       {static_cast<int64_t> (std::ceil(-mTokens/mRate*1000))};
             }
-            msr3_free(&miniSEEDRecord);
-            throw std::runtime_error(
-                 "Insufficient data.  Number of additional bytes estimated is "
-                + std::to_string(returnCode));
         }
+        if (isBackedUp && isBackedUp()){return backedUpWaitTime;}
+        return std::chrono::milliseconds {0};
+    }
+private:
+    void refill()
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - mLastRefill;
+        mLastRefill = now;
+        mTokens = std::min(mRate, mTokens + elapsed.count()*mRate);
     }
-    if (dataPackets.size() > 1)
+    std::mutex mMutex;
+    std::chrono::steady_clock::time_point mLastRefill
+    {
+        std::chrono::steady_clock::now()
+    };
+    std::chrono::seconds mThreshold{60};
+    double mRate{0};
+    double mTokens{0};
+    bool mBackFilling{false};
+};
+
+/// @brief Hashes the stream identifier in a raw miniSEED record so that
+///        records from the same stream are always sent to the same decoder.
+[[nodiscard]] size_t streamHash(const char *record, const size_t length)
+{
+    // miniSEED3 - the source identifier follows the fixed header
+    if (length >= 40 && record[0] == 'M' && record[1] == 'S' &&
+        record[2] == 3)
     {
-        spdlog::warn("Multiple mseed packets received");
+        auto sidLength = static_cast<size_t> (static_cast<uint8_t> (record[33]));
+        if (40 + sidLength <= length)
+        {
+            return std::hash<std::string_view> {}
+                   (std::string_view {record + 40, sidLength});
+        }
     }
-    else if (dataPackets.empty())
+    // miniSEED2 - station, location, channel, and network are in bytes 8-19
+    if (length >= 20)
     {
-        spdlog::warn("No mseed packets unpacked");
-    } 
-    return dataPackets;
+        return std::hash<std::string_view> {}
+               (std::string_view {record + 8, 12});
+    }
+    return 0;
 }
 
 }
@@ -154,40 +352,110 @@ std::vector<US8::MessageFormats::Broadcasts::DataPacket>
 class Client::ClientImpl
 {
 public:
+    /// Constructor
+    ClientImpl()
+    {
+        // The poller blocks on the SEEDLink sockets so stop() needs a way
+        // to wake it up
+        mWakeUpFileDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (mWakeUpFileDescriptor < 0)
+        {
+            throw std::runtime_error("Failed to create wake-up eventfd");
+        }
+        mEpollFileDescriptor = epoll_create1(EPOLL_CLOEXEC);
+        if (mEpollFileDescriptor < 0)
+        {
+            close(mWakeUpFileDescriptor);
+            throw std::runtime_error("Failed to create epoll instance");
+        }
+        struct epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = WAKE_UP_EVENT;
+        if (epoll_ctl(mEpollFileDescriptor, EPOLL_CTL_ADD,
+                      mWakeUpFileDescriptor, &event) != 0)
+        {
+            close(mEpollFileDescriptor);
+            close(mWakeUpFileDescriptor);
+            throw std::runtime_error("Failed to add eventfd to epoll");
+        }
+    }
     /// Destructor
     ~ClientImpl()
     {
         stop();
         disconnect();
+        if (mEpollFileDescriptor >= 0){close(mEpollFileDescriptor);}
+        if (mWakeUpFileDescriptor >= 0){close(mWakeUpFileDescriptor);}
     }
-    /// Terminate the SEED link client connection
+    /// Terminate the SEED link client connections
     void disconnect()
     {
-        if (mSEEDLinkConnection != nullptr)
+        // Each connection submits its final state
+        mConnections.clear();
+        mRegisteredFileDescriptors.clear();
+        if (mStateFileWriter){mStateFileWriter->flush();}
+    }
+    /// Sends a terminate command to the SEEDLink connections
+    void terminate()
+    {
+        for (auto &connection : mConnections)
         {
-            if (mSEEDLinkConnection->link != -1)
-            {
-                spdlog::debug("Disconnecting SEEDLink...");
-                sl_disconnect(mSEEDLinkConnection);
-            }
-            if (mUseStateFile)
+            connection->terminate();
+        }
+        wakeUp();
+    }
+    /// Interrupts the poller if it is waiting on the sockets
+    void wakeUp()
+    {
+        if (mWakeUpFileDescriptor >= 0)
+        {
+            constexpr uint64_t one{1};
+            if (write(mWakeUpFileDescriptor, &one, sizeof(one)) < 0)
             {
-                spdlog::debug("Saving state prior to disconnect...");
-                sl_savestate(mSEEDLinkConnection, mStateFile.c_str());
+                spdlog::debug("Failed to write to wake-up eventfd");
             }
-            spdlog::debug("Freeing SEEDLink structure...");
-            sl_freeslcd(mSEEDLinkConnection);
-            mSEEDLinkConnection = nullptr;
         }
     }
-    /// Sends a terminate command to the SEEDLink connection
-    void terminate()
+    /// Clears any pending wake-up requests
+    void clearWakeUp()
+    {
+        uint64_t value{0};
+        while (read(mWakeUpFileDescriptor, &value, sizeof(value)) > 0){}
+    }
+    /// libslink may close and re-open a connection's socket when it
+    /// reconnects.  This keeps the epoll registration current.  Since a
+    /// closed descriptor is silently dropped from the epoll set and the
+    /// number can be reused, this re-arms rather than trusting the cached
+    /// value.
+    void updateRegistration(const size_t index)
     {
-        if (mSEEDLinkConnection != nullptr)
+        auto fileDescriptor = mConnections[index]->getFileDescriptor();
+        auto &registeredFileDescriptor = mRegisteredFileDescriptors[index];
+        if (registeredFileDescriptor >= 0 &&
+            registeredFileDescriptor != fileDescriptor)
         {
-            spdlog::debug("Issuing terminate command to poller");
-            sl_terminate(mSEEDLinkConnection);
+            // Fails harmlessly if the old socket was already closed
+            epoll_ctl(mEpollFileDescriptor, EPOLL_CTL_DEL,
+                      registeredFileDescriptor, nullptr);
+            registeredFileDescriptor =-1;
+        }
+        if (fileDescriptor < 0){return;}
+        struct epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = static_cast<uint64_t> (index);
+        if (epoll_ctl(mEpollFileDescriptor, EPOLL_CTL_MOD,
+                      fileDescriptor, &event) != 0)
+        {
+            if (epoll_ctl(mEpollFileDescriptor, EPOLL_CTL_ADD,
+                          fileDescriptor, &event) != 0)
+            {
+                spdlog::warn("Failed to add "
+                           + mConnections[index]->getAddress()
+                           + " to epoll: " + std::strerror(errno));
+                return;
+            }
         }
+        registeredFileDescriptor = fileDescriptor;
     }
     /// Toggles this as running or not running
     void setRunning(const bool running)
@@ -202,11 +470,23 @@ public:
         // because it received a terminate request
         mKeepRunning = running;
     }
-    /// Stops the service
+    /// Stops the service.  The reader is stopped first then the decoders
+    /// finish what is queued so the saved state covers every record read.
     void stop()
     {
         setRunning(false); // Issues terminate command
         if (mSEEDLinkReaderThread.joinable()){mSEEDLinkReaderThread.join();}
+        mDecodersKeepRunning = false;
+        for (auto &decoderThread : mDecoderThreads)
+        {
+            if (decoderThread.joinable()){decoderThread.join();}
+        }
+        mDecoderThreads.clear();
+        for (auto &connection : mConnections)
+        {
+            connection->saveState();
+        }
+        if (mStateFileWriter){mStateFileWriter->flush();}
     }
     /// Starts the service
     void start()
@@ -216,272 +496,518 @@ public:
         {
             throw std::runtime_error("SEEDLink client not initialized");
         }
+        clearWakeUp();
         setRunning(true);
+        mDecodersKeepRunning = true;
+        // stop() drained the old queues
+        mRecordQueues.clear();
+        mPayloadBuffers.clear();
+        for (int i = 0; i < mNumberOfDecoderThreads; ++i)
+        {
+            mRecordQueues.push_back(
+                std::make_unique<moodycamel::BlockingReaderWriterQueue
+                                 <::SEEDLinkRecord>> (mMaximumQueueSize));
+            mPayloadBuffers.push_back(
+                std::make_unique<moodycamel::ReaderWriterQueue
+                                 <std::vector<char>>> (mMaximumQueueSize));
+        }
+        spdlog::debug("Starting "
+                    + std::to_string(mNumberOfDecoderThreads)
+                    + " miniSEED decoder thread(s)...");
+        for (int i = 0; i < mNumberOfDecoderThreads; ++i)
+        {
+            mDecoderThreads.push_back(
+                std::thread(&ClientImpl::decodeRecords, this, i));
+        }
         spdlog::debug("Starting the SEEDLink polling thread...");
-        mSEEDLinkConnection->terminate = 0;
-        mSEEDLinkReaderThread = std::thread(&ClientImpl::packetToCallback,
-                                            this);
+        for (auto &connection : mConnections)
+        {
+            connection->resetTerminate();
+        }
+        mSEEDLinkReaderThread = std::thread(&ClientImpl::readRecords, this);
     }
-    /// Scrapes the packets and puts them to the callback
-    void packetToCallback()
+    /// Hands a raw record to the decoder responsible for its stream.  If that
+    /// decoder is backed up then this stops reading the socket until there is
+    /// space which pushes back on the SEEDLink server rather than losing data.
+    void enqueueRecord(const std::string_view &rawRecord,
+                       const Connection::Checkpoint &checkpoint,
+                       const int connection)
     {
-        constexpr std::chrono::milliseconds timeToSleep{50};
-        mConnected = true;
-        // Recover state
-        if (mUseStateFile)
+        size_t index{0};
+        if (mRecordQueues.size() > 1)
+        {
+            index = ::streamHash(rawRecord.data(), rawRecord.size())
+                   %mRecordQueues.size();
+        }
+        // Reuse a buffer the decoder is done with so the steady state
+        // does not allocate
+        ::SEEDLinkRecord record;
+        mPayloadBuffers[index]->try_dequeue(record.payload);
+        record.payload.assign(rawRecord.begin(), rawRecord.end());
+        record.checkpoint = checkpoint;
+        record.connection = connection;
+        auto &queue = *mRecordQueues[index];
+        bool warned{false};
+        while (mKeepRunning)
         {
-            if (!sl_recoverstate(mSEEDLinkConnection, mStateFile.c_str()))
+            if (queue.try_enqueue(std::move(record))){return;}
+            if (!warned)
             {
-                 spdlog::warn("Failed to recover state");
+                spdlog::warn("Decoder " + std::to_string(index)
+                           + " is backed up; pausing SEEDLink reads");
+                warned = true;
             }
+            std::this_thread::sleep_for(std::chrono::milliseconds {1});
         }
-        // Now start scraping
-        //sl_printslcd(mSEEDLinkConnection); // Useful for debugging
-        const SLpacketinfo *seedLinkPacketInfo{nullptr};
-        std::array<char, SL_RECV_BUFFER_SIZE> seedLinkBuffer;
-        const auto seedLinkBufferSize
-            = static_cast<uint32_t> (seedLinkBuffer.size());
-        int updateStateFile{1};
+    }
+    /// Stops waiting on a connection's socket while it is paused.  The
+    /// registration is kept so updateRegistration() can re-arm it.
+    void pauseRegistration(const size_t index)
+    {
+        auto fileDescriptor = mRegisteredFileDescriptors[index];
+        if (fileDescriptor < 0){return;}
+        struct epoll_event event{};
+        event.events = 0;
+        event.data.u64 = static_cast<uint64_t> (index);
+        epoll_ctl(mEpollFileDescriptor, EPOLL_CTL_MOD, fileDescriptor, &event);
+    }
+    /// Reads everything currently buffered on a connection then re-arms its
+    /// socket in the epoll set.  A back-filling connection that is over its
+    /// rate, or whose packets cannot be taken, is paused instead.  This
+    /// pushes back on its server without holding up the other connections.
+    /// @param[out] resumeTime  If the connection is paused then this is
+    ///                         when it should be read again.
+    /// @result False indicates the connection was terminated.
+    bool drainConnection(const size_t index,
+                         std::chrono::steady_clock::time_point *resumeTime)
+    {
+        auto &connection = mConnections[index];
+        auto &throttle = *mBackFillThrottles[index];
+        std::string_view rawRecord;
+        Connection::Checkpoint checkpoint;
+        bool terminated{false};
+        bool paused{false};
+        while (mKeepRunning)
+        {
+            auto waitTime = throttle.getWaitTime(mBackFillBackPressure);
+            if (waitTime.count() > 0)
+            {
+                *resumeTime = std::chrono::steady_clock::now() + waitTime;
+                paused = true;
+                break;
+            }
+            auto result = connection->collect(&rawRecord, &checkpoint);
+            if (result == Connection::CollectResult::Record)
+            {
+                enqueueRecord(rawRecord, checkpoint, static_cast<int> (index));
+            }
+            else if (result == Connection::CollectResult::Terminated)
+            {
+                terminated = true;
+                break;
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (paused && !terminated)
+        {
+            pauseRegistration(index);
+        }
+        else
+        {
+            updateRegistration(index);
+        }
+        return !terminated;
+    }
+    /// Reads raw records off the SEEDLink connections and passes them to the
+    /// decoders.  All connections are serviced from this one thread by
+    /// waiting on their sockets with epoll.  No decoding is done here so the
+    /// sockets are drained at line rate.
+    void readRecords()
+    {
+        // Bounds the wait so libslink can still service its keep-alive and
+        // reconnect timers
+        constexpr std::chrono::milliseconds maximumWaitTime{500};
+        constexpr int maximumEvents{64};
+        mConnected = true;
+        // Recover state
+        for (auto &connection : mConnections)
+        {
+            connection->recoverState();
+        }
+        const auto nConnections = mConnections.size();
+        std::vector<bool> active(nConnections, true);
+        // Paused connections are read again at these times
+        constexpr auto notPaused = std::chrono::steady_clock::time_point::max();
+        std::vector<std::chrono::steady_clock::time_point>
+            resumeTimes(nConnections, notPaused);
+        std::vector<size_t> toService(nConnections);
+        std::iota(toService.begin(), toService.end(), 0);
+        std::array<struct epoll_event, maximumEvents> events;
+        auto nextFullServiceTime
+            = std::chrono::steady_clock::now() + maximumWaitTime;
         spdlog::debug("Thread entering SEEDLink polling loop...");
         while (mKeepRunning)
         {
-            // Attempt to collect data but then immediately return.
-            auto returnValue = sl_collect(mSEEDLinkConnection,
-                                          &seedLinkPacketInfo,
-                                          seedLinkBuffer.data(),
-                                          seedLinkBufferSize);
-            // Deal with packet
-            if (returnValue == SLPACKET)
+            terminateFinishedConnections();
+            for (const auto index : toService)
             {
-                // I really only care about data packets
-                if (seedLinkPacketInfo->payloadformat == SLPAYLOAD_MSEED2 ||
-                    seedLinkPacketInfo->payloadformat == SLPAYLOAD_MSEED3)
+                if (!active[index]){continue;}
+                resumeTimes[index] = notPaused;
+                if (!drainConnection(index, &resumeTimes[index]))
                 {
-                    //auto sequenceNumber = sl_sequence(seedLinkPacket);
-                    auto payloadLength = seedLinkPacketInfo->payloadlength;
-                    try
-                    {
-                        auto packets
-                            = ::miniSEEDToDataPackets(seedLinkBuffer.data(),
-                                                      payloadLength);
-                        for (auto &packet : packets)
-                        {
-                            try
-                            {
-                                mAddPacketFunction(std::move(packet));
-                            }
-                            catch (const std::exception &e)
-                            {
-                                spdlog::warn("Failed to propagate packet because "
-                                           + std::string {e.what()});
-                            }
-                        }
-                    }
-                    catch (const std::exception &e)
-                    {
-                        spdlog::warn("Skipping packet.  Unpacking failed with: "
-                                   + std::string(e.what()));
-                    }
-                    if (mUseStateFile)
-                    {
-                        if (updateStateFile > mStateFileUpdateInterval)
-                        {
-                            sl_savestate(mSEEDLinkConnection,
-                                         mStateFile.c_str());
-                            updateStateFile = 0;
-                        }
-                        updateStateFile = updateStateFile + 1;
-                    }
+                    active[index] = false;
                 }
             }
-            else if (returnValue == SLTOOLARGE)
+            if (std::none_of(active.begin(), active.end(),
+                             [](const bool isActive){return isActive;}))
             {
-                spdlog::warn("Pyaload length "
-                           + std::to_string(seedLinkPacketInfo->payloadlength)
-                           + " exceeds " + std::to_string(seedLinkBufferSize) 
-                           + "; skipping");
-                continue;
+                break;
             }
-            else if (returnValue == SLNOPACKET)
+            toService.clear();
+            // Wake in time to resume the first paused connection
+            auto waitTime = maximumWaitTime;
+            auto now = std::chrono::steady_clock::now();
+            for (const auto &resumeTime : resumeTimes)
             {
-                spdlog::debug("No data from sl_collect");
-                std::this_thread::sleep_for(timeToSleep);
-                continue;
+                if (resumeTime == notPaused){continue;}
+                waitTime = std::min(waitTime,
+                                    std::chrono::ceil<std::chrono::milliseconds>
+                                    (std::max(resumeTime - now,
+                                              std::chrono::steady_clock::duration {0})));
             }
-            else if (returnValue == SLTERMINATE)
+            auto nEvents = epoll_wait(mEpollFileDescriptor,
+                                      events.data(), maximumEvents,
+                                      static_cast<int> (waitTime.count()));
+            if (nEvents < 0 && errno != EINTR)
             {
-                spdlog::info("SEEDLink terminate request received");
-                mConnected = false;
-                break;
+                spdlog::warn("epoll_wait failed with: "
+                           + std::string {std::strerror(errno)});
+            }
+            for (int i = 0; i < nEvents; ++i)
+            {
+                if (events[i].data.u64 == WAKE_UP_EVENT)
+                {
+                    clearWakeUp();
+                    // Let the connections see the terminate request
+                    toService.resize(nConnections);
+                    std::iota(toService.begin(), toService.end(), 0);
+                    break;
+                }
+                toService.push_back(static_cast<size_t> (events[i].data.u64));
+            }
+            // Quiet or reconnecting connections still need their timers
+            // serviced even when other connections keep epoll busy
+            now = std::chrono::steady_clock::now();
+            if (nEvents <= 0 || now >= nextFullServiceTime)
+            {
+                toService.resize(nConnections);
+                std::iota(toService.begin(), toService.end(), 0);
+                nextFullServiceTime = now + maximumWaitTime;
             }
             else
             {
-                spdlog::warn("Unhandled SEEDLink return value: "
-                           + std::to_string(returnValue));
-                continue;
+                for (size_t index = 0; index < nConnections; ++index)
+                {
+                    if (resumeTimes[index] != notPaused &&
+                        now >= resumeTimes[index])
+                    {
+                        toService.push_back(index);
+                    }
+                }
             }
         }
         spdlog::info("Thread leaving SEEDLink polling loop");
         mConnected = false;
     }
-    /// Initialize
-    void initialize(const ClientOptions &options)
+    /// Unpacks a raw record and puts the resulting packets to the callback
+    void decodeRecord(
+        const ::SEEDLinkRecord &record,
+        const bool serializeCallback,
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> *packets)
     {
-        mHaveOptions = false;
-        disconnect();
-        mInitialized = false;
-        // Create a new instance
-        mSEEDLinkConnection
-            = sl_initslcd(mClientName.c_str(),
-                          US8::Version::getVersion().c_str());
-        if (!mSEEDLinkConnection)
-        {
-            throw std::runtime_error("Failed to create client handle");
-        }
-        // Set the connection string
-        auto address = options.getAddress();
-        auto port = options.getPort();
-        auto seedLinkAddress = address +  ":" + std::to_string(port);
-        spdlog::info("Connecting to SEEDLink server "
-                   + seedLinkAddress + "...");
-        if (sl_set_serveraddress(
-               mSEEDLinkConnection, seedLinkAddress.c_str()) != 0)
-        {
-            throw std::invalid_argument("Failed to set server address " 
-                                      + seedLinkAddress);
-        }
-        // Set the record size and state file
-        mSEEDRecordSize = options.getSEEDRecordSize();
-        if (options.haveStateFile())
+        packets->clear();
+        US8::Broadcasts::DataPacket::MiniSEED::unpack(
+            record.payload.data(), record.payload.size(), packets);
+        if (!mEndTimes.empty())
         {
-            mStateFile = options.getStateFile();
-            mStateFileUpdateInterval = options.getStateFileUpdateInterval();
-            mUseStateFile = true;
-        }   
-        // If there are selectors then try to use them
-        constexpr uint64_t sequenceNumber{SL_UNSETSEQUENCE}; // Start at next data
-        const char *timeStamp{nullptr};
-        auto streamSelectors = options.getStreamSelectors();
-        for (const auto &selector : streamSelectors)
-        {
-            try
+            for (const auto &packet : *packets)
             {
-                auto network = selector.getNetwork();
-                auto station = selector.getStation();
-                auto stationID = network + "_" + station;
-                auto streamSelector = selector.getSelector();
-                spdlog::info("Adding: "
-                            + stationID + " " 
-                            + streamSelector);
-                auto returnCode = sl_add_stream(mSEEDLinkConnection,
-                                                stationID.c_str(),
-                                                streamSelector.c_str(),
-                                                sequenceNumber,
-                                                timeStamp);
-                if (returnCode != 0)
+                if (isPastEndTime(packet, END_TIME_GRACE_PERIOD))
                 {
-                    throw std::runtime_error("Failed to add selector: "
-                                           + network + " "
-                                           + station + " "
-                                           + streamSelector);
+                    finishStation(record.connection, packet);
                 }
             }
-            catch (const std::exception &e)
+            std::erase_if(*packets,
+                [this](const auto &packet)
+                {
+                    return isPastEndTime(packet);
+                });
+        }
+        if (packets->empty()){return;}
+        // Pace the catch-up.  This only charges the connection; the reader
+        // stops pulling from the socket while the connection is in debt so
+        // the decoders never wait on back-fill.
+        auto &throttle = *mBackFillThrottles.at(record.connection);
+        auto now
+            = std::chrono::time_point_cast<std::chrono::microseconds>
+              (std::chrono::system_clock::now()).time_since_epoch();
+        int nBackFillPackets{0};
+        for (const auto &packet : *packets)
+        {
+            if (throttle.isBackFill(packet, now))
             {
-                spdlog::warn("Could not add selector because "
-                            + std::string {e.what()});
+                nBackFillPackets = nBackFillPackets + 1;
             }
         }
-        // Configure uni-station mode if no streams were specified
-        if (mSEEDLinkConnection->streams == nullptr)
+        throttle.charge(nBackFillPackets);
+        // The callback need not be thread-safe.  Since every decoder shares
+        // this lock the callback must not block.
+        std::unique_lock<std::mutex> lock(mCallbackMutex, std::defer_lock);
+        if (serializeCallback){lock.lock();}
+        try
+        {
+            mAddPacketsFunction(std::move(*packets));
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::warn("Failed to propagate packets because "
+                       + std::string {e.what()});
+        }
+    }
+    /// Unpacks the raw records assigned to this decoder and puts the
+    /// resulting packets to the callback.  On stop this keeps going until
+    /// its queue is empty.
+    void decodeRecords(const int decoderIndex)
+    {
+        constexpr std::chrono::milliseconds timeOut{100};
+        auto &queue = *mRecordQueues.at(decoderIndex);
+        auto &payloadBuffers = *mPayloadBuffers.at(decoderIndex);
+        const bool serializeCallback{mRecordQueues.size() > 1};
+        spdlog::debug("Thread entering miniSEED decoder "
+                    + std::to_string(decoderIndex));
+        ::SEEDLinkRecord record;
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+        while (true)
         {
-            const char *selectors{nullptr};
-            auto returnCode = sl_set_allstation_params(mSEEDLinkConnection,
-                                                       selectors,
-                                                       sequenceNumber,
-                                                       timeStamp);
-            if (returnCode != 0)
+            if (!queue.wait_dequeue_timed(record, timeOut))
+            {
+                // The reader has exited so nothing more will arrive
+                if (!mDecodersKeepRunning){break;}
+                continue;
+            }
+            try
+            {
+                decodeRecord(record, serializeCallback, &packets);
+            }
+            catch (const std::exception &e)
             {
-                spdlog::error("Could not set SEEDLink uni-station mode");
-                throw std::runtime_error(
-                    "Failed to create a SEEDLink uni-station client");
+                spdlog::warn("Skipping packet.  Unpacking failed with: "
+                           + std::string(e.what()));
             }
+            // Handled, even if it could not be used
+            mConnections.at(record.connection)->acknowledge(record.checkpoint);
+            // Give the buffer back to the reader.  If the reader has enough
+            // then this one is freed.
+            payloadBuffers.try_enqueue(std::move(record.payload));
         }
-        // Preferentially do not block so our thread can check for other
-        // commands.
-        constexpr bool nonBlock{true};
-        if (sl_set_blockingmode(mSEEDLinkConnection, nonBlock) != 0)
+        spdlog::debug("Thread leaving miniSEED decoder "
+                    + std::to_string(decoderIndex));
+    }
+    /// @result True indicates the packet starts more than the grace period
+    ///         after the end of the time window requested for its station.
+    [[nodiscard]] bool isPastEndTime(
+        const US8::MessageFormats::Broadcasts::DataPacket &packet,
+        const std::chrono::microseconds &gracePeriod
+            = std::chrono::microseconds {0}) const
+    {
+        if (mEndTimes.empty()){return false;}
+        auto endTime
+            = mEndTimes.find(packet.getNetwork() + "_" + packet.getStation());
+        if (endTime == mEndTimes.end()){return false;}
+        return packet.getStartTime() > endTime->second + gracePeriod;
+    }
+    /// Marks the packet's station as done with its time window.  Once every
+    /// station on a bounded connection is done the reader terminates the
+    /// connection since the server would otherwise keep streaming.
+    void finishStation(
+        const int connection,
+        const US8::MessageFormats::Broadcasts::DataPacket &packet)
+    {
+        std::lock_guard<std::mutex> lock(mEndTimeMutex);
+        auto &unfinishedStations = mUnfinishedStations.at(connection);
+        if (unfinishedStations.empty()){return;}
+        auto name = packet.getNetwork() + "_" + packet.getStation();
+        if (unfinishedStations.erase(name) == 0){return;}
+        spdlog::info(name + " passed the end of its time window");
+        if (unfinishedStations.empty())
         {
-            spdlog::warn("Failed to set non-blocking mode");
+            spdlog::info("Every station on "
+                       + mConnections.at(connection)->getAddress()
+                       + " passed the end of its time window; terminating"
+                       + " the connection");
+            mFinishedConnections.at(connection) = true;
+            mHaveFinishedConnections = true;
+            wakeUp();
         }
-#ifndef NDEBUG
-        assert(mSEEDLinkConnection->noblock == 1);
-#endif
-        constexpr bool closeConnection{false};
-        if (sl_set_dialupmode(mSEEDLinkConnection, closeConnection) != 0)
+    }
+    /// Terminates the connections whose time windows have ended
+    void terminateFinishedConnections()
+    {
+        if (!mHaveFinishedConnections.exchange(false)){return;}
+        std::lock_guard<std::mutex> lock(mEndTimeMutex);
+        for (size_t index = 0; index < mConnections.size(); ++index)
         {
-            spdlog::warn("Failed to set keep-alive connection");
+            if (mFinishedConnections[index])
+            {
+                mConnections[index]->terminate();
+            }
         }
-#ifndef NDEBUG
-        assert(mSEEDLinkConnection->dialup == 0);
-#endif
-        // Time out and reconnect delay
-        auto networkTimeOut
-            = static_cast<int> (options.getNetworkTimeOut().count());
-        if (sl_set_idletimeout(mSEEDLinkConnection, networkTimeOut) != 0)
+    }
+    /// Initialize
+    void initialize(const std::vector<ClientOptions> &options)
+    {
+        if (options.empty())
         {
-            spdlog::warn("Failed to set idle connection time");
+            throw std::invalid_argument("No SEEDLink client options");
         }
-        auto reconnectDelay
-            = static_cast<int> (options.getNetworkReconnectDelay().count());
-        if (sl_set_reconnectdelay(mSEEDLinkConnection, reconnectDelay) != 0)
+        mHaveOptions = false;
+        disconnect();
+        mInitialized = false;
+        // The decoder pool is shared by all connections
+        mNumberOfDecoderThreads = 1;
+        mMaximumQueueSize = 1;
+        for (const auto &clientOptions : options)
         {
-            spdlog::warn("Failed to set reconnect delay");
+            mNumberOfDecoderThreads
+                = std::max(mNumberOfDecoderThreads,
+                           clientOptions.getNumberOfDecoderThreads());
+            mMaximumQueueSize
+                = std::max(mMaximumQueueSize,
+                           clientOptions.getMaximumInternalQueueSize());
         }
-        // Check this worked
-#ifndef NDEBUG
-        std::string slSite(512, '\0');
-        std::string slServerID(512, '\0');
-        auto returnCode = sl_ping(mSEEDLinkConnection,
-                                  slServerID.data(),
-                                  slSite.data());
-        if (returnCode != 0)
+        // Create the connections for each server
+        std::vector<ClientOptions> connectionOptions;
+        for (const auto &clientOptions : options)
         {
-            if (returnCode ==-1)
+            auto shards = ::shardOptions(clientOptions);
+            for (auto &shard : shards)
             {
-                spdlog::warn("Invalid ping response");
+                connectionOptions.push_back(std::move(shard));
             }
-            else
+        }
+        // State files are written off the polling thread
+        bool useStateFile{false};
+        for (const auto &clientOptions : connectionOptions)
+        {
+            if (clientOptions.haveStateFile()){useStateFile = true;}
+        }
+        if (useStateFile && !mStateFileWriter)
+        {
+            mStateFileWriter = std::make_shared<StateFileWriter> ();
+        }
+        for (const auto &clientOptions : connectionOptions)
+        {
+            mConnections.push_back(
+                std::make_unique<Connection> (clientOptions,
+                                              mStateFileWriter));
+        }
+        mRegisteredFileDescriptors.resize(mConnections.size(), -1);
+        // Back-fill pacing is per connection
+        mBackFillThrottles.clear();
+        for (const auto &clientOptions : connectionOptions)
+        {
+            mBackFillThrottles.push_back(
+                std::make_unique<::BackFillThrottle>
+                (clientOptions.getMaximumBackFillRate(),
+                 clientOptions.getBackFillThreshold()));
+        }
+        // A station's time window is closed only if every selector for
+        // that station has an end time
+        mEndTimes.clear();
+        std::set<std::string> openEndedStations;
+        for (const auto &clientOptions : options)
+        {
+            for (const auto &selector : clientOptions.getStreamSelectors())
             {
-                spdlog::error("Could not connect to server");
-                throw std::runtime_error("Failed to connect");
+                if (!selector.haveNetwork()){continue;}
+                auto name = selector.getNetwork() + "_"
+                          + selector.getStation();
+                if (!selector.haveEndTime())
+                {
+                    openEndedStations.insert(name);
+                    continue;
+                }
+                auto endTime = selector.getEndTime();
+                auto [item, inserted] = mEndTimes.insert({name, endTime});
+                if (!inserted)
+                {
+                    item->second = std::max(item->second, endTime);
+                }
             }
         }
-        else
+        for (const auto &name : openEndedStations){mEndTimes.erase(name);}
+        // A connection whose stations all have an end time is terminated
+        // once they are all past it
+        mUnfinishedStations.clear();
+        mUnfinishedStations.resize(connectionOptions.size());
+        mFinishedConnections.assign(connectionOptions.size(), false);
+        mHaveFinishedConnections = false;
+        for (size_t index = 0; index < connectionOptions.size(); ++index)
         {
-            spdlog::info("SEEDLink ping successfully returned server "
-                       + slServerID + " (site " + slSite + " )");
+            std::set<std::string> stations;
+            bool bounded{true};
+            for (const auto &selector :
+                 connectionOptions[index].getStreamSelectors())
+            {
+                auto name = selector.haveNetwork() ?
+                            selector.getNetwork() + "_" + selector.getStation() :
+                            std::string {""};
+                if (!mEndTimes.contains(name))
+                {
+                    bounded = false;
+                    break;
+                }
+                stations.insert(name);
+            }
+            if (bounded){mUnfinishedStations[index] = std::move(stations);}
         }
-#endif
         // All-good
         mOptions = options;
         mInitialized = true;
         mHaveOptions = true;
     }
     //mutable std::mutex mMutex;
-    std::string mClientName{"uwsDataLoader"};
-    std::function<void(US8::MessageFormats::Broadcasts::DataPacket &&packet)>
-        mAddPacketFunction;
+    std::function<void(std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)>
+        mAddPacketsFunction;
     std::thread mSEEDLinkReaderThread;
-    SLCD *mSEEDLinkConnection{nullptr};
-    ClientOptions mOptions; 
-    std::string mStateFile;
+    std::vector<std::thread> mDecoderThreads;
+    std::vector<std::unique_ptr<moodycamel::BlockingReaderWriterQueue
+                                <::SEEDLinkRecord>>> mRecordQueues;
+    std::vector<std::unique_ptr<moodycamel::ReaderWriterQueue
+                                <std::vector<char>>>> mPayloadBuffers;
+    std::mutex mCallbackMutex;
+    std::shared_ptr<StateFileWriter> mStateFileWriter{nullptr};
+    std::vector<std::unique_ptr<Connection>> mConnections;
+    std::vector<int> mRegisteredFileDescriptors;
+    std::vector<std::unique_ptr<::BackFillThrottle>> mBackFillThrottles;
+    std::function<bool ()> mBackFillBackPressure{nullptr};
+    std::map<std::string, std::chrono::microseconds> mEndTimes;
+    std::mutex mEndTimeMutex;
+    std::vector<std::set<std::string>> mUnfinishedStations;
+    std::vector<bool> mFinishedConnections;
+    std::atomic<bool> mHaveFinishedConnections{false};
+    std::vector<ClientOptions> mOptions;
     std::atomic<bool> mKeepRunning{true};
+    std::atomic<bool> mDecodersKeepRunning{true};
     std::atomic<bool> mConnected{false};
-    int mStateFileUpdateInterval{100};
-    int mSEEDRecordSize{512};
+    int mWakeUpFileDescriptor{-1};
+    int mEpollFileDescriptor{-1};
+    int mNumberOfDecoderThreads{1};
+    int mMaximumQueueSize{8192};
     bool mHaveOptions{false};
-    bool mUseStateFile{false};
     bool mInitialized{false};
 };
 
@@ -489,10 +1015,39 @@ public:
 Client::Client(
     const std::function<void (US8::MessageFormats::Broadcasts::DataPacket &&packet)> &callback,
     const ClientOptions &options) :
+    Client(callback, std::vector<ClientOptions> {options})
+{
+}
+
+/// Constructor with multiple servers
+Client::Client(
+    const std::function<void (US8::MessageFormats::Broadcasts::DataPacket &&packet)> &callback,
+    const std::vector<ClientOptions> &options) :
     IImportClient(callback),
     pImpl(std::make_unique<ClientImpl> ())
 {
-    pImpl->mAddPacketFunction = callback;
+    // Packets go through IImportClient which handles the per-packet
+    // callback
+    pImpl->mAddPacketsFunction = [this](
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)
+    {
+        IImportClient::operator()(std::move(packets));
+    };
+    pImpl->initialize(options);
+}
+
+/// Constructor with multiple servers and a batch callback
+Client::Client(
+    const std::function<void (std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)> &callback,
+    const std::vector<ClientOptions> &options) :
+    IImportClient(callback),
+    pImpl(std::make_unique<ClientImpl> ())
+{
+    pImpl->mAddPacketsFunction = [this](
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)
+    {
+        IImportClient::operator()(std::move(packets));
+    };
     pImpl->initialize(options);
 }
 
@@ -517,6 +1072,12 @@ void Client::connect()
     pImpl->initialize(optionsCopy);
 }
 
+/// Back-pressure on the back-filling connections
+void Client::setBackFillBackPressure(const std::function<bool ()> &isBackedUp)
+{
+    pImpl->mBackFillBackPressure = isBackedUp;
+}
+
 /// Connected?
 bool Client::isConnected() const noexcept
 {
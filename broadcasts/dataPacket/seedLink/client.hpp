@@ -1,5 +1,6 @@
 #ifndef US8_DATA_CLIENT_DATA_PACKET_SEED_LINK_HPP
 #define US8_DATA_CLIENT_DATA_PACKET_SEED_LINK_HPP
+#include <vector>
 #include <us8/broadcasts/dataPacket/importClient.hpp>
 namespace US8::MessageFormats::Broadcasts
 {
@@ -15,9 +16,40 @@ class Client : public US8::Broadcasts::DataPacket::IImportClient
 {
 public:
     Client() = delete;
+    /// @brief Creates a client that reads from a single SEEDLink server.
+    /// @param[in] callback  The function to which unpacked packets are sent.
+    /// @param[in] options   The SEEDLink client options.
     Client(const std::function<void (US8::MessageFormats::Broadcasts::DataPacket &&packets)> &callback,
            const ClientOptions &options);
+    /// @brief Creates a client that reads from many SEEDLink servers.  Each
+    ///        server has its own selectors and state file but all are read
+    ///        from one thread waiting on their sockets and all feed the same
+    ///        decoder pool and callback.
+    /// @param[in] callback  The function to which unpacked packets are sent.
+    /// @param[in] options   The options for each SEEDLink connection.  The
+    ///                      decoder pool uses the largest number of decoder
+    ///                      threads and queue size found in these options.
+    /// @throws std::invalid_argument if options is empty.
+    Client(const std::function<void (US8::MessageFormats::Broadcasts::DataPacket &&packets)> &callback,
+           const std::vector<ClientOptions> &options);
+    /// @brief Creates a client that reads from many SEEDLink servers and
+    ///        passes all the packets unpacked from a record to the callback
+    ///        in one call.
+    /// @param[in] callback  The function to which batches of unpacked
+    ///                      packets are sent.
+    /// @param[in] options   The options for each SEEDLink connection.
+    /// @throws std::invalid_argument if options is empty.
+    Client(const std::function<void (std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)> &callback,
+           const std::vector<ClientOptions> &options);
     ~Client() override;
+    /// @brief Sets a test of whether the consumer can take more back-fill.
+    ///        While this returns true the connections that are back-filling
+    ///        are not read.  This pushes back on their servers without
+    ///        holding up the real-time connections, so the callback never
+    ///        needs to block on back-fill.
+    /// @param[in] isBackedUp  Returns true when the consumer is backed up.
+    /// @note This must be set before start().
+    void setBackFillBackPressure(const std::function<bool ()> &isBackedUp);
     void connect() final;
     void start() final;
     void stop() final;
@@ -15,8 +15,13 @@ public:
     std::vector<StreamSelector> mSelectors;
     std::chrono::seconds mNetworkTimeOut{600};
     std::chrono::seconds mNetworkDelay{30};
+    std::chrono::seconds mBackFillThreshold{60};
+    std::chrono::seconds mStateFileTimeInterval{10};
+    double mMaximumBackFillRate{0};
     int mSEEDRecordSize{512};
     int mMaxQueueSize{8192};
+    int mDecoderThreads{1};
+    int mConnections{1};
     uint16_t mStateFileInterval{100};
     uint16_t mPort{18000};
 };
@@ -132,6 +137,24 @@ uint16_t ClientOptions::getStateFileUpdateInterval() const noexcept
     return pImpl->mStateFileInterval;
 }
 
+/// State file update time interval
+void ClientOptions::setStateFileUpdateTimeInterval(
+    const std::chrono::seconds &interval)
+{
+    if (interval.count() < 0)
+    {
+        throw std::invalid_argument(
+            "State file update time interval cannot be negative");
+    }
+    pImpl->mStateFileTimeInterval = interval;
+}
+
+std::chrono::seconds
+ClientOptions::getStateFileUpdateTimeInterval() const noexcept
+{
+    return pImpl->mStateFileTimeInterval;
+}
+
 /// The SEEDLink record size
 void ClientOptions::setSEEDRecordSize(const int recordSize)
 {
@@ -164,6 +187,68 @@ int ClientOptions::getMaximumInternalQueueSize() const noexcept
     return pImpl->mMaxQueueSize;
 }
 
+/// Number of decoder threads
+void ClientOptions::setNumberOfDecoderThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument(
+            "Number of decoder threads must be positive");
+    }
+    pImpl->mDecoderThreads = nThreads;
+}
+
+int ClientOptions::getNumberOfDecoderThreads() const noexcept
+{
+    return pImpl->mDecoderThreads;
+}
+
+/// Number of connections
+void ClientOptions::setNumberOfConnections(const int nConnections)
+{
+    if (nConnections < 1)
+    {
+        throw std::invalid_argument(
+            "Number of connections must be positive");
+    }
+    pImpl->mConnections = nConnections;
+}
+
+int ClientOptions::getNumberOfConnections() const noexcept
+{
+    return pImpl->mConnections;
+}
+
+/// Back-fill threshold
+void ClientOptions::setBackFillThreshold(const std::chrono::seconds &threshold)
+{
+    if (threshold < std::chrono::seconds {0})
+    {
+        throw std::invalid_argument("Back-fill threshold cannot be negative");
+    }
+    pImpl->mBackFillThreshold = threshold;
+}
+
+std::chrono::seconds ClientOptions::getBackFillThreshold() const noexcept
+{
+    return pImpl->mBackFillThreshold;
+}
+
+/// Back-fill rate
+void ClientOptions::setMaximumBackFillRate(const double packetsPerSecond)
+{
+    if (packetsPerSecond < 0)
+    {
+        throw std::invalid_argument("Back-fill rate cannot be negative");
+    }
+    pImpl->mMaximumBackFillRate = packetsPerSecond;
+}
+
+double ClientOptions::getMaximumBackFillRate() const noexcept
+{
+    return pImpl->mMaximumBackFillRate;
+}
+
 /// Network timeout
 void ClientOptions::setNetworkTimeOut(const std::chrono::seconds &timeOut)
 {
@@ -217,3 +302,9 @@ std::vector<StreamSelector> ClientOptions::getStreamSelectors() const noexcept
 {
     return pImpl->mSelectors;
 }
+
+/// Clear the selectors
+void ClientOptions::clearStreamSelectors() noexcept
+{
+    pImpl->mSelectors.clear();
+}
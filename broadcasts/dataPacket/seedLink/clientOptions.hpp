@@ -63,7 +63,10 @@ public:
     /// @brief Packets are read from SEED Link, put onto an internal queue,
     ///        then sent out via the databroadcast.  This sets the maximum
     ///        internal queue size.  After this point, the oldest packets
-    ///        are popped from the queue.
+    ///        are popped from the queue.  This also bounds the number of raw
+    ///        records each decoder thread can have waiting.  When that is
+    ///        full the reader stops reading the socket until the decoder
+    ///        catches up.
     /// @param[in] maximumQueueSize  The maximum queue size in number of
     ///                              packets.
     /// @throws std::invalid_argument if this is not positive.
@@ -71,6 +74,52 @@ public:
     /// @result The maximum internal queue size in packets.
     [[nodiscard]] int getMaximumInternalQueueSize() const noexcept;
 
+    /// @brief The reader thread copies raw records from the SEEDLink socket
+    ///        then hands them to a pool of decoder threads.  Records from
+    ///        the same stream are always decoded by the same thread so that
+    ///        packet order is preserved for each stream.
+    /// @param[in] nThreads  The number of decoder threads.
+    /// @throws std::invalid_argument if this is not positive.
+    void setNumberOfDecoderThreads(int nThreads);
+    /// @result The number of decoder threads.  By default this is 1.
+    [[nodiscard]] int getNumberOfDecoderThreads() const noexcept;
+
+    /// @brief Spreads the stream selectors over this many connections to
+    ///        the server.  Selectors are assigned to connections by station
+    ///        so a station's streams always arrive on the same connection.
+    ///        When a state file is set each connection i keeps its own
+    ///        state in the file with the suffix .i.  If the number of
+    ///        connections changes then the existing state files are
+    ///        re-partitioned on start-up so no resume point is lost.
+    /// @param[in] nConnections  The number of connections.
+    /// @throws std::invalid_argument if this is not positive.
+    /// @note This has no effect without stream selectors.
+    void setNumberOfConnections(int nConnections);
+    /// @result The number of connections.  By default this is 1.
+    [[nodiscard]] int getNumberOfConnections() const noexcept;
+
+    /// @brief Packets whose last sample is older than this are considered
+    ///        back-fill rather than real-time data.  This happens when the
+    ///        selectors request a start time or the client resumes from a
+    ///        stale state file.
+    /// @param[in] threshold  The back-fill threshold.
+    /// @throws std::invalid_argument if threshold is negative.
+    void setBackFillThreshold(const std::chrono::seconds &threshold);
+    /// @result The back-fill threshold.  By default this is 60 seconds.
+    [[nodiscard]] std::chrono::seconds getBackFillThreshold() const noexcept;
+
+    /// @brief Limits the rate at which back-fill packets are passed on.
+    ///        When the limit is reached the client stops reading the socket
+    ///        which lets the server pace the catch-up.
+    /// @param[in] packetsPerSecond  The maximum back-fill rate in packets per
+    ///                              second.  If this is 0 then the rate is
+    ///                              not limited.
+    /// @throws std::invalid_argument if packetsPerSecond is negative.
+    void setMaximumBackFillRate(double packetsPerSecond);
+    /// @result The maximum back-fill rate in packets per second.  By default
+    ///         this is 0 which indicates the rate is not limited.
+    [[nodiscard]] double getMaximumBackFillRate() const noexcept;
+
     /// @brief Sets the SEEDLink client's state file.  The state file
     ///        contains a list of sequence numbers written during
     ///        clean shutdown.  When the client resumes these numbers
@@ -90,6 +139,15 @@ public:
     void setStateFileUpdateInterval(uint16_t interval) noexcept;
     /// @result The state file update interval in packets.  The default is 100.
     [[nodiscard]] uint16_t getStateFileUpdateInterval() const noexcept;
+    /// @brief The state file is also updated when this much time has passed
+    ///        since the last update and packets have arrived in the meantime.
+    /// @param[in] interval  The update interval.  If this is 0 then only the
+    ///                      packet count triggers an update.
+    /// @throws std::invalid_argument if interval is negative.
+    void setStateFileUpdateTimeInterval(const std::chrono::seconds &interval);
+    /// @result The state file update time interval.  The default is 10
+    ///         seconds.
+    [[nodiscard]] std::chrono::seconds getStateFileUpdateTimeInterval() const noexcept;
 
     /// @brief Specifies the size in bytes of the SEED records.
     ///        Traditionally, this is 512 however RockToSLink may use
@@ -119,6 +177,8 @@ public:
     void addStreamSelector(const StreamSelector &selector);
     /// @result The stream selectors. 
     [[nodiscard]] std::vector<StreamSelector> getStreamSelectors() const noexcept;
+    /// @brief Removes all stream selectors.
+    void clearStreamSelectors() noexcept;
     /// @}
 
     /// @name Destructors
@@ -0,0 +1,522 @@
+#include <string>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#ifndef NDEBUG
+#include <cassert>
+#endif
+#include <libslink.h>
+#include <spdlog/spdlog.h>
+#include "connection.hpp"
+#include "clientOptions.hpp"
+#include "streamSelector.hpp"
+#include "stateFileWriter.hpp"
+#include "us8/version.hpp"
+#include "us8/utilities/writeAtomically.hpp"
+
+using namespace US8::Broadcasts::DataPacket::SEEDLink;
+
+namespace
+{
+/// @brief Formats a time for a SEEDLink time window - e.g.,
+///        2024-01-01T00:00:00.
+[[nodiscard]] std::string toTimeStamp(const std::chrono::microseconds &time)
+{
+    auto seconds
+        = std::chrono::duration_cast<std::chrono::seconds> (time).count();
+    auto epochTime = static_cast<time_t> (seconds);
+    struct tm utc{};
+    if (gmtime_r(&epochTime, &utc) == nullptr)
+    {
+        throw std::invalid_argument("Could not convert time");
+    }
+    std::array<char, 64> timeStamp;
+    std::fill(timeStamp.begin(), timeStamp.end(), '\0');
+    snprintf(timeStamp.data(), timeStamp.size(),
+             "%04d-%02d-%02dT%02d:%02d:%02d",
+             utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+             utc.tm_hour, utc.tm_min, utc.tm_sec);
+    return std::string {timeStamp.data()};
+}
+
+/// @brief A record that was collected but may not yet be delivered.
+struct PendingRecord
+{
+    uint64_t sequenceNumber{SL_UNSETSEQUENCE};
+    std::string timeStamp;
+    bool acknowledged{false};
+};
+
+/// @brief The state of a stream as far as the records have been delivered.
+///        This, rather than libslink's read position, is what is saved so a
+///        restart resumes after the last record that reached the callback.
+struct StreamState
+{
+    std::string stationID;
+    uint64_t sequenceNumber{SL_UNSETSEQUENCE};
+    std::string timeStamp;
+    std::map<uint64_t, PendingRecord> pendingRecords;
+};
+}
+
+class Connection::ConnectionImpl
+{
+public:
+    /// Constructor
+    ConnectionImpl(const ClientOptions &options,
+                   std::shared_ptr<StateFileWriter> stateFileWriter) :
+        mStateFileWriter(std::move(stateFileWriter))
+    {
+        // Create a new instance
+        mSEEDLinkConnection
+            = sl_initslcd(mClientName.c_str(),
+                          US8::Version::getVersion().c_str());
+        if (!mSEEDLinkConnection)
+        {
+            throw std::runtime_error("Failed to create client handle");
+        }
+        try
+        {
+            initialize(options);
+        }
+        catch (...)
+        {
+            sl_freeslcd(mSEEDLinkConnection);
+            mSEEDLinkConnection = nullptr;
+            throw;
+        }
+    }
+    /// Destructor
+    ~ConnectionImpl()
+    {
+        disconnect();
+    }
+    /// Terminate the SEED link client connection
+    void disconnect()
+    {
+        if (mSEEDLinkConnection != nullptr)
+        {
+            if (mSEEDLinkConnection->link != -1)
+            {
+                spdlog::debug("Disconnecting SEEDLink...");
+                sl_disconnect(mSEEDLinkConnection);
+            }
+            if (mUseStateFile)
+            {
+                spdlog::debug("Saving delivered state prior to disconnect...");
+                saveState();
+            }
+            spdlog::debug("Freeing SEEDLink structure...");
+            sl_freeslcd(mSEEDLinkConnection);
+            mSEEDLinkConnection = nullptr;
+        }
+    }
+    /// Configure the connection
+    void initialize(const ClientOptions &options)
+    {
+        // Set the connection string
+        auto address = options.getAddress();
+        auto port = options.getPort();
+        mAddress = address +  ":" + std::to_string(port);
+        spdlog::info("Connecting to SEEDLink server " + mAddress + "...");
+        if (sl_set_serveraddress(
+               mSEEDLinkConnection, mAddress.c_str()) != 0)
+        {
+            throw std::invalid_argument("Failed to set server address "
+                                      + mAddress);
+        }
+        // Set the state file
+        if (options.haveStateFile())
+        {
+            mStateFile = options.getStateFile();
+            mStateFileUpdateInterval = options.getStateFileUpdateInterval();
+            mStateFileUpdateTimeInterval
+                = options.getStateFileUpdateTimeInterval();
+            mLastStateFileUpdate = std::chrono::steady_clock::now();
+            mUseStateFile = true;
+        }
+        // If there are selectors then try to use them
+        constexpr uint64_t sequenceNumber{SL_UNSETSEQUENCE}; // Start at next data
+        const char *timeStamp{nullptr};
+        auto streamSelectors = options.getStreamSelectors();
+        for (const auto &selector : streamSelectors)
+        {
+            try
+            {
+                auto network = selector.getNetwork();
+                auto station = selector.getStation();
+                auto stationID = network + "_" + station;
+                auto streamSelector = selector.getSelector();
+                // Back-fill from the start time
+                std::string startTime;
+                if (selector.haveStartTime())
+                {
+                    startTime = ::toTimeStamp(selector.getStartTime());
+                }
+                spdlog::info("Adding: "
+                            + stationID + " "
+                            + streamSelector
+                            + (startTime.empty() ?
+                               std::string {""} : " from " + startTime));
+                auto returnCode
+                    = sl_add_stream(mSEEDLinkConnection,
+                                    stationID.c_str(),
+                                    streamSelector.c_str(),
+                                    sequenceNumber,
+                                    startTime.empty() ?
+                                    timeStamp : startTime.c_str());
+                if (returnCode != 0)
+                {
+                    throw std::runtime_error("Failed to add selector: "
+                                           + network + " "
+                                           + station + " "
+                                           + streamSelector);
+                }
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::warn("Could not add selector because "
+                            + std::string {e.what()});
+            }
+        }
+        // Configure uni-station mode if no streams were specified
+        if (mSEEDLinkConnection->streams == nullptr)
+        {
+            const char *selectors{nullptr};
+            auto returnCode = sl_set_allstation_params(mSEEDLinkConnection,
+                                                       selectors,
+                                                       sequenceNumber,
+                                                       timeStamp);
+            if (returnCode != 0)
+            {
+                spdlog::error("Could not set SEEDLink uni-station mode");
+                throw std::runtime_error(
+                    "Failed to create a SEEDLink uni-station client");
+            }
+        }
+        // Do not block.  The caller waits on the socket and must be able
+        // to service other connections and commands.
+        constexpr bool nonBlock{true};
+        if (sl_set_blockingmode(mSEEDLinkConnection, nonBlock) != 0)
+        {
+            spdlog::warn("Failed to set non-blocking mode");
+        }
+#ifndef NDEBUG
+        assert(mSEEDLinkConnection->noblock == 1);
+#endif
+        constexpr bool closeConnection{false};
+        if (sl_set_dialupmode(mSEEDLinkConnection, closeConnection) != 0)
+        {
+            spdlog::warn("Failed to set keep-alive connection");
+        }
+#ifndef NDEBUG
+        assert(mSEEDLinkConnection->dialup == 0);
+#endif
+        // Time out and reconnect delay
+        auto networkTimeOut
+            = static_cast<int> (options.getNetworkTimeOut().count());
+        if (sl_set_idletimeout(mSEEDLinkConnection, networkTimeOut) != 0)
+        {
+            spdlog::warn("Failed to set idle connection time");
+        }
+        auto reconnectDelay
+            = static_cast<int> (options.getNetworkReconnectDelay().count());
+        if (sl_set_reconnectdelay(mSEEDLinkConnection, reconnectDelay) != 0)
+        {
+            spdlog::warn("Failed to set reconnect delay");
+        }
+        // Check this worked
+#ifndef NDEBUG
+        std::string slSite(512, '\0');
+        std::string slServerID(512, '\0');
+        auto returnCode = sl_ping(mSEEDLinkConnection,
+                                  slServerID.data(),
+                                  slSite.data());
+        if (returnCode != 0)
+        {
+            if (returnCode ==-1)
+            {
+                spdlog::warn("Invalid ping response");
+            }
+            else
+            {
+                spdlog::error("Could not connect to server");
+                throw std::runtime_error("Failed to connect");
+            }
+        }
+        else
+        {
+            spdlog::info("SEEDLink ping successfully returned server "
+                       + slServerID + " (site " + slSite + " )");
+        }
+#endif
+        resetStreamStates();
+    }
+    /// Sets the delivered state to libslink's current stream state and
+    /// forgets any pending records
+    void resetStreamStates()
+    {
+        std::lock_guard<std::mutex> lockGuard(mStreamStateMutex);
+        mStreamStates.clear();
+        for (auto stream = mSEEDLinkConnection->streams;
+             stream != nullptr;
+             stream = stream->next)
+        {
+            ::StreamState streamState;
+            streamState.stationID = stream->stationid;
+            streamState.sequenceNumber = stream->seqnum;
+            streamState.timeStamp = stream->timestamp;
+            mStreamStates.push_back(std::move(streamState));
+        }
+    }
+    /// Registers a collected record as pending on its stream
+    void addPendingRecord(const SLpacketinfo &packetInfo,
+                          Connection::Checkpoint *checkpoint)
+    {
+        *checkpoint = Connection::Checkpoint {};
+        if (!mUseStateFile){return;}
+        // Find the stream libslink just updated.  In uni-station mode there
+        // is only one.
+        int index{0};
+        const SLstream *stream{mSEEDLinkConnection->streams};
+        if (stream != nullptr && stream->next != nullptr)
+        {
+            std::string_view stationID{packetInfo.stationid};
+            for ( ; stream != nullptr; stream = stream->next, ++index)
+            {
+                if (stationID == stream->stationid){break;}
+            }
+        }
+        if (stream == nullptr){return;}
+        std::lock_guard<std::mutex> lockGuard(mStreamStateMutex);
+        if (index >= static_cast<int> (mStreamStates.size())){return;}
+        ::PendingRecord pendingRecord;
+        pendingRecord.sequenceNumber = packetInfo.seqnum;
+        pendingRecord.timeStamp = stream->timestamp;
+        checkpoint->stream = index;
+        checkpoint->ticket = mNextTicket;
+        mStreamStates[index].pendingRecords.insert(
+            {mNextTicket, std::move(pendingRecord)});
+        mNextTicket = mNextTicket + 1;
+    }
+    /// Marks a record as delivered then advances the stream's delivered
+    /// state over the leading run of delivered records
+    void acknowledge(const Connection::Checkpoint &checkpoint)
+    {
+        if (checkpoint.stream < 0){return;}
+        std::lock_guard<std::mutex> lockGuard(mStreamStateMutex);
+        if (checkpoint.stream >= static_cast<int> (mStreamStates.size()))
+        {
+            return;
+        }
+        auto &streamState = mStreamStates[checkpoint.stream];
+        auto &pendingRecords = streamState.pendingRecords;
+        auto pendingRecord = pendingRecords.find(checkpoint.ticket);
+        if (pendingRecord == pendingRecords.end()){return;}
+        pendingRecord->second.acknowledged = true;
+        while (!pendingRecords.empty() &&
+               pendingRecords.begin()->second.acknowledged)
+        {
+            auto &delivered = pendingRecords.begin()->second;
+            streamState.sequenceNumber = delivered.sequenceNumber;
+            streamState.timeStamp = std::move(delivered.timeStamp);
+            pendingRecords.erase(pendingRecords.begin());
+        }
+    }
+    /// Collect a record
+    [[nodiscard]] Connection::CollectResult collect(
+        std::string_view *record, Connection::Checkpoint *checkpoint)
+    {
+        const SLpacketinfo *seedLinkPacketInfo{nullptr};
+        const auto seedLinkBufferSize
+            = static_cast<uint32_t> (mSEEDLinkBuffer.size());
+        while (true)
+        {
+            // Attempt to collect data but then immediately return.
+            auto returnValue = sl_collect(mSEEDLinkConnection,
+                                          &seedLinkPacketInfo,
+                                          mSEEDLinkBuffer.data(),
+                                          seedLinkBufferSize);
+            if (returnValue == SLPACKET)
+            {
+                // I really only care about data packets
+                if (seedLinkPacketInfo->payloadformat == SLPAYLOAD_MSEED2 ||
+                    seedLinkPacketInfo->payloadformat == SLPAYLOAD_MSEED3)
+                {
+                    *record = std::string_view {mSEEDLinkBuffer.data(),
+                                                seedLinkPacketInfo->payloadlength};
+                    addPendingRecord(*seedLinkPacketInfo, checkpoint);
+                    updateStateFile();
+                    return Connection::CollectResult::Record;
+                }
+            }
+            else if (returnValue == SLTOOLARGE)
+            {
+                spdlog::warn("Pyaload length "
+                           + std::to_string(seedLinkPacketInfo->payloadlength)
+                           + " exceeds " + std::to_string(seedLinkBufferSize)
+                           + " from " + mAddress + "; skipping");
+            }
+            else if (returnValue == SLNOPACKET)
+            {
+                return Connection::CollectResult::NoRecord;
+            }
+            else if (returnValue == SLTERMINATE)
+            {
+                spdlog::info("SEEDLink terminate request received for "
+                           + mAddress);
+                return Connection::CollectResult::Terminated;
+            }
+            else
+            {
+                spdlog::warn("Unhandled SEEDLink return value: "
+                           + std::to_string(returnValue));
+            }
+        }
+    }
+    /// Copies the streams' delivered sequence numbers and times.  This
+    /// follows the layout of sl_savestate so sl_recoverstate can read it.
+    [[nodiscard]] std::string createStateSnapshot() const
+    {
+        std::string snapshot;
+        std::lock_guard<std::mutex> lockGuard(mStreamStateMutex);
+        for (const auto &streamState : mStreamStates)
+        {
+            snapshot = snapshot + streamState.stationID + " "
+                     + std::to_string(streamState.sequenceNumber) + " "
+                     + streamState.timeStamp + "\n";
+        }
+        return snapshot;
+    }
+    /// Saves the state.  With a writer the disk I/O happens on the writer's
+    /// thread.
+    void saveState()
+    {
+        auto snapshot = createStateSnapshot();
+        if (mStateFileWriter)
+        {
+            mStateFileWriter->submit(mStateFile, std::move(snapshot));
+            return;
+        }
+        try
+        {
+            US8::Utilities::writeAtomically(mStateFile, snapshot);
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::warn("Failed to save state for " + mAddress
+                       + " because " + std::string {e.what()});
+        }
+    }
+    /// Periodically save the state file
+    void updateStateFile()
+    {
+        if (!mUseStateFile){return;}
+        mPacketsSinceStateFileUpdate = mPacketsSinceStateFileUpdate + 1;
+        bool update{mPacketsSinceStateFileUpdate > mStateFileUpdateInterval};
+        auto now = std::chrono::steady_clock::now();
+        if (!update && mStateFileUpdateTimeInterval.count() > 0)
+        {
+            update = now - mLastStateFileUpdate >= mStateFileUpdateTimeInterval;
+        }
+        if (update)
+        {
+            saveState();
+            mPacketsSinceStateFileUpdate = 0;
+            mLastStateFileUpdate = now;
+        }
+    }
+    std::string mClientName{"uwsDataLoader"};
+    std::string mAddress;
+    std::string mStateFile;
+    std::array<char, SL_RECV_BUFFER_SIZE> mSEEDLinkBuffer;
+    SLCD *mSEEDLinkConnection{nullptr};
+    std::shared_ptr<StateFileWriter> mStateFileWriter{nullptr};
+    mutable std::mutex mStreamStateMutex;
+    std::vector<::StreamState> mStreamStates;
+    uint64_t mNextTicket{0};
+    std::chrono::steady_clock::time_point mLastStateFileUpdate;
+    std::chrono::seconds mStateFileUpdateTimeInterval{10};
+    int mStateFileUpdateInterval{100};
+    int mPacketsSinceStateFileUpdate{0};
+    bool mUseStateFile{false};
+};
+
+/// Constructor
+Connection::Connection(const ClientOptions &options,
+                       std::shared_ptr<StateFileWriter> stateFileWriter) :
+    pImpl(std::make_unique<ConnectionImpl> (options,
+                                            std::move(stateFileWriter)))
+{
+}
+
+/// Destructor
+Connection::~Connection() = default;
+
+/// Recover state
+void Connection::recoverState()
+{
+    if (pImpl->mUseStateFile)
+    {
+        if (sl_recoverstate(pImpl->mSEEDLinkConnection,
+                            pImpl->mStateFile.c_str()) != 0)
+        {
+             spdlog::warn("Failed to recover state for " + pImpl->mAddress);
+        }
+        pImpl->resetStreamStates();
+    }
+}
+
+/// Collect
+Connection::CollectResult Connection::collect(std::string_view *record,
+                                              Checkpoint *checkpoint)
+{
+    if (record == nullptr){throw std::invalid_argument("record is NULL");}
+    if (checkpoint == nullptr)
+    {
+        throw std::invalid_argument("checkpoint is NULL");
+    }
+    return pImpl->collect(record, checkpoint);
+}
+
+/// Acknowledge
+void Connection::acknowledge(const Checkpoint &checkpoint)
+{
+    pImpl->acknowledge(checkpoint);
+}
+
+/// Save state
+void Connection::saveState()
+{
+    if (pImpl->mUseStateFile){pImpl->saveState();}
+}
+
+/// File descriptor
+int Connection::getFileDescriptor() const noexcept
+{
+    return static_cast<int> (pImpl->mSEEDLinkConnection->link);
+}
+
+/// Terminate
+void Connection::terminate() noexcept
+{
+    spdlog::debug("Issuing terminate command to " + pImpl->mAddress);
+    sl_terminate(pImpl->mSEEDLinkConnection);
+}
+
+void Connection::resetTerminate() noexcept
+{
+    pImpl->mSEEDLinkConnection->terminate = 0;
+}
+
+/// Address
+std::string Connection::getAddress() const noexcept
+{
+    return pImpl->mAddress;
+}
@@ -0,0 +1,100 @@
+#ifndef US8_BROADCASTS_DATA_PACKET_SEED_LINK_CONNECTION_HPP
+#define US8_BROADCASTS_DATA_PACKET_SEED_LINK_CONNECTION_HPP
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+namespace US8::Broadcasts::DataPacket::SEEDLink
+{
+ class ClientOptions;
+ class StateFileWriter;
+}
+namespace US8::Broadcasts::DataPacket::SEEDLink
+{
+/// @class Connection "connection.hpp"
+/// @brief Wraps a single non-blocking libslink connection.  The connection
+///        does no waiting of its own; it is up to the caller to wait on
+///        \c getFileDescriptor() becoming readable.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class Connection
+{
+public:
+    /// @brief Defines the result of attempting to collect a record.
+    enum class CollectResult
+    {
+        Record,    /*!< A miniSEED record was collected. */
+        NoRecord,  /*!< Nothing complete is buffered; wait on the socket. */
+        Terminated /*!< The connection was terminated. */
+    };
+    /// @brief Identifies a collected record.  The state file only advances
+    ///        past a record once it has been acknowledged.
+    struct Checkpoint
+    {
+        /// The index of the record's stream.  This is -1 if the record
+        /// does not belong to a stream with state.
+        int stream{-1};
+        /// The record's position in the order of collection.
+        uint64_t ticket{0};
+    };
+public:
+    /// @brief Creates the SEEDLink connection handle and configures its
+    ///        stream selectors, state file, and timeouts.
+    /// @param[in] options          The SEEDLink client options.
+    /// @param[in] stateFileWriter  If not NULL then periodic state file
+    ///                             updates are handed to this writer.
+    ///                             Otherwise, they are written in place.
+    /// @throws std::invalid_argument if the server address is invalid.
+    /// @throws std::runtime_error if the handle cannot be created.
+    explicit Connection(const ClientOptions &options,
+                        std::shared_ptr<StateFileWriter> stateFileWriter = nullptr);
+
+    /// @brief Restores the sequence numbers from the state file, if one was
+    ///        specified.  Records collected but not acknowledged in a
+    ///        previous session are forgotten since the server will send
+    ///        them again.
+    void recoverState();
+    /// @brief Attempts to collect a miniSEED record without blocking.
+    /// @param[out] record      If the result is \c CollectResult::Record then
+    ///                         this is a view of the raw record.  It is valid
+    ///                         until the next call to \c collect().
+    /// @param[out] checkpoint  If the result is \c CollectResult::Record then
+    ///                         this identifies the record.  It must be passed
+    ///                         to \c acknowledge() once the record has been
+    ///                         delivered.
+    /// @result The outcome of the collection attempt.
+    [[nodiscard]] CollectResult collect(std::string_view *record,
+                                        Checkpoint *checkpoint);
+    /// @brief Marks a collected record as delivered.  A stream's state
+    ///        advances to its latest record for which every earlier record
+    ///        has also been delivered.
+    /// @param[in] checkpoint  The checkpoint returned by \c collect().
+    /// @note This is thread-safe.
+    void acknowledge(const Checkpoint &checkpoint);
+    /// @brief Writes the delivered state to the state file, if one was
+    ///        specified.
+    void saveState();
+    /// @result The socket's file descriptor.  This is -1 while libslink is
+    ///         between connection attempts.
+    [[nodiscard]] int getFileDescriptor() const noexcept;
+    /// @brief Asks the connection to terminate.  The next call to
+    ///        \c collect() will return \c CollectResult::Terminated.
+    void terminate() noexcept;
+    /// @brief Clears a previous terminate request.
+    void resetTerminate() noexcept;
+    /// @result The server address - e.g., rtserve.iris.washington.edu:18000.
+    [[nodiscard]] std::string getAddress() const noexcept;
+
+    /// @brief Disconnects, saves the state, and releases the handle.
+    ~Connection();
+
+    Connection() = delete;
+    Connection(const Connection &) = delete;
+    Connection(Connection &&) noexcept = delete;
+    Connection& operator=(const Connection &) = delete;
+    Connection& operator=(Connection &&) noexcept = delete;
+private:
+    class ConnectionImpl;
+    std::unique_ptr<ConnectionImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,279 @@
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cmath>
+#ifndef NDEBUG
+#include <cassert>
+#endif
+#include <spdlog/spdlog.h>
+#include "packetAggregator.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "broadcasts/dataPacket/sanitizer/toName.hpp"
+
+using namespace US8::Broadcasts::DataPacket::SEEDLink;
+
+namespace
+{
+
+using DataType = US8::MessageFormats::Broadcasts::DataPacket::DataType;
+
+/// @brief A channel's packet that is waiting for more data.
+struct PendingPacket
+{
+    US8::MessageFormats::Broadcasts::DataPacket packet;
+    std::vector<int> integer32Data;
+    std::vector<int64_t> integer64Data;
+    std::vector<float> floatData;
+    std::vector<double> doubleData;
+    std::chrono::steady_clock::time_point createdTime;
+    std::chrono::microseconds startTime{0};
+    double samplingRate{0};
+    DataType dataType{DataType::Unknown};
+    int nSamples{0};
+    int nPackets{0};
+    bool active{false};
+};
+
+template<typename T>
+void append(const US8::MessageFormats::Broadcasts::DataPacket &packet,
+            std::vector<T> *data)
+{
+    const auto nSamples = packet.getNumberOfSamples();
+    const auto pointer = static_cast<const T *> (packet.getDataPointer());
+    data->insert(data->end(), pointer, pointer + nSamples);
+}
+
+/// @brief Appends the packet's samples to the pending packet's buffer.
+void appendData(const US8::MessageFormats::Broadcasts::DataPacket &packet,
+                PendingPacket *pending)
+{
+    auto dataType = packet.getDataType();
+    if (dataType == DataType::Integer32)
+    {
+        ::append(packet, &pending->integer32Data);
+    }
+    else if (dataType == DataType::Integer64)
+    {
+        ::append(packet, &pending->integer64Data);
+    }
+    else if (dataType == DataType::Float)
+    {
+        ::append(packet, &pending->floatData);
+    }
+    else if (dataType == DataType::Double)
+    {
+        ::append(packet, &pending->doubleData);
+    }
+    else
+    {
+        throw std::invalid_argument("Unhandled data type");
+    }
+}
+
+/// @result The duration of nSamples at the given sampling rate.
+[[nodiscard]] std::chrono::microseconds
+    toDuration(const int nSamples, const double samplingRate)
+{
+    return std::chrono::microseconds
+           {
+               static_cast<int64_t> (std::round(nSamples*1.e6/samplingRate))
+           };
+}
+
+}
+
+class PacketAggregator::PacketAggregatorImpl
+{
+public:
+    PacketAggregatorImpl(const std::chrono::microseconds &maximumDuration,
+                         const std::chrono::milliseconds &maximumLatency) :
+        mMaximumDuration(maximumDuration),
+        mMaximumLatency(maximumLatency)
+    {
+    }
+    /// Opens a pending packet
+    void open(US8::MessageFormats::Broadcasts::DataPacket &&packet,
+              ::PendingPacket *pending)
+    {
+        pending->startTime = packet.getStartTime();
+        pending->samplingRate = packet.getSamplingRate();
+        pending->dataType = packet.getDataType();
+        pending->nSamples = packet.getNumberOfSamples();
+        pending->nPackets = 1;
+        pending->createdTime = std::chrono::steady_clock::now();
+        pending->packet = std::move(packet);
+        pending->active = true;
+        mPendingPackets = mPendingPackets + 1;
+    }
+    /// Releases a pending packet
+    void release(::PendingPacket *pending,
+                 std::vector<US8::MessageFormats::Broadcasts::DataPacket> *readyPackets)
+    {
+        if (!pending->active){return;}
+        // A single packet still has its own data
+        if (pending->nPackets > 1)
+        {
+            if (pending->dataType == DataType::Integer32)
+            {
+                pending->packet.setData(std::move(pending->integer32Data));
+            }
+            else if (pending->dataType == DataType::Integer64)
+            {
+                pending->packet.setData(std::move(pending->integer64Data));
+            }
+            else if (pending->dataType == DataType::Float)
+            {
+                pending->packet.setData(std::move(pending->floatData));
+            }
+            else if (pending->dataType == DataType::Double)
+            {
+                pending->packet.setData(std::move(pending->doubleData));
+            }
+#ifndef NDEBUG
+            assert(pending->packet.getNumberOfSamples() == pending->nSamples);
+#endif
+        }
+        readyPackets->push_back(std::move(pending->packet));
+        pending->integer32Data.clear();
+        pending->integer64Data.clear();
+        pending->floatData.clear();
+        pending->doubleData.clear();
+        pending->nSamples = 0;
+        pending->nPackets = 0;
+        pending->active = false;
+        mPendingPackets = mPendingPackets - 1;
+    }
+    /// @result True indicates the packet continues the pending packet.
+    [[nodiscard]] bool isContiguous(
+        const US8::MessageFormats::Broadcasts::DataPacket &packet,
+        const ::PendingPacket &pending) const
+    {
+        if (packet.getDataType() != pending.dataType){return false;}
+        auto samplingRate = packet.getSamplingRate();
+        if (std::abs(samplingRate - pending.samplingRate) >
+            1.e-6*pending.samplingRate)
+        {
+            return false;
+        }
+        // Allow half a sample of slop for timing jitter
+        auto expectedStartTime
+            = pending.startTime
+            + ::toDuration(pending.nSamples, pending.samplingRate);
+        auto tolerance = ::toDuration(1, 2*pending.samplingRate);
+        auto difference = packet.getStartTime() - expectedStartTime;
+        return std::chrono::abs(difference) <= tolerance;
+    }
+    std::unordered_map<std::string, ::PendingPacket> mPendingPacketsMap;
+    std::chrono::microseconds mMaximumDuration{1000000};
+    std::chrono::milliseconds mMaximumLatency{1000};
+    int mPendingPackets{0};
+};
+
+/// Constructor
+PacketAggregator::PacketAggregator(
+    const std::chrono::microseconds &maximumDuration,
+    const std::chrono::milliseconds &maximumLatency)
+{
+    if (maximumDuration.count() <= 0)
+    {
+        throw std::invalid_argument("Maximum duration must be positive");
+    }
+    if (maximumLatency.count() <= 0)
+    {
+        throw std::invalid_argument("Maximum latency must be positive");
+    }
+    pImpl = std::make_unique<PacketAggregatorImpl> (maximumDuration,
+                                                    maximumLatency);
+}
+
+/// Destructor
+PacketAggregator::~PacketAggregator() = default;
+
+/// Add a packet
+void PacketAggregator::add(
+    US8::MessageFormats::Broadcasts::DataPacket &&packet,
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> *readyPackets)
+{
+    if (readyPackets == nullptr)
+    {
+        throw std::invalid_argument("readyPackets is NULL");
+    }
+    if (!packet.haveSamplingRate())
+    {
+        throw std::invalid_argument("Sampling rate not set");
+    }
+    auto nSamples = packet.getNumberOfSamples();
+    if (nSamples < 1){throw std::invalid_argument("No data in packet");}
+    auto name = ::toName(packet);
+    auto &pending = pImpl->mPendingPacketsMap[name];
+    if (pending.active)
+    {
+        auto mergedDuration
+            = ::toDuration(pending.nSamples + nSamples, pending.samplingRate);
+        if (!pImpl->isContiguous(packet, pending) ||
+            mergedDuration > pImpl->mMaximumDuration)
+        {
+            pImpl->release(&pending, readyPackets);
+        }
+    }
+    if (!pending.active)
+    {
+        pImpl->open(std::move(packet), &pending);
+    }
+    else
+    {
+        // Move the first packet's samples to the merge buffer
+        if (pending.nPackets == 1){::appendData(pending.packet, &pending);}
+        ::appendData(packet, &pending);
+        pending.nSamples = pending.nSamples + nSamples;
+        pending.nPackets = pending.nPackets + 1;
+    }
+    // Full?
+    if (::toDuration(pending.nSamples, pending.samplingRate) >=
+        pImpl->mMaximumDuration)
+    {
+        pImpl->release(&pending, readyPackets);
+    }
+}
+
+/// Flush old packets
+void PacketAggregator::flushExpired(
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> *readyPackets)
+{
+    if (readyPackets == nullptr)
+    {
+        throw std::invalid_argument("readyPackets is NULL");
+    }
+    if (pImpl->mPendingPackets < 1){return;}
+    auto now = std::chrono::steady_clock::now();
+    for (auto &item : pImpl->mPendingPacketsMap)
+    {
+        auto &pending = item.second;
+        if (pending.active &&
+            now - pending.createdTime >= pImpl->mMaximumLatency)
+        {
+            pImpl->release(&pending, readyPackets);
+        }
+    }
+}
+
+/// Flush all packets
+void PacketAggregator::flush(
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> *readyPackets)
+{
+    if (readyPackets == nullptr)
+    {
+        throw std::invalid_argument("readyPackets is NULL");
+    }
+    for (auto &item : pImpl->mPendingPacketsMap)
+    {
+        pImpl->release(&item.second, readyPackets);
+    }
+}
+
+/// Number of pending packets
+int PacketAggregator::getNumberOfPendingPackets() const noexcept
+{
+    return pImpl->mPendingPackets;
+}
@@ -0,0 +1,69 @@
+#ifndef US8_BROADCASTS_DATA_PACKET_SEED_LINK_PACKET_AGGREGATOR_HPP
+#define US8_BROADCASTS_DATA_PACKET_SEED_LINK_PACKET_AGGREGATOR_HPP
+#include <chrono>
+#include <vector>
+#include <memory>
+namespace US8::MessageFormats::Broadcasts
+{
+ class DataPacket;
+}
+namespace US8::Broadcasts::DataPacket::SEEDLink
+{
+/// @class PacketAggregator "packetAggregator.hpp"
+/// @brief SEEDLink records are small so at typical sampling rates each
+///        packet holds well under a second of data.  This merges contiguous
+///        packets from a channel into larger packets to reduce the number of
+///        messages sent downstream.  A channel's pending packet is released
+///        when it reaches the maximum duration, when it has been held for the
+///        maximum latency, or as soon as the next packet is not contiguous or
+///        changes data type or sampling rate.
+/// @note This is not thread-safe.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class PacketAggregator
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] maximumDuration  The maximum duration of an aggregated
+    ///                             packet.
+    /// @param[in] maximumLatency   The maximum time a packet can be held
+    ///                             while waiting for more data.
+    /// @throws std::invalid_argument if maximumDuration or maximumLatency is
+    ///         not positive.
+    PacketAggregator(const std::chrono::microseconds &maximumDuration,
+                     const std::chrono::milliseconds &maximumLatency);
+
+    /// @brief Adds a packet to the aggregator.
+    /// @param[in,out] packet       The packet to add.  On exit, packet's
+    ///                             behavior is undefined.
+    /// @param[in,out] readyPackets Any packets that are ready to be sent are
+    ///                             appended to this.
+    /// @throws std::invalid_argument if readyPackets is NULL or the packet
+    ///         is missing its name, sampling rate, or data.
+    void add(US8::MessageFormats::Broadcasts::DataPacket &&packet,
+             std::vector<US8::MessageFormats::Broadcasts::DataPacket> *readyPackets);
+    /// @brief Releases the pending packets that have been held for at least
+    ///        the maximum latency.
+    /// @param[in,out] readyPackets The released packets are appended to this.
+    /// @throws std::invalid_argument if readyPackets is NULL.
+    void flushExpired(std::vector<US8::MessageFormats::Broadcasts::DataPacket> *readyPackets);
+    /// @brief Releases all pending packets.
+    /// @param[in,out] readyPackets The released packets are appended to this.
+    /// @throws std::invalid_argument if readyPackets is NULL.
+    void flush(std::vector<US8::MessageFormats::Broadcasts::DataPacket> *readyPackets);
+    /// @result The number of channels with a pending packet.
+    [[nodiscard]] int getNumberOfPendingPackets() const noexcept;
+
+    /// @brief Destructor.
+    ~PacketAggregator();
+
+    PacketAggregator() = delete;
+    PacketAggregator(const PacketAggregator &) = delete;
+    PacketAggregator(PacketAggregator &&) noexcept = delete;
+    PacketAggregator& operator=(const PacketAggregator &) = delete;
+    PacketAggregator& operator=(PacketAggregator &&) noexcept = delete;
+private:
+    class PacketAggregatorImpl;
+    std::unique_ptr<PacketAggregatorImpl> pImpl;
+};
+}
+#endif
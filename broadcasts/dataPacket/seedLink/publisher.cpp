@@ -5,11 +5,12 @@
 #include <thread>
 #include <filesystem>
 #include <cerrno>
+#include <cmath>
+#include <cstdio>
 #include <boost/algorithm/string.hpp>
 #include <boost/program_options.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
-#include <readerwriterqueue.h>
 #include <opentelemetry/nostd/shared_ptr.h>
 #include <opentelemetry/metrics/meter.h>
 #include <opentelemetry/metrics/meter_provider.h>
@@ -28,14 +29,22 @@
 #include <opentelemetry/sdk/metrics/view/meter_selector_factory.h>
 #include "client.hpp"
 #include "clientOptions.hpp"
+#include "broadcasts/dataPacket/miniSEED/fileClient.hpp"
+#include "broadcasts/dataPacket/miniSEED/fileClientOptions.hpp"
+#include "broadcasts/dataPacket/sanitizer/testFutureDataPacket.hpp"
+#include "broadcasts/dataPacket/sanitizer/testExpiredDataPacket.hpp"
+#include "broadcasts/dataPacket/sanitizer/testDuplicateDataPacket.hpp"
+#include "packetAggregator.hpp"
+#include "publishingQueue.hpp"
+#include "spillQueue.hpp"
 #include "streamSelector.hpp"
 #include "us8/broadcasts/dataPacket/publisher.hpp"
 #include "us8/broadcasts/dataPacket/publisherOptions.hpp"
 #include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/utilities/clock.hpp"
 
 #define APPLICATION_NAME "seedlink_data_packet_broadcaster"
 #define PROXY_FRONTEND_ADDRESS "tcp://127.0.0.1:5550"
-#define MAX_QUEUE_SIZE 1024
 #define OTEL_VERSION "1.2.0"
 #define OTEL_SCHEMA "https://opentelemetry.io/schemas/1.2.0"
 
@@ -43,11 +52,23 @@ namespace
 {
 std::atomic<bool> mInterrupted{false};
 }
+namespace USanitizer = US8::Broadcasts::DataPacket::Sanitizer;
 
+/// The source of the current time for the inline testers
+enum class ClockType
+{
+    Wall,      // Read the system clock for every packet
+    Coarse,    // Read a system time cached by a ticker thread
+    Simulated  // Packet times drive the clock, e.g., to replay archived data
+};
 
 struct ProgramOptions
 {
-    US8::Broadcasts::DataPacket::SEEDLink::ClientOptions seedLinkClientOptions;
+    std::vector<US8::Broadcasts::DataPacket::SEEDLink::ClientOptions>
+        seedLinkClientOptions;
+    // Replays miniSEED files instead of reading from SEEDLink
+    US8::Broadcasts::DataPacket::MiniSEED::FileClientOptions
+        miniSEEDFileClientOptions;
     std::string prometheusURL{"localhost:9090"};
     std::string applicationName{APPLICATION_NAME};
     std::string openTelemetrySchema{OTEL_SCHEMA};
@@ -60,9 +81,39 @@ struct ProgramOptions
     std::chrono::seconds logPublishingPerformanceInterval{600}; // Every 10 minutes 
     std::chrono::milliseconds openTelemetryExportInterval{60000}; // 1 second
     std::chrono::milliseconds openTelemetryTimeOut{500};
+    // Packets are merged up to this duration.  0 disables aggregation.
+    std::chrono::milliseconds aggregationMaximumDuration{0};
+    std::chrono::milliseconds aggregationMaximumLatency{1000};
+    // Packets waiting to be published
+    US8::Broadcasts::DataPacket::SEEDLink::PublishingQueue::OverflowPolicy
+        queueOverflowPolicy
+    {
+        US8::Broadcasts::DataPacket::SEEDLink::PublishingQueue::OverflowPolicy::DropOldest
+    };
+    int queueCapacity{1024};
+    int maximumBatchSize{64};
+    // Inline sanitizing.  This removes the need for the separate sanitizer
+    // hop.  All tests are disabled by default; in particular, packets
+    // stamped slightly ahead of this machine's clock are not rejected
+    // unless asked.
+    std::chrono::milliseconds maximumFutureTime{0};
+    std::chrono::seconds maximumLatency{-1};
+    std::chrono::seconds circularBufferDuration{0};
+    std::chrono::seconds logBadDataInterval{60};
+    bool useContentHash{false};
+    // The inline testers and the back-fill split read the time from this
+    ::ClockType clock{::ClockType::Wall};
+    std::chrono::milliseconds coarseClockResolution{1};
+    // Packets are spilled here while the proxy is unreachable.  An empty
+    // directory disables spilling.
+    std::filesystem::path spillDirectory;
+    int64_t spillMaximumSizeInBytes{1024*1024*1024};
+    int64_t spillSegmentSizeInBytes{16*1024*1024};
+    double spillMaximumDrainRate{500};
     int sendHighWaterMark{4096};
     int verbosity{3};
-    bool preventFuturePackets{true};
+    bool preventFuturePackets{false};
+    bool useMiniSEEDFiles{false};
 };
 
 ::ProgramOptions parseIniFile(const std::filesystem::path &iniFile);
@@ -159,6 +210,109 @@ public:
 
         mLogPublishingPerformanceInterval
             = options.logPublishingPerformanceInterval;
+        // Packets older than this are back-filled and wait behind real-time
+        // packets
+        for (const auto &clientOptions : options.seedLinkClientOptions)
+        {
+            mBackFillThreshold = std::min(mBackFillThreshold,
+                                          clientOptions.getBackFillThreshold());
+        }
+        // A replay is never dropped.  Instead the replay waits for the
+        // publisher.
+        if (options.useMiniSEEDFiles)
+        {
+            mBackFillThreshold = std::chrono::seconds {-1};
+        }
+        // Acquisition latency is recorded as packets arrive from SEEDLink
+        if (!options.useMiniSEEDFiles)
+        {
+        auto provider = opentelemetry::metrics::Provider::GetMeterProvider();
+        opentelemetry::nostd::shared_ptr<opentelemetry::metrics::Meter>
+            meter = provider->GetMeter(mOptions.applicationName,
+                                       mOptions.openTelemetryVersion);
+        mAcquisitionLatencyHistogram
+            = meter->CreateDoubleHistogram(
+                 mOptions.applicationName + "-acquisition_latency",
+                 "Time between the last sample in a packet and the packet's arrival from SEEDLink",
+                 "ms");
+        }
+        // The testers use the data's clock while the logging and
+        // metrics intervals are always measured in real time
+        if (options.clock == ::ClockType::Simulated)
+        {
+            spdlog::info("Will use packet times as the current time");
+            mSimulatedClock = std::make_shared<US8::Utilities::SimulatedClock> ();
+            mClock = mSimulatedClock;
+            mProcessClock = std::make_shared<US8::Utilities::WallClock> ();
+        }
+        else if (options.clock == ::ClockType::Coarse)
+        {
+            spdlog::info("Will read the time at a resolution of "
+                  + std::to_string(options.coarseClockResolution.count())
+                  + " milliseconds");
+            mClock = std::make_shared<US8::Utilities::CoarseClock>
+                     (options.coarseClockResolution);
+            mProcessClock = mClock;
+        }
+        else
+        {
+            mClock = std::make_shared<US8::Utilities::WallClock> ();
+            mProcessClock = mClock;
+        }
+        // Create the inline testers
+        if (options.preventFuturePackets)
+        {
+            spdlog::info("Will test for future data");
+            // The coarse clock can lag the system clock by its resolution
+            auto maximumFutureTime
+                = std::chrono::duration_cast<std::chrono::microseconds>
+                  (options.maximumFutureTime);
+            if (options.clock == ::ClockType::Coarse)
+            {
+                maximumFutureTime = maximumFutureTime
+                                  + options.coarseClockResolution;
+            }
+            mFutureDataPacketTester
+                = std::make_unique<USanitizer::TestFutureDataPacket>
+                  (maximumFutureTime, options.logBadDataInterval);
+            mFutureDataPacketTester->setClock(mClock);
+        }
+        if (options.maximumLatency.count() > 0)
+        {
+            spdlog::info("Will test for latent data older than "
+                       + std::to_string(options.maximumLatency.count())
+                       + " seconds");
+            mExpiredDataPacketTester
+                = std::make_unique<USanitizer::TestExpiredDataPacket>
+                  (options.maximumLatency, options.logBadDataInterval);
+            mExpiredDataPacketTester->setClock(mClock);
+        }
+        if (options.circularBufferDuration.count() > 0)
+        {
+            spdlog::info("Will test for duplicate data");
+            mDuplicateDataPacketTester
+                = std::make_unique<USanitizer::TestDuplicateDataPacket>
+                  (options.circularBufferDuration, options.logBadDataInterval);
+            mDuplicateDataPacketTester->setUseContentHash(
+                options.useContentHash);
+            mDuplicateDataPacketTester->setClock(mClock);
+        }
+        mPublishingQueue
+            = std::make_unique
+              <US8::Broadcasts::DataPacket::SEEDLink::PublishingQueue>
+              (options.queueCapacity, options.queueOverflowPolicy);
+        if (!options.spillDirectory.empty())
+        {
+            spdlog::info("Will spill packets to "
+                       + options.spillDirectory.string()
+                       + " while the proxy is unreachable");
+            mSpillQueue
+                = std::make_unique
+                  <US8::Broadcasts::DataPacket::SEEDLink::SpillQueue>
+                  (options.spillDirectory,
+                   options.spillMaximumSizeInBytes,
+                   options.spillSegmentSizeInBytes);
+        }
         // Initialize ZMQ publisher
         try
         {
@@ -177,19 +331,63 @@ public:
                               + std::string {e.what()};
             throw std::runtime_error(errorMessage);
         }
-        // Initialize SEEDLink client
-        try
+        // Optionally merge the small SEEDLink packets
+        if (options.aggregationMaximumDuration.count() > 0)
         {
-            mSEEDLinkClient
-                = std::make_unique<US8::Broadcasts::DataPacket::SEEDLink::Client>
-                     (mAddPacketsFromAcquisitionCallback,
-                      options.seedLinkClientOptions);
+            spdlog::info("Aggregating packets up to "
+                  + std::to_string(options.aggregationMaximumDuration.count())
+                  + " ms with a maximum latency of "
+                  + std::to_string(options.aggregationMaximumLatency.count())
+                  + " ms");
+            mPacketAggregator
+                = std::make_unique
+                  <US8::Broadcasts::DataPacket::SEEDLink::PacketAggregator>
+                  (options.aggregationMaximumDuration,
+                   options.aggregationMaximumLatency);
         }
-        catch (const std::exception &e)
+        // Initialize the import client
+        if (options.useMiniSEEDFiles)
         {
-            auto errorMessage = "Failed to create SEEDLink client because "
-                              + std::string {e.what()};
-            throw std::runtime_error(errorMessage);
+            try
+            {
+                mImportClient
+                    = std::make_unique
+                      <US8::Broadcasts::DataPacket::MiniSEED::FileClient>
+                      (mAddPacketsFromAcquisitionCallback,
+                       options.miniSEEDFileClientOptions);
+                mImportClient->connect();
+            }
+            catch (const std::exception &e)
+            {
+                auto errorMessage = "Failed to create miniSEED file client because "
+                                  + std::string {e.what()};
+                throw std::runtime_error(errorMessage);
+            }
+        }
+        else
+        {
+            try
+            {
+                auto seedLinkClient
+                    = std::make_unique<US8::Broadcasts::DataPacket::SEEDLink::Client>
+                         (mAddPacketsFromAcquisitionCallback,
+                          options.seedLinkClientOptions);
+                // The client's decoders share a lock around the callback so
+                // instead of waiting for back-fill space the client stops
+                // reading its back-filling connections
+                seedLinkClient->setBackFillBackPressure([this]()
+                {
+                    return mPublishingQueue->isFull(
+                        US8::Broadcasts::DataPacket::SEEDLink::PublishingQueue::Priority::BackFill);
+                });
+                mImportClient = std::move(seedLinkClient);
+            }
+            catch (const std::exception &e)
+            {
+                auto errorMessage = "Failed to create SEEDLink client because "
+                                  + std::string {e.what()};
+                throw std::runtime_error(errorMessage);
+            }
         }
     }
     /// Destructor
@@ -209,17 +407,24 @@ public:
     {
         stop();
         mKeepRunning = true;
+        mPublishingQueue->open();
         mPublisherThread = std::thread(&::Process::sendPacketsViaZeroMQ, this);
 #ifndef NDEBUG
-        assert(mSEEDLinkClient);
+        assert(mImportClient);
 #endif
-        mSEEDLinkClient->start(); 
+        mImportClient->start(); 
     }
-    /// Stops the threads
+    /// Stops the threads.  The import client is stopped first while the
+    /// publisher is still running so the packets its decoders drain are
+    /// published before their records are acknowledged.  The publisher then
+    /// empties the queue and the aggregator before exiting.  The queue is
+    /// closed last so nothing is stranded in it.
     void stop()
     {
+        if (mImportClient){mImportClient->stop();}
         mKeepRunning = false; 
         if (mPublisherThread.joinable()){mPublisherThread.join();}
+        if (mPublishingQueue){mPublishingQueue->close();}
     }
     /// Sends packets to the proxy via ZeroMQ
     void sendPacketsViaZeroMQ()
@@ -244,18 +449,45 @@ public:
                  notPropagatedGaugeName,
                  "Number of packets not propagated from SEEDLink to ZeroMQ in last minute",
                  "packets/minute");
+        auto queueDepthGauge
+            = meter->CreateInt64Gauge(
+                 mOptions.applicationName + "-publishing_queue_depth_gauge",
+                 "Number of packets waiting to be published",
+                 "packets");
+        auto droppedPacketsGauge
+            = meter->CreateInt64Gauge(
+                 mOptions.applicationName + "-dropped_packets_gauge",
+                 "Number of packets dropped by the publishing queue in last minute",
+                 "packets/minute");
+        auto rejectedPacketsGauge
+            = meter->CreateInt64Gauge(
+                 mOptions.applicationName + "-rejected_packets_gauge",
+                 "Number of future, expired, or duplicate packets rejected in last minute",
+                 "packets/minute");
+        auto spilledPacketsGauge
+            = meter->CreateInt64Gauge(
+                 mOptions.applicationName + "-spilled_packets_gauge",
+                 "Number of packets spilled to disk in last minute",
+                 "packets/minute");
+        auto recoveredPacketsGauge
+            = meter->CreateInt64Gauge(
+                 mOptions.applicationName + "-recovered_packets_gauge",
+                 "Number of spilled packets published in last minute",
+                 "packets/minute");
+        auto spillQueueDepthGauge
+            = meter->CreateInt64Gauge(
+                 mOptions.applicationName + "-spill_queue_depth_gauge",
+                 "Number of packets spilled to disk waiting to be published",
+                 "packets");
         auto context = opentelemetry::context::Context{};
 
 #ifndef NDEBUG
         assert(mPacketPublisher != nullptr);
 #endif
         spdlog::info("Thread entering publisher");
-        std::chrono::milliseconds sleepTime{5};
         bool logPublishingPerformance
             = mLogPublishingPerformanceInterval.count() > 0 ? true : false;
-        auto nowMuSeconds
-            = std::chrono::time_point_cast<std::chrono::microseconds>
-              (std::chrono::high_resolution_clock::now()).time_since_epoch();
+        auto nowMuSeconds = mProcessClock->now();
         auto lastLogTime
             = std::chrono::duration_cast<std::chrono::seconds> (nowMuSeconds);
         auto nextSendMetricTime
@@ -265,48 +497,247 @@ public:
         int64_t nNotSentPackets{0};
         uint64_t nSentPacketsInLastMinute{0};
         uint64_t nNotSentPacketsInLastMinute{0};
-        while (mKeepRunning)
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> readyPackets;
+        // Aggregated packets are checked for expiration at this interval
+        const std::chrono::milliseconds aggregatorFlushInterval
+        {
+            mPacketAggregator ?
+            std::max(std::chrono::milliseconds {1},
+                     std::min(std::chrono::milliseconds {100},
+                              mOptions.aggregationMaximumLatency/4)) :
+            std::chrono::milliseconds {100}
+        };
+        auto nextAggregatorFlushTime
+            = std::chrono::steady_clock::now() + aggregatorFlushInterval;
+        int64_t nSpilledPacketsInLastMinute{0};
+        int64_t nRecoveredPacketsInLastMinute{0};
+        // Without a peer the publisher silently discards packets so they
+        // are spilled instead
+        bool connected{true};
+        auto publishPackets = [&](
+            const std::vector<US8::MessageFormats::Broadcasts::DataPacket>
+                &packetsToSend) -> int64_t
+        {
+            if (packetsToSend.empty()){return 0;}
+            int64_t nSent{0};
+            try
+            {
+                nSent = mPacketPublisher->send(packetsToSend);
+            }
+            catch (const std::exception &e) 
+            {   
+                spdlog::warn("Failed to send messages because "
+                           + std::string {e.what()});
+            }   
+            auto nNotSent
+                = static_cast<int64_t> (packetsToSend.size()) - nSent;
+            if (nNotSent > 0)
+            {
+                spdlog::warn("Failed to send " + std::to_string(nNotSent)
+                           + " messages");
+            }
+            nSentPackets = nSentPackets + nSent;
+            nSentPacketsInLastMinute = nSentPacketsInLastMinute + nSent;
+            nNotSentPackets = nNotSentPackets + nNotSent;
+            nNotSentPacketsInLastMinute = nNotSentPacketsInLastMinute + nNotSent;
+            return nSent;
+        };
+        auto spillPackets = [&](
+            const std::vector<US8::MessageFormats::Broadcasts::DataPacket>
+                &packetsToSpill)
         {
-            if (mQueue.size_approx() > MAX_QUEUE_SIZE)
+            int64_t nNotSpilled{0};
+            for (const auto &packet : packetsToSpill)
             {
-                int nDeleted{0};
-                while (mQueue.size_approx() > MAX_QUEUE_SIZE)
+                try
+                {
+                    if (mSpillQueue->push(packet))
+                    {
+                        nSpilledPacketsInLastMinute
+                            = nSpilledPacketsInLastMinute + 1;
+                        continue;
+                    }
+                }
+                catch (const std::exception &e)
                 {
-                    if (!mQueue.pop()){break;}
-                    nDeleted = nDeleted + 1;
-                } 
-                spdlog::warn("Overfull queue - deleted "
-                           + std::to_string(nDeleted) + " packets");
-                nNotSentPackets = nNotSentPackets + nDeleted;
-                nNotSentPacketsInLastMinute
-                    = nNotSentPacketsInLastMinute + nDeleted;
-            }
-            // Got a packet?
-            auto packet = mQueue.peek();
-            if (packet)
+                    spdlog::debug("Failed to spill packet because "
+                                + std::string {e.what()});
+                }
+                nNotSpilled = nNotSpilled + 1;
+            }
+            if (nNotSpilled > 0)
+            {
+                spdlog::warn("Spill queue full - discarded "
+                           + std::to_string(nNotSpilled) + " packets");
+            }
+            nNotSentPackets = nNotSentPackets + nNotSpilled;
+            nNotSentPacketsInLastMinute
+                = nNotSentPacketsInLastMinute + nNotSpilled;
+            try
+            {
+                mSpillQueue->flush();
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::warn(e.what());
+            }
+        };
+        auto sendPackets = [&](
+            const std::vector<US8::MessageFormats::Broadcasts::DataPacket>
+                &packetsToSend)
+        {
+            if (packetsToSend.empty()){return;}
+            if (mSpillQueue && !connected)
+            {
+                spillPackets(packetsToSend);
+                return;
+            }
+            publishPackets(packetsToSend);
+        };
+        // Spilled packets are drained at a controlled rate so that the
+        // recovery does not crowd out the real-time data
+        double drainCredit{0};
+        auto lastDrainTime = std::chrono::steady_clock::now();
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket>
+            recoveredPackets;
+        auto drainSpilledPackets = [&]()
+        {
+            auto now = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed = now - lastDrainTime;
+            lastDrainTime = now;
+            if (!connected || mSpillQueue->empty())
+            {
+                drainCredit = 0;
+                return;
+            }
+            drainCredit
+                = std::min(mOptions.spillMaximumDrainRate,
+                           drainCredit
+                         + mOptions.spillMaximumDrainRate*elapsed.count());
+            auto nToDrain
+                = std::min(static_cast<size_t> (drainCredit),
+                           static_cast<size_t> (mOptions.maximumBatchSize));
+            if (nToDrain == 0){return;}
+            recoveredPackets.clear();
+            mSpillQueue->peek(&recoveredPackets, nToDrain);
+            // Packets leave the spill queue only once they are sent.  This
+            // stops at the first failure so the sent packets are the oldest.
+            int64_t nSent{0};
+            for (const auto &packet : recoveredPackets)
             {
                 try
                 {
-                    mPacketPublisher->send(*packet);
-                    nSentPackets = nSentPackets + 1;
-                    nSentPacketsInLastMinute = nSentPacketsInLastMinute + 1;
+                    mPacketPublisher->send(packet);
                 }
-                catch (const std::exception &e) 
-                {   
-                    spdlog::warn("Failed to send message because "
+                catch (const std::exception &e)
+                {
+                    spdlog::warn("Failed to send spilled packet because "
                                + std::string {e.what()});
-                     nNotSentPackets = nNotSentPackets + 1;
-                }   
-                if (!mQueue.pop()){spdlog::warn("Queue appears to be empty");}
+                    break;
+                }
+                nSent = nSent + 1;
             }
-            else
+            mSpillQueue->commit(static_cast<size_t> (nSent));
+            try
+            {
+                mSpillQueue->flush();
+            }
+            catch (const std::exception &e)
             {
-                std::this_thread::sleep_for(sleepTime);
+                spdlog::warn(e.what());
             }
+            drainCredit = drainCredit - static_cast<double> (nSent);
+            nSentPackets = nSentPackets + nSent;
+            nSentPacketsInLastMinute = nSentPacketsInLastMinute + nSent;
+            nRecoveredPacketsInLastMinute
+                = nRecoveredPacketsInLastMinute + nSent;
+        };
+        auto sendReadyPackets = [&]()
+        {
+            sendPackets(readyPackets);
+            readyPackets.clear();
+        };
+        auto updateConnected = [&]()
+        {
+            if (!mSpillQueue){return;}
+            auto wasConnected = connected;
+            connected = mPacketPublisher->isConnected();
+            if (wasConnected && !connected)
+            {
+                spdlog::warn("Proxy unreachable; spilling packets to disk");
+            }
+            else if (!wasConnected && connected)
+            {
+                spdlog::info("Proxy reachable; recovering "
+                           + std::to_string(mSpillQueue->size())
+                           + " spilled packets");
+            }
+        };
+        const auto maximumBatchSize
+            = static_cast<size_t> (mOptions.maximumBatchSize);
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket>
+            dequeuedPackets;
+        dequeuedPackets.reserve(maximumBatchSize);
+        auto sendDequeuedPackets = [&]()
+        {
+            if (!mPacketAggregator)
+            {
+                sendPackets(dequeuedPackets);
+                return;
+            }
+            for (auto &dequeuedPacket : dequeuedPackets)
+            {
+                try
+                {
+                    mPacketAggregator->add(std::move(dequeuedPacket),
+                                           &readyPackets);
+                }
+                catch (const std::exception &e)
+                {
+                    spdlog::warn("Failed to aggregate packet because "
+                               + std::string {e.what()});
+                    nNotSentPackets = nNotSentPackets + 1;
+                }
+            }
+            sendReadyPackets();
+        };
+        auto lastDropped = mPublishingQueue->getNumberOfDroppedPackets();
+        int64_t lastRejected = mRejectedPackets.load();
+        while (mKeepRunning)
+        {
+            updateConnected();
+            // Sleep until packets arrive or the aggregator is due
+            auto timeOut = aggregatorFlushInterval;
+            if (mPacketAggregator)
+            {
+                timeOut = std::max(std::chrono::milliseconds {0},
+                                   std::chrono::duration_cast
+                                   <std::chrono::milliseconds>
+                                   (nextAggregatorFlushTime
+                                  - std::chrono::steady_clock::now()));
+            }
+            // Wake regularly while there is a backlog to recover
+            if (mSpillQueue && connected && !mSpillQueue->empty())
+            {
+                timeOut = std::min(timeOut, std::chrono::milliseconds {10});
+            }
+            dequeuedPackets.clear();
+            mPublishingQueue->pop(&dequeuedPackets, maximumBatchSize,
+                                  timeOut);
+            sendDequeuedPackets();
+            // Release aggregated packets that have waited long enough
+            if (mPacketAggregator &&
+                std::chrono::steady_clock::now() >= nextAggregatorFlushTime)
+            {
+                mPacketAggregator->flushExpired(&readyPackets);
+                sendReadyPackets();
+                nextAggregatorFlushTime
+                    = std::chrono::steady_clock::now()
+                    + aggregatorFlushInterval;
+            }
+            if (mSpillQueue){drainSpilledPackets();}
 
-            nowMuSeconds
-                = std::chrono::time_point_cast<std::chrono::microseconds>
-                 (std::chrono::high_resolution_clock::now()).time_since_epoch();
+            nowMuSeconds = mProcessClock->now();
             auto nowSeconds
                 = std::chrono::duration_cast<std::chrono::seconds>
                   (nowMuSeconds);
@@ -325,10 +756,38 @@ public:
             }
             if (nowSeconds >= nextSendMetricTime)
             {
+                auto dropped = mPublishingQueue->getNumberOfDroppedPackets();
+                auto nDroppedInLastMinute = dropped - lastDropped;
+                lastDropped = dropped;
+                if (nDroppedInLastMinute > 0)
+                {
+                    spdlog::warn("Publishing queue dropped "
+                               + std::to_string(nDroppedInLastMinute)
+                               + " packets in last minute");
+                }
+                auto rejected = mRejectedPackets.load();
+                auto nRejectedInLastMinute = rejected - lastRejected;
+                lastRejected = rejected;
                 try
                 {
                     publishedPacketsGauge->Record(nSentPacketsInLastMinute, context);
-                    notPublishedPacketsGauge->Record(nNotSentPacketsInLastMinute, context);
+                    notPublishedPacketsGauge->Record(nNotSentPacketsInLastMinute
+                                                   + nDroppedInLastMinute,
+                                                     context);
+                    queueDepthGauge->Record(
+                        static_cast<int64_t> (mPublishingQueue->size()),
+                        context);
+                    droppedPacketsGauge->Record(nDroppedInLastMinute, context);
+                    rejectedPacketsGauge->Record(nRejectedInLastMinute, context);
+                    if (mSpillQueue)
+                    {
+                        spilledPacketsGauge->Record(
+                            nSpilledPacketsInLastMinute, context);
+                        recoveredPacketsGauge->Record(
+                            nRecoveredPacketsInLastMinute, context);
+                        spillQueueDepthGauge->Record(mSpillQueue->size(),
+                                                     context);
+                    }
                 }
                 catch (const std::exception &e)
                 {
@@ -337,23 +796,49 @@ public:
                 }
                 nSentPacketsInLastMinute = 0;
                 nNotSentPacketsInLastMinute = 0;
+                nSpilledPacketsInLastMinute = 0;
+                nRecoveredPacketsInLastMinute = 0;
                 nextSendMetricTime
                     = nowSeconds + std::chrono::seconds {60};
             }
         }
+        // The import client has stopped so what is queued is the last of
+        // its packets.  These are sent, or spilled, before exiting.
+        updateConnected();
+        int64_t nDrainedPackets{0};
+        while (true)
+        {
+            dequeuedPackets.clear();
+            auto nPopped
+                = mPublishingQueue->pop(&dequeuedPackets, maximumBatchSize,
+                                        std::chrono::milliseconds {0});
+            if (nPopped == 0){break;}
+            nDrainedPackets = nDrainedPackets + static_cast<int64_t> (nPopped);
+            sendDequeuedPackets();
+        }
+        if (mPacketAggregator)
+        {
+            mPacketAggregator->flush(&readyPackets);
+            sendReadyPackets();
+        }
+        if (nDrainedPackets > 0)
+        {
+            spdlog::info("Sent " + std::to_string(nDrainedPackets)
+                       + " queued packets on exit");
+        }
         spdlog::info("Thread exiting publisher");
     }
-    void addPacketsFromAcquisitionCallback(
-        US8::MessageFormats::Broadcasts::DataPacket &&packet)
+    /// Verifies a packet from the import client can be published
+    static void checkPacket(
+        const US8::MessageFormats::Broadcasts::DataPacket &packet)
     {
-        // Check the packet 
         if (!packet.haveNetwork())
         {
             throw std::invalid_argument("Packet does not have network code");
         }
         if (!packet.haveStation())
         {
-            throw std::invalid_argument("Packet does nto have station name");
+            throw std::invalid_argument("Packet does not have station name");
         }
         if (!packet.haveChannel())
         {
@@ -377,11 +862,124 @@ public:
             throw std::runtime_error("Data type not correctly set");
         }
 #endif
-        // Hand it off to the publisher socket
-        if (!mQueue.try_enqueue(std::move(packet)))
+    }
+    /// @result True indicates the packet passes the inline future, expired,
+    ///         and duplicate tests.
+    [[nodiscard]] bool allowPacket(
+        const US8::MessageFormats::Broadcasts::DataPacket &packet)
+    {
+        if (mFutureDataPacketTester &&
+            !mFutureDataPacketTester->allow(packet))
+        {
+            return false;
+        }
+        if (mExpiredDataPacketTester &&
+            !mExpiredDataPacketTester->allow(packet))
+        {
+            return false;
+        }
+        // This is last since it remembers the packets it has seen
+        if (mDuplicateDataPacketTester &&
+            !mDuplicateDataPacketTester->allow(packet))
         {
-            spdlog::warn("Failed to add packet to queue");
+            return false;
         }
+        return true;
+    }
+    /// Advances the simulated clock to the end of the packet.  Archived data
+    /// never ends after the present so a packet that does is not trusted
+    /// to move the clock.
+    void advanceSimulatedClock(
+        const US8::MessageFormats::Broadcasts::DataPacket &dataPacket)
+    {
+        try
+        {
+            auto endTime = dataPacket.getEndTime(); // Throws
+            if (endTime <= mProcessClock->now())
+            {
+                mSimulatedClock->advance(endTime);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::debug("Failed to advance clock because "
+                        + std::string {e.what()});
+        }
+    }
+    /// Sorts a batch of packets from the import client into the real-time
+    /// and back-fill queues.  Each queue receives one bulk enqueue.
+    void addPacketsFromAcquisitionCallback(
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)
+    {
+        // The import client serializes calls so the scratch space is safe
+        mRealTimePackets.clear();
+        mBackFillPackets.clear();
+        for (auto &packet : packets)
+        {
+            try
+            {
+                checkPacket(packet);
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::warn("Skipping packet because "
+                           + std::string {e.what()});
+                continue;
+            }
+            if (mSimulatedClock){advanceSimulatedClock(packet);}
+            auto nowMuSeconds = mClock->now();
+            try
+            {
+                if (!allowPacket(packet))
+                {
+                    mRejectedPackets.fetch_add(1);
+                    continue;
+                }
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::warn("Failed to scrutinize packet because "
+                           + std::string {e.what()});
+                mRejectedPackets.fetch_add(1);
+                continue;
+            }
+            // Acquisition latency is arrival time minus the last sample time
+            bool isBackFill{false};
+            try
+            {
+                auto latency = nowMuSeconds - packet.getEndTime();
+                isBackFill = latency > mBackFillThreshold;
+                if (mAcquisitionLatencyHistogram)
+                {
+                    mAcquisitionLatencyHistogram->Record(latency.count()*1.e-3,
+                                                         mMetricsContext);
+                }
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::debug("Failed to record acquisition latency because "
+                            + std::string {e.what()});
+            }
+            if (isBackFill)
+            {
+                mBackFillPackets.push_back(std::move(packet));
+            }
+            else
+            {
+                mRealTimePackets.push_back(std::move(packet));
+            }
+        }
+        // Hand it off to the publisher socket.  Back-fill is not dropped.
+        // A replay waits for space.  The SEEDLink client must not block here
+        // so its back-fill may overrun the lane; it stops reading its
+        // back-filling connections until the lane has space.
+        using Priority
+            = US8::Broadcasts::DataPacket::SEEDLink::PublishingQueue::Priority;
+        mPublishingQueue->push(std::move(mRealTimePackets),
+                               Priority::RealTime);
+        mPublishingQueue->push(std::move(mBackFillPackets),
+                               Priority::BackFill,
+                               mOptions.useMiniSEEDFiles);
     }
     /// Place for the main thread to sleep until someone wakes it up.
     void handleMainThread()
@@ -397,6 +995,13 @@ public:
                     mStopRequested = true;
                     break;
                 }   
+                // A finished replay stops once its packets are sent
+                if (isReplayFinished())
+                {
+                    spdlog::info("Replay finished");
+                    mStopRequested = true;
+                    break;
+                }
                 std::this_thread::sleep_for(std::chrono::milliseconds {50});
             }
         }
@@ -406,6 +1011,19 @@ public:
             stop();
         }
     }
+    /// @result True indicates a file replay has finished and its packets
+    ///         have left the queues.
+    [[nodiscard]] bool isReplayFinished()
+    {
+        if (!mImportClient){return false;}
+        if (mImportClient->getType() !=
+            US8::Broadcasts::DataPacket::IImportClient::Type::MiniSEEDFile)
+        {
+            return false;
+        }
+        if (mImportClient->isConnected()){return false;}
+        return mPublishingQueue->size() == 0;
+    }
     /// Handles sigterm and sigint
     static void signalHandler(const int )
     {   
@@ -426,19 +1044,42 @@ public:
     std::thread mPublisherThread;
     std::unique_ptr<US8::Broadcasts::DataPacket::Publisher>
         mPacketPublisher{nullptr};
-    moodycamel::ReaderWriterQueue<US8::MessageFormats::Broadcasts::DataPacket>
-        mQueue{MAX_QUEUE_SIZE};
-    std::unique_ptr<US8::Broadcasts::DataPacket::SEEDLink::Client>
-        mSEEDLinkClient{nullptr};
+    std::unique_ptr<US8::Broadcasts::DataPacket::SEEDLink::PublishingQueue>
+        mPublishingQueue{nullptr};
+    std::unique_ptr<US8::Broadcasts::DataPacket::SEEDLink::SpillQueue>
+        mSpillQueue{nullptr};
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> mRealTimePackets;
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> mBackFillPackets;
+    std::unique_ptr<US8::Broadcasts::DataPacket::IImportClient>
+        mImportClient{nullptr};
+    std::unique_ptr<US8::Broadcasts::DataPacket::SEEDLink::PacketAggregator>
+        mPacketAggregator{nullptr};
+    std::unique_ptr<USanitizer::TestFutureDataPacket>
+        mFutureDataPacketTester{nullptr};
+    std::unique_ptr<USanitizer::TestExpiredDataPacket>
+        mExpiredDataPacketTester{nullptr};
+    std::unique_ptr<USanitizer::TestDuplicateDataPacket>
+        mDuplicateDataPacketTester{nullptr};
+    // The testers' clock
+    std::shared_ptr<const US8::Utilities::IClock> mClock{nullptr};
+    // Set when packet times drive the testers' clock
+    std::shared_ptr<US8::Utilities::SimulatedClock> mSimulatedClock{nullptr};
+    // The logging and metrics clock
+    std::shared_ptr<const US8::Utilities::IClock> mProcessClock{nullptr};
+    std::atomic<int64_t> mRejectedPackets{0};
     std::unique_ptr<opentelemetry::sdk::metrics::PushMetricExporter>
         mMetricsExporter{nullptr};
-    std::function<void(US8::MessageFormats::Broadcasts::DataPacket &&packet)>
+    opentelemetry::nostd::unique_ptr<opentelemetry::metrics::Histogram<double>>
+        mAcquisitionLatencyHistogram{nullptr};
+    opentelemetry::context::Context mMetricsContext{};
+    std::function<void(std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)>
         mAddPacketsFromAcquisitionCallback
     {
         std::bind(&::Process::addPacketsFromAcquisitionCallback, this,
                   std::placeholders::_1)
     };
     std::chrono::seconds mLogPublishingPerformanceInterval{600};
+    std::chrono::seconds mBackFillThreshold{std::chrono::seconds::max()};
     std::atomic<bool> mKeepRunning{true};
     bool mStopRequested{false};
 };
@@ -524,6 +1165,8 @@ std::pair<std::string, bool> parseCommandLineOptions(int argc, char *argv[])
     boost::program_options::options_description desc(R"""(
 The seedLinkDataPacketBroadcastPublisher reads packets from a SEEDLink 
 server then propagates them to a US8 data packet broadcasts proxy.
+Alternatively, it can replay miniSEED files listed in the [MiniSEED]
+section of the initialization file.
 Example usage is
 
     seedLinkDataPacketBroadcastPublisher --ini=loader.ini
@@ -554,6 +1197,40 @@ Allowed options)""");
     return {iniFile, false};
 }
 
+/// Converts a UTC time string - e.g., 2024-01-01T00:00:00 - to microseconds
+/// from the epoch
+[[nodiscard]] std::chrono::microseconds parseTime(const std::string &timeString)
+{
+    int year{0};
+    unsigned int month{0};
+    unsigned int day{0};
+    int hour{0};
+    int minute{0};
+    double second{0};
+    auto nRead = std::sscanf(timeString.c_str(), "%d-%u-%uT%d:%d:%lf",
+                             &year, &month, &day, &hour, &minute, &second);
+    std::chrono::year_month_day date{std::chrono::year {year},
+                                     std::chrono::month {month},
+                                     std::chrono::day {day}};
+    if (nRead < 3 || !date.ok() ||
+        hour < 0 || hour > 23 || minute < 0 || minute > 59 ||
+        second < 0 || second >= 61)
+    {
+        throw std::invalid_argument("Could not parse time " + timeString
+                                  + "; expecting YYYY-MM-DDThh:mm:ss");
+    }
+    std::chrono::microseconds time
+    {
+        std::chrono::duration_cast<std::chrono::microseconds>
+            (std::chrono::sys_days {date}.time_since_epoch())
+    };
+    return time
+         + std::chrono::hours {hour}
+         + std::chrono::minutes {minute}
+         + std::chrono::microseconds
+           {static_cast<int64_t> (std::round(second*1.e6))};
+}
+
 [[nodiscard]] US8::Broadcasts::DataPacket::SEEDLink::ClientOptions
 getSEEDLinkOptions(const boost::property_tree::ptree &propertyTree,
                    const std::string &clientName)
@@ -564,6 +1241,41 @@ getSEEDLinkOptions(const boost::property_tree::ptree &propertyTree,
     auto port = propertyTree.get<uint16_t> (clientName + ".port", 18000);
     clientOptions.setAddress(address);
     clientOptions.setPort(port);
+    auto nDecoderThreads
+        = propertyTree.get<int> (clientName + ".numberOfDecoderThreads",
+                                 clientOptions.getNumberOfDecoderThreads());
+    clientOptions.setNumberOfDecoderThreads(nDecoderThreads);
+    auto nConnections
+        = propertyTree.get<int> (clientName + ".numberOfConnections",
+                                 clientOptions.getNumberOfConnections());
+    clientOptions.setNumberOfConnections(nConnections);
+    auto stateFile
+        = propertyTree.get<std::string> (clientName + ".stateFile", "");
+    if (!stateFile.empty())
+    {
+        clientOptions.setStateFile(stateFile);
+        auto stateFileUpdateInterval
+            = propertyTree.get<uint16_t> (
+                 clientName + ".stateFileUpdateInterval",
+                 clientOptions.getStateFileUpdateInterval());
+        clientOptions.setStateFileUpdateInterval(stateFileUpdateInterval);
+        auto stateFileUpdateTimeInterval
+            = propertyTree.get<int> (
+                 clientName + ".stateFileUpdateTimeIntervalInSeconds",
+                 static_cast<int> (
+                    clientOptions.getStateFileUpdateTimeInterval().count()));
+        clientOptions.setStateFileUpdateTimeInterval(
+            std::chrono::seconds {stateFileUpdateTimeInterval});
+    }
+    auto backFillThreshold
+        = propertyTree.get<int> (clientName + ".backFillThresholdInSeconds",
+              static_cast<int> (clientOptions.getBackFillThreshold().count()));
+    clientOptions.setBackFillThreshold(
+        std::chrono::seconds {backFillThreshold});
+    auto maximumBackFillRate
+        = propertyTree.get<double> (clientName + ".maximumBackFillRate",
+                                    clientOptions.getMaximumBackFillRate());
+    clientOptions.setMaximumBackFillRate(maximumBackFillRate);
     for (int iSelector = 1; iSelector <= 32768; ++iSelector)
     {
         std::string selectorName{clientName
@@ -578,6 +1290,8 @@ getSEEDLinkOptions(const boost::property_tree::ptree &propertyTree,
                          boost::is_any_of(",|"));
             // A selector string can look like:
             // UU.FORK.HH?.01 | UU.CTU.EN?.01 | ....
+            // A back-fill window can follow the data type - e.g.,
+            // UU FORK HH? 01 D 2024-01-01T00:00:00 2024-01-02T00:00:00
             for (const auto &thisSplitSelector : splitSelectors)
             {
                 std::vector<std::string> thisSelector; 
@@ -595,7 +1309,7 @@ getSEEDLinkOptions(const boost::property_tree::ptree &propertyTree,
                 boost::algorithm::trim(thisSelector.at(0));
                 selector.setNetwork(thisSelector.at(0));
                 // Add a station?
-                if (splitSelector.size() > 1)
+                if (thisSelector.size() > 1)
                 {
                     boost::algorithm::trim(thisSelector.at(1));
                     selector.setStation(thisSelector.at(1));
@@ -603,19 +1317,19 @@ getSEEDLinkOptions(const boost::property_tree::ptree &propertyTree,
                 // Add channel + location code + data type
                 std::string channel{"*"};
                 std::string locationCode{"??"};
-                if (splitSelector.size() > 2)
+                if (thisSelector.size() > 2)
                 {
                     boost::algorithm::trim(thisSelector.at(2));
                     channel = thisSelector.at(2);
                 }
-                if (splitSelector.size() > 3)
+                if (thisSelector.size() > 3)
                 {
                     boost::algorithm::trim(thisSelector.at(3));
                     locationCode = thisSelector.at(3);
                 }
                 // Data type
                 auto dataType = USL::StreamSelector::Type::All;
-                if (splitSelector.size() > 4)
+                if (thisSelector.size() > 4)
                 {
                     boost::algorithm::trim(thisSelector.at(4));
                     if (thisSelector.at(4) == "D")
@@ -629,6 +1343,15 @@ getSEEDLinkOptions(const boost::property_tree::ptree &propertyTree,
                     // TODO other data types
                 }
                 selector.setSelector(channel, locationCode, dataType);
+                // Back-fill window
+                if (thisSelector.size() > 5)
+                {
+                    selector.setStartTime(::parseTime(thisSelector.at(5)));
+                }
+                if (thisSelector.size() > 6)
+                {
+                    selector.setEndTime(::parseTime(thisSelector.at(6)));
+                }
                 clientOptions.addStreamSelector(selector);
             } // Loop on selectors
         } // End check on selector string
@@ -673,11 +1396,205 @@ getSEEDLinkOptions(const boost::property_tree::ptree &propertyTree,
     if (sendTimeOut < 0){sendTimeOut = -1;}
     options.sendTimeOut = std::chrono::milliseconds {sendTimeOut}; 
                                          
-    // SEEDLink properties
+    // Packet aggregation
+    auto aggregationMaximumDuration
+        = static_cast<int> (options.aggregationMaximumDuration.count());
+    aggregationMaximumDuration
+        = propertyTree.get<int> ("Aggregator.maximumDurationInMilliSeconds",
+                                 aggregationMaximumDuration);
+    if (aggregationMaximumDuration < 0){aggregationMaximumDuration = 0;}
+    options.aggregationMaximumDuration
+        = std::chrono::milliseconds {aggregationMaximumDuration};
+    auto aggregationMaximumLatency
+        = static_cast<int> (options.aggregationMaximumLatency.count());
+    aggregationMaximumLatency
+        = propertyTree.get<int> ("Aggregator.maximumLatencyInMilliSeconds",
+                                 aggregationMaximumLatency);
+    if (aggregationMaximumDuration > 0 && aggregationMaximumLatency <= 0)
+    {
+        throw std::invalid_argument(
+            "Aggregator.maximumLatencyInMilliSeconds must be positive");
+    }
+    options.aggregationMaximumLatency
+        = std::chrono::milliseconds {aggregationMaximumLatency};
+
+    // Publishing queue
+    options.queueCapacity
+        = propertyTree.get<int> ("PublishingQueue.capacity",
+                                 options.queueCapacity);
+    if (options.queueCapacity < 1)
+    {
+        throw std::invalid_argument("PublishingQueue.capacity must be positive");
+    }
+    auto overflowPolicy
+        = propertyTree.get_optional<std::string>
+          ("PublishingQueue.overflowPolicy");
+    if (overflowPolicy)
+    {
+        options.queueOverflowPolicy
+            = US8::Broadcasts::DataPacket::SEEDLink::PublishingQueue
+              ::toOverflowPolicy(*overflowPolicy);
+    }
+    options.maximumBatchSize
+        = propertyTree.get<int> ("PublishingQueue.maximumBatchSize",
+                                 options.maximumBatchSize);
+    if (options.maximumBatchSize < 1)
+    {
+        throw std::invalid_argument(
+            "PublishingQueue.maximumBatchSize must be positive");
+    }
+
+    // Spill queue
+    options.spillDirectory
+        = propertyTree.get<std::string> ("SpillQueue.directory",
+                                         options.spillDirectory.string());
+    if (!options.spillDirectory.empty())
+    {
+        auto maximumSizeInMegaBytes
+            = propertyTree.get<int64_t> ("SpillQueue.maximumSizeInMegaBytes",
+                  options.spillMaximumSizeInBytes/(1024*1024));
+        auto segmentSizeInMegaBytes
+            = propertyTree.get<int64_t> ("SpillQueue.segmentSizeInMegaBytes",
+                  options.spillSegmentSizeInBytes/(1024*1024));
+        if (segmentSizeInMegaBytes < 1)
+        {
+            throw std::invalid_argument(
+                "SpillQueue.segmentSizeInMegaBytes must be positive");
+        }
+        if (maximumSizeInMegaBytes < segmentSizeInMegaBytes)
+        {
+            throw std::invalid_argument(
+               "SpillQueue.maximumSizeInMegaBytes must be at least the segment size");
+        }
+        options.spillMaximumSizeInBytes = maximumSizeInMegaBytes*1024*1024;
+        options.spillSegmentSizeInBytes = segmentSizeInMegaBytes*1024*1024;
+        options.spillMaximumDrainRate
+            = propertyTree.get<double> ("SpillQueue.maximumDrainRate",
+                                        options.spillMaximumDrainRate);
+        if (options.spillMaximumDrainRate <= 0)
+        {
+            throw std::invalid_argument(
+                "SpillQueue.maximumDrainRate must be positive");
+        }
+    }
+
+    // Inline sanitizing
+    options.preventFuturePackets
+        = propertyTree.get<bool> ("Sanitizer.preventFuturePackets",
+                                  options.preventFuturePackets);
+    auto maximumFutureTimeInMilliSeconds
+        = static_cast<int> (options.maximumFutureTime.count());
+    maximumFutureTimeInMilliSeconds
+        = propertyTree.get<int> ("Sanitizer.maximumFutureTimeInMilliSeconds",
+                                 maximumFutureTimeInMilliSeconds);
+    if (maximumFutureTimeInMilliSeconds < 0)
+    {
+        options.preventFuturePackets = false;
+    }
+    options.maximumFutureTime
+        = std::chrono::milliseconds {maximumFutureTimeInMilliSeconds};
+    auto maximumLatencyInSeconds
+        = static_cast<int> (options.maximumLatency.count());
+    maximumLatencyInSeconds
+        = propertyTree.get<int> ("Sanitizer.maximumLatencyInSeconds",
+                                 maximumLatencyInSeconds);
+    options.maximumLatency = std::chrono::seconds {maximumLatencyInSeconds};
+    auto circularBufferDurationInSeconds
+        = static_cast<int> (options.circularBufferDuration.count());
+    circularBufferDurationInSeconds
+        = propertyTree.get<int> ("Sanitizer.circularBufferDurationInSeconds",
+                                 circularBufferDurationInSeconds);
+    options.circularBufferDuration
+        = std::chrono::seconds {circularBufferDurationInSeconds};
+    auto logBadDataIntervalInSeconds
+        = static_cast<int> (options.logBadDataInterval.count());
+    logBadDataIntervalInSeconds
+        = propertyTree.get<int> ("Sanitizer.logBadDataIntervalInSeconds",
+                                 logBadDataIntervalInSeconds);
+    options.logBadDataInterval
+        = std::chrono::seconds {logBadDataIntervalInSeconds};
+    options.useContentHash
+        = propertyTree.get<bool> ("Sanitizer.useContentHash",
+                                  options.useContentHash);
+    auto clock
+        = propertyTree.get<std::string> ("Sanitizer.clock", "wall");
+    boost::algorithm::to_lower(clock);
+    if (clock == "wall")
+    {
+        options.clock = ::ClockType::Wall;
+    }
+    else if (clock == "coarse")
+    {
+        options.clock = ::ClockType::Coarse;
+    }
+    else if (clock == "simulated")
+    {
+        options.clock = ::ClockType::Simulated;
+    }
+    else
+    {
+        throw std::invalid_argument(
+           "Sanitizer.clock must be wall, coarse, or simulated");
+    }
+    auto coarseClockResolutionInMilliSeconds
+        = static_cast<int> (options.coarseClockResolution.count());
+    coarseClockResolutionInMilliSeconds
+        = propertyTree.get<int> (
+             "Sanitizer.coarseClockResolutionInMilliSeconds",
+             coarseClockResolutionInMilliSeconds);
+    if (coarseClockResolutionInMilliSeconds <= 0)
+    {
+        throw std::invalid_argument(
+           "Sanitizer.coarseClockResolutionInMilliSeconds must be positive");
+    }
+    options.coarseClockResolution
+        = std::chrono::milliseconds {coarseClockResolutionInMilliSeconds};
+
+    // SEEDLink properties.  Additional servers are specified in the
+    // sections SEEDLink_1, SEEDLink_2, ...
     if (propertyTree.get_optional<std::string> ("SEEDLink.address"))
     {
-        options.seedLinkClientOptions 
-             = ::getSEEDLinkOptions(propertyTree, "SEEDLink");
+        options.seedLinkClientOptions.push_back(
+             ::getSEEDLinkOptions(propertyTree, "SEEDLink"));
+    }
+    for (int iClient = 1; iClient <= 256; ++iClient)
+    {
+        std::string clientName{"SEEDLink_" + std::to_string(iClient)};
+        if (propertyTree.get_optional<std::string> (clientName + ".address"))
+        {
+            options.seedLinkClientOptions.push_back(
+                ::getSEEDLinkOptions(propertyTree, clientName));
+        }
+    }
+    // miniSEED file replay.  This replaces the SEEDLink servers.
+    for (int iPath = 1; iPath <= 4096; ++iPath)
+    {
+        auto path = propertyTree.get_optional<std::string>
+                    ("MiniSEED.path_" + std::to_string(iPath));
+        if (path)
+        {
+            options.miniSEEDFileClientOptions.addPath(*path);
+            options.useMiniSEEDFiles = true;
+        }
+    }
+    if (options.useMiniSEEDFiles)
+    {
+        options.miniSEEDFileClientOptions.setReplaySpeed(
+            propertyTree.get<double> ("MiniSEED.replaySpeed",
+                options.miniSEEDFileClientOptions.getReplaySpeed()));
+        options.miniSEEDFileClientOptions.setShiftToCurrentTime(
+            propertyTree.get<bool> ("MiniSEED.shiftToCurrentTime",
+                options.miniSEEDFileClientOptions.shiftToCurrentTime()));
+        if (!options.seedLinkClientOptions.empty())
+        {
+            spdlog::warn("Replaying miniSEED files; ignoring SEEDLink servers");
+            options.seedLinkClientOptions.clear();
+        }
+    }
+    if (options.seedLinkClientOptions.empty() && !options.useMiniSEEDFiles)
+    {
+        throw std::invalid_argument(
+            "No SEEDLink servers or miniSEED files specified");
     }
 
     auto logPublishingPerformanceIntervalInSeconds
@@ -0,0 +1,232 @@
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include "publishingQueue.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+
+using namespace US8::Broadcasts::DataPacket::SEEDLink;
+
+class PublishingQueue::PublishingQueueImpl
+{
+public:
+    PublishingQueueImpl(const int capacity, const OverflowPolicy policy) :
+        mCapacity(static_cast<size_t> (capacity)),
+        mPolicy(policy)
+    {
+    }
+    /// Moves packets into a lane past its capacity
+    int pushUnbounded(
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> &packets,
+        std::deque<US8::MessageFormats::Broadcasts::DataPacket> &lane)
+    {
+        if (mClosed){return static_cast<int> (packets.size());}
+        for (auto &packet : packets)
+        {
+            lane.push_back(std::move(packet));
+        }
+        mNotEmpty.notify_one();
+        return 0;
+    }
+    /// Moves packets into a lane.  The lock is released while waiting for
+    /// space.
+    int pushBlocking(
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> &packets,
+        std::deque<US8::MessageFormats::Broadcasts::DataPacket> &lane,
+        std::unique_lock<std::mutex> &lock)
+    {
+        size_t index{0};
+        while (index < packets.size())
+        {
+            mNotFull.wait(lock, [&]()
+                          {
+                              return mClosed || lane.size() < mCapacity;
+                          });
+            if (mClosed){break;}
+            auto nCopy = std::min(packets.size() - index,
+                                  mCapacity - lane.size());
+            for (size_t i = 0; i < nCopy; ++i)
+            {
+                lane.push_back(std::move(packets[index + i]));
+            }
+            index = index + nCopy;
+            mNotEmpty.notify_one();
+        }
+        return static_cast<int> (packets.size() - index);
+    }
+    std::deque<US8::MessageFormats::Broadcasts::DataPacket> mRealTimeLane;
+    std::deque<US8::MessageFormats::Broadcasts::DataPacket> mBackFillLane;
+    mutable std::mutex mMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+    std::atomic<int64_t> mDropped{0};
+    size_t mCapacity{1024};
+    OverflowPolicy mPolicy{OverflowPolicy::DropOldest};
+    bool mClosed{false};
+};
+
+/// Constructor
+PublishingQueue::PublishingQueue(const int capacity,
+                                 const OverflowPolicy policy)
+{
+    if (capacity < 1)
+    {
+        throw std::invalid_argument("Capacity must be positive");
+    }
+    pImpl = std::make_unique<PublishingQueueImpl> (capacity, policy);
+}
+
+/// Destructor
+PublishingQueue::~PublishingQueue() = default;
+
+/// Push
+int PublishingQueue::push(
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets,
+    const Priority priority,
+    const bool waitForSpace)
+{
+    if (packets.empty()){return 0;}
+    int nDropped{0};
+    {
+    std::unique_lock<std::mutex> lock(pImpl->mMutex);
+    if (priority == Priority::BackFill ||
+        pImpl->mPolicy == OverflowPolicy::Block)
+    {
+        auto &lane = priority == Priority::BackFill ?
+                     pImpl->mBackFillLane : pImpl->mRealTimeLane;
+        if (waitForSpace)
+        {
+            nDropped = pImpl->pushBlocking(packets, lane, lock);
+        }
+        else
+        {
+            nDropped = pImpl->pushUnbounded(packets, lane);
+        }
+    }
+    else if (pImpl->mClosed)
+    {
+        // Nothing would ever remove them
+        nDropped = static_cast<int> (packets.size());
+    }
+    else
+    {
+        auto &lane = pImpl->mRealTimeLane;
+        const auto capacity = pImpl->mCapacity;
+        if (pImpl->mPolicy == OverflowPolicy::DropNewest)
+        {
+            auto nCopy = std::min(packets.size(),
+                                  capacity - std::min(capacity, lane.size()));
+            for (size_t i = 0; i < nCopy; ++i)
+            {
+                lane.push_back(std::move(packets[i]));
+            }
+            nDropped = static_cast<int> (packets.size() - nCopy);
+        }
+        else
+        {
+            for (auto &packet : packets)
+            {
+                lane.push_back(std::move(packet));
+            }
+            while (lane.size() > capacity)
+            {
+                lane.pop_front();
+                nDropped = nDropped + 1;
+            }
+        }
+        pImpl->mNotEmpty.notify_one();
+    }
+    }
+    if (nDropped > 0){pImpl->mDropped += nDropped;}
+    return nDropped;
+}
+
+/// Pop
+size_t PublishingQueue::pop(
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> *packets,
+    const size_t maximumPackets,
+    const std::chrono::milliseconds &timeOut)
+{
+    if (packets == nullptr){throw std::invalid_argument("packets is NULL");}
+    if (maximumPackets == 0){return 0;}
+    size_t nPopped{0};
+    {
+    std::unique_lock<std::mutex> lock(pImpl->mMutex);
+    pImpl->mNotEmpty.wait_for(lock, timeOut, [this]()
+                              {
+                                  return pImpl->mClosed ||
+                                         !pImpl->mRealTimeLane.empty() ||
+                                         !pImpl->mBackFillLane.empty();
+                              });
+    // Real-time packets go first
+    for (auto lane : {&pImpl->mRealTimeLane, &pImpl->mBackFillLane})
+    {
+        while (!lane->empty() && nPopped < maximumPackets)
+        {
+            packets->push_back(std::move(lane->front()));
+            lane->pop_front();
+            nPopped = nPopped + 1;
+        }
+    }
+    }
+    if (nPopped > 0){pImpl->mNotFull.notify_all();}
+    return nPopped;
+}
+
+/// Close
+void PublishingQueue::close()
+{
+    {
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mClosed = true;
+    }
+    pImpl->mNotFull.notify_all();
+    pImpl->mNotEmpty.notify_all();
+}
+
+/// Open
+void PublishingQueue::open()
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mClosed = false;
+}
+
+/// Full?
+bool PublishingQueue::isFull(const Priority priority) const
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    const auto &lane = priority == Priority::BackFill ?
+                       pImpl->mBackFillLane : pImpl->mRealTimeLane;
+    return lane.size() >= pImpl->mCapacity;
+}
+
+/// Size
+size_t PublishingQueue::size() const
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mRealTimeLane.size() + pImpl->mBackFillLane.size();
+}
+
+/// Dropped packets
+int64_t PublishingQueue::getNumberOfDroppedPackets() const noexcept
+{
+    return pImpl->mDropped.load();
+}
+
+/// Policy from string
+PublishingQueue::OverflowPolicy
+PublishingQueue::toOverflowPolicy(const std::string &policyIn)
+{
+    auto policy = policyIn;
+    boost::algorithm::trim(policy);
+    boost::algorithm::to_lower(policy);
+    if (policy == "dropoldest"){return OverflowPolicy::DropOldest;}
+    if (policy == "dropnewest"){return OverflowPolicy::DropNewest;}
+    if (policy == "block"){return OverflowPolicy::Block;}
+    throw std::invalid_argument("Unhandled overflow policy " + policyIn
+                              + "; expecting dropOldest, dropNewest, or block");
+}
@@ -0,0 +1,103 @@
+#ifndef US8_BROADCASTS_DATA_PACKET_SEED_LINK_PUBLISHING_QUEUE_HPP
+#define US8_BROADCASTS_DATA_PACKET_SEED_LINK_PUBLISHING_QUEUE_HPP
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+namespace US8::MessageFormats::Broadcasts
+{
+ class DataPacket;
+}
+namespace US8::Broadcasts::DataPacket::SEEDLink
+{
+/// @class PublishingQueue "publishingQueue.hpp"
+/// @brief Holds the packets waiting to be published.  Real-time and back-fill
+///        packets are held in separate lanes and real-time packets are always
+///        removed first.  The consumer blocks until packets arrive and then
+///        drains up to a batch of packets at once.
+/// @note This is thread-safe.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class PublishingQueue
+{
+public:
+    /// @brief Defines what happens when the real-time lane is full.
+    enum class OverflowPolicy
+    {
+        DropOldest, /*!< The oldest queued packets are discarded. */
+        DropNewest, /*!< The incoming packets are discarded. */
+        Block       /*!< The producer waits for space. */
+    };
+    /// @brief Defines the lane to which packets are added.
+    enum class Priority
+    {
+        RealTime, /*!< Subject to the overflow policy. */
+        BackFill  /*!< Never dropped; the producer waits for space or
+                       watches isFull(). */
+    };
+public:
+    /// @brief Constructor.
+    /// @param[in] capacity  The maximum number of packets in each lane.
+    /// @param[in] policy    The overflow policy for the real-time lane.
+    /// @throws std::invalid_argument if capacity is not positive.
+    PublishingQueue(int capacity, OverflowPolicy policy);
+
+    /// @brief Adds packets to the queue.
+    /// @param[in,out] packets  The packets to add.  On exit, packets's
+    ///                         behavior is undefined.
+    /// @param[in] priority     The lane to which to add the packets.
+    /// @param[in] waitForSpace If false then packets that would wait for
+    ///                         space are added beyond the lane's capacity
+    ///                         instead.  A producer that must not block,
+    ///                         e.g., one holding a lock shared with other
+    ///                         producers, uses this and stops producing
+    ///                         while isFull() is true.
+    /// @result The number of packets dropped to make room or that could not
+    ///         be added.
+    /// @note If the queue is closed, or is closed while this is waiting for
+    ///       space, then the remaining packets are discarded and counted as
+    ///       dropped.
+    int push(std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets,
+             Priority priority,
+             bool waitForSpace = true);
+    /// @brief Removes up to maximumPackets packets from the queue.  Real-time
+    ///        packets are removed first.
+    /// @param[out] packets       The removed packets are appended to this.
+    /// @param[in] maximumPackets The maximum number of packets to remove.
+    /// @param[in] timeOut        The maximum time to wait for a packet.
+    /// @result The number of packets removed.
+    /// @throws std::invalid_argument if packets is NULL.
+    size_t pop(std::vector<US8::MessageFormats::Broadcasts::DataPacket> *packets,
+               size_t maximumPackets,
+               const std::chrono::milliseconds &timeOut);
+    /// @brief Wakes any waiting producers and consumers.  Producers waiting
+    ///        for space give up.
+    void close();
+    /// @brief Re-opens a closed queue.
+    void open();
+
+    /// @result True indicates the lane is at or beyond its capacity.
+    [[nodiscard]] bool isFull(Priority priority) const;
+    /// @result The number of queued packets in both lanes.
+    [[nodiscard]] size_t size() const;
+    /// @result The total number of packets dropped.
+    [[nodiscard]] int64_t getNumberOfDroppedPackets() const noexcept;
+
+    /// @result The overflow policy corresponding to the string - e.g.,
+    ///         dropOldest, dropNewest, or block.
+    /// @throws std::invalid_argument if the string is not recognized.
+    [[nodiscard]] static OverflowPolicy toOverflowPolicy(const std::string &policy);
+
+    /// @brief Destructor.
+    ~PublishingQueue();
+
+    PublishingQueue() = delete;
+    PublishingQueue(const PublishingQueue &) = delete;
+    PublishingQueue(PublishingQueue &&) noexcept = delete;
+    PublishingQueue& operator=(const PublishingQueue &) = delete;
+    PublishingQueue& operator=(PublishingQueue &&) noexcept = delete;
+private:
+    class PublishingQueueImpl;
+    std::unique_ptr<PublishingQueueImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,478 @@
+#include <string>
+#include <string_view>
+#include <deque>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifndef NDEBUG
+#include <cassert>
+#endif
+#include <spdlog/spdlog.h>
+#include "spillQueue.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+
+using namespace US8::Broadcasts::DataPacket::SEEDLink;
+
+namespace
+{
+
+constexpr uint32_t WRITTEN{0x55380001};
+constexpr uint32_t CONSUMED{0x55380002};
+constexpr std::string_view SEGMENT_PREFIX{"segment_"};
+constexpr std::string_view SEGMENT_SUFFIX{".spill"};
+
+/// Every record starts with this
+struct RecordHeader
+{
+    uint32_t length{0};
+    uint32_t state{0};
+};
+
+/// Records are 8 byte aligned
+[[nodiscard]] int64_t toRecordSize(const size_t payloadLength)
+{
+    auto size = static_cast<int64_t> (sizeof(RecordHeader) + payloadLength);
+    return ((size + 7)/8)*8;
+}
+
+/// A memory-mapped segment file
+class Segment
+{
+public:
+    /// Opens (and if necessary creates) the segment
+    Segment(const std::filesystem::path &path,
+            const int64_t sequenceNumber,
+            const int64_t size) :
+        mPath(path),
+        mSequenceNumber(sequenceNumber),
+        mSize(size)
+    {
+        mFileDescriptor = ::open(mPath.c_str(),
+                                 O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (mFileDescriptor < 0)
+        {
+            throw std::runtime_error("Failed to open " + mPath.string()
+                                   + ": " + std::strerror(errno));
+        }
+        // New files are zero-filled which marks the end of the records
+        if (ftruncate(mFileDescriptor, static_cast<off_t> (mSize)) != 0)
+        {
+            auto error = std::string {std::strerror(errno)};
+            ::close(mFileDescriptor);
+            throw std::runtime_error("Failed to size " + mPath.string()
+                                   + ": " + error);
+        }
+        auto data = mmap(nullptr, static_cast<size_t> (mSize),
+                         PROT_READ | PROT_WRITE, MAP_SHARED,
+                         mFileDescriptor, 0);
+        if (data == MAP_FAILED)
+        {
+            auto error = std::string {std::strerror(errno)};
+            ::close(mFileDescriptor);
+            throw std::runtime_error("Failed to map " + mPath.string()
+                                   + ": " + error);
+        }
+        mData = static_cast<char *> (data);
+    }
+    ~Segment()
+    {
+        if (mData){munmap(mData, static_cast<size_t> (mSize));}
+        if (mFileDescriptor >= 0){::close(mFileDescriptor);}
+    }
+    /// Finds the unconsumed records left by a previous run
+    void recover()
+    {
+        mReadOffset =-1;
+        mWriteOffset = 0;
+        mNumberOfPackets = 0;
+        while (mWriteOffset + static_cast<int64_t> (sizeof(RecordHeader))
+               <= mSize)
+        {
+            RecordHeader header;
+            std::memcpy(&header, mData + mWriteOffset, sizeof(RecordHeader));
+            if (header.length == 0){break;}
+            auto recordSize = toRecordSize(header.length);
+            // A partially written record ends the segment
+            if (header.state != WRITTEN && header.state != CONSUMED){break;}
+            if (mWriteOffset + recordSize > mSize){break;}
+            if (header.state == WRITTEN)
+            {
+                if (mReadOffset < 0){mReadOffset = mWriteOffset;}
+                mNumberOfPackets = mNumberOfPackets + 1;
+            }
+            mWriteOffset = mWriteOffset + recordSize;
+        }
+        if (mReadOffset < 0){mReadOffset = mWriteOffset;}
+    }
+    /// Appends a record
+    [[nodiscard]] bool append(const std::string &payload)
+    {
+        auto recordSize = toRecordSize(payload.size());
+        if (mWriteOffset + recordSize > mSize){return false;}
+        RecordHeader header{static_cast<uint32_t> (payload.size()), 0};
+        auto record = mData + mWriteOffset;
+        std::memcpy(record + sizeof(RecordHeader),
+                    payload.data(), payload.size());
+        std::memcpy(record, &header, sizeof(RecordHeader));
+        // The record only counts once the payload is in place
+        header.state = WRITTEN;
+        std::memcpy(record, &header, sizeof(RecordHeader));
+        markDirty(mWriteOffset, recordSize);
+        mWriteOffset = mWriteOffset + recordSize;
+        mNumberOfPackets = mNumberOfPackets + 1;
+        return true;
+    }
+    /// Reads the next unconsumed record at or after offset without
+    /// consuming it.  On success offset is moved past the record.
+    [[nodiscard]] bool read(int64_t *offset, std::string_view *payload) const
+    {
+        while (*offset < mWriteOffset)
+        {
+            RecordHeader header;
+            auto record = mData + *offset;
+            std::memcpy(&header, record, sizeof(RecordHeader));
+            *offset = *offset + toRecordSize(header.length);
+            if (header.state != WRITTEN){continue;}
+            *payload = std::string_view {record + sizeof(RecordHeader),
+                                         header.length};
+            return true;
+        }
+        return false;
+    }
+    /// Marks the record holding the payload consumed
+    void consume(const std::string_view &payload)
+    {
+        auto record = const_cast<char *> (payload.data())
+                    - sizeof(RecordHeader);
+        RecordHeader header;
+        std::memcpy(&header, record, sizeof(RecordHeader));
+        if (header.state != WRITTEN){return;}
+        header.state = CONSUMED;
+        std::memcpy(record, &header, sizeof(RecordHeader));
+        markDirty(record - mData, sizeof(RecordHeader));
+        mNumberOfPackets = mNumberOfPackets - 1;
+    }
+    /// Removes the oldest record
+    [[nodiscard]] bool next()
+    {
+        std::string_view payload;
+        if (!read(&mReadOffset, &payload)){return false;}
+        consume(payload);
+        return true;
+    }
+    /// Writes the modified pages to disk
+    void flush()
+    {
+        if (mDirtyBegin >= mDirtyEnd){return;}
+        const auto pageSize = static_cast<int64_t> (sysconf(_SC_PAGESIZE));
+        auto begin = (mDirtyBegin/pageSize)*pageSize;
+        if (msync(mData + begin, static_cast<size_t> (mDirtyEnd - begin),
+                  MS_SYNC) != 0)
+        {
+            throw std::runtime_error("Failed to synchronize " + mPath.string()
+                                   + ": " + std::strerror(errno));
+        }
+        mDirtyBegin = mSize;
+        mDirtyEnd = 0;
+    }
+    /// Notes a modified byte range
+    void markDirty(const int64_t offset, const int64_t length) noexcept
+    {
+        mDirtyBegin = std::min(mDirtyBegin, offset);
+        mDirtyEnd = std::max(mDirtyEnd, offset + length);
+    }
+    std::filesystem::path mPath;
+    char *mData{nullptr};
+    int64_t mSequenceNumber{0};
+    int64_t mSize{0};
+    int64_t mReadOffset{0};
+    int64_t mWriteOffset{0};
+    int64_t mNumberOfPackets{0};
+    int64_t mDirtyBegin{std::numeric_limits<int64_t>::max()};
+    int64_t mDirtyEnd{0};
+    int mFileDescriptor{-1};
+};
+
+[[nodiscard]] std::filesystem::path
+toSegmentPath(const std::filesystem::path &directory,
+              const int64_t sequenceNumber)
+{
+    auto number = std::to_string(sequenceNumber);
+    if (number.size() < 20)
+    {
+        number = std::string(20 - number.size(), '0') + number;
+    }
+    return directory
+         / (std::string {SEGMENT_PREFIX} + number
+          + std::string {SEGMENT_SUFFIX});
+}
+
+}
+
+class SpillQueue::SpillQueueImpl
+{
+public:
+    /// Loads the segments from a previous run
+    void recover()
+    {
+        std::vector<std::pair<int64_t, std::filesystem::path>> paths;
+        for (const auto &entry :
+             std::filesystem::directory_iterator(mDirectory))
+        {
+            if (!entry.is_regular_file()){continue;}
+            auto fileName = entry.path().filename().string();
+            if (!fileName.starts_with(SEGMENT_PREFIX) ||
+                !fileName.ends_with(SEGMENT_SUFFIX))
+            {
+                continue;
+            }
+            try
+            {
+                auto number
+                    = fileName.substr(SEGMENT_PREFIX.size(),
+                                      fileName.size()
+                                    - SEGMENT_PREFIX.size()
+                                    - SEGMENT_SUFFIX.size());
+                paths.push_back(std::pair {std::stoll(number), entry.path()});
+            }
+            catch (...)
+            {
+                spdlog::warn("Ignoring " + entry.path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        for (const auto &[sequenceNumber, path] : paths)
+        {
+            mNextSequenceNumber = std::max(mNextSequenceNumber,
+                                           sequenceNumber + 1);
+            auto size
+                = static_cast<int64_t> (std::filesystem::file_size(path));
+            // A crash while creating a segment can leave an empty file which
+            // cannot be mapped and holds no records
+            if (size <= static_cast<int64_t> (sizeof(::RecordHeader)))
+            {
+                spdlog::warn("Removing short segment " + path.string());
+                std::error_code error;
+                std::filesystem::remove(path, error);
+                continue;
+            }
+            std::unique_ptr<::Segment> segment{nullptr};
+            try
+            {
+                segment = std::make_unique<::Segment>
+                          (path, sequenceNumber, size);
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::warn("Skipping segment because "
+                           + std::string {e.what()});
+                continue;
+            }
+            segment->recover();
+            if (segment->mNumberOfPackets == 0)
+            {
+                segment.reset();
+                std::filesystem::remove(path);
+                continue;
+            }
+            mNumberOfPackets = mNumberOfPackets + segment->mNumberOfPackets;
+            mSizeInBytes = mSizeInBytes + size;
+            mSegments.push_back(std::move(segment));
+        }
+        if (mNumberOfPackets > 0)
+        {
+            spdlog::info("Recovered " + std::to_string(mNumberOfPackets)
+                       + " spilled packets from "
+                       + std::to_string(mSegments.size()) + " segments");
+        }
+    }
+    /// Deletes the oldest segment
+    void removeHead()
+    {
+        auto path = mSegments.front()->mPath;
+        mSizeInBytes = mSizeInBytes - mSegments.front()->mSize;
+        mSegments.pop_front();
+        std::error_code error;
+        if (!std::filesystem::remove(path, error))
+        {
+            spdlog::warn("Failed to remove " + path.string());
+        }
+    }
+    std::deque<std::unique_ptr<::Segment>> mSegments;
+    std::filesystem::path mDirectory;
+    int64_t mMaximumSizeInBytes{0};
+    int64_t mSegmentSizeInBytes{0};
+    int64_t mSizeInBytes{0};
+    int64_t mNumberOfPackets{0};
+    int64_t mNextSequenceNumber{0};
+};
+
+/// Constructor
+SpillQueue::SpillQueue(const std::filesystem::path &directory,
+                       const int64_t maximumSizeInBytes,
+                       const int64_t segmentSizeInBytes) :
+    pImpl(std::make_unique<SpillQueueImpl> ())
+{
+    if (segmentSizeInBytes <= static_cast<int64_t> (sizeof(::RecordHeader)))
+    {
+        throw std::invalid_argument("Segment size is too small");
+    }
+    if (maximumSizeInBytes < segmentSizeInBytes)
+    {
+        throw std::invalid_argument(
+            "Maximum size must be at least the segment size");
+    }
+    if (!std::filesystem::exists(directory))
+    {
+        if (!std::filesystem::create_directories(directory))
+        {
+            throw std::runtime_error("Failed to create "
+                                   + directory.string());
+        }
+    }
+    pImpl->mDirectory = directory;
+    pImpl->mMaximumSizeInBytes = maximumSizeInBytes;
+    pImpl->mSegmentSizeInBytes = segmentSizeInBytes;
+    pImpl->recover();
+}
+
+/// Destructor
+SpillQueue::~SpillQueue()
+{
+    try
+    {
+        flush();
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::warn(e.what());
+    }
+}
+
+/// Push
+bool SpillQueue::push(
+    const US8::MessageFormats::Broadcasts::DataPacket &packet)
+{
+    auto payload = packet.serialize();
+    if (::toRecordSize(payload.size()) > pImpl->mSegmentSizeInBytes)
+    {
+        throw std::invalid_argument("Packet does not fit in a segment");
+    }
+    if (!pImpl->mSegments.empty() &&
+        pImpl->mSegments.back()->append(payload))
+    {
+        pImpl->mNumberOfPackets = pImpl->mNumberOfPackets + 1;
+        return true;
+    }
+    // Start a new segment
+    if (pImpl->mSizeInBytes + pImpl->mSegmentSizeInBytes
+        > pImpl->mMaximumSizeInBytes)
+    {
+        return false;
+    }
+    auto sequenceNumber = pImpl->mNextSequenceNumber;
+    auto segment
+        = std::make_unique<::Segment>
+          (::toSegmentPath(pImpl->mDirectory, sequenceNumber),
+           sequenceNumber, pImpl->mSegmentSizeInBytes);
+    pImpl->mNextSequenceNumber = pImpl->mNextSequenceNumber + 1;
+    pImpl->mSizeInBytes = pImpl->mSizeInBytes + segment->mSize;
+    pImpl->mSegments.push_back(std::move(segment));
+    if (!pImpl->mSegments.back()->append(payload))
+    {
+#ifndef NDEBUG
+        assert(false);
+#endif
+        return false;
+    }
+    pImpl->mNumberOfPackets = pImpl->mNumberOfPackets + 1;
+    return true;
+}
+
+/// Peek
+size_t SpillQueue::peek(
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> *packets,
+    const size_t maximumPackets)
+{
+    if (packets == nullptr){throw std::invalid_argument("packets is NULL");}
+    size_t nRead{0};
+    for (auto &segment : pImpl->mSegments)
+    {
+        auto offset = segment->mReadOffset;
+        std::string_view payload;
+        while (nRead < maximumPackets && segment->read(&offset, &payload))
+        {
+            try
+            {
+                US8::MessageFormats::Broadcasts::DataPacket packet;
+                packet.deserialize(payload);
+                packets->push_back(std::move(packet));
+                nRead = nRead + 1;
+            }
+            catch (const std::exception &e)
+            {
+                // Otherwise this would be read again by every peek
+                spdlog::warn("Discarding unreadable spilled packet because "
+                           + std::string {e.what()});
+                segment->consume(payload);
+                pImpl->mNumberOfPackets = pImpl->mNumberOfPackets - 1;
+            }
+        }
+        if (nRead == maximumPackets){break;}
+    }
+    return nRead;
+}
+
+/// Commit
+size_t SpillQueue::commit(const size_t nPackets)
+{
+    size_t nCommitted{0};
+    while (nCommitted < nPackets && !pImpl->mSegments.empty())
+    {
+        if (!pImpl->mSegments.front()->next())
+        {
+            // Everything in this segment was published
+            pImpl->removeHead();
+            continue;
+        }
+        pImpl->mNumberOfPackets = pImpl->mNumberOfPackets - 1;
+        nCommitted = nCommitted + 1;
+    }
+    while (!pImpl->mSegments.empty() &&
+           pImpl->mSegments.front()->mNumberOfPackets == 0)
+    {
+        pImpl->removeHead();
+    }
+    return nCommitted;
+}
+
+/// Flush
+void SpillQueue::flush()
+{
+    for (auto &segment : pImpl->mSegments)
+    {
+        segment->flush();
+    }
+}
+
+/// Empty?
+bool SpillQueue::empty() const noexcept
+{
+    return pImpl->mNumberOfPackets == 0;
+}
+
+/// Number of packets
+int64_t SpillQueue::size() const noexcept
+{
+    return pImpl->mNumberOfPackets;
+}
+
+/// Size on disk
+int64_t SpillQueue::getSizeInBytes() const noexcept
+{
+    return pImpl->mSizeInBytes;
+}
@@ -0,0 +1,87 @@
+#ifndef US8_BROADCASTS_DATA_PACKET_SEED_LINK_SPILL_QUEUE_HPP
+#define US8_BROADCASTS_DATA_PACKET_SEED_LINK_SPILL_QUEUE_HPP
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <memory>
+namespace US8::MessageFormats::Broadcasts
+{
+ class DataPacket;
+}
+namespace US8::Broadcasts::DataPacket::SEEDLink
+{
+/// @class SpillQueue "spillQueue.hpp"
+/// @brief Holds packets on disk while they cannot be published.  This is an
+///        append-only log of memory-mapped, fixed-size segment files.  Packets
+///        are read with peek() and removed with commit() once delivered, in
+///        the order they were added, so a crash in between replays packets
+///        rather than loses them.  A segment file is deleted once all of its
+///        packets are removed.  Since the segments
+///        are files, packets that were not removed before the program exits
+///        are recovered on the next start.
+/// @note This is not thread-safe.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class SpillQueue
+{
+public:
+    /// @brief Constructor.  Segments left in the directory by a previous run
+    ///        are recovered.
+    /// @param[in] directory           The directory holding the segments.
+    ///                                This is created if it does not exist.
+    /// @param[in] maximumSizeInBytes  The maximum size of all segments.
+    /// @param[in] segmentSizeInBytes  The size of each segment.
+    /// @throws std::invalid_argument if the segment size is not positive or
+    ///         the maximum size is less than the segment size.
+    /// @throws std::runtime_error if the directory cannot be created.
+    SpillQueue(const std::filesystem::path &directory,
+               int64_t maximumSizeInBytes,
+               int64_t segmentSizeInBytes);
+
+    /// @brief Appends a packet to the log.
+    /// @param[in] packet  The packet to add.
+    /// @result False indicates the log is full and the packet was not added.
+    /// @throws std::invalid_argument if the serialized packet does not fit
+    ///         in a segment.
+    /// @throws std::runtime_error if a segment cannot be created.
+    [[nodiscard]] bool push(const US8::MessageFormats::Broadcasts::DataPacket &packet);
+    /// @brief Reads up to maximumPackets of the oldest packets without
+    ///        removing them.  Reading again returns the same packets until
+    ///        they are committed.
+    /// @param[out] packets        The packets are appended to this.
+    /// @param[in] maximumPackets  The maximum number of packets to read.
+    /// @result The number of packets read.
+    /// @throws std::invalid_argument if packets is NULL.
+    /// @note Records that cannot be deserialized are discarded.
+    size_t peek(std::vector<US8::MessageFormats::Broadcasts::DataPacket> *packets,
+                size_t maximumPackets);
+    /// @brief Removes the oldest packets from the log.  Call this once the
+    ///        packets returned by \c peek() have been delivered.
+    /// @param[in] nPackets  The number of packets to remove.
+    /// @result The number of packets removed.
+    size_t commit(size_t nPackets);
+    /// @brief Writes the modified parts of the segments to disk so the log
+    ///        survives a power failure as well as a crash.
+    /// @throws std::runtime_error if a segment cannot be synchronized.
+    void flush();
+
+    /// @result True indicates there are no packets in the log.
+    [[nodiscard]] bool empty() const noexcept;
+    /// @result The number of packets in the log.
+    [[nodiscard]] int64_t size() const noexcept;
+    /// @result The number of bytes used by the segment files.
+    [[nodiscard]] int64_t getSizeInBytes() const noexcept;
+
+    /// @brief Destructor.  Remaining packets are flushed and left on disk.
+    ~SpillQueue();
+
+    SpillQueue() = delete;
+    SpillQueue(const SpillQueue &) = delete;
+    SpillQueue(SpillQueue &&) noexcept = delete;
+    SpillQueue& operator=(const SpillQueue &) = delete;
+    SpillQueue& operator=(SpillQueue &&) noexcept = delete;
+private:
+    class SpillQueueImpl;
+    std::unique_ptr<SpillQueueImpl> pImpl;
+};
+}
+#endif
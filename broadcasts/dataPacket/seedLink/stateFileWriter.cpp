@@ -0,0 +1,104 @@
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <spdlog/spdlog.h>
+#include "stateFileWriter.hpp"
+#include "us8/utilities/writeAtomically.hpp"
+
+using namespace US8::Broadcasts::DataPacket::SEEDLink;
+
+class StateFileWriter::StateFileWriterImpl
+{
+public:
+    StateFileWriterImpl()
+    {
+        mThread = std::thread(&StateFileWriterImpl::run, this);
+    }
+    ~StateFileWriterImpl()
+    {
+        {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mKeepRunning = false;
+        }
+        mCondition.notify_all();
+        if (mThread.joinable()){mThread.join();}
+    }
+    /// Writes the pending snapshots until told to stop.  Pending snapshots
+    /// are written before exiting.
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true)
+        {
+            mCondition.wait(lock, [this]()
+                            {
+                                return !mKeepRunning || !mPending.empty();
+                            });
+            if (mPending.empty())
+            {
+                if (!mKeepRunning){break;}
+                continue;
+            }
+            auto snapshots = std::move(mPending);
+            mPending.clear();
+            mWriting = true;
+            lock.unlock();
+            for (const auto &snapshot : snapshots)
+            {
+                try
+                {
+                    US8::Utilities::writeAtomically(snapshot.first,
+                                                     snapshot.second);
+                }
+                catch (const std::exception &e)
+                {
+                    spdlog::warn("Failed to write state file because "
+                               + std::string {e.what()});
+                }
+            }
+            lock.lock();
+            mWriting = false;
+            mFlushed.notify_all();
+        }
+    }
+    std::map<std::string, std::string> mPending;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::condition_variable mFlushed;
+    std::thread mThread;
+    bool mKeepRunning{true};
+    bool mWriting{false};
+};
+
+/// Constructor
+StateFileWriter::StateFileWriter() :
+    pImpl(std::make_unique<StateFileWriterImpl> ())
+{
+}
+
+/// Destructor
+StateFileWriter::~StateFileWriter() = default;
+
+/// Submit a snapshot
+void StateFileWriter::submit(const std::string &fileName,
+                             std::string &&contents)
+{
+    {
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mPending.insert_or_assign(fileName, std::move(contents));
+    }
+    pImpl->mCondition.notify_one();
+}
+
+/// Flush
+void StateFileWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(pImpl->mMutex);
+    pImpl->mFlushed.wait(lock, [this]()
+                         {
+                             return pImpl->mPending.empty() &&
+                                    !pImpl->mWriting;
+                         });
+}
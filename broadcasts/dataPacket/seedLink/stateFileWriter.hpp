@@ -0,0 +1,39 @@
+#ifndef US8_BROADCASTS_DATA_PACKET_SEED_LINK_STATE_FILE_WRITER_HPP
+#define US8_BROADCASTS_DATA_PACKET_SEED_LINK_STATE_FILE_WRITER_HPP
+#include <string>
+#include <memory>
+namespace US8::Broadcasts::DataPacket::SEEDLink
+{
+/// @class StateFileWriter "stateFileWriter.hpp"
+/// @brief Writes SEEDLink state files from a background thread so that the
+///        acquisition thread never waits on the disk.  Only the latest
+///        snapshot for each file is kept; a snapshot that is superseded
+///        before it is written is discarded.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class StateFileWriter
+{
+public:
+    /// @brief Constructor.  This starts the writer thread.
+    StateFileWriter();
+
+    /// @brief Queues a snapshot to be written.
+    /// @param[in] fileName  The state file.
+    /// @param[in] contents  The state file contents.
+    void submit(const std::string &fileName, std::string &&contents);
+    /// @brief Blocks until all queued snapshots are written.
+    void flush();
+
+    /// @brief Destructor.  This writes any queued snapshots then stops the
+    ///        writer thread.
+    ~StateFileWriter();
+
+    StateFileWriter(const StateFileWriter &) = delete;
+    StateFileWriter(StateFileWriter &&) noexcept = delete;
+    StateFileWriter& operator=(const StateFileWriter &) = delete;
+    StateFileWriter& operator=(StateFileWriter &&) noexcept = delete;
+private:
+    class StateFileWriterImpl;
+    std::unique_ptr<StateFileWriterImpl> pImpl;
+};
+}
+#endif
@@ -3,6 +3,7 @@
 #include <cassert>
 #endif
 #include <string>
+#include <chrono>
 #include <algorithm>
 #include "streamSelector.hpp"
 
@@ -15,7 +16,11 @@ public:
     std::string mStation{"*"};
     std::string mChannel;
     std::string mLocationCode;
+    std::chrono::microseconds mStartTime{0};
+    std::chrono::microseconds mEndTime{0};
     StreamSelector::Type mType{StreamSelector::Type::All};
+    bool mHaveStartTime{false};
+    bool mHaveEndTime{false};
 };
 
 /// Constructor
@@ -113,6 +118,47 @@ void StreamSelector::setSelector(
     pImpl->mType = type;
 }
 
+/// Start time
+void StreamSelector::setStartTime(
+    const std::chrono::microseconds &startTime) noexcept
+{
+    pImpl->mStartTime = startTime;
+    pImpl->mHaveStartTime = true;
+}
+
+std::chrono::microseconds StreamSelector::getStartTime() const
+{
+    if (!haveStartTime()){throw std::runtime_error("Start time not set");}
+    return pImpl->mStartTime;
+}
+
+bool StreamSelector::haveStartTime() const noexcept
+{
+    return pImpl->mHaveStartTime;
+}
+
+/// End time
+void StreamSelector::setEndTime(const std::chrono::microseconds &endTime)
+{
+    if (haveStartTime() && endTime <= pImpl->mStartTime)
+    {
+        throw std::invalid_argument("End time must be after start time");
+    }
+    pImpl->mEndTime = endTime;
+    pImpl->mHaveEndTime = true;
+}
+
+std::chrono::microseconds StreamSelector::getEndTime() const
+{
+    if (!haveEndTime()){throw std::runtime_error("End time not set");}
+    return pImpl->mEndTime;
+}
+
+bool StreamSelector::haveEndTime() const noexcept
+{
+    return pImpl->mHaveEndTime;
+}
+
 /// Build the selector
 std::string StreamSelector::getSelector() const noexcept
 {
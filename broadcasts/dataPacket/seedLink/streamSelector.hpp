@@ -71,6 +71,30 @@ public:
     /// @result A string representation of the selector.
     [[nodiscard]] std::string getSelector() const noexcept;
 
+    /// @brief Requests that the server back-fill data beginning at this
+    ///        time rather than start with the next available packet.
+    /// @param[in] startTime  The UTC start time in microseconds from the
+    ///                       epoch (Jan 1, 1970).
+    void setStartTime(const std::chrono::microseconds &startTime) noexcept;
+    /// @result The UTC start time in microseconds from the epoch.
+    /// @throws std::runtime_error if \c haveStartTime() is false.
+    [[nodiscard]] std::chrono::microseconds getStartTime() const;
+    /// @result True indicates the start time was set.
+    [[nodiscard]] bool haveStartTime() const noexcept;
+
+    /// @brief Packets starting after this time will be discarded.  Once
+    ///        every station on a connection has an end time and has sent
+    ///        data well past it, the connection is terminated.
+    /// @param[in] endTime  The UTC end time in microseconds from the epoch.
+    /// @throws std::invalid_argument if the start time is set and endTime
+    ///         is not after the start time.
+    void setEndTime(const std::chrono::microseconds &endTime);
+    /// @result The UTC end time in microseconds from the epoch.
+    /// @throws std::runtime_error if \c haveEndTime() is false.
+    [[nodiscard]] std::chrono::microseconds getEndTime() const;
+    /// @result True indicates the end time was set.
+    [[nodiscard]] bool haveEndTime() const noexcept;
+
     /// @name Destructors
     /// @{
 
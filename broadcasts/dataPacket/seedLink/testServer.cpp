@@ -0,0 +1,952 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <spdlog/spdlog.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+
+// A stand-in SEEDLink v3 server for load and latency testing of the SEEDLink
+// publisher without a live ringserver.  It implements the subset of the
+// protocol libslink uses - HELLO, BATCH, STATION, SELECT, DATA, FETCH, TIME,
+// END, INFO, and BYE - and serves either synthetic miniSEED2 records or the
+// miniSEED2 records in a set of files.
+
+#define SERVER_ADDRESS "127.0.0.1"
+#define SERVER_PORT 18000
+#define RECORD_SIZE 512
+#define DATA_OFFSET 64
+#define SAMPLES_PER_RECORD ((RECORD_SIZE - DATA_OFFSET)/4)
+
+namespace
+{
+std::atomic<bool> mInterrupted{false};
+
+void signalHandler(const int )
+{
+    mInterrupted = true;
+}
+}
+
+struct ProgramOptions
+{
+    std::vector<std::filesystem::path> files;
+    std::vector<std::string> channels{"HHZ", "HHN", "HHE"};
+    std::string address{SERVER_ADDRESS};
+    std::string network{"XX"};
+    std::string locationCode{"01"};
+    // Rate at which file records are served
+    double filePacketsPerSecond{100};
+    double samplingRate{100};
+    // Time acceleration for synthetic data.  0 is as fast as possible.
+    double speed{1};
+    int nStations{10};
+    int verbosity{3};
+    uint16_t port{SERVER_PORT};
+};
+
+namespace
+{
+
+/// @brief A stream the client asked for.
+struct Request
+{
+    std::string network;
+    std::string station;
+    std::vector<std::string> selectors;
+};
+
+/// @brief A synthetic channel.
+struct SyntheticChannel
+{
+    std::string network;
+    std::string station;
+    std::string channel;
+    std::string locationCode;
+    double phase{0};
+};
+
+void pack16(char *buffer, const uint16_t value)
+{
+    buffer[0] = static_cast<char> ((value >> 8) & 0xFF);
+    buffer[1] = static_cast<char> (value & 0xFF);
+}
+
+void pack32(char *buffer, const uint32_t value)
+{
+    buffer[0] = static_cast<char> ((value >> 24) & 0xFF);
+    buffer[1] = static_cast<char> ((value >> 16) & 0xFF);
+    buffer[2] = static_cast<char> ((value >> 8) & 0xFF);
+    buffer[3] = static_cast<char> (value & 0xFF);
+}
+
+/// @brief Copies a code into a fixed-width, space-padded header field.
+void packCode(char *buffer, const std::string &code, const size_t width)
+{
+    std::fill(buffer, buffer + width, ' ');
+    std::copy(code.begin(),
+              code.begin() + static_cast<long> (std::min(width, code.size())),
+              buffer);
+}
+
+/// @brief Builds the fixed header and blockette 1000 of a big-endian
+///        miniSEED2 record.
+void packHeader(const std::string &network, const std::string &station,
+                const std::string &locationCode, const std::string &channel,
+                const std::chrono::microseconds &startTime,
+                const double samplingRate, const int nSamples,
+                const uint8_t encoding, const char quality, char *record)
+{
+    std::fill(record, record + RECORD_SIZE, '\0');
+    std::memcpy(record, "000001", 6);
+    record[6] = quality;
+    record[7] = ' ';
+    packCode(record + 8,  station, 5);
+    packCode(record + 13, locationCode, 2);
+    packCode(record + 15, channel, 3);
+    packCode(record + 18, network, 2);
+    // BTIME
+    auto seconds
+        = std::chrono::duration_cast<std::chrono::seconds> (startTime);
+    auto fraction = (startTime - seconds).count()/100; // 0.0001 s
+    std::chrono::sys_seconds time{seconds};
+    auto days = std::chrono::floor<std::chrono::days> (time);
+    std::chrono::year_month_day date{days};
+    std::chrono::hh_mm_ss timeOfDay{time - days};
+    auto firstDay
+        = std::chrono::sys_days {date.year()/std::chrono::January/1};
+    auto dayOfYear = (days - firstDay).count() + 1;
+    pack16(record + 20, static_cast<uint16_t> (static_cast<int> (date.year())));
+    pack16(record + 22, static_cast<uint16_t> (dayOfYear));
+    record[24] = static_cast<char> (timeOfDay.hours().count());
+    record[25] = static_cast<char> (timeOfDay.minutes().count());
+    record[26] = static_cast<char> (timeOfDay.seconds().count());
+    pack16(record + 28, static_cast<uint16_t> (fraction));
+    pack16(record + 30, static_cast<uint16_t> (nSamples));
+    // Sampling rate factor and multiplier
+    if (samplingRate >= 1)
+    {
+        pack16(record + 32, static_cast<uint16_t> (std::lround(samplingRate)));
+        pack16(record + 34, 1);
+    }
+    else if (samplingRate > 0)
+    {
+        auto period = static_cast<int16_t> (-std::lround(1/samplingRate));
+        pack16(record + 32, static_cast<uint16_t> (period));
+        pack16(record + 34, 1);
+    }
+    record[39] = 1; // Number of blockettes
+    pack16(record + 44, DATA_OFFSET);
+    pack16(record + 46, 48);
+    // Blockette 1000
+    pack16(record + 48, 1000);
+    pack16(record + 50, 0);
+    record[52] = static_cast<char> (encoding);
+    record[53] = 1; // Big endian
+    record[54] = 9; // 2^9 = 512
+}
+
+/// @result True indicates the value matches the pattern with ? and *
+///         wildcards.
+[[nodiscard]] bool globMatch(const std::string_view pattern,
+                             const std::string_view value)
+{
+    if (pattern.empty()){return value.empty();}
+    if (pattern[0] == '*')
+    {
+        for (size_t i = 0; i <= value.size(); ++i)
+        {
+            if (globMatch(pattern.substr(1), value.substr(i))){return true;}
+        }
+        return false;
+    }
+    if (value.empty()){return false;}
+    if (pattern[0] == '?' || pattern[0] == value[0])
+    {
+        return globMatch(pattern.substr(1), value.substr(1));
+    }
+    return false;
+}
+
+/// @result True indicates the location code and channel pass the SEEDLink
+///         selectors - e.g., HH?, 01HH?.D, or !LCQ.
+[[nodiscard]] bool matchesSelectors(const std::vector<std::string> &selectors,
+                                    const std::string &locationCode,
+                                    const std::string &channel)
+{
+    if (selectors.empty()){return true;}
+    auto location = locationCode;
+    if (location.empty() || location == "--"){location = "  ";}
+    bool haveInclusion{false};
+    bool included{false};
+    for (const auto &selector : selectors)
+    {
+        std::string_view work{selector};
+        bool exclude{false};
+        if (!work.empty() && work[0] == '!')
+        {
+            exclude = true;
+            work.remove_prefix(1);
+        }
+        // Only data records are served so drop the type
+        auto dot = work.find('.');
+        if (dot != std::string_view::npos)
+        {
+            if (work.substr(dot + 1) != "D" && work.substr(dot + 1) != "*")
+            {
+                continue;
+            }
+            work = work.substr(0, dot);
+        }
+        bool match{false};
+        if (work == "*" || work.empty())
+        {
+            match = true;
+        }
+        else if (work.size() <= 3)
+        {
+            match = globMatch(work, channel);
+        }
+        else
+        {
+            match = globMatch(work, location + channel);
+        }
+        if (exclude)
+        {
+            if (match){return false;}
+        }
+        else
+        {
+            haveInclusion = true;
+            if (match){included = true;}
+        }
+    }
+    return !haveInclusion || included;
+}
+
+/// @brief Serves a single SEEDLink client.
+class Session
+{
+public:
+    Session(const int socket,
+            const ::ProgramOptions &options,
+            const std::vector<std::vector<char>> &fileRecords) :
+        mOptions(options),
+        mFileRecords(fileRecords),
+        mSocket(socket)
+    {
+    }
+    ~Session()
+    {
+        if (mSocket >= 0){close(mSocket);}
+    }
+    /// Runs the session until the client leaves or the server stops
+    void run()
+    {
+        while (!mInterrupted && mKeepRunning)
+        {
+            if (mStreaming)
+            {
+                stream();
+            }
+            else
+            {
+                if (!readCommands(std::chrono::milliseconds {100})){break;}
+            }
+        }
+        spdlog::info("Session finished after sending "
+                   + std::to_string(mPacketsSent) + " packets");
+    }
+private:
+    /// Sends everything in the buffer
+    bool sendAll(const char *buffer, const size_t length)
+    {
+        size_t offset{0};
+        while (offset < length)
+        {
+            auto nSent = send(mSocket, buffer + offset, length - offset,
+                              MSG_NOSIGNAL);
+            if (nSent < 0)
+            {
+                if (errno == EINTR){continue;}
+                spdlog::info("Client disconnected: "
+                           + std::string {std::strerror(errno)});
+                mKeepRunning = false;
+                return false;
+            }
+            offset = offset + static_cast<size_t> (nSent);
+        }
+        return true;
+    }
+    bool sendLine(const std::string &line)
+    {
+        auto message = line + "\r\n";
+        return sendAll(message.data(), message.size());
+    }
+    /// Acknowledges a command unless in batch mode
+    bool acknowledge()
+    {
+        if (mBatch){return true;}
+        return sendLine("OK");
+    }
+    /// Sends a record with the SEEDLink header
+    bool sendRecord(char *record, const std::string &header = "")
+    {
+        std::array<char, 8 + RECORD_SIZE> packet;
+        if (header.empty())
+        {
+            snprintf(packet.data(), 9, "SL%06X", mSequenceNumber);
+            mSequenceNumber = (mSequenceNumber + 1) & 0xFFFFFF;
+        }
+        else
+        {
+            std::memcpy(packet.data(), header.data(), 8);
+        }
+        std::memcpy(packet.data() + 8, record, RECORD_SIZE);
+        if (!sendAll(packet.data(), packet.size())){return false;}
+        mPacketsSent = mPacketsSent + 1;
+        return true;
+    }
+    /// Reads and processes any commands the client sent
+    /// @result False indicates the session should end.
+    bool readCommands(const std::chrono::milliseconds &timeOut)
+    {
+        struct pollfd item{};
+        item.fd = mSocket;
+        item.events = POLLIN;
+        auto returnCode = poll(&item, 1, static_cast<int> (timeOut.count()));
+        if (returnCode <= 0){return true;}
+        std::array<char, 4096> buffer;
+        auto nRead = recv(mSocket, buffer.data(), buffer.size(), 0);
+        if (nRead <= 0)
+        {
+            spdlog::info("Client closed connection");
+            mKeepRunning = false;
+            return false;
+        }
+        mCommandBuffer.append(buffer.data(), static_cast<size_t> (nRead));
+        while (true)
+        {
+            auto end = mCommandBuffer.find_first_of("\r\n");
+            if (end == std::string::npos){break;}
+            auto command = mCommandBuffer.substr(0, end);
+            mCommandBuffer.erase(0, end + 1);
+            boost::algorithm::trim(command);
+            if (command.empty()){continue;}
+            if (!processCommand(command)){return false;}
+        }
+        return true;
+    }
+    /// Handles a command
+    /// @result False indicates the session should end.
+    bool processCommand(const std::string &command)
+    {
+        spdlog::debug("Received: " + command);
+        std::vector<std::string> tokens;
+        boost::split(tokens, command, boost::is_any_of(" \t"),
+                     boost::token_compress_on);
+        auto verb = tokens.at(0);
+        boost::algorithm::to_upper(verb);
+        if (verb == "HELLO")
+        {
+            return sendLine("SeedLink v3.1 (us8 test server)")
+                && sendLine("us8 test server");
+        }
+        if (verb == "BYE")
+        {
+            mKeepRunning = false;
+            return false;
+        }
+        if (verb == "BATCH")
+        {
+            auto result = sendLine("OK");
+            mBatch = true;
+            return result;
+        }
+        if (verb == "STATION")
+        {
+            if (tokens.size() < 2){return sendLine("ERROR");}
+            Request request;
+            request.station = tokens[1];
+            request.network = tokens.size() > 2 ? tokens[2] : "*";
+            mRequests.push_back(std::move(request));
+            return acknowledge();
+        }
+        if (verb == "SELECT")
+        {
+            if (mRequests.empty())
+            {
+                // Uni-station mode
+                Request request{"*", "*", {}};
+                mRequests.push_back(std::move(request));
+                mUniStation = true;
+            }
+            if (tokens.size() > 1)
+            {
+                mRequests.back().selectors.push_back(tokens[1]);
+            }
+            return acknowledge();
+        }
+        if (verb == "DATA" || verb == "FETCH" || verb == "TIME")
+        {
+            if (mRequests.empty())
+            {
+                Request request{"*", "*", {}};
+                mRequests.push_back(std::move(request));
+                mUniStation = true;
+            }
+            if (!acknowledge()){return false;}
+            // Uni-station mode starts immediately
+            if (mUniStation){startStreaming();}
+            return true;
+        }
+        if (verb == "END")
+        {
+            startStreaming();
+            return true;
+        }
+        if (verb == "INFO")
+        {
+            auto level = tokens.size() > 1 ? tokens[1] : "ID";
+            boost::algorithm::to_upper(level);
+            return sendInfo(level);
+        }
+        if (verb == "CAPABILITIES" || verb == "USERAGENT")
+        {
+            return acknowledge();
+        }
+        spdlog::warn("Unhandled command: " + command);
+        return sendLine("ERROR");
+    }
+    /// Responds to INFO with XML packed into text records
+    bool sendInfo(const std::string &level)
+    {
+        std::string xml{"<?xml version=\"1.0\"?>\n"};
+        xml = xml + "<seedlink software=\"us8 test server\" "
+                  + "organization=\"us8\">\n";
+        if (level == "STATIONS" || level == "STREAMS")
+        {
+            for (int i = 0; i < mOptions.nStations; ++i)
+            {
+                xml = xml + " <station name=\"" + stationName(i)
+                    + "\" network=\"" + mOptions.network
+                    + "\" description=\"Synthetic\">\n";
+                if (level == "STREAMS")
+                {
+                    for (const auto &channel : mOptions.channels)
+                    {
+                        xml = xml + "  <stream location=\""
+                            + mOptions.locationCode + "\" seedname=\""
+                            + channel + "\" type=\"D\"/>\n";
+                    }
+                }
+                xml = xml + " </station>\n";
+            }
+        }
+        xml = xml + "</seedlink>\n";
+        constexpr size_t capacity{RECORD_SIZE - DATA_OFFSET};
+        std::array<char, RECORD_SIZE> record;
+        auto now
+            = std::chrono::time_point_cast<std::chrono::microseconds>
+              (std::chrono::system_clock::now()).time_since_epoch();
+        for (size_t offset = 0; offset < xml.size(); offset = offset + capacity)
+        {
+            auto length = std::min(capacity, xml.size() - offset);
+            ::packHeader("SL", "INFO", "", "INF", now, 0,
+                         static_cast<int> (length), 0, 'D', record.data());
+            std::memcpy(record.data() + DATA_OFFSET,
+                        xml.data() + offset, length);
+            // An asterisk indicates more INFO packets follow
+            bool last = offset + length >= xml.size();
+            if (!sendRecord(record.data(), last ? "SLINFO  " : "SLINFO *"))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    [[nodiscard]] static std::string stationName(const int index)
+    {
+        std::array<char, 16> name;
+        snprintf(name.data(), name.size(), "T%04d", index);
+        return std::string {name.data()};
+    }
+    [[nodiscard]] bool isRequested(const std::string &network,
+                                   const std::string &station,
+                                   const std::string &locationCode,
+                                   const std::string &channel) const
+    {
+        for (const auto &request : mRequests)
+        {
+            if (!::globMatch(request.network, network)){continue;}
+            if (!::globMatch(request.station, station)){continue;}
+            if (::matchesSelectors(request.selectors, locationCode, channel))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    /// Begins sending data
+    void startStreaming()
+    {
+        mStreaming = true;
+        if (!mFileRecords.empty()){return;}
+        mChannels.clear();
+        for (int i = 0; i < mOptions.nStations; ++i)
+        {
+            auto station = stationName(i);
+            for (const auto &channel : mOptions.channels)
+            {
+                if (isRequested(mOptions.network, station,
+                                mOptions.locationCode, channel))
+                {
+                    SyntheticChannel synthetic{mOptions.network, station,
+                                               channel,
+                                               mOptions.locationCode,
+                                               0.1*static_cast<double> (i)};
+                    mChannels.push_back(std::move(synthetic));
+                }
+            }
+        }
+        spdlog::info("Streaming " + std::to_string(mChannels.size())
+                   + " synthetic channels");
+    }
+    /// Sends data while servicing commands between packets
+    void stream()
+    {
+        if (mFileRecords.empty())
+        {
+            streamSynthetic();
+        }
+        else
+        {
+            streamFiles();
+        }
+    }
+    /// Waits until the given time while handling commands
+    /// @result False indicates the session should end.
+    bool waitUntil(const std::chrono::steady_clock::time_point &time)
+    {
+        while (!mInterrupted && mKeepRunning)
+        {
+            auto now = std::chrono::steady_clock::now();
+            auto wait
+                = std::chrono::duration_cast<std::chrono::milliseconds>
+                  (time - now);
+            if (wait.count() <= 0)
+            {
+                // Still check for keep-alives without waiting
+                return readCommands(std::chrono::milliseconds {0});
+            }
+            if (!readCommands(std::min(wait,
+                                       std::chrono::milliseconds {100})))
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+    /// Generates records for each selected channel in lock step
+    void streamSynthetic()
+    {
+        if (mChannels.empty())
+        {
+            readCommands(std::chrono::milliseconds {100});
+            return;
+        }
+        const auto recordDuration
+            = std::chrono::microseconds
+              {
+                  static_cast<int64_t>
+                  (std::round(SAMPLES_PER_RECORD*1.e6/mOptions.samplingRate))
+              };
+        auto dataTime
+            = std::chrono::time_point_cast<std::chrono::microseconds>
+              (std::chrono::system_clock::now()).time_since_epoch();
+        auto wallTime = std::chrono::steady_clock::now();
+        std::mt19937 generator(1);
+        std::normal_distribution<double> noise(0, 50);
+        std::array<char, RECORD_SIZE> record;
+        const auto dt = 1./mOptions.samplingRate;
+        while (!mInterrupted && mKeepRunning)
+        {
+            // The records' last samples are emitted when they are due
+            if (mOptions.speed > 0)
+            {
+                auto due
+                    = std::chrono::duration_cast
+                      <std::chrono::steady_clock::duration>
+                      (std::chrono::duration<double, std::micro>
+                      (recordDuration.count()/mOptions.speed));
+                wallTime = wallTime + due;
+                if (!waitUntil(wallTime)){return;}
+            }
+            else
+            {
+                if (!readCommands(std::chrono::milliseconds {0})){return;}
+            }
+            for (auto &channel : mChannels)
+            {
+                ::packHeader(channel.network, channel.station,
+                             channel.locationCode, channel.channel,
+                             dataTime, mOptions.samplingRate,
+                             SAMPLES_PER_RECORD, 3, 'D', record.data());
+                auto t0 = static_cast<double> (dataTime.count())*1.e-6;
+                for (int i = 0; i < SAMPLES_PER_RECORD; ++i)
+                {
+                    auto t = t0 + i*dt;
+                    auto value = 1000*std::sin(2*M_PI*t + channel.phase)
+                               + noise(generator);
+                    ::pack32(record.data() + DATA_OFFSET + 4*i,
+                             static_cast<uint32_t>
+                             (static_cast<int32_t> (std::lround(value))));
+                }
+                if (!sendRecord(record.data())){return;}
+            }
+            dataTime = dataTime + recordDuration;
+        }
+    }
+    /// Replays the file records at the requested rate
+    void streamFiles()
+    {
+        const auto interval
+            = std::chrono::duration_cast<std::chrono::steady_clock::duration>
+              (std::chrono::duration<double>
+               (1/std::max(1.e-3, mOptions.filePacketsPerSecond)));
+        auto wallTime = std::chrono::steady_clock::now();
+        std::array<char, RECORD_SIZE> record;
+        size_t nSentThisPass{0};
+        while (!mInterrupted && mKeepRunning)
+        {
+            nSentThisPass = 0;
+            for (const auto &fileRecord : mFileRecords)
+            {
+                // Filter on the header codes
+                std::string_view header{fileRecord.data(), 20};
+                auto station = std::string {header.substr(8, 5)};
+                auto locationCode = std::string {header.substr(13, 2)};
+                auto channel = std::string {header.substr(15, 3)};
+                auto network = std::string {header.substr(18, 2)};
+                boost::algorithm::trim(station);
+                boost::algorithm::trim(channel);
+                boost::algorithm::trim(network);
+                if (!isRequested(network, station, locationCode, channel))
+                {
+                    continue;
+                }
+                wallTime = wallTime + interval;
+                if (!waitUntil(wallTime)){return;}
+                std::copy(fileRecord.begin(), fileRecord.end(),
+                          record.begin());
+                if (!sendRecord(record.data())){return;}
+                nSentThisPass = nSentThisPass + 1;
+            }
+            if (nSentThisPass == 0)
+            {
+                if (!readCommands(std::chrono::milliseconds {100})){return;}
+            }
+        }
+    }
+    const ::ProgramOptions &mOptions;
+    const std::vector<std::vector<char>> &mFileRecords;
+    std::vector<Request> mRequests;
+    std::vector<SyntheticChannel> mChannels;
+    std::string mCommandBuffer;
+    int64_t mPacketsSent{0};
+    int mSocket{-1};
+    int mSequenceNumber{1};
+    bool mBatch{false};
+    bool mUniStation{false};
+    bool mStreaming{false};
+    bool mKeepRunning{true};
+};
+
+/// @brief Reads the 512 byte miniSEED2 records from the files.
+[[nodiscard]] std::vector<std::vector<char>>
+    readRecords(const std::vector<std::filesystem::path> &files)
+{
+    std::vector<std::vector<char>> records;
+    for (const auto &file : files)
+    {
+        std::ifstream stream(file, std::ios::binary);
+        if (!stream.is_open())
+        {
+            throw std::invalid_argument("Could not open " + file.string());
+        }
+        std::vector<char> contents((std::istreambuf_iterator<char> (stream)),
+                                   std::istreambuf_iterator<char> ());
+        size_t offset{0};
+        int nSkipped{0};
+        while (offset + 64 <= contents.size())
+        {
+            const auto record = contents.data() + offset;
+            // Find the record length in blockette 1000
+            size_t recordLength{RECORD_SIZE};
+            auto blocketteOffset
+                = static_cast<size_t>
+                  ((static_cast<uint8_t> (record[46]) << 8)
+                 | static_cast<uint8_t> (record[47]));
+            if (blocketteOffset == 48 &&
+                static_cast<uint8_t> (record[48]) == 0x03 &&
+                static_cast<uint8_t> (record[49]) == 0xE8)
+            {
+                recordLength = size_t {1} << static_cast<uint8_t> (record[54]);
+            }
+            if (recordLength < 64 || offset + recordLength > contents.size())
+            {
+                break;
+            }
+            // SEEDLink v3 carries 512 byte records
+            if (recordLength == RECORD_SIZE)
+            {
+                records.emplace_back(record, record + RECORD_SIZE);
+            }
+            else
+            {
+                nSkipped = nSkipped + 1;
+            }
+            offset = offset + recordLength;
+        }
+        if (nSkipped > 0)
+        {
+            spdlog::warn("Skipped " + std::to_string(nSkipped)
+                       + " records that are not 512 bytes in "
+                       + file.string());
+        }
+    }
+    spdlog::info("Read " + std::to_string(records.size()) + " records");
+    return records;
+}
+
+}
+
+std::pair<::ProgramOptions, bool>
+    parseCommandLineOptions(int argc, char *argv[]);
+
+///--------------------------------------------------------------------------///
+///                                    Main Function                         ///
+///--------------------------------------------------------------------------///
+
+int main(int argc, char *argv[])
+{
+    ::ProgramOptions options;
+    try
+    {
+        auto [programOptions, isHelp] = ::parseCommandLineOptions(argc, argv);
+        if (isHelp){return EXIT_SUCCESS;}
+        options = programOptions;
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::error(e.what());
+        return EXIT_FAILURE;
+    }
+    if (options.verbosity <= 1){spdlog::set_level(spdlog::level::critical);}
+    if (options.verbosity == 2){spdlog::set_level(spdlog::level::warn);}
+    if (options.verbosity == 3){spdlog::set_level(spdlog::level::info);}
+    if (options.verbosity >= 4){spdlog::set_level(spdlog::level::debug);}
+
+    std::vector<std::vector<char>> fileRecords;
+    try
+    {
+        fileRecords = ::readRecords(options.files);
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::error(e.what());
+        return EXIT_FAILURE;
+    }
+    if (!options.files.empty() && fileRecords.empty())
+    {
+        spdlog::error("No records to serve");
+        return EXIT_FAILURE;
+    }
+
+    // Listen
+    auto listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        spdlog::error("Failed to create socket");
+        return EXIT_FAILURE;
+    }
+    int reuse{1};
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.address.c_str(), &address.sin_addr) != 1)
+    {
+        spdlog::error("Invalid address " + options.address);
+        close(listener);
+        return EXIT_FAILURE;
+    }
+    if (bind(listener, reinterpret_cast<struct sockaddr *> (&address),
+             sizeof(address)) != 0 ||
+        listen(listener, 16) != 0)
+    {
+        spdlog::error("Failed to listen on " + options.address + ":"
+                    + std::to_string(options.port) + " because "
+                    + std::string {std::strerror(errno)});
+        close(listener);
+        return EXIT_FAILURE;
+    }
+    spdlog::info("Listening on " + options.address + ":"
+               + std::to_string(options.port));
+
+    struct sigaction action{};
+    action.sa_handler = ::signalHandler;
+    action.sa_flags = 0;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT,  &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    std::vector<std::thread> sessions;
+    while (!mInterrupted)
+    {
+        struct pollfd item{};
+        item.fd = listener;
+        item.events = POLLIN;
+        if (poll(&item, 1, 100) <= 0){continue;}
+        auto client = accept(listener, nullptr, nullptr);
+        if (client < 0){continue;}
+        int noDelay{1};
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        spdlog::info("Accepted connection");
+        sessions.push_back(std::thread([client, &options, &fileRecords]()
+        {
+            ::Session session(client, options, fileRecords);
+            session.run();
+        }));
+    }
+    spdlog::info("Shutting down");
+    close(listener);
+    for (auto &session : sessions)
+    {
+        if (session.joinable()){session.join();}
+    }
+    return EXIT_SUCCESS;
+}
+
+///--------------------------------------------------------------------------///
+///                            Utility Functions                             ///
+///--------------------------------------------------------------------------///
+/// Read the program options from the command line
+std::pair<::ProgramOptions, bool>
+    parseCommandLineOptions(int argc, char *argv[])
+{
+    ::ProgramOptions options;
+    boost::program_options::options_description desc(R"""(
+The seedLinkTestServer is a stand-in SEEDLink v3 server for testing the
+seedLinkDataPacketBroadcastPublisher.  It serves synthetic 100 Hz data from
+stations T0000, T0001, ... or replays the 512 byte miniSEED2 records in files.
+
+Example usage:
+    seedLinkTestServer --port=18000 --stations=500 --speed=1
+    seedLinkTestServer --file=data.mseed --packets-per-second=2000
+
+Allowed options)""");
+    desc.add_options()
+        ("help", "Produces this help message")
+        ("address", boost::program_options::value<std::string> ()->default_value(options.address),
+                    "The address on which to listen")
+        ("port",    boost::program_options::value<uint16_t> ()->default_value(options.port),
+                    "The port on which to listen")
+        ("network", boost::program_options::value<std::string> ()->default_value(options.network),
+                    "The synthetic stations' network code")
+        ("stations", boost::program_options::value<int> ()->default_value(options.nStations),
+                     "The number of synthetic stations")
+        ("channels", boost::program_options::value<std::string> ()->default_value("HHZ,HHN,HHE"),
+                     "The synthetic channels at each station")
+        ("sampling-rate", boost::program_options::value<double> ()->default_value(options.samplingRate),
+                          "The synthetic sampling rate in Hz")
+        ("speed", boost::program_options::value<double> ()->default_value(options.speed),
+                  "Time acceleration of the synthetic data.  0 sends as fast as possible")
+        ("file", boost::program_options::value<std::vector<std::string>> (),
+                 "A miniSEED2 file to replay instead of synthetic data.  This can be repeated")
+        ("packets-per-second", boost::program_options::value<double> ()->default_value(options.filePacketsPerSecond),
+                               "The replay rate for file records")
+        ("verbosity", boost::program_options::value<int> ()->default_value(options.verbosity),
+                      "The logging verbosity (1-4)");
+    boost::program_options::variables_map vm;
+    boost::program_options::store(
+        boost::program_options::parse_command_line(argc, argv, desc), vm);
+    boost::program_options::notify(vm);
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return {options, true};
+    }
+    options.address = vm["address"].as<std::string> ();
+    options.port = vm["port"].as<uint16_t> ();
+    options.network = vm["network"].as<std::string> ();
+    if (options.network.empty() || options.network.size() > 2)
+    {
+        throw std::invalid_argument("Network must be 1 or 2 characters");
+    }
+    options.nStations = vm["stations"].as<int> ();
+    if (options.nStations < 1 || options.nStations > 10000)
+    {
+        throw std::invalid_argument("Number of stations must be in [1,10000]");
+    }
+    auto channels = vm["channels"].as<std::string> ();
+    options.channels.clear();
+    boost::split(options.channels, channels, boost::is_any_of(","));
+    for (auto &channel : options.channels)
+    {
+        boost::algorithm::trim(channel);
+        if (channel.size() != 3)
+        {
+            throw std::invalid_argument("Channel " + channel
+                                      + " must be 3 characters");
+        }
+    }
+    options.samplingRate = vm["sampling-rate"].as<double> ();
+    if (options.samplingRate <= 0)
+    {
+        throw std::invalid_argument("Sampling rate must be positive");
+    }
+    options.speed = vm["speed"].as<double> ();
+    if (options.speed < 0)
+    {
+        throw std::invalid_argument("Speed cannot be negative");
+    }
+    if (vm.count("file"))
+    {
+        for (const auto &file : vm["file"].as<std::vector<std::string>> ())
+        {
+            if (!std::filesystem::exists(file))
+            {
+                throw std::invalid_argument("File " + file
+                                          + " does not exist");
+            }
+            options.files.push_back(file);
+        }
+    }
+    options.filePacketsPerSecond = vm["packets-per-second"].as<double> ();
+    if (options.filePacketsPerSecond <= 0)
+    {
+        throw std::invalid_argument("Packets per second must be positive");
+    }
+    options.verbosity = vm["verbosity"].as<int> ();
+    return {options, false};
+}
@@ -12,6 +12,7 @@
 #include "us8/broadcasts/dataPacket/subscriber.hpp"
 #include "us8/broadcasts/dataPacket/subscriberOptions.hpp"
 #include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/utilities/clock.hpp"
 
 using namespace US8::Broadcasts::DataPacket;
 
@@ -88,10 +89,9 @@ public:
         auto callback = mOptions.getCallback();
         auto logInterval = mOptions.getLoggingInterval();
         auto doLogging = logInterval.count() >= 0 ? true : false;
+        auto clock = mOptions.getClock();
         spdlog::debug("Thread entering listener");
-        auto nowMuSeconds
-           = std::chrono::time_point_cast<std::chrono::microseconds>
-             (std::chrono::high_resolution_clock::now()).time_since_epoch();
+        auto nowMuSeconds = clock->now();
         auto lastLogTime
             = std::chrono::duration_cast<std::chrono::seconds> (nowMuSeconds);
         int64_t nReceivedMessages{0};
@@ -134,9 +134,7 @@ public:
                            + std::string {e.what()});
                 nNotPropagatedMessages = nNotPropagatedMessages + 1;
             }
-            nowMuSeconds
-                = std::chrono::time_point_cast<std::chrono::microseconds>
-                 (std::chrono::high_resolution_clock::now()).time_since_epoch();
+            nowMuSeconds = clock->now();
             auto nowSeconds
                 = std::chrono::duration_cast<std::chrono::seconds>
                   (nowMuSeconds);
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include "us8/broadcasts/dataPacket/subscriberOptions.hpp"
 #include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/utilities/clock.hpp"
 
 using namespace US8::Broadcasts::DataPacket;
 
@@ -11,6 +12,8 @@ public:
     std::function<void (US8::MessageFormats::Broadcasts::DataPacket &&)>
          mCallback;
     std::string mEndPoint;
+    std::shared_ptr<const US8::Utilities::IClock> mClock{
+        std::make_shared<US8::Utilities::WallClock> ()};
     std::chrono::seconds mLoggingInterval{3600};
     std::chrono::milliseconds mReceiveTimeOut{10};
     int mReceiveHighWaterMark{4096};
@@ -168,3 +171,17 @@ std::chrono::seconds SubscriberOptions::getLoggingInterval() const noexcept
 {
     return pImpl->mLoggingInterval;
 }
+
+/// Clock
+void SubscriberOptions::setClock(
+    std::shared_ptr<const US8::Utilities::IClock> clock)
+{
+    if (clock == nullptr){throw std::invalid_argument("Clock is null");}
+    pImpl->mClock = std::move(clock);
+}
+
+std::shared_ptr<const US8::Utilities::IClock>
+    SubscriberOptions::getClock() const noexcept
+{
+    return pImpl->mClock;
+}
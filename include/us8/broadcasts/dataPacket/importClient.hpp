@@ -14,11 +14,16 @@ class IImportClient
 public:
     enum class Type
     {
-        SEEDLink
+        SEEDLink,    /*!< Reads from SEEDLink servers. */
+        MiniSEEDFile /*!< Replays miniSEED files. */
     };
 public:
     /// @brief Construtor with callback.
     explicit IImportClient(const std::function<void (US8::MessageFormats::Broadcasts::DataPacket &&packet)> &callback);
+    /// @brief Constructor with a batch callback.  This receives all the
+    ///        packets unpacked from a record at once which avoids invoking
+    ///        the callback for every packet.
+    explicit IImportClient(const std::function<void (std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets)> &callback);
     /// @brief Destructor.
     virtual ~IImportClient();
     /// @brief Connects the client to the data source.
@@ -35,10 +40,15 @@ public:
     /// @result True indicates the client is connected.
     [[nodiscard]] virtual bool isConnected() const noexcept = 0;
     /// @brief Passes the packets read from the client to the callback.
+    ///        If this was constructed with a batch callback then the
+    ///        packets are passed in one call.  Otherwise, each packet is
+    ///        passed to the per-packet callback.
     /// @param[in,out] packets  The packets to send to the callback.
     ///                         On exit,  the behavior of packets is undefined.
     virtual void operator()(std::vector<US8::MessageFormats::Broadcasts::DataPacket> &&packets);
     /// @brief Passes the packet read from the client to the callback.
+    ///        If this was constructed with a batch callback then the packet
+    ///        is passed as a batch of one.
     /// @param[in,out] packet  The packet to send to the callback.
     ///                        On exit, packet's behavior is undefined.
     virtual void operator()(US8::MessageFormats::Broadcasts::DataPacket &&packet);
@@ -1,6 +1,11 @@
 #ifndef US8_BROADCASTS_DATA_PACKET_PUBLISHER_HPP
 #define US8_BROADCASTS_DATA_PACKET_PUBLISHER_HPP
 #include <memory>
+#include <vector>
+namespace US8::MessageFormats
+{
+ class IMessage;
+}
 namespace US8::MessageFormats::Broadcasts
 {
  class DataPacket;
@@ -21,6 +26,29 @@ public:
     explicit Publisher(const PublisherOptions &options);
     /// @brief Publishes a data packet.
     void send(const US8::MessageFormats::Broadcasts::DataPacket &dataPacket);
+    /// @brief Publishes a batch of data packets.  A packet that fails to
+    ///        serialize or send does not stop the rest of the batch.
+    /// @note Each packet is still published as its own two-part message so
+    ///       subscribers are unaffected.  This is a convenience that saves
+    ///       the caller a loop and its error handling; it does not reduce
+    ///       the number of socket sends.
+    /// @param[in] dataPackets  The packets to publish.
+    /// @result The number of packets sent.
+    /// @throws std::invalid_argument if the publisher is not initialized.
+    [[nodiscard]] int send(const std::vector<US8::MessageFormats::Broadcasts::DataPacket> &dataPackets);
+    /// @brief Publishes an arbitrary message - e.g., stream watermarks.
+    ///        Subscribers filter on the message type so this does not
+    ///        disturb subscribers that only handle data packets.
+    /// @param[in] message  The message to publish.
+    /// @throws std::invalid_argument if the publisher is not initialized.
+    /// @throws std::runtime_error if the message cannot be sent.
+    void send(const US8::MessageFormats::IMessage &message);
+    /// @result True indicates the socket is connected to its peer.  Since
+    ///         a publisher silently discards messages when there is no peer
+    ///         this can be used to hold messages back during an outage.
+    /// @note This processes pending socket events so it should be called
+    ///       from the thread that sends.
+    [[nodiscard]] bool isConnected();
     /// @brief Destructor.
     ~Publisher();
 
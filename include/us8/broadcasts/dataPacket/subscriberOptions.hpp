@@ -9,6 +9,10 @@ namespace US8::MessageFormats::Broadcasts
 {
  class DataPacket;
 }
+namespace US8::Utilities
+{
+ class IClock;
+}
 namespace US8::Broadcasts::DataPacket
 {
 /// @brief Defines the options for a data broadcast subscriber.
@@ -68,6 +72,13 @@ public:
     void setLoggingInterval(const std::chrono::seconds &interval) noexcept;
     /// @result The logging interval.
     [[nodiscard]] std::chrono::seconds getLoggingInterval() const noexcept;
+
+    /// @brief Sets the clock used to time the performance statistics.
+    /// @param[in] clock  The clock.  By default this is the wall clock.
+    /// @throws std::invalid_argument if clock is null.
+    void setClock(std::shared_ptr<const US8::Utilities::IClock> clock);
+    /// @result The clock used to time the performance statistics.
+    [[nodiscard]] std::shared_ptr<const US8::Utilities::IClock> getClock() const noexcept;
     /// @}
 
     ~SubscriberOptions();
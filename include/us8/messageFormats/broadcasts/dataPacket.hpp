@@ -62,6 +62,8 @@ public:
     /// @param[in] network  The network code.
     /// @throws std::invalid_argument if network is empty.
     void setNetwork(const std::string &network);
+    /// @brief Sets the network code by taking ownership of the string.
+    void setNetwork(std::string &&network);
     /// @result The network code.
     /// @throws std::runtime_error if \c haveNetwork() is false.
     [[nodiscard]] std::string getNetwork() const;
@@ -72,6 +74,8 @@ public:
     /// @param[in] station   The station name.
     /// @throws std::invalid_argument if station is empty.
     void setStation(const std::string &station);
+    /// @brief Sets the station name by taking ownership of the string.
+    void setStation(std::string &&station);
     /// @result The station name.
     /// @throws std::runtime_error if \c haveStation() is false.
     [[nodiscard]] std::string getStation() const;
@@ -82,6 +86,8 @@ public:
     /// @param[in] channel  The channel name.
     /// @throws std::invalid_argument if channel is empty.
     void setChannel(const std::string &channel);
+    /// @brief Sets the channel name by taking ownership of the string.
+    void setChannel(std::string &&channel);
     /// @result The channel name.
     /// @throws std::runtime_error if the channel was not set.
     [[nodiscard]] std::string getChannel() const;
@@ -92,6 +98,8 @@ public:
     /// @param[in] location  The location code.
     /// @throws std::invalid_argument if location is empty.
     void setLocationCode(const std::string &location);
+    /// @brief Sets the location code by taking ownership of the string.
+    void setLocationCode(std::string &&location);
     /// @brief Sets the location code.
     /// @throws std::runtime_error if \c haveLocationCode() is false.
     [[nodiscard]] std::string getLocationCode() const;
@@ -0,0 +1,115 @@
+#ifndef US8_MESSAGE_FORMATS_BROADCASTS_STREAM_WATERMARKS_HPP
+#define US8_MESSAGE_FORMATS_BROADCASTS_STREAM_WATERMARKS_HPP
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <us8/messageFormats/message.hpp>
+namespace US8::MessageFormats::Broadcasts
+{
+/// @class StreamWatermarks "streamWatermarks.hpp" "us8/messageFormats/broadcasts/streamWatermarks.hpp"
+/// @brief A batch of stream watermarks.  A stream's watermark is the time
+///        through which its data has been contiguously published.  A
+///        windowed consumer may close a window on a stream once the stream's
+///        watermark reaches the end of the window.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+/// @ingroup Modules_Broadcasts_Internal_DataPacket
+class StreamWatermarks : public US8::MessageFormats::IMessage
+{
+public:
+    /// @brief A stream's watermark.
+    struct Watermark
+    {
+        /// The stream's name - e.g., UU.FORK.HHZ.01.
+        std::string stream;
+        /// The UTC time in microseconds from the epoch of the last sample
+        /// in the stream's contiguous data.
+        std::chrono::microseconds completeThrough{0};
+    };
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    StreamWatermarks();
+    /// @brief Copy constructor.
+    /// @param[in] watermarks  The watermarks from which to initialize this
+    ///                        class.
+    StreamWatermarks(const StreamWatermarks &watermarks);
+    /// @brief Move constructor.
+    /// @param[in,out] watermarks  The watermarks from which to initialize
+    ///                            this class.  On exit, watermarks's behavior
+    ///                            is undefined.
+    StreamWatermarks(StreamWatermarks &&watermarks) noexcept;
+    /// @brief Constructs class from a message.
+    /// @param[in] message  A string view of the message from which to
+    ///                     construct this class.
+    explicit StreamWatermarks(const std::string_view &message);
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] watermarks  The watermarks to copy to this class.
+    /// @result A deep copy of the input watermarks.
+    StreamWatermarks& operator=(const StreamWatermarks &watermarks);
+    /// @brief Move assignment.
+    /// @param[in,out] watermarks  The watermarks whose memory will be moved
+    ///                            to this class.
+    /// @result The memory from watermarks moved to this.
+    StreamWatermarks& operator=(StreamWatermarks &&watermarks) noexcept;
+    /// @}
+
+    /// @name Watermarks
+    /// @{
+
+    /// @brief Adds a stream's watermark to the batch.
+    /// @param[in] stream           The stream name - e.g., UU.FORK.HHZ.01.
+    /// @param[in] completeThrough  The UTC time in microseconds from the epoch
+    ///                             through which the stream is complete.
+    /// @throws std::invalid_argument if stream is empty.
+    void addWatermark(const std::string &stream,
+                      const std::chrono::microseconds &completeThrough);
+    /// @result The watermarks in the batch.
+    [[nodiscard]] const std::vector<Watermark> &getWatermarks() const noexcept;
+    /// @result The number of watermarks in the batch.
+    [[nodiscard]] int size() const noexcept;
+    /// @result True indicates there are no watermarks in the batch.
+    [[nodiscard]] bool empty() const noexcept;
+    /// @}
+
+    /// @name Message Abstract Base Class Properties
+    /// @{
+
+    /// @result A copy of this class.
+    [[nodiscard]] std::unique_ptr<US8::MessageFormats::IMessage> clone() const final;
+    /// @result An instance of an uninitialized class.
+    [[nodiscard]] std::unique_ptr<US8::MessageFormats::IMessage> createInstance() const noexcept final;
+    /// @brief Converts the watermarks to a string message.
+    /// @result The class expressed as a string message.
+    /// @note Though the container is a string the message need not be
+    ///       human readable.
+    [[nodiscard]] std::string serialize() const final;
+    /// @brief Creates the class from a message.
+    void deserialize(const std::string_view &message) final;
+    /// @result The message type - e.g., "StreamWatermarks".
+    [[nodiscard]] std::string getMessageType() const noexcept final;
+    /// @result The message version.
+    [[nodiscard]] std::string getMessageVersion() const noexcept final;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class and releases all memory.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~StreamWatermarks() override;
+    /// @}
+private:
+    class StreamWatermarksImpl;
+    std::unique_ptr<StreamWatermarksImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,100 @@
+#ifndef US8_UTILITIES_CLOCK_HPP
+#define US8_UTILITIES_CLOCK_HPP
+#include <chrono>
+#include <memory>
+namespace US8::Utilities
+{
+/// @class IClock "clock.hpp" "us8/utilities/clock.hpp"
+/// @brief An abstract base class for a source of the current UTC time.
+///        Code that reads the time through this can be driven by a simulated
+///        clock, e.g., when replaying archived data faster than real time.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class IClock
+{
+public:
+    /// @brief Destructor.
+    virtual ~IClock();
+    /// @result The current UTC time in microseconds from the epoch.
+    [[nodiscard]] virtual std::chrono::microseconds now() const noexcept = 0;
+};
+
+/// @class WallClock "clock.hpp" "us8/utilities/clock.hpp"
+/// @brief Reads the system clock on every call.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class WallClock final : public IClock
+{
+public:
+    /// @brief Constructor.
+    WallClock() = default;
+    /// @result The current UTC time in microseconds from the epoch.
+    [[nodiscard]] std::chrono::microseconds now() const noexcept final;
+    /// @brief Destructor.
+    ~WallClock() override;
+};
+
+/// @class CoarseClock "clock.hpp" "us8/utilities/clock.hpp"
+/// @brief A ticker thread reads the system clock at a fixed resolution so
+///        that reading the time is a single atomic load.  This is for hot
+///        loops that need the time of each packet but can tolerate an error
+///        of up to the resolution.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class CoarseClock final : public IClock
+{
+public:
+    /// @brief Constructs the clock and starts the ticker thread.
+    /// @param[in] resolution  The interval at which the time is updated.
+    /// @throws std::invalid_argument if resolution is not positive.
+    explicit CoarseClock(const std::chrono::milliseconds &resolution = std::chrono::milliseconds {1});
+    /// @result The UTC time in microseconds from the epoch at the last tick.
+    [[nodiscard]] std::chrono::microseconds now() const noexcept final;
+    /// @result The interval at which the time is updated.
+    [[nodiscard]] std::chrono::milliseconds getResolution() const noexcept;
+    /// @brief Stops the ticker thread.
+    ~CoarseClock() override;
+
+    CoarseClock(const CoarseClock &) = delete;
+    CoarseClock(CoarseClock &&) noexcept = delete;
+    CoarseClock& operator=(const CoarseClock &) = delete;
+    CoarseClock& operator=(CoarseClock &&) noexcept = delete;
+private:
+    class CoarseClockImpl;
+    std::unique_ptr<CoarseClockImpl> pImpl;
+};
+
+/// @class SimulatedClock "clock.hpp" "us8/utilities/clock.hpp"
+/// @brief A clock that is driven by the data.  The time is the latest time
+///        given to \c advance() and never runs backwards, so archived data
+///        can be replayed at any speed and tested as though it arrived in
+///        real time.
+/// @note This is thread-safe.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class SimulatedClock final : public IClock
+{
+public:
+    /// @brief Constructs the clock at the epoch.  The first call to
+    ///        \c advance() sets the time.
+    SimulatedClock();
+    /// @param[in] startTime  The initial UTC time in microseconds from the
+    ///                       epoch.
+    explicit SimulatedClock(const std::chrono::microseconds &startTime);
+    /// @brief Advances the clock.
+    /// @param[in] time  The UTC time in microseconds from the epoch - e.g.,
+    ///                  the time of the last sample in the latest packet.
+    ///                  If this precedes the current time then the clock is
+    ///                  unchanged.
+    void advance(const std::chrono::microseconds &time) noexcept;
+    /// @result The latest time given to \c advance().
+    [[nodiscard]] std::chrono::microseconds now() const noexcept final;
+    /// @brief Destructor.
+    ~SimulatedClock() override;
+
+    SimulatedClock(const SimulatedClock &) = delete;
+    SimulatedClock(SimulatedClock &&) noexcept = delete;
+    SimulatedClock& operator=(const SimulatedClock &) = delete;
+    SimulatedClock& operator=(SimulatedClock &&) noexcept = delete;
+private:
+    class SimulatedClockImpl;
+    std::unique_ptr<SimulatedClockImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,16 @@
+#ifndef US8_UTILITIES_WRITE_ATOMICALLY_HPP
+#define US8_UTILITIES_WRITE_ATOMICALLY_HPP
+#include <filesystem>
+#include <string>
+namespace US8::Utilities
+{
+/// @brief Writes a file so that a crash leaves either the old or the new
+///        contents.  The contents are written to a temporary file which is
+///        flushed to disk then renamed over the original.
+/// @param[in] fileName  The file to write.
+/// @param[in] contents  The file contents.
+/// @throws std::runtime_error if the file cannot be written.
+void writeAtomically(const std::filesystem::path &fileName,
+                     const std::string &contents);
+}
+#endif
@@ -15,11 +15,16 @@ using namespace US8::MessageFormats::Broadcasts;
 namespace
 {
 
+void convertStringInPlace(std::string *s)
+{
+    s->erase(std::remove(s->begin(), s->end(), ' '), s->end());
+    std::transform(s->begin(), s->end(), s->begin(), ::toupper);
+}
+
 std::string convertString(const std::string &s) 
 {
     auto temp = s;
-    temp.erase(std::remove(temp.begin(), temp.end(), ' '), temp.end());
-    std::transform(temp.begin(), temp.end(), temp.begin(), ::toupper);
+    convertStringInPlace(&temp);
     return temp;
 }
 
@@ -269,6 +274,13 @@ void DataPacket::setNetwork(const std::string &network)
     pImpl->mNetwork = ::convertString(network);
 }
 
+void DataPacket::setNetwork(std::string &&network)
+{
+    if (::isEmpty(network)){throw std::invalid_argument("Network is empty");}
+    ::convertStringInPlace(&network);
+    pImpl->mNetwork = std::move(network);
+}
+
 std::string DataPacket::getNetwork() const
 {
     if (!haveNetwork()){throw std::runtime_error("Network not set yet");}
@@ -287,6 +299,13 @@ void DataPacket::setStation(const std::string &station)
     pImpl->mStation = ::convertString(station);
 }
 
+void DataPacket::setStation(std::string &&station)
+{
+    if (::isEmpty(station)){throw std::invalid_argument("Station is empty");}
+    ::convertStringInPlace(&station);
+    pImpl->mStation = std::move(station);
+}
+
 std::string DataPacket::getStation() const
 {
     if (!haveStation()){throw std::runtime_error("Station not set yet");}
@@ -305,6 +324,13 @@ void DataPacket::setChannel(const std::string &channel)
     pImpl->mChannel = ::convertString(channel);
 }
 
+void DataPacket::setChannel(std::string &&channel)
+{
+    if (::isEmpty(channel)){throw std::invalid_argument("Channel is empty");}
+    ::convertStringInPlace(&channel);
+    pImpl->mChannel = std::move(channel);
+}
+
 std::string DataPacket::getChannel() const
 {
     if (!haveChannel()){throw std::runtime_error("Channel not set yet");}
@@ -323,6 +349,13 @@ void DataPacket::setLocationCode(const std::string &location)
     pImpl->mLocationCode = ::convertString(location);
 }
 
+void DataPacket::setLocationCode(std::string &&location)
+{
+    if (::isEmpty(location)){throw std::invalid_argument("Location is empty");}
+    ::convertStringInPlace(&location);
+    pImpl->mLocationCode = std::move(location);
+}
+
 std::string DataPacket::getLocationCode() const
 {
     if (!haveLocationCode())
@@ -0,0 +1,194 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include "us8/messageFormats/broadcasts/streamWatermarks.hpp"
+#include "private/isEmpty.hpp"
+
+#define MESSAGE_TYPE "US8::MessageFormats::Broadcasts::StreamWatermarks"
+#define MESSAGE_VERSION "1.0.0"
+
+using namespace US8::MessageFormats::Broadcasts;
+
+namespace
+{
+
+/// The streams and times are stored in parallel arrays which keeps the
+/// message compact
+nlohmann::json toJSONObject(const StreamWatermarks &watermarks)
+{
+    nlohmann::json obj;
+    obj["messageType"] = watermarks.getMessageType();
+    obj["messageVersion"] = watermarks.getMessageVersion();
+    std::vector<std::string> streams;
+    std::vector<int64_t> completeThrough;
+    streams.reserve(watermarks.size());
+    completeThrough.reserve(watermarks.size());
+    for (const auto &watermark : watermarks.getWatermarks())
+    {
+        streams.push_back(watermark.stream);
+        completeThrough.push_back(watermark.completeThrough.count());
+    }
+    obj["streams"] = std::move(streams);
+    obj["completeThrough"] = std::move(completeThrough);
+    return obj;
+}
+
+StreamWatermarks objectToStreamWatermarks(const nlohmann::json &obj)
+{
+    StreamWatermarks watermarks;
+    if (obj["messageType"] != watermarks.getMessageType())
+    {
+        throw std::invalid_argument("Message has invalid message type");
+    }
+    auto streams = obj["streams"].get<std::vector<std::string>> ();
+    auto completeThrough
+        = obj["completeThrough"].get<std::vector<int64_t>> ();
+    if (streams.size() != completeThrough.size())
+    {
+        throw std::invalid_argument("Inconsistent number of watermarks");
+    }
+    for (size_t i = 0; i < streams.size(); ++i)
+    {
+        watermarks.addWatermark(streams[i],
+                                std::chrono::microseconds {completeThrough[i]});
+    }
+    return watermarks;
+}
+
+}
+
+class StreamWatermarks::StreamWatermarksImpl
+{
+public:
+    std::vector<StreamWatermarks::Watermark> mWatermarks;
+};
+
+/// Constructor
+StreamWatermarks::StreamWatermarks() :
+    IMessage(),
+    pImpl(std::make_unique<StreamWatermarksImpl> ())
+{
+}
+
+/// Copy constructor
+StreamWatermarks::StreamWatermarks(const StreamWatermarks &watermarks)
+{
+    *this = watermarks;
+}
+
+/// Move constructor
+StreamWatermarks::StreamWatermarks(StreamWatermarks &&watermarks) noexcept
+{
+    *this = std::move(watermarks);
+}
+
+/// Construct from message
+StreamWatermarks::StreamWatermarks(const std::string_view &message) :
+    IMessage(),
+    pImpl(std::make_unique<StreamWatermarksImpl> ())
+{
+    deserialize(message);
+}
+
+/// Copy assignment
+StreamWatermarks& StreamWatermarks::operator=(const StreamWatermarks &watermarks)
+{
+    if (&watermarks == this){return *this;}
+    pImpl = std::make_unique<StreamWatermarksImpl> (*watermarks.pImpl);
+    return *this;
+}
+
+/// Move assignment
+StreamWatermarks& StreamWatermarks::operator=(
+    StreamWatermarks &&watermarks) noexcept
+{
+    if (&watermarks == this){return *this;}
+    pImpl = std::move(watermarks.pImpl);
+    return *this;
+}
+
+/// Destructor
+StreamWatermarks::~StreamWatermarks() = default;
+
+/// Clear class
+void StreamWatermarks::clear() noexcept
+{
+    pImpl->mWatermarks.clear();
+}
+
+/// Add a watermark
+void StreamWatermarks::addWatermark(
+    const std::string &stream,
+    const std::chrono::microseconds &completeThrough)
+{
+    if (::isEmpty(stream)){throw std::invalid_argument("Stream is empty");}
+    pImpl->mWatermarks.push_back(Watermark {stream, completeThrough});
+}
+
+/// Watermarks
+const std::vector<StreamWatermarks::Watermark>&
+    StreamWatermarks::getWatermarks() const noexcept
+{
+    return pImpl->mWatermarks;
+}
+
+/// Size
+int StreamWatermarks::size() const noexcept
+{
+    return static_cast<int> (pImpl->mWatermarks.size());
+}
+
+/// Empty?
+bool StreamWatermarks::empty() const noexcept
+{
+    return pImpl->mWatermarks.empty();
+}
+
+/// Message type
+std::string StreamWatermarks::getMessageType() const noexcept
+{
+    return MESSAGE_TYPE;
+}
+
+/// Message version
+std::string StreamWatermarks::getMessageVersion() const noexcept
+{
+    return MESSAGE_VERSION;
+}
+
+/// Copy this class
+std::unique_ptr<US8::MessageFormats::IMessage> StreamWatermarks::clone() const
+{
+    std::unique_ptr<US8::MessageFormats::IMessage> result
+        = std::make_unique<StreamWatermarks> (*this);
+    return result;
+}
+
+/// Create an instance of this class
+std::unique_ptr<US8::MessageFormats::IMessage>
+    StreamWatermarks::createInstance() const noexcept
+{
+    std::unique_ptr<US8::MessageFormats::IMessage> result
+        = std::make_unique<StreamWatermarks> ();
+    return result;
+}
+
+/// Convert message
+std::string StreamWatermarks::serialize() const
+{
+    auto obj = ::toJSONObject(*this);
+    auto message = nlohmann::json::to_cbor(obj);
+    std::string result(message.begin(), message.end());
+    return result;
+}
+
+/// Create from message
+void StreamWatermarks::deserialize(const std::string_view &message)
+{
+    if (message.empty()){throw std::invalid_argument("Message is empty");}
+    auto messageData = reinterpret_cast<const uint8_t *> (message.data());
+    auto obj = nlohmann::json::from_cbor(messageData,
+                                         messageData + message.size());
+    *this = ::objectToStreamWatermarks(obj);
+}
@@ -0,0 +1,59 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <spdlog/spdlog.h>
+#include "broadcasts/dataPacket/sanitizer/testDuplicateDataPacket.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "../duplicateDataPacket.hpp"
+
+// Compares the duplicate tester's time-ordered packet index with the circular
+// buffer it replaced.  The back-fill traffic is where the circular buffer's
+// linear searches and re-sorts are expensive.  Run
+//   duplicateDataPacketBenchmark --benchmark-samples 10
+
+namespace UDS = US8::Broadcasts::DataPacket::Sanitizer;
+
+namespace
+{
+// Five minutes of one second packets as estimated by the tester
+constexpr std::chrono::seconds RETENTION{300};
+constexpr int CAPACITY{451};
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::TestDuplicateDataPacket",
+          "[benchmark]")
+{
+    spdlog::set_level(spdlog::level::warn);
+    for (const bool backFill : {false, true})
+    {
+        const auto packets = ::createDuplicateTraffic(20, 3600, backFill);
+        const std::string traffic{backFill ? "back-fill" : "in order"};
+
+        BENCHMARK("circular buffer, " + traffic + " ("
+                + std::to_string(packets.size()) + " packets)")
+        {
+            ::CircularBufferDuplicateTester tester(CAPACITY);
+            int nAllowed{0};
+            for (const auto &packet : packets)
+            {
+                if (tester.allow(packet)){nAllowed = nAllowed + 1;}
+            }
+            return nAllowed;
+        };
+
+        BENCHMARK("packet index, " + traffic + " ("
+                + std::to_string(packets.size()) + " packets)")
+        {
+            UDS::TestDuplicateDataPacket tester(RETENTION,
+                                                std::chrono::seconds {-1});
+            int nAllowed{0};
+            for (const auto &packet : packets)
+            {
+                if (tester.allow(packet)){nAllowed = nAllowed + 1;}
+            }
+            return nAllowed;
+        };
+    }
+}
@@ -0,0 +1,217 @@
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <libmseed.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "broadcasts/dataPacket/miniSEED/unpacker.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+
+// Measures the SEEDLink decoder's per-record path on archived data.  Point
+// US8_MINISEED_CORPUS at a file of miniSEED records, e.g., a day of 512 byte
+// records from a real-time feed, then run
+//   miniSEEDUnpackerBenchmark --benchmark-samples 20
+// The baseline is the previous msr3_parse path on the same records.
+
+namespace
+{
+
+/// @brief Splits a file of miniSEED records into one buffer per record.
+[[nodiscard]] std::vector<std::vector<char>> loadCorpus()
+{
+    std::vector<std::vector<char>> records;
+    const char *fileName = std::getenv("US8_MINISEED_CORPUS");
+    if (fileName == nullptr){return records;}
+    std::ifstream file(fileName, std::ios::binary);
+    std::vector<char> buffer{std::istreambuf_iterator<char> (file),
+                             std::istreambuf_iterator<char> ()};
+    size_t offset{0};
+    while (offset < buffer.size())
+    {
+        uint8_t formatVersion{0};
+        auto recordLength = ms3_detect(buffer.data() + offset,
+                                       buffer.size() - offset,
+                                       &formatVersion);
+        if (recordLength <= 0 ||
+            offset + static_cast<size_t> (recordLength) > buffer.size())
+        {
+            break;
+        }
+        records.emplace_back(buffer.begin() + offset,
+                             buffer.begin() + offset + recordLength);
+        offset = offset + static_cast<size_t> (recordLength);
+    }
+    return records;
+}
+
+/// @brief The decoder the client used before the unpacker.  Each record is
+///        fully parsed into a freshly allocated MS3Record, the identifier is
+///        split into zero-filled scratch arrays, and the decoded samples are
+///        copied into the packet with setData.  This is the baseline.
+[[nodiscard]] US8::MessageFormats::Broadcasts::DataPacket
+    unpackWithMSR3Parse(const char *msRecord, const size_t bufferSize)
+{
+    constexpr int8_t verbose{0};
+    constexpr uint32_t flags{MSF_UNPACKDATA};
+    US8::MessageFormats::Broadcasts::DataPacket dataPacket;
+    MS3Record *miniSEEDRecord{nullptr};
+    auto returnCode = msr3_parse(msRecord, static_cast<uint64_t> (bufferSize),
+                                 &miniSEEDRecord, flags, verbose);
+    if (returnCode != MS_NOERROR || miniSEEDRecord == nullptr)
+    {
+        if (miniSEEDRecord){msr3_free(&miniSEEDRecord);}
+        throw std::runtime_error("libmseed error detected");
+    }
+    std::array<char, 64> networkWork;
+    std::array<char, 64> stationWork;
+    std::array<char, 64> channelWork;
+    std::array<char, 64> locationWork;
+    std::fill(networkWork.begin(),  networkWork.end(), '\0');
+    std::fill(stationWork.begin(),  stationWork.end(), '\0');
+    std::fill(channelWork.begin(),  channelWork.end(), '\0');
+    std::fill(locationWork.begin(), locationWork.end(), '\0');
+#ifdef USE_MS_VERSION_315
+    returnCode = ms_sid2nslc_n(miniSEEDRecord->sid,
+                               networkWork.data(), networkWork.size(),
+                               stationWork.data(), stationWork.size(),
+                               locationWork.data(), locationWork.size(),
+                               channelWork.data(), channelWork.size());
+#else
+    returnCode = ms_sid2nslc(miniSEEDRecord->sid,
+                             networkWork.data(), stationWork.data(),
+                             locationWork.data(), channelWork.data());
+#endif
+    if (returnCode != MS_NOERROR)
+    {
+        msr3_free(&miniSEEDRecord);
+        throw std::runtime_error("Failed to unpack SNCL");
+    }
+    std::string location{locationWork.data()};
+    if (locationWork[0] == '\0'){location = "--";}
+    if (std::string {"  "} == location.substr(0, 2)){location = "--";}
+    dataPacket.setNetwork(std::string {networkWork.data()});
+    dataPacket.setStation(std::string {stationWork.data()});
+    dataPacket.setChannel(std::string {channelWork.data()});
+    dataPacket.setLocationCode(location);
+    dataPacket.setSamplingRate(miniSEEDRecord->samprate);
+    dataPacket.setStartTime(std::chrono::microseconds
+    {
+        static_cast<int64_t> (std::round(miniSEEDRecord->starttime*1.e-3))
+    });
+    auto nSamples = static_cast<int> (miniSEEDRecord->numsamples);
+    if (nSamples > 0)
+    {
+        if (miniSEEDRecord->sampletype == 'i')
+        {
+            dataPacket.setData(nSamples,
+                               reinterpret_cast<const int *>
+                               (miniSEEDRecord->datasamples));
+        }
+        else if (miniSEEDRecord->sampletype == 'f')
+        {
+            dataPacket.setData(nSamples,
+                               reinterpret_cast<const float *>
+                               (miniSEEDRecord->datasamples));
+        }
+        else if (miniSEEDRecord->sampletype == 'd')
+        {
+            dataPacket.setData(nSamples,
+                               reinterpret_cast<const double *>
+                               (miniSEEDRecord->datasamples));
+        }
+        else
+        {
+            msr3_free(&miniSEEDRecord);
+            throw std::runtime_error("Unhandled sample type");
+        }
+    }
+    msr3_free(&miniSEEDRecord);
+    return dataPacket;
+}
+
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::MiniSEED", "[benchmark]")
+{
+    const auto records = ::loadCorpus();
+    if (records.empty())
+    {
+        SKIP("Set US8_MINISEED_CORPUS to a file of miniSEED records");
+    }
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+    packets.reserve(1);
+
+    // Both decoders must do the same work for the comparison to be fair
+    int64_t nExpectedSamples{0};
+    int64_t nBaselineSamples{0};
+    for (const auto &record : records)
+    {
+        packets.clear();
+        US8::Broadcasts::DataPacket::MiniSEED::unpack(
+            record.data(), record.size(), &packets);
+        nExpectedSamples = nExpectedSamples + packets.at(0).getNumberOfSamples();
+        nBaselineSamples = nBaselineSamples
+            + ::unpackWithMSR3Parse(record.data(), record.size())
+                 .getNumberOfSamples();
+    }
+    REQUIRE(nBaselineSamples == nExpectedSamples);
+
+    BENCHMARK("baseline: msr3_parse, msr3_free, and setData ("
+            + std::to_string(records.size()) + " records)")
+    {
+        int64_t nSamples{0};
+        for (const auto &record : records)
+        {
+            nSamples = nSamples
+                + ::unpackWithMSR3Parse(record.data(), record.size())
+                     .getNumberOfSamples();
+        }
+        return nSamples;
+    };
+
+    BENCHMARK("unpack corpus (" + std::to_string(records.size())
+            + " records)")
+    {
+        int64_t nSamples{0};
+        for (const auto &record : records)
+        {
+            packets.clear();
+            US8::Broadcasts::DataPacket::MiniSEED::unpack(
+                record.data(), record.size(), &packets);
+            nSamples = nSamples + packets.at(0).getNumberOfSamples();
+        }
+        return nSamples;
+    };
+
+    // The client's reader copies each record off the socket before handing
+    // it to a decoder
+    BENCHMARK("copy records into fresh buffers")
+    {
+        size_t nBytes{0};
+        for (const auto &record : records)
+        {
+            std::vector<char> payload(record.begin(), record.end());
+            nBytes = nBytes + payload.size();
+        }
+        return nBytes;
+    };
+
+    std::vector<char> recycledPayload;
+    BENCHMARK("copy records into a recycled buffer")
+    {
+        size_t nBytes{0};
+        for (const auto &record : records)
+        {
+            recycledPayload.assign(record.begin(), record.end());
+            nBytes = nBytes + recycledPayload.size();
+        }
+        return nBytes;
+    };
+}
@@ -0,0 +1,320 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <cstdlib>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <spdlog/spdlog.h>
+#include <zmq.hpp>
+#include <zmq_addon.hpp>
+#include <boost/program_options.hpp>
+
+// End-to-end throughput of the SEEDLink publisher.  This starts
+// seedLinkTestServer serving synthetic data as fast as it can, points
+// seedLinkDataPacketBroadcastPublisher at it, and counts what arrives on a
+// subscriber bound where the publisher expects the proxy's frontend.  The
+// result is the rate the whole path - socket reads, decoding, inline
+// sanitizing, and publishing - sustains.
+
+extern char **environ;
+
+#ifndef US8_TEST_SERVER
+#define US8_TEST_SERVER "seedLinkTestServer"
+#endif
+#ifndef US8_PUBLISHER
+#define US8_PUBLISHER "seedLinkDataPacketBroadcastPublisher"
+#endif
+
+struct ProgramOptions
+{
+    std::string server{US8_TEST_SERVER};
+    std::string publisher{US8_PUBLISHER};
+    std::string proxyFrontendAddress{"tcp://127.0.0.1:15550"};
+    std::chrono::seconds warmUp{5};
+    std::chrono::seconds duration{30};
+    int nStations{500};
+    int nDecoderThreads{1};
+    int nConnections{1};
+    int aggregationDuration{0};
+    uint16_t port{18100};
+};
+
+namespace
+{
+std::atomic<bool> mInterrupted{false};
+
+void signalHandler(const int )
+{
+    mInterrupted = true;
+}
+
+/// @brief Starts a program.
+[[nodiscard]] pid_t launch(const std::vector<std::string> &arguments)
+{
+    std::vector<char *> argv;
+    for (const auto &argument : arguments)
+    {
+        argv.push_back(const_cast<char *> (argument.c_str()));
+    }
+    argv.push_back(nullptr);
+    pid_t pid{-1};
+    if (posix_spawn(&pid, argv[0], nullptr, nullptr,
+                    argv.data(), environ) != 0)
+    {
+        throw std::runtime_error("Failed to launch " + arguments.at(0));
+    }
+    return pid;
+}
+
+/// @brief Asks a program to exit and waits for it.
+void terminate(const pid_t pid)
+{
+    if (pid <= 0){return;}
+    kill(pid, SIGINT);
+    int status{0};
+    waitpid(pid, &status, 0);
+}
+
+/// @brief Writes the publisher's initialization file.
+void writeIniFile(const std::filesystem::path &iniFile,
+                  const ::ProgramOptions &options)
+{
+    std::ofstream file(iniFile);
+    file << "[ZeroMQ]\n"
+         << "proxyFrontendAddress=" << options.proxyFrontendAddress << "\n"
+         << "sendHighWaterMark=0\n"
+         << "sendTimeOutInMilliSeconds=-1\n\n"
+         << "[Aggregator]\n"
+         << "maximumDurationInMilliSeconds="
+         << options.aggregationDuration << "\n\n"
+         << "[PublishingQueue]\n"
+         << "capacity=65536\n"
+         << "overflowPolicy=block\n\n"
+         // The synthetic data run ahead of the wall clock
+         << "[Sanitizer]\n"
+         << "preventFuturePackets=false\n\n"
+         << "[SEEDLink]\n"
+         << "address=127.0.0.1\n"
+         << "port=" << options.port << "\n"
+         << "numberOfDecoderThreads=" << options.nDecoderThreads << "\n"
+         << "numberOfConnections=" << options.nConnections << "\n"
+         << "maximumBackFillRate=0\n";
+    for (int i = 0; i < options.nStations; ++i)
+    {
+        std::array<char, 16> station;
+        snprintf(station.data(), station.size(), "T%04d", i);
+        file << "data_selector_" << i + 1 << "=XX " << station.data()
+             << " HH? 01\n";
+    }
+}
+
+std::pair<::ProgramOptions, bool> parseCommandLineOptions(int argc,
+                                                          char *argv[]);
+}
+
+int main(int argc, char *argv[])
+{
+    ::ProgramOptions options;
+    try
+    {
+        auto [commandLineOptions, isHelp]
+            = ::parseCommandLineOptions(argc, argv);
+        if (isHelp){return EXIT_SUCCESS;}
+        options = commandLineOptions;
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::error(e.what());
+        return EXIT_FAILURE;
+    }
+    struct sigaction action{};
+    action.sa_handler = ::signalHandler;
+    sigaction(SIGINT,  &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    // Stand in for the proxy.  This binds before the publisher connects so
+    // nothing is lost to the slow joiner.
+    zmq::context_t context{1};
+    zmq::socket_t subscriber{context, zmq::socket_type::sub};
+    subscriber.set(zmq::sockopt::rcvhwm, 0);
+    subscriber.set(zmq::sockopt::subscribe, "");
+    subscriber.set(zmq::sockopt::rcvtimeo, 100);
+    subscriber.bind(options.proxyFrontendAddress);
+
+    auto iniFile = std::filesystem::temp_directory_path()
+                 / ("us8SEEDLinkThroughput."
+                  + std::to_string(getpid()) + ".ini");
+    pid_t serverPID{-1};
+    pid_t publisherPID{-1};
+    try
+    {
+        ::writeIniFile(iniFile, options);
+        serverPID = ::launch({options.server,
+                              "--port=" + std::to_string(options.port),
+                              "--stations="
+                            + std::to_string(options.nStations),
+                              "--speed=0",
+                              "--verbosity=2"});
+        std::this_thread::sleep_for(std::chrono::milliseconds {500});
+        publisherPID = ::launch({options.publisher,
+                                 "--ini=" + iniFile.string()});
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::error(e.what());
+        ::terminate(publisherPID);
+        ::terminate(serverPID);
+        std::filesystem::remove(iniFile);
+        return EXIT_FAILURE;
+    }
+
+    spdlog::info("Warming up for "
+               + std::to_string(options.warmUp.count()) + " s...");
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto measureTime = startTime + options.warmUp;
+    const auto endTime = measureTime + options.duration;
+    auto reportTime = measureTime + std::chrono::seconds {1};
+    int64_t nMessages{0};
+    int64_t nBytes{0};
+    int64_t nIntervalMessages{0};
+    int64_t nIntervalBytes{0};
+    bool measuring{false};
+    while (!mInterrupted)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= endTime){break;}
+        if (!measuring && now >= measureTime)
+        {
+            spdlog::info("Measuring for "
+                       + std::to_string(options.duration.count()) + " s...");
+            measuring = true;
+        }
+        if (measuring && now >= reportTime)
+        {
+            std::cout << "Interval: " << nIntervalMessages << " packets/s, "
+                      << nIntervalBytes/(1024.*1024.) << " MB/s"
+                      << std::endl;
+            nIntervalMessages = 0;
+            nIntervalBytes = 0;
+            reportTime = reportTime + std::chrono::seconds {1};
+        }
+        zmq::multipart_t message;
+        if (!message.recv(subscriber)){continue;}
+        if (!measuring){continue;}
+        int64_t size{0};
+        for (const auto &part : message){size = size + part.size();}
+        nMessages = nMessages + 1;
+        nBytes = nBytes + size;
+        nIntervalMessages = nIntervalMessages + 1;
+        nIntervalBytes = nIntervalBytes + size;
+    }
+    ::terminate(publisherPID);
+    ::terminate(serverPID);
+    std::filesystem::remove(iniFile);
+
+    auto elapsed
+        = std::chrono::duration<double>
+          (std::min(std::chrono::steady_clock::now(), endTime)
+         - measureTime).count();
+    if (!measuring || elapsed <= 0)
+    {
+        spdlog::error("Interrupted before measuring");
+        return EXIT_FAILURE;
+    }
+    std::cout << "Stations: " << options.nStations
+              << ", decoder threads: " << options.nDecoderThreads
+              << ", connections: " << options.nConnections
+              << ", aggregation: " << options.aggregationDuration << " ms"
+              << std::endl;
+    std::cout << "Throughput: " << nMessages/elapsed << " packets/s, "
+              << nBytes/elapsed/(1024.*1024.) << " MB/s over "
+              << elapsed << " s" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+namespace
+{
+/// Read the program options from the command line
+std::pair<::ProgramOptions, bool> parseCommandLineOptions(int argc,
+                                                          char *argv[])
+{
+    ::ProgramOptions options;
+    boost::program_options::options_description desc(R"""(
+The seedLinkThroughputBenchmark measures how many packets per second the
+seedLinkDataPacketBroadcastPublisher can move from a SEEDLink server to
+ZeroMQ.  It launches seedLinkTestServer and the publisher then counts the
+packets published.
+
+Example usage:
+    seedLinkThroughputBenchmark --stations=1000 --decoder-threads=4
+
+Allowed options)""");
+    desc.add_options()
+        ("help", "Produces this help message")
+        ("server", boost::program_options::value<std::string> ()->default_value(options.server),
+                   "The seedLinkTestServer executable")
+        ("publisher", boost::program_options::value<std::string> ()->default_value(options.publisher),
+                      "The seedLinkDataPacketBroadcastPublisher executable")
+        ("port", boost::program_options::value<uint16_t> ()->default_value(options.port),
+                 "The test server's port")
+        ("proxy-frontend-address", boost::program_options::value<std::string> ()->default_value(options.proxyFrontendAddress),
+                                   "The address the publisher sends to")
+        ("stations", boost::program_options::value<int> ()->default_value(options.nStations),
+                     "The number of three-component stations")
+        ("decoder-threads", boost::program_options::value<int> ()->default_value(options.nDecoderThreads),
+                            "The publisher's number of miniSEED decoder threads")
+        ("connections", boost::program_options::value<int> ()->default_value(options.nConnections),
+                        "The publisher's number of SEEDLink connections")
+        ("aggregation", boost::program_options::value<int> ()->default_value(options.aggregationDuration),
+                        "The publisher's packet aggregation duration in milliseconds.  0 disables aggregation")
+        ("warm-up", boost::program_options::value<int> ()->default_value(static_cast<int> (options.warmUp.count())),
+                    "Seconds to run before measuring")
+        ("duration", boost::program_options::value<int> ()->default_value(static_cast<int> (options.duration.count())),
+                     "Seconds to measure");
+    boost::program_options::variables_map vm;
+    boost::program_options::store(
+        boost::program_options::parse_command_line(argc, argv, desc), vm);
+    boost::program_options::notify(vm);
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return {options, true};
+    }
+    options.server = vm["server"].as<std::string> ();
+    options.publisher = vm["publisher"].as<std::string> ();
+    options.port = vm["port"].as<uint16_t> ();
+    options.proxyFrontendAddress
+        = vm["proxy-frontend-address"].as<std::string> ();
+    options.nStations = vm["stations"].as<int> ();
+    if (options.nStations < 1 || options.nStations > 10000)
+    {
+        throw std::invalid_argument("Number of stations must be in [1,10000]");
+    }
+    options.nDecoderThreads = vm["decoder-threads"].as<int> ();
+    if (options.nDecoderThreads < 1)
+    {
+        throw std::invalid_argument("Number of decoder threads must be positive");
+    }
+    options.nConnections = vm["connections"].as<int> ();
+    if (options.nConnections < 1)
+    {
+        throw std::invalid_argument("Number of connections must be positive");
+    }
+    options.aggregationDuration = std::max(0, vm["aggregation"].as<int> ());
+    options.warmUp = std::chrono::seconds {std::max(0, vm["warm-up"].as<int> ())};
+    options.duration = std::chrono::seconds {vm["duration"].as<int> ()};
+    if (options.duration.count() < 1)
+    {
+        throw std::invalid_argument("Duration must be positive");
+    }
+    return {options, false};
+}
+}
@@ -0,0 +1,208 @@
+#ifndef US8_TESTING_DUPLICATE_DATA_PACKET_HPP
+#define US8_TESTING_DUPLICATE_DATA_PACKET_HPP
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <boost/circular_buffer.hpp>
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+
+namespace
+{
+
+/// @brief The duplicate tester as it was before the packets were indexed by
+///        start time.  Each stream's packets are held in a circular buffer
+///        that is searched linearly and re-sorted after a back-fill.  This
+///        is the reference for the time-ordered index.
+class CircularBufferDuplicateTester
+{
+public:
+    explicit CircularBufferDuplicateTester(const int capacity) :
+        mCapacity(capacity)
+    {
+    }
+    [[nodiscard]] bool allow(
+        const US8::MessageFormats::Broadcasts::DataPacket &packet)
+    {
+        Header header;
+        header.startTime = packet.getStartTime();
+        header.endTime = packet.getEndTime();
+        header.samplingRate
+            = static_cast<int> (std::round(packet.getSamplingRate()));
+        header.nSamples = packet.getNumberOfSamples();
+        auto name = packet.getNetwork() + "." + packet.getStation()
+                  + "." + packet.getChannel()
+                  + "." + packet.getLocationCode();
+        auto bufferIndex = mCircularBuffers.find(name);
+        if (bufferIndex == mCircularBuffers.end())
+        {
+            boost::circular_buffer<Header> newBuffer(mCapacity);
+            newBuffer.push_back(header);
+            mCircularBuffers.insert(std::pair {name, std::move(newBuffer)});
+            return true;
+        }
+        auto &buffer = bufferIndex->second;
+        if (std::find_if(buffer.begin(), buffer.end(),
+                         [&](const Header &other)
+                         {
+                             return header.isDuplicate(other);
+                         }) != buffer.end())
+        {
+            return false;
+        }
+        if (header.startTime > buffer.back().endTime)
+        {
+            buffer.push_back(header);
+            return true;
+        }
+        if (header.endTime < buffer.front().startTime)
+        {
+            if (!buffer.full()){buffer.push_front(header);}
+            return false;
+        }
+        for (const auto &other : buffer)
+        {
+            if ((header.startTime >= other.startTime &&
+                 header.startTime <= other.endTime) ||
+                (header.endTime >= other.startTime &&
+                 header.endTime <= other.endTime))
+            {
+                return false;
+            }
+        }
+        buffer.push_back(header);
+        std::sort(buffer.begin(), buffer.end(),
+                  [](const Header &lhs, const Header &rhs)
+                  {
+                      return lhs.startTime < rhs.startTime;
+                  });
+        return true;
+    }
+private:
+    struct Header
+    {
+        [[nodiscard]] bool isDuplicate(const Header &other) const
+        {
+            if (other.nSamples != nSamples){return false;}
+            auto dStartTime = std::abs(other.startTime.count()
+                                     - startTime.count());
+            if (samplingRate < 105){return dStartTime < 15000;}
+            if (samplingRate < 255){return dStartTime < 4500;}
+            if (samplingRate < 505){return dStartTime < 2500;}
+            return dStartTime < 1500;
+        }
+        std::chrono::microseconds startTime{0};
+        std::chrono::microseconds endTime{0};
+        int samplingRate{100};
+        int nSamples{0};
+    };
+    std::map<std::string, boost::circular_buffer<Header>> mCircularBuffers;
+    int mCapacity{100};
+};
+
+/// @brief Creates the traffic of several 100 Hz streams sending one second
+///        packets with timing jitter.  Interleaved with the real-time
+///        packets are
+///          - back-fills that arrive out of order,
+///          - re-transmissions, some with their start time jittered within
+///            the duplicate tolerance,
+///          - packets whose times slipped so they overlap processed packets,
+///          - and re-transmissions of packets older than the tester retains.
+/// @param[in] nStreams   The number of streams.
+/// @param[in] nPackets   The number of packets in each stream.
+/// @param[in] backFill   True mixes in the out-of-order packets.  Otherwise,
+///                       each stream is in order and without duplicates.
+[[nodiscard]] std::vector<US8::MessageFormats::Broadcasts::DataPacket>
+    createDuplicateTraffic(const int nStreams, const int nPackets,
+                           const bool backFill)
+{
+    constexpr int nSamples{100};
+    constexpr int64_t startTime{1706745600000000};
+    std::mt19937 generator(8675309);
+    std::uniform_int_distribution<int> jitter(0, 2000);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<int32_t> data(nSamples, 0);
+    std::vector<std::vector<US8::MessageFormats::Broadcasts::DataPacket>>
+        streams(nStreams);
+    for (int iStream = 0; iStream < nStreams; ++iStream)
+    {
+        US8::MessageFormats::Broadcasts::DataPacket packet;
+        packet.setNetwork("UU");
+        packet.setStation("S" + std::to_string(iStream));
+        packet.setChannel("HHZ");
+        packet.setLocationCode("01");
+        packet.setSamplingRate(100);
+        packet.setData(nSamples, data.data());
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> sent;
+        for (int i = 0; i < nPackets; ++i)
+        {
+            packet.setStartTime(std::chrono::microseconds
+                                {startTime + i*1000000LL + jitter(generator)});
+            sent.push_back(packet);
+        }
+        if (backFill)
+        {
+            // Back-fills from a reconnecting data logger
+            for (int i = 0; i + 200 < nPackets; i = i + 1000)
+            {
+                std::shuffle(sent.begin() + i, sent.begin() + i + 200,
+                             generator);
+            }
+        }
+        auto &stream = streams[iStream];
+        for (int i = 0; i < static_cast<int> (sent.size()); ++i)
+        {
+            stream.push_back(sent[i]);
+            if (!backFill){continue;}
+            auto roll = percent(generator);
+            auto copy = sent[i];
+            if (roll < 5)
+            {
+                // Alternate telemetry route
+                stream.push_back(copy);
+            }
+            else if (roll < 8)
+            {
+                copy.setStartTime(copy.getStartTime()
+                                + std::chrono::microseconds {9000});
+                stream.push_back(copy);
+            }
+            else if (roll < 9)
+            {
+                // Timing slip
+                copy.setStartTime(copy.getStartTime()
+                                + std::chrono::microseconds {400000});
+                stream.push_back(copy);
+            }
+            else if (roll < 10 && i > 500)
+            {
+                // Long delayed re-transmission
+                stream.push_back(sent[i - 500]);
+            }
+        }
+    }
+    // Interleave the streams like a data feed
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+    std::vector<size_t> positions(nStreams, 0);
+    bool remaining{true};
+    while (remaining)
+    {
+        remaining = false;
+        for (int iStream = 0; iStream < nStreams; ++iStream)
+        {
+            if (positions[iStream] < streams[iStream].size())
+            {
+                packets.push_back(streams[iStream][positions[iStream]]);
+                positions[iStream] = positions[iStream] + 1;
+                remaining = true;
+            }
+        }
+    }
+    return packets;
+}
+
+}
+#endif
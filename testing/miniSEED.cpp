@@ -0,0 +1,294 @@
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <libmseed.h>
+#include <catch2/catch_test_macros.hpp>
+#include "broadcasts/dataPacket/miniSEED/steim.hpp"
+#include "broadcasts/dataPacket/miniSEED/unpacker.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+
+namespace UMS = US8::Broadcasts::DataPacket::MiniSEED;
+
+namespace
+{
+
+/// @brief Makes a random walk that steps through every difference width
+///        Steim can pack.  Each run is long enough that the encoder fills
+///        whole words with that width.
+[[nodiscard]] std::vector<int32_t> createSignal(const bool steim1)
+{
+    std::vector<int> widths{4, 5, 6, 8, 10, 15, 16, 30};
+    if (steim1){widths.push_back(31);}
+    std::mt19937 generator(86754309);
+    std::vector<int32_t> signal{12345};
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        for (const auto width : widths)
+        {
+            const int32_t bound = (int32_t {1} << (width - 1)) - 1;
+            std::uniform_int_distribution<int32_t> distribution(-bound, bound);
+            for (int i = 0; i < 71; ++i)
+            {
+                // Keep the walk near zero so a full width step cannot
+                // overflow
+                auto step = distribution(generator);
+                if ((signal.back() > 0 && step > 0) ||
+                    (signal.back() < 0 && step < 0))
+                {
+                    step =-step;
+                }
+                signal.push_back(signal.back() + step);
+            }
+        }
+    }
+    return signal;
+}
+
+/// @brief Collects the records libmseed packs.
+void appendRecord(char *record, int recordLength, void *records)
+{
+    static_cast<std::vector<std::vector<char>> *> (records)
+        ->emplace_back(record, record + recordLength);
+}
+
+/// @brief Packs a signal into 512 byte miniSEED2 records with libmseed's
+///        Steim encoder.  The last record's final frame is partially full.
+[[nodiscard]] std::vector<std::vector<char>>
+    packSignal(std::vector<int32_t> signal, const int16_t encoding)
+{
+    std::vector<std::vector<char>> records;
+    MS3Record *record = msr3_init(nullptr);
+    REQUIRE(record != nullptr);
+    std::strncpy(record->sid, "FDSN:UU_TEST_01_H_H_Z", LM_SIDLEN - 1);
+    record->formatversion = 2;
+    record->reclen = 512;
+    record->encoding = encoding;
+    record->pubversion = 1;
+    record->samprate = 100;
+    record->starttime = 1706745600123456789;
+    record->datasamples = signal.data();
+    record->numsamples = static_cast<int64_t> (signal.size());
+    record->sampletype = 'i';
+    int64_t nPacked{0};
+    constexpr int8_t verbose{0};
+    auto nRecords = msr3_pack(record, ::appendRecord, &records,
+                              &nPacked, MSF_FLUSHDATA, verbose);
+    // The signal belongs to the caller
+    record->datasamples = nullptr;
+    msr3_free(&record);
+    REQUIRE(nRecords > 1);
+    REQUIRE(nPacked == static_cast<int64_t> (signal.size()));
+    return records;
+}
+
+/// @brief Loads the records in the file named by US8_MINISEED_CORPUS.
+[[nodiscard]] std::vector<std::vector<char>> loadCorpus()
+{
+    std::vector<std::vector<char>> records;
+    const char *fileName = std::getenv("US8_MINISEED_CORPUS");
+    if (fileName == nullptr){return records;}
+    std::ifstream file(fileName, std::ios::binary);
+    std::vector<char> buffer{std::istreambuf_iterator<char> (file),
+                             std::istreambuf_iterator<char> ()};
+    size_t offset{0};
+    while (offset < buffer.size())
+    {
+        uint8_t formatVersion{0};
+        auto recordLength = ms3_detect(buffer.data() + offset,
+                                       buffer.size() - offset,
+                                       &formatVersion);
+        if (recordLength <= 0 ||
+            offset + static_cast<size_t> (recordLength) > buffer.size())
+        {
+            break;
+        }
+        records.emplace_back(buffer.begin() + offset,
+                             buffer.begin() + offset + recordLength);
+        offset = offset + static_cast<size_t> (recordLength);
+    }
+    return records;
+}
+
+/// @brief Decodes a Steim record's first nSamples samples with both
+///        decoders and checks they agree.
+void compareDecoders(const std::vector<char> &buffer, const int nSamples)
+{
+    MS3Record *record{nullptr};
+    constexpr int8_t verbose{0};
+    REQUIRE(msr3_parse(buffer.data(), buffer.size(),
+                       &record, 0, verbose) == MS_NOERROR);
+    REQUIRE((record->encoding == DE_STEIM1 || record->encoding == DE_STEIM2));
+    uint32_t payloadOffset{0};
+    uint32_t payloadLength{0};
+    REQUIRE(msr3_data_bounds(record, &payloadOffset, &payloadLength) == 0);
+    const auto payload = buffer.data() + payloadOffset;
+    const int8_t swapFlag = ms_bigendianhost() ? 0 : 1;
+    const auto n = std::min(static_cast<int64_t> (nSamples),
+                            record->samplecnt);
+    std::vector<int32_t> reference(static_cast<size_t> (record->samplecnt));
+    char sampleType{'\0'};
+    auto nReference = ms_decode_data(payload, payloadLength,
+                                     static_cast<uint8_t> (record->encoding),
+                                     static_cast<uint64_t> (record->samplecnt),
+                                     reference.data(),
+                                     reference.size()*sizeof(int32_t),
+                                     &sampleType, swapFlag,
+                                     record->sid, verbose);
+    REQUIRE(nReference == record->samplecnt);
+    reference.resize(static_cast<size_t> (n));
+    // The frames as they are on the wire
+    std::vector<int32_t> samples(static_cast<size_t> (n), 0);
+    if (record->encoding == DE_STEIM1)
+    {
+        UMS::decodeSteim1(payload, payloadLength, static_cast<int> (n),
+                          swapFlag != 0, samples.data());
+    }
+    else
+    {
+        UMS::decodeSteim2(payload, payloadLength, static_cast<int> (n),
+                          swapFlag != 0, samples.data());
+    }
+    CHECK(samples == reference);
+    // The frames in the other byte order
+    std::vector<char> swapped(payload, payload + payloadLength);
+    for (size_t i = 0; i + 4 <= swapped.size(); i = i + 4)
+    {
+        std::swap(swapped[i], swapped[i + 3]);
+        std::swap(swapped[i + 1], swapped[i + 2]);
+    }
+    std::fill(samples.begin(), samples.end(), 0);
+    if (record->encoding == DE_STEIM1)
+    {
+        UMS::decodeSteim1(swapped.data(), swapped.size(),
+                          static_cast<int> (n), swapFlag == 0,
+                          samples.data());
+    }
+    else
+    {
+        UMS::decodeSteim2(swapped.data(), swapped.size(),
+                          static_cast<int> (n), swapFlag == 0,
+                          samples.data());
+    }
+    CHECK(samples == reference);
+    msr3_free(&record);
+}
+
+/// @brief Checks the decoder for an encoding against libmseed.
+void checkSteim(const int16_t encoding)
+{
+    const bool steim1 = (encoding == DE_STEIM1);
+    const auto signal = ::createSignal(steim1);
+    const auto records = ::packSignal(signal, encoding);
+    SECTION("Matches libmseed")
+    {
+        for (const auto &record : records)
+        {
+            ::compareDecoders(record, std::numeric_limits<int>::max());
+        }
+    }
+    SECTION("Stops mid-frame")
+    {
+        // Every stopping point in the first record's words and frames
+        for (int n = 1; n < 128; ++n)
+        {
+            ::compareDecoders(records.at(0), n);
+        }
+    }
+    SECTION("Round trips")
+    {
+        std::vector<int32_t> decoded;
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+        for (const auto &record : records)
+        {
+            packets.clear();
+            UMS::unpack(record.data(), record.size(), &packets);
+            REQUIRE(packets.size() == 1);
+            auto data = packets[0].getData<int32_t> ();
+            decoded.insert(decoded.end(), data.begin(), data.end());
+        }
+        CHECK(decoded == signal);
+    }
+    SECTION("Rejects short frames")
+    {
+        std::vector<int32_t> samples(64);
+        if (steim1)
+        {
+            CHECK_THROWS(UMS::decodeSteim1(records.at(0).data() + 64, 63,
+                                           1, true, samples.data()));
+        }
+        else
+        {
+            CHECK_THROWS(UMS::decodeSteim2(records.at(0).data() + 64, 63,
+                                           1, true, samples.data()));
+        }
+    }
+}
+
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::MiniSEED::decodeSteim1", "[steim]")
+{
+    ::checkSteim(DE_STEIM1);
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::MiniSEED::decodeSteim2", "[steim]")
+{
+    ::checkSteim(DE_STEIM2);
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::MiniSEED::unpack", "[unpacker]")
+{
+    // The miniSEED2 headers are read without libmseed so check them against
+    // msr3_parse
+    auto records = ::packSignal(::createSignal(false), DE_STEIM2);
+    for (const auto &buffer : records)
+    {
+        std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+        UMS::unpack(buffer.data(), buffer.size(), &packets);
+        REQUIRE(packets.size() == 1);
+        MS3Record *record{nullptr};
+        REQUIRE(msr3_parse(buffer.data(), buffer.size(),
+                           &record, 0, 0) == MS_NOERROR);
+        CHECK(packets[0].getNetwork() == "UU");
+        CHECK(packets[0].getStation() == "TEST");
+        CHECK(packets[0].getChannel() == "HHZ");
+        CHECK(packets[0].getLocationCode() == "01");
+        CHECK(packets[0].getSamplingRate() == record->samprate);
+        CHECK(packets[0].getStartTime().count() ==
+              static_cast<int64_t> (std::round(record->starttime*1.e-3)));
+        CHECK(packets[0].getNumberOfSamples() == record->samplecnt);
+        msr3_free(&record);
+    }
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::MiniSEED::Corpus", "[steim]")
+{
+    // Archived records, when available, cover encoder quirks the synthetic
+    // signal does not
+    const auto records = ::loadCorpus();
+    if (records.empty())
+    {
+        SKIP("Set US8_MINISEED_CORPUS to a file of miniSEED records");
+    }
+    for (const auto &buffer : records)
+    {
+        MS3Record *record{nullptr};
+        if (msr3_parse(buffer.data(), buffer.size(),
+                       &record, 0, 0) != MS_NOERROR){continue;}
+        const bool isSteim = (record->encoding == DE_STEIM1 ||
+                              record->encoding == DE_STEIM2) &&
+                             record->samplecnt > 0;
+        msr3_free(&record);
+        if (isSteim)
+        {
+            ::compareDecoders(buffer, std::numeric_limits<int>::max());
+        }
+    }
+}
@@ -0,0 +1,894 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <nlohmann/json.hpp>
+#include "broadcasts/dataPacket/sanitizer/availabilityIndex.hpp"
+#include "broadcasts/dataPacket/sanitizer/reorderBuffer.hpp"
+#include "broadcasts/dataPacket/sanitizer/testClippedDataPacket.hpp"
+#include "broadcasts/dataPacket/sanitizer/testDuplicateDataPacket.hpp"
+#include "broadcasts/dataPacket/sanitizer/testExpiredDataPacket.hpp"
+#include "broadcasts/dataPacket/sanitizer/testFlatLinedDataPacket.hpp"
+#include "broadcasts/dataPacket/sanitizer/testFutureDataPacket.hpp"
+#include "broadcasts/dataPacket/sanitizer/testSpikedDataPacket.hpp"
+#include "broadcasts/dataPacket/sanitizer/waveformStatistics.hpp"
+#include "broadcasts/dataPacket/sanitizer/watermarkTracker.hpp"
+#include "broadcasts/dataPacket/sanitizer/contentHash.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+#include "us8/messageFormats/broadcasts/streamWatermarks.hpp"
+#include "us8/utilities/clock.hpp"
+#include "duplicateDataPacket.hpp"
+
+namespace UDS = US8::Broadcasts::DataPacket::Sanitizer;
+
+namespace
+{
+
+/// @brief Checks the packet index's decisions against the circular buffer's.
+void compareDuplicateTesters(
+    const std::vector<US8::MessageFormats::Broadcasts::DataPacket> &packets,
+    const int capacity)
+{
+    ::CircularBufferDuplicateTester reference(capacity);
+    UDS::TestDuplicateDataPacket tester(capacity, std::chrono::seconds {-1});
+    int nRejected{0};
+    for (size_t i = 0; i < packets.size(); ++i)
+    {
+        auto expected = reference.allow(packets[i]);
+        auto allow = tester.allow(packets[i]);
+        if (allow != expected)
+        {
+            FAIL("Packet " + std::to_string(i) + " with start time "
+               + std::to_string(packets[i].getStartTime().count())
+               + " differs from the circular buffer");
+        }
+        if (!allow){nRejected = nRejected + 1;}
+    }
+    // Make sure the traffic exercised the rejections
+    if (packets.size() > 1000){CHECK(nRejected > 0);}
+}
+
+/// @brief A packet at 100 Hz with the given samples.
+template<typename T>
+[[nodiscard]] US8::MessageFormats::Broadcasts::DataPacket
+    createWaveformPacket(const std::chrono::microseconds &startTime,
+                         const std::vector<T> &data)
+{
+    US8::MessageFormats::Broadcasts::DataPacket packet;
+    packet.setNetwork("UU");
+    packet.setStation("FORK");
+    packet.setChannel("HHZ");
+    packet.setLocationCode("01");
+    packet.setSamplingRate(100);
+    packet.setStartTime(startTime);
+    packet.setData(static_cast<int> (data.size()), data.data());
+    return packet;
+}
+
+/// @brief Deterministic noise uniformly distributed in [-amplitude, amplitude].
+[[nodiscard]] std::vector<int32_t> createNoise(const int n,
+                                               const int32_t amplitude,
+                                               uint64_t seed)
+{
+    std::vector<int32_t> data(n);
+    for (auto &sample : data)
+    {
+        seed = seed*6364136223846793005ULL + 1442695040888963407ULL;
+        sample = static_cast<int32_t> ((seed >> 33) % (2*amplitude + 1))
+               - amplitude;
+    }
+    return data;
+}
+
+/// @brief Fills a buffer like xxHash's sanity test.
+[[nodiscard]] std::vector<unsigned char> createSanityBuffer(const size_t length)
+{
+    std::vector<unsigned char> buffer(length);
+    uint64_t generator{2654435761U};
+    for (auto &byte : buffer)
+    {
+        byte = static_cast<unsigned char> (generator >> 56);
+        generator = generator*11400714785074694797ULL;
+    }
+    return buffer;
+}
+
+/// @brief XXH64 as written in the specification.  Lanes are assembled from
+///        bytes so this is independent of the host's byte order and of the
+///        optimized implementation's loads.
+[[nodiscard]] uint64_t referenceXXHash64(const unsigned char *input,
+                                         const size_t length,
+                                         const uint64_t seed)
+{
+    constexpr uint64_t PRIME1{11400714785074694791ULL};
+    constexpr uint64_t PRIME2{14029467366897019727ULL};
+    constexpr uint64_t PRIME3{1609587929392839161ULL};
+    constexpr uint64_t PRIME4{9650029242287828579ULL};
+    constexpr uint64_t PRIME5{2870177450012600261ULL};
+    auto rotl = [](const uint64_t x, const int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    };
+    auto lane = [&](const size_t offset, const size_t nBytes)
+    {
+        uint64_t value{0};
+        for (size_t i = 0; i < nBytes; ++i)
+        {
+            value = value | (static_cast<uint64_t> (input[offset + i]) << (8*i));
+        }
+        return value;
+    };
+    auto round = [&](const uint64_t accumulator, const uint64_t value)
+    {
+        return rotl(accumulator + value*PRIME2, 31)*PRIME1;
+    };
+    size_t offset{0};
+    uint64_t hash{0};
+    if (length >= 32)
+    {
+        uint64_t accumulators[4]{seed + PRIME1 + PRIME2, seed + PRIME2,
+                                 seed, seed - PRIME1};
+        for (; offset + 32 <= length; offset = offset + 32)
+        {
+            for (size_t i = 0; i < 4; ++i)
+            {
+                accumulators[i] = round(accumulators[i],
+                                        lane(offset + 8*i, 8));
+            }
+        }
+        hash = rotl(accumulators[0], 1) + rotl(accumulators[1], 7)
+             + rotl(accumulators[2], 12) + rotl(accumulators[3], 18);
+        for (const auto accumulator : accumulators)
+        {
+            hash = (hash ^ round(0, accumulator))*PRIME1 + PRIME4;
+        }
+    }
+    else
+    {
+        hash = seed + PRIME5;
+    }
+    hash = hash + length;
+    for (; offset + 8 <= length; offset = offset + 8)
+    {
+        hash = rotl(hash ^ round(0, lane(offset, 8)), 27)*PRIME1 + PRIME4;
+    }
+    if (offset + 4 <= length)
+    {
+        hash = rotl(hash ^ (lane(offset, 4)*PRIME1), 23)*PRIME2 + PRIME3;
+        offset = offset + 4;
+    }
+    for (; offset < length; ++offset)
+    {
+        hash = rotl(hash ^ (lane(offset, 1)*PRIME5), 11)*PRIME1;
+    }
+    hash = (hash ^ (hash >> 33))*PRIME2;
+    hash = (hash ^ (hash >> 29))*PRIME3;
+    return hash ^ (hash >> 32);
+}
+
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::xxHash64", "[contentHash]")
+{
+    SECTION("Reference vectors")
+    {
+        // From xxHash's sanity test
+        constexpr uint64_t PRIME32{2654435761U};
+        const auto buffer = ::createSanityBuffer(222);
+        CHECK(::xxHash64(buffer.data(), 0, 0) == 0xEF46DB3751D8E999ULL);
+        CHECK(::xxHash64(buffer.data(), 0, PRIME32) == 0xAC75FDA2929B17EFULL);
+        CHECK(::xxHash64(buffer.data(), 1, 0) == 0xE934A84ADB052768ULL);
+        CHECK(::xxHash64(buffer.data(), 1, PRIME32) == 0x5014607643A9B4C3ULL);
+        CHECK(::xxHash64(buffer.data(), 4, 0) == 0x9136A0DCA57457EEULL);
+        CHECK(::xxHash64(buffer.data(), 14, 0) == 0x8282DCC4994E35C8ULL);
+        CHECK(::xxHash64(buffer.data(), 14, PRIME32) == 0xC3BD6BF63DEB6DF0ULL);
+        CHECK(::xxHash64(buffer.data(), 222, 0) == 0xB641AE8CB691C174ULL);
+        CHECK(::xxHash64(buffer.data(), 222, PRIME32) == 0x20CB8AB7AE10C14AULL);
+        // Strings
+        const std::string abc{"abc"};
+        CHECK(::xxHash64(abc.data(), abc.size()) == 0x44BC2CF5AD770999ULL);
+        const std::string xxhash{"xxhash"};
+        CHECK(::xxHash64(xxhash.data(), xxhash.size()) == 0x32DD38952C4BC720ULL);
+        CHECK(::xxHash64(xxhash.data(), xxhash.size(), 20141025)
+              == 0xB559B98D844E0635ULL);
+        const std::string sentence{"Nobody inspects the spammish repetition"};
+        CHECK(::xxHash64(sentence.data(), sentence.size())
+              == 0xFBCEA83C8A378BF1ULL);
+    }
+    SECTION("Tails")
+    {
+        // Every combination of 32 byte stripes, 8 and 4 byte words, and
+        // trailing bytes from unaligned addresses
+        const auto buffer = ::createSanityBuffer(160);
+        for (size_t offset = 0; offset < 8; ++offset)
+        {
+            for (size_t length = 0; length + offset <= 144; ++length)
+            {
+                const auto *input = buffer.data() + offset;
+                CHECK(::xxHash64(input, length, 0) ==
+                      ::referenceXXHash64(input, length, 0));
+                CHECK(::xxHash64(input, length, 2654435761U) ==
+                      ::referenceXXHash64(input, length, 2654435761U));
+            }
+        }
+    }
+    SECTION("Content hash")
+    {
+        // The data type seeds the hash
+        std::vector<int32_t> integers(100, 0);
+        std::vector<float> floats(100, 0);
+        US8::MessageFormats::Broadcasts::DataPacket packet;
+        packet.setData(static_cast<int> (integers.size()), integers.data());
+        auto integerHash = ::toContentHash(packet);
+        CHECK(integerHash ==
+              ::xxHash64(integers.data(), integers.size()*sizeof(int32_t),
+                         static_cast<uint64_t> (packet.getDataType())));
+        packet.setData(static_cast<int> (floats.size()), floats.data());
+        CHECK(::toContentHash(packet) != integerHash);
+        integers[50] = 1;
+        packet.setData(static_cast<int> (integers.size()), integers.data());
+        CHECK(::toContentHash(packet) != integerHash);
+    }
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::TestDuplicateDataPacket",
+          "[duplicate]")
+{
+    SECTION("In order")
+    {
+        auto packets = ::createDuplicateTraffic(4, 2000, false);
+        UDS::TestDuplicateDataPacket tester(100, std::chrono::seconds {-1});
+        for (const auto &packet : packets)
+        {
+            REQUIRE(tester.allow(packet));
+        }
+        // Everything again is a duplicate
+        for (const auto &packet : packets)
+        {
+            CHECK(!tester.allow(packet));
+        }
+    }
+    SECTION("Matches the circular buffer")
+    {
+        // The capacities are shorter than, similar to, and longer than the
+        // back-fill windows and re-transmission delays
+        auto packets = ::createDuplicateTraffic(4, 3000, true);
+        for (const int capacity : {10, 150, 600})
+        {
+            ::compareDuplicateTesters(packets, capacity);
+        }
+    }
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::AvailabilityIndex",
+          "[availability]")
+{
+    using namespace std::chrono_literals;
+    // 1 s packets at 100 Hz starting at 1000 s
+    auto createPacket = [](const std::chrono::seconds &startTime)
+    {
+        std::vector<int32_t> data(100, 0);
+        US8::MessageFormats::Broadcasts::DataPacket packet;
+        packet.setNetwork("UU");
+        packet.setStation("FORK");
+        packet.setChannel("HHZ");
+        packet.setLocationCode("01");
+        packet.setSamplingRate(100);
+        packet.setStartTime(std::chrono::microseconds {startTime});
+        packet.setData(static_cast<int> (data.size()), data.data());
+        return packet;
+    };
+    UDS::AvailabilityIndex index{60s};
+    const std::chrono::microseconds now{1100s};
+    for (int i = 0; i < 30; ++i)
+    {
+        if (i == 10){continue;}
+        index.update(createPacket(std::chrono::seconds {1060 + i}), now);
+    }
+    SECTION("Latency is not a gap")
+    {
+        // Data runs through 1090 s so the 10 s to now is latency
+        auto availability = index.getAvailability(now);
+        REQUIRE(availability.size() == 1);
+        CHECK(availability[0].stream == "UU.FORK.HHZ.01");
+        CHECK(availability[0].window.startTime == 1060s);
+        CHECK(availability[0].window.endTime == 1090s);
+        CHECK(availability[0].latency == 10s);
+        REQUIRE(availability[0].gaps.size() == 1);
+        CHECK(availability[0].gaps[0].startTime == 1070s);
+        CHECK(availability[0].gaps[0].endTime == 1071s);
+        CHECK(availability[0].largestGap == 1s);
+        CHECK(std::abs(availability[0].percentComplete - 100.*29/30) < 1.e-8);
+    }
+    SECTION("Complete")
+    {
+        index.update(createPacket(1070s), now);
+        auto availability = index.getAvailability(now);
+        REQUIRE(availability.size() == 1);
+        CHECK(availability[0].gaps.empty());
+        CHECK(availability[0].largestGap == 0s);
+        CHECK(availability[0].percentComplete == 100);
+        CHECK(availability[0].latency == 10s);
+        // A duplicate is an overlap
+        index.update(createPacket(1080s), now);
+        availability = index.getAvailability(now);
+        REQUIRE(availability[0].overlaps.size() == 1);
+        CHECK(availability[0].overlaps[0].startTime == 1080s);
+        CHECK(availability[0].overlaps[0].endTime == 1081s);
+    }
+    SECTION("Explicit window")
+    {
+        // An explicit query still reports the trailing gap
+        auto availability
+            = index.getAvailability("UU.FORK.HHZ.01", 1060s, 1100s);
+        REQUIRE(availability.gaps.size() == 2);
+        CHECK(availability.gaps[1].startTime == 1090s);
+        CHECK(availability.gaps[1].endTime == 1100s);
+        CHECK(availability.largestGap == 10s);
+        CHECK(availability.latency == 0s);
+    }
+    SECTION("JSON")
+    {
+        auto report = nlohmann::json::parse(
+            UDS::toJSON(index.getAvailability(now), now));
+        CHECK(report["time"].get<int64_t> () == 1100000000);
+        REQUIRE(report["streams"].size() == 1);
+        const auto &stream = report["streams"][0];
+        CHECK(stream["stream"] == "UU.FORK.HHZ.01");
+        CHECK(stream["startTime"].get<int64_t> () == 1060000000);
+        CHECK(stream["endTime"].get<int64_t> () == 1090000000);
+        CHECK(stream["largestGap"].get<int64_t> () == 1000000);
+        CHECK(stream["latency"].get<int64_t> () == 10000000);
+        CHECK(stream["gaps"]
+              == nlohmann::json::parse("[[1070000000, 1071000000]]"));
+        CHECK(stream["overlaps"].empty());
+        CHECK(std::abs(stream["percentComplete"].get<double> ()
+                       - 100.*29/30) < 1.e-8);
+        // No streams
+        report = nlohmann::json::parse(UDS::toJSON({}, now));
+        CHECK(report["streams"].empty());
+    }
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::ReorderBuffer",
+          "[reorder]")
+{
+    using namespace std::chrono_literals;
+    // 1 s packets at 100 Hz.  The number of samples tells packets that
+    // start at the same time apart.
+    auto createPacket = [](const std::chrono::microseconds &startTime,
+                           const std::string &station = "FORK",
+                           const int nSamples = 100)
+    {
+        std::vector<int32_t> data(nSamples, 0);
+        US8::MessageFormats::Broadcasts::DataPacket packet;
+        packet.setNetwork("UU");
+        packet.setStation(station);
+        packet.setChannel("HHZ");
+        packet.setLocationCode("01");
+        packet.setSamplingRate(100);
+        packet.setStartTime(startTime);
+        packet.setData(static_cast<int> (data.size()), data.data());
+        return packet;
+    };
+    auto toStartTimes = [](
+        const std::vector<US8::MessageFormats::Broadcasts::DataPacket> &packets)
+    {
+        std::vector<std::chrono::microseconds> startTimes;
+        for (const auto &packet : packets)
+        {
+            startTimes.push_back(packet.getStartTime());
+        }
+        return startTimes;
+    };
+    using Times = std::vector<std::chrono::microseconds>;
+    UDS::ReorderBuffer buffer{1000ms};
+    const std::chrono::microseconds now{1000s};
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> released;
+    buffer.push(createPacket(0s), now, &released);
+    buffer.push(createPacket(2s), now, &released);
+    REQUIRE(toStartTimes(released) == Times {0s});
+    CHECK(buffer.size() == 1);
+    released.clear();
+    SECTION("Gap filled")
+    {
+        buffer.push(createPacket(1s), now + 10ms, &released);
+        CHECK(toStartTimes(released) == Times {1s, 2s});
+        CHECK(buffer.size() == 0);
+    }
+    SECTION("Expired")
+    {
+        buffer.release(now + 900ms, &released);
+        CHECK(released.empty());
+        buffer.release(now + 1100ms, &released);
+        CHECK(toStartTimes(released) == Times {2s});
+        CHECK(buffer.size() == 0);
+        // The expired gap is not waited on again
+        buffer.push(createPacket(3s), now + 1200ms, &released);
+        CHECK(toStartTimes(released) == Times {2s, 3s});
+    }
+    SECTION("Late")
+    {
+        buffer.push(createPacket(1s), now, &released);
+        released.clear();
+        // Re-sends and back-fill that precede the released data pass
+        buffer.push(createPacket(0s), now, &released);
+        buffer.push(createPacket(-5s), now, &released);
+        CHECK(toStartTimes(released) == Times {0s, -5s});
+        CHECK(buffer.size() == 0);
+    }
+    SECTION("Replaced")
+    {
+        buffer.push(createPacket(2s, "FORK", 50), now + 500ms, &released);
+        CHECK(released.empty());
+        CHECK(buffer.size() == 1);
+        // The replacement keeps the original's deadline
+        buffer.release(now + 1100ms, &released);
+        REQUIRE(toStartTimes(released) == Times {2s});
+        CHECK(released[0].getNumberOfSamples() == 50);
+    }
+    SECTION("Idle longer than a turn of the wheel")
+    {
+        buffer.release(now + 10s, &released);
+        CHECK(toStartTimes(released) == Times {2s});
+        released.clear();
+        // A packet held after the idle period gets the full hold latency
+        buffer.push(createPacket(4s), now + 10s, &released);
+        buffer.release(now + 10s + 900ms, &released);
+        CHECK(released.empty());
+        buffer.release(now + 10s + 1100ms, &released);
+        CHECK(toStartTimes(released) == Times {4s});
+        // Nothing is released twice
+        buffer.release(now + 20s, &released);
+        CHECK(released.size() == 1);
+    }
+    SECTION("Idle streams")
+    {
+        UDS::ReorderBuffer longHold{10000ms};
+        longHold.setStreamTimeToLive(1s);
+        longHold.push(createPacket(0s), now, &released);
+        longHold.push(createPacket(2s), now, &released);
+        longHold.push(createPacket(0s, "CTU"), now + 4s, &released);
+        // An idle stream is kept while it holds packets and the streams
+        // idle for less time wait behind it
+        longHold.release(now + 6s, &released);
+        CHECK(longHold.getNumberOfStreams() == 2);
+        longHold.release(now + 12s, &released);
+        CHECK(longHold.getNumberOfStreams() == 0);
+        // A forgotten stream starts over
+        released.clear();
+        longHold.push(createPacket(10s), now + 12s, &released);
+        CHECK(toStartTimes(released) == Times {10s});
+    }
+    SECTION("Flush")
+    {
+        buffer.push(createPacket(5s), now, &released);
+        buffer.flush(&released);
+        CHECK(toStartTimes(released) == Times {2s, 5s});
+        CHECK(buffer.size() == 0);
+    }
+}
+
+TEST_CASE("US8::MessageFormats::Broadcasts::StreamWatermarks",
+          "[watermarks]")
+{
+    using namespace std::chrono_literals;
+    US8::MessageFormats::Broadcasts::StreamWatermarks watermarks;
+    CHECK(watermarks.empty());
+    watermarks.addWatermark("UU.FORK.HHZ.01", 1000s);
+    watermarks.addWatermark("UU.CTU.EHZ.01", 1001500ms);
+    CHECK_THROWS_AS(watermarks.addWatermark("", 1000s), std::invalid_argument);
+    SECTION("Round trip")
+    {
+        US8::MessageFormats::Broadcasts::StreamWatermarks
+            copy{watermarks.serialize()};
+        REQUIRE(copy.size() == 2);
+        CHECK(copy.getWatermarks()[0].stream == "UU.FORK.HHZ.01");
+        CHECK(copy.getWatermarks()[0].completeThrough == 1000s);
+        CHECK(copy.getWatermarks()[1].stream == "UU.CTU.EHZ.01");
+        CHECK(copy.getWatermarks()[1].completeThrough == 1001500ms);
+        // An empty batch also survives
+        US8::MessageFormats::Broadcasts::StreamWatermarks empty;
+        copy.deserialize(empty.serialize());
+        CHECK(copy.empty());
+    }
+    SECTION("Malformed")
+    {
+        nlohmann::json obj;
+        obj["messageType"] = watermarks.getMessageType();
+        obj["messageVersion"] = watermarks.getMessageVersion();
+        obj["streams"] = std::vector<std::string> {"UU.FORK.HHZ.01",
+                                                   "UU.CTU.EHZ.01"};
+        obj["completeThrough"] = std::vector<int64_t> {1000000000};
+        auto cbor = nlohmann::json::to_cbor(obj);
+        std::string message(cbor.begin(), cbor.end());
+        CHECK_THROWS_AS(watermarks.deserialize(message),
+                        std::invalid_argument);
+        obj["completeThrough"] = std::vector<int64_t> {1000000000, 1000000000};
+        obj["messageType"] = "US8::MessageFormats::Broadcasts::DataPacket";
+        cbor = nlohmann::json::to_cbor(obj);
+        message = std::string(cbor.begin(), cbor.end());
+        CHECK_THROWS_AS(watermarks.deserialize(message),
+                        std::invalid_argument);
+        CHECK_THROWS_AS(watermarks.deserialize(std::string {}),
+                        std::invalid_argument);
+        // A failed deserialization leaves the watermarks alone
+        CHECK(watermarks.size() == 2);
+    }
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::WatermarkTracker",
+          "[watermarks]")
+{
+    using namespace std::chrono_literals;
+    // 1 s packets at 100 Hz so a packet starting at t ends at t + 0.99 s
+    auto createPacket = [](const std::chrono::microseconds &startTime)
+    {
+        std::vector<int32_t> data(100, 0);
+        US8::MessageFormats::Broadcasts::DataPacket packet;
+        packet.setNetwork("UU");
+        packet.setStation("FORK");
+        packet.setChannel("HHZ");
+        packet.setLocationCode("01");
+        packet.setSamplingRate(100);
+        packet.setStartTime(startTime);
+        packet.setData(static_cast<int> (data.size()), data.data());
+        return packet;
+    };
+    auto toCompleteThrough = [](
+        const US8::MessageFormats::Broadcasts::StreamWatermarks &watermarks)
+    {
+        REQUIRE(watermarks.size() == 1);
+        CHECK(watermarks.getWatermarks()[0].stream == "UU.FORK.HHZ.01");
+        return watermarks.getWatermarks()[0].completeThrough;
+    };
+    UDS::WatermarkTracker tracker{1000ms};
+    const std::chrono::microseconds now{5000s};
+    tracker.update(createPacket(0s), now);
+    tracker.update(createPacket(1s), now);
+    CHECK(toCompleteThrough(tracker.getAdvancedWatermarks(now)) == 1990ms);
+    // Data after the gap at 2 s is held back
+    tracker.update(createPacket(4s), now);
+    CHECK(tracker.getAdvancedWatermarks(now + 100ms).empty());
+    CHECK(tracker.getNumberOfStreams() == 1);
+    SECTION("Gap filled")
+    {
+        tracker.update(createPacket(2s), now + 200ms);
+        CHECK(toCompleteThrough(tracker.getAdvancedWatermarks(now + 200ms))
+              == 2990ms);
+        tracker.update(createPacket(3s), now + 300ms);
+        CHECK(toCompleteThrough(tracker.getAdvancedWatermarks(now + 300ms))
+              == 4990ms);
+    }
+    SECTION("Gap abandoned")
+    {
+        // Narrowing the gap does not restart its clock
+        tracker.update(createPacket(2s), now + 600ms);
+        CHECK(toCompleteThrough(tracker.getAdvancedWatermarks(now + 600ms))
+              == 2990ms);
+        CHECK(tracker.getAdvancedWatermarks(now + 900ms).empty());
+        CHECK(toCompleteThrough(tracker.getAdvancedWatermarks(now + 1000ms))
+              == 4990ms);
+        // Nothing is reported until the stream advances again
+        CHECK(tracker.getAdvancedWatermarks(now + 2000ms).empty());
+    }
+    SECTION("Abandoning restarts the clock for the next gap")
+    {
+        tracker.update(createPacket(8s), now + 500ms);
+        CHECK(toCompleteThrough(tracker.getAdvancedWatermarks(now + 1000ms))
+              == 4990ms);
+        CHECK(tracker.getAdvancedWatermarks(now + 1900ms).empty());
+        CHECK(toCompleteThrough(tracker.getAdvancedWatermarks(now + 2000ms))
+              == 8990ms);
+    }
+    SECTION("Maximum pending segments")
+    {
+        // Every other second is missing.  The 4 s segment is the first of
+        // 1025 so the leading gap is abandoned without waiting.
+        for (int i = 1; i <= 1024; ++i)
+        {
+            tracker.update(createPacket(std::chrono::seconds {4 + 2*i}), now);
+        }
+        CHECK(toCompleteThrough(tracker.getAdvancedWatermarks(now)) == 4990ms);
+    }
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::TestFlatLinedDataPacket",
+          "[flatLine]")
+{
+    using namespace std::chrono_literals;
+    // 1 s packets of a constant at 100 Hz
+    auto createPacket = [](const std::chrono::microseconds &startTime,
+                           const int32_t value)
+    {
+        std::vector<int32_t> data(100, value);
+        US8::MessageFormats::Broadcasts::DataPacket packet;
+        packet.setNetwork("UU");
+        packet.setStation("FORK");
+        packet.setChannel("HHZ");
+        packet.setLocationCode("01");
+        packet.setSamplingRate(100);
+        packet.setStartTime(startTime);
+        packet.setData(static_cast<int> (data.size()), data.data());
+        return packet;
+    };
+    UDS::TestFlatLinedDataPacket tester{5000ms, std::chrono::seconds {-1}};
+    SECTION("Contiguous")
+    {
+        // The run crosses packets and is flagged once it exceeds 5 s
+        for (int i = 0; i < 5; ++i)
+        {
+            CHECK(tester.allow(createPacket(std::chrono::seconds {i}, 1)));
+        }
+        CHECK(!tester.allow(createPacket(5s, 1)));
+        CHECK(tester.getNumberOfFlaggedPackets() == 1);
+        // A new value ends the run
+        CHECK(tester.allow(createPacket(6s, 2)));
+    }
+    SECTION("Gap")
+    {
+        // The same value after a gap is a new run
+        for (int i = 0; i < 10; ++i)
+        {
+            CHECK(tester.allow(createPacket(std::chrono::seconds {2*i}, 1)));
+        }
+        CHECK(tester.getNumberOfFlaggedPackets() == 0);
+    }
+    SECTION("Out of order")
+    {
+        // Re-sends and back-fill do not extend the run
+        for (int i = 0; i < 4; ++i)
+        {
+            CHECK(tester.allow(createPacket(std::chrono::seconds {i}, 1)));
+            CHECK(tester.allow(createPacket(std::chrono::seconds {i}, 1)));
+        }
+        CHECK(tester.getNumberOfFlaggedPackets() == 0);
+        // Timing jitter under half a sample is contiguous
+        for (int i = 0; i < 6; ++i)
+        {
+            auto startTime = std::chrono::microseconds {100s + i*1s + 4ms};
+            CHECK(tester.allow(createPacket(startTime, 1)) == (i < 5));
+        }
+    }
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::WaveformStatistics",
+          "[waveformStatistics]")
+{
+    using Catch::Matchers::WithinRel;
+    // An odd length exercises the vectorized and scalar loops
+    auto data = ::createNoise(103, 1000, 7);
+    data[50] = 5000;
+    data[51] = 5000;
+    data[52] = 5000;
+    double sum{0};
+    double sumSquared{0};
+    for (const auto sample : data)
+    {
+        sum = sum + sample;
+        sumSquared = sumSquared + static_cast<double> (sample)*sample;
+    }
+    auto mean = sum/static_cast<double> (data.size());
+    auto rms = std::sqrt(sumSquared/static_cast<double> (data.size()));
+    auto minimum = *std::min_element(data.begin(), data.end());
+    SECTION("Integer32")
+    {
+        auto statistics
+            = UDS::computeWaveformStatistics(
+                  ::createWaveformPacket(std::chrono::microseconds {0}, data));
+        CHECK(statistics.nSamples == 103);
+        CHECK(statistics.minimum == minimum);
+        CHECK(statistics.maximum == 5000);
+        CHECK_THAT(statistics.mean, WithinRel(mean, 1.e-12));
+        CHECK_THAT(statistics.rms, WithinRel(rms, 1.e-12));
+        CHECK(statistics.longestRun == 3);
+    }
+    SECTION("Float")
+    {
+        std::vector<float> floatData(data.begin(), data.end());
+        auto statistics
+            = UDS::computeWaveformStatistics(
+                  ::createWaveformPacket(std::chrono::microseconds {0},
+                                         floatData));
+        CHECK(statistics.minimum == minimum);
+        CHECK(statistics.maximum == 5000);
+        CHECK_THAT(statistics.mean, WithinRel(mean, 1.e-12));
+        CHECK_THAT(statistics.rms, WithinRel(rms, 1.e-12));
+        CHECK(statistics.longestRun == 3);
+    }
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::TestClippedDataPacket",
+          "[clipped]")
+{
+    constexpr int32_t clipLevel{8388607};
+    // The extreme sample lands in the vectorized and the scalar loops
+    auto createData = [](const int32_t value, const size_t index)
+    {
+        auto data = ::createNoise(101, 1000, 11);
+        data.at(index) = value;
+        return data;
+    };
+    UDS::TestClippedDataPacket tester{static_cast<double> (clipLevel),
+                                      std::chrono::seconds {-1}};
+    std::chrono::microseconds startTime{0};
+    SECTION("Integer32")
+    {
+        for (const size_t index : {size_t {0}, size_t {41}, size_t {100}})
+        {
+            CHECK(!tester.allow(::createWaveformPacket(
+                       startTime, createData(clipLevel, index))));
+            CHECK(tester.allow(::createWaveformPacket(
+                      startTime, createData(clipLevel - 1, index))));
+            CHECK(!tester.allow(::createWaveformPacket(
+                       startTime, createData(-clipLevel, index))));
+            CHECK(tester.allow(::createWaveformPacket(
+                      startTime, createData(-clipLevel + 1, index))));
+        }
+        CHECK(tester.getNumberOfFlaggedPackets() == 6);
+    }
+    SECTION("Float")
+    {
+        auto toFloat = [](const std::vector<int32_t> &data)
+        {
+            return std::vector<float> (data.begin(), data.end());
+        };
+        for (const size_t index : {size_t {0}, size_t {41}, size_t {100}})
+        {
+            CHECK(!tester.allow(::createWaveformPacket(
+                       startTime, toFloat(createData(clipLevel, index)))));
+            CHECK(tester.allow(::createWaveformPacket(
+                      startTime, toFloat(createData(clipLevel - 1, index)))));
+            CHECK(!tester.allow(::createWaveformPacket(
+                       startTime, toFloat(createData(-clipLevel, index)))));
+            CHECK(tester.allow(::createWaveformPacket(
+                      startTime, toFloat(createData(-clipLevel + 1, index)))));
+        }
+        // A fractional clip level
+        UDS::TestClippedDataPacket fractionalTester{1.5,
+                                                    std::chrono::seconds {-1}};
+        std::vector<float> data(16, 0);
+        data[9] = 1.49f;
+        CHECK(fractionalTester.allow(::createWaveformPacket(startTime, data)));
+        data[9] =-1.5f;
+        CHECK(!fractionalTester.allow(::createWaveformPacket(startTime, data)));
+        CHECK(tester.getNumberOfFlaggedPackets() == 6);
+    }
+    CHECK_THROWS_AS(UDS::TestClippedDataPacket(0, std::chrono::seconds {-1}),
+                    std::invalid_argument);
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::TestSpikedDataPacket",
+          "[spiked]")
+{
+    using namespace std::chrono_literals;
+    UDS::TestSpikedDataPacket tester{50, std::chrono::seconds {-1}};
+    // Noise with a standard deviation of about 577 counts
+    auto createNoisePacket = [](const std::chrono::seconds &startTime,
+                                const uint64_t seed)
+    {
+        return ::createWaveformPacket(
+                   std::chrono::microseconds {startTime},
+                   ::createNoise(100, 1000, seed));
+    };
+    SECTION("Spike")
+    {
+        // The first packets establish the noise floor so a spike is allowed
+        auto data = ::createNoise(100, 1000, 0);
+        data[10] = 100000;
+        CHECK(tester.allow(::createWaveformPacket(0s, data)));
+        for (int i = 1; i < 10; ++i)
+        {
+            CHECK(tester.allow(createNoisePacket(std::chrono::seconds {i}, i)));
+        }
+        CHECK(tester.getNumberOfStreams() == 1);
+        data = ::createNoise(100, 1000, 10);
+        data[33] =-100000;
+        CHECK(!tester.allow(::createWaveformPacket(10s, data)));
+        // Just under the threshold
+        data[33] = 10000;
+        CHECK(tester.allow(::createWaveformPacket(11s, data)));
+        CHECK(tester.getNumberOfFlaggedPackets() == 1);
+    }
+    SECTION("Earthquake")
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            CHECK(tester.allow(createNoisePacket(std::chrono::seconds {i}, i)));
+        }
+        // A large signal spans many samples so it is not a spike
+        auto data = ::createNoise(100, 1000, 10);
+        for (size_t i = 20; i < data.size(); ++i)
+        {
+            data[i] = data[i] + static_cast<int32_t>
+                      (500000*std::exp(-0.05*(i - 20.))*std::sin(0.8*i));
+        }
+        CHECK(tester.allow(::createWaveformPacket(10s, data)));
+        CHECK(tester.getNumberOfFlaggedPackets() == 0);
+    }
+    SECTION("Noise floor")
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            CHECK(tester.allow(createNoisePacket(std::chrono::seconds {i}, i)));
+        }
+        // A quiet packet with a step small relative to the stream's noise
+        std::vector<int32_t> data(100, 0);
+        data[70] = 1000;
+        CHECK(tester.allow(::createWaveformPacket(10s, data)));
+        // A constant packet
+        data[70] = 0;
+        CHECK(tester.allow(::createWaveformPacket(11s, data)));
+        CHECK(tester.getNumberOfFlaggedPackets() == 0);
+    }
+    CHECK_THROWS_AS(UDS::TestSpikedDataPacket(0, std::chrono::seconds {-1}),
+                    std::invalid_argument);
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::Sanitizer::Replay", "[replay]")
+{
+    using namespace std::chrono_literals;
+    // Archived traffic from a reconnecting data logger with back-fills,
+    // re-sends, and timing slips
+    const auto packets = ::createDuplicateTraffic(4, 3000, true);
+    auto wallClock = std::make_shared<US8::Utilities::WallClock> ();
+    auto clock = std::make_shared<US8::Utilities::SimulatedClock> ();
+    UDS::TestExpiredDataPacket expiredTester{3600s, std::chrono::seconds {-1}};
+    UDS::TestFutureDataPacket futureTester{1s, std::chrono::seconds {-1}};
+    UDS::TestDuplicateDataPacket duplicateTester{600s,
+                                                 std::chrono::seconds {-1}};
+    UDS::AvailabilityIndex availabilityIndex{3600s};
+    SECTION("Wall clock")
+    {
+        // Against the wall clock every archived packet is expired
+        expiredTester.setClock(wallClock);
+        for (const auto &packet : packets)
+        {
+            CHECK(!expiredTester.allow(packet));
+            availabilityIndex.update(packet, wallClock->now());
+        }
+        CHECK(availabilityIndex.getAvailability(wallClock->now()).empty());
+    }
+    SECTION("Simulated clock")
+    {
+        expiredTester.setClock(clock);
+        futureTester.setClock(clock);
+        duplicateTester.setClock(clock);
+        int nDuplicates{0};
+        for (const auto &packet : packets)
+        {
+            // Like the sanitizer's subscriber callback, only data that ends
+            // before the present moves the clock
+            auto endTime = packet.getEndTime();
+            if (endTime <= wallClock->now()){clock->advance(endTime);}
+            // The testers run in the sanitizer's order.  Duplicates are
+            // indexed so they appear as overlaps.
+            REQUIRE(expiredTester.allow(packet));
+            REQUIRE(futureTester.allow(packet));
+            availabilityIndex.update(packet, clock->now());
+            if (!duplicateTester.allow(packet)){nDuplicates = nDuplicates + 1;}
+        }
+        CHECK(nDuplicates > 0);
+        // The clock stopped at the end of the archive so the streams are
+        // complete and current
+        auto availability = availabilityIndex.getAvailability(clock->now());
+        REQUIRE(availability.size() == 4);
+        for (const auto &stream : availability)
+        {
+            CHECK(stream.gaps.empty());
+            CHECK(!stream.overlaps.empty());
+            CHECK(stream.percentComplete == 100);
+            CHECK(stream.latency < 1s);
+        }
+        // A packet from the future would not move the clock so it is
+        // rejected
+        auto packet = packets.back();
+        packet.setStartTime(wallClock->now() + 3600s);
+        CHECK(!futureTester.allow(packet));
+    }
+}
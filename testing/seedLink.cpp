@@ -0,0 +1,437 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <catch2/catch_test_macros.hpp>
+#include "broadcasts/dataPacket/seedLink/publishingQueue.hpp"
+#include "broadcasts/dataPacket/seedLink/spillQueue.hpp"
+#include "us8/messageFormats/broadcasts/dataPacket.hpp"
+
+namespace USL = US8::Broadcasts::DataPacket::SEEDLink;
+
+namespace
+{
+
+/// The spill queue's on-disk record layout
+struct RecordHeader
+{
+    uint32_t length{0};
+    uint32_t state{0};
+};
+constexpr uint32_t CONSUMED{0x55380002};
+
+/// @brief A scratch directory that is removed when the test ends.
+class ScratchDirectory
+{
+public:
+    explicit ScratchDirectory(const std::string &name) :
+        mPath(std::filesystem::temp_directory_path()
+            / (name + "_" + std::to_string(getpid())))
+    {
+        std::filesystem::remove_all(mPath);
+    }
+    ~ScratchDirectory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(mPath, error);
+    }
+    [[nodiscard]] const std::filesystem::path &path() const noexcept
+    {
+        return mPath;
+    }
+    ScratchDirectory(const ScratchDirectory &) = delete;
+    ScratchDirectory& operator=(const ScratchDirectory &) = delete;
+private:
+    std::filesystem::path mPath;
+};
+
+/// @brief A 1 s packet at 100 Hz.
+[[nodiscard]] US8::MessageFormats::Broadcasts::DataPacket
+    createPacket(const std::chrono::seconds &startTime)
+{
+    std::vector<int32_t> data(100, 0);
+    US8::MessageFormats::Broadcasts::DataPacket packet;
+    packet.setNetwork("UU");
+    packet.setStation("FORK");
+    packet.setChannel("HHZ");
+    packet.setLocationCode("01");
+    packet.setSamplingRate(100);
+    packet.setStartTime(std::chrono::microseconds {startTime});
+    packet.setData(static_cast<int> (data.size()), data.data());
+    return packet;
+}
+
+/// @result The start times of the packets in seconds.
+[[nodiscard]] std::vector<int64_t> toStartTimes(
+    const std::vector<US8::MessageFormats::Broadcasts::DataPacket> &packets)
+{
+    std::vector<int64_t> startTimes;
+    for (const auto &packet : packets)
+    {
+        startTimes.push_back(std::chrono::duration_cast<std::chrono::seconds>
+                             (packet.getStartTime()).count());
+    }
+    return startTimes;
+}
+
+/// @result Packets starting at the given times in seconds.
+[[nodiscard]] std::vector<US8::MessageFormats::Broadcasts::DataPacket>
+    createPackets(const std::vector<int64_t> &startTimes)
+{
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+    for (const auto startTime : startTimes)
+    {
+        packets.push_back(::createPacket(std::chrono::seconds {startTime}));
+    }
+    return packets;
+}
+
+/// @result The segment files in sequence order.
+[[nodiscard]] std::vector<std::filesystem::path>
+    getSegments(const std::filesystem::path &directory)
+{
+    std::vector<std::filesystem::path> segments;
+    for (const auto &entry : std::filesystem::directory_iterator(directory))
+    {
+        segments.push_back(entry.path());
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+/// @result The byte offsets of the records in a segment file.
+[[nodiscard]] std::vector<int64_t>
+    getRecordOffsets(const std::filesystem::path &segment)
+{
+    std::ifstream file(segment, std::ios::binary);
+    std::vector<int64_t> offsets;
+    int64_t offset{0};
+    ::RecordHeader header;
+    while (file.seekg(offset) &&
+           file.read(reinterpret_cast<char *> (&header), sizeof(header)) &&
+           header.length > 0)
+    {
+        offsets.push_back(offset);
+        auto size = static_cast<int64_t> (sizeof(header) + header.length);
+        offset = offset + ((size + 7)/8)*8;
+    }
+    return offsets;
+}
+
+/// @brief Overwrites bytes of a segment file.
+void overwrite(const std::filesystem::path &segment,
+               const int64_t offset,
+               const void *data,
+               const size_t length)
+{
+    std::fstream file(segment,
+                      std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(offset);
+    file.write(static_cast<const char *> (data),
+               static_cast<std::streamsize> (length));
+}
+
+/// @brief Sets the state of a record.
+void setState(const std::filesystem::path &segment,
+              const int64_t recordOffset,
+              const uint32_t state)
+{
+    ::overwrite(segment,
+                recordOffset + static_cast<int64_t> (offsetof(::RecordHeader,
+                                                              state)),
+                &state, sizeof(state));
+}
+
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::SEEDLink::SpillQueue", "[spillQueue]")
+{
+    using namespace std::chrono_literals;
+    ::ScratchDirectory directory{"us8SpillQueueTests"};
+    constexpr int64_t segmentSize{64*1024};
+    constexpr int64_t maximumSize{16*segmentSize};
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+    SECTION("Partially written record")
+    {
+        {
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        for (int i = 0; i < 3; ++i)
+        {
+            REQUIRE(queue.push(::createPacket(std::chrono::seconds {i})));
+        }
+        }
+        // A crash before the record was marked written
+        auto segments = ::getSegments(directory.path());
+        REQUIRE(segments.size() == 1);
+        auto offsets = ::getRecordOffsets(segments[0]);
+        REQUIRE(offsets.size() == 3);
+        ::setState(segments[0], offsets[2], 0);
+        {
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        CHECK(queue.size() == 2);
+        CHECK(queue.peek(&packets, 10) == 2);
+        CHECK(::toStartTimes(packets) == std::vector<int64_t> {0, 1});
+        // The next packet replaces the partial record
+        REQUIRE(queue.push(::createPacket(10s)));
+        }
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        packets.clear();
+        CHECK(queue.peek(&packets, 10) == 3);
+        CHECK(::toStartTimes(packets) == std::vector<int64_t> {0, 1, 10});
+    }
+    SECTION("Consumed and written records")
+    {
+        {
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        for (int i = 0; i < 5; ++i)
+        {
+            REQUIRE(queue.push(::createPacket(std::chrono::seconds {i})));
+        }
+        REQUIRE(queue.peek(&packets, 2) == 2);
+        REQUIRE(queue.commit(2) == 2);
+        }
+        // Discarded records can also sit between written records
+        auto segments = ::getSegments(directory.path());
+        REQUIRE(segments.size() == 1);
+        auto offsets = ::getRecordOffsets(segments[0]);
+        REQUIRE(offsets.size() == 5);
+        ::setState(segments[0], offsets[3], ::CONSUMED);
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        CHECK(queue.size() == 2);
+        packets.clear();
+        CHECK(queue.peek(&packets, 10) == 2);
+        CHECK(::toStartTimes(packets) == std::vector<int64_t> {2, 4});
+        CHECK(queue.commit(2) == 2);
+        CHECK(queue.empty());
+        CHECK(::getSegments(directory.path()).empty());
+    }
+    SECTION("Zero-length segment")
+    {
+        {
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        REQUIRE(queue.push(::createPacket(0s)));
+        }
+        // A crash while creating the next segment
+        auto empty = directory.path()/"segment_00000000000000000007.spill";
+        {
+        std::ofstream file(empty);
+        }
+        {
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        CHECK(!std::filesystem::exists(empty));
+        CHECK(queue.size() == 1);
+        CHECK(queue.getSizeInBytes() == segmentSize);
+        }
+        // Nor does a segment that is entirely zeros hold packets
+        {
+        std::ofstream file(empty);
+        }
+        std::filesystem::resize_file(empty, segmentSize);
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        CHECK(!std::filesystem::exists(empty));
+        CHECK(queue.size() == 1);
+        // New segments follow the removed one
+        while (::getSegments(directory.path()).size() < 2)
+        {
+            REQUIRE(queue.push(::createPacket(1s)));
+        }
+        CHECK(::getSegments(directory.path()).back().filename()
+              == "segment_00000000000000000008.spill");
+    }
+    SECTION("Commit across segments")
+    {
+        // Size the segments to hold two packets
+        int64_t recordSize{0};
+        {
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        REQUIRE(queue.push(::createPacket(0s)));
+        queue.flush();
+        auto segments = ::getSegments(directory.path());
+        auto offsets = ::getRecordOffsets(segments.at(0));
+        REQUIRE(offsets.size() == 1);
+        ::RecordHeader header;
+        std::ifstream file(segments[0], std::ios::binary);
+        file.read(reinterpret_cast<char *> (&header), sizeof(header));
+        recordSize
+            = ((static_cast<int64_t> (sizeof(header) + header.length) + 7)/8)*8;
+        REQUIRE(queue.commit(1) == 1);
+        }
+        REQUIRE(::getSegments(directory.path()).empty());
+        const int64_t smallSegmentSize{2*recordSize + 4};
+        USL::SpillQueue queue(directory.path(),
+                              3*smallSegmentSize, smallSegmentSize);
+        for (int i = 0; i < 6; ++i)
+        {
+            REQUIRE(queue.push(::createPacket(std::chrono::seconds {i})));
+        }
+        CHECK(::getSegments(directory.path()).size() == 3);
+        // Full
+        CHECK(!queue.push(::createPacket(6s)));
+        // Reading spans the segments
+        CHECK(queue.peek(&packets, 5) == 5);
+        CHECK(::toStartTimes(packets) == std::vector<int64_t> {0, 1, 2, 3, 4});
+        // Committing into the second segment removes the first
+        CHECK(queue.commit(3) == 3);
+        CHECK(::getSegments(directory.path()).size() == 2);
+        CHECK(queue.getSizeInBytes() == 2*smallSegmentSize);
+        packets.clear();
+        CHECK(queue.peek(&packets, 5) == 3);
+        CHECK(::toStartTimes(packets) == std::vector<int64_t> {3, 4, 5});
+        // The freed space can be used again
+        CHECK(queue.push(::createPacket(6s)));
+        CHECK(queue.commit(10) == 4);
+        CHECK(queue.empty());
+        CHECK(::getSegments(directory.path()).empty());
+        CHECK(queue.getSizeInBytes() == 0);
+    }
+    SECTION("Corrupt record")
+    {
+        {
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        for (int i = 0; i < 3; ++i)
+        {
+            REQUIRE(queue.push(::createPacket(std::chrono::seconds {i})));
+        }
+        }
+        auto segments = ::getSegments(directory.path());
+        REQUIRE(segments.size() == 1);
+        auto offsets = ::getRecordOffsets(segments[0]);
+        REQUIRE(offsets.size() == 3);
+        std::vector<char> garbage(16, '\xff');
+        ::overwrite(segments[0],
+                    offsets[1] + static_cast<int64_t> (sizeof(::RecordHeader)),
+                    garbage.data(), garbage.size());
+        USL::SpillQueue queue(directory.path(), maximumSize, segmentSize);
+        CHECK(queue.size() == 3);
+        // The unreadable record is discarded rather than read again
+        CHECK(queue.peek(&packets, 10) == 2);
+        CHECK(::toStartTimes(packets) == std::vector<int64_t> {0, 2});
+        CHECK(queue.size() == 2);
+        packets.clear();
+        CHECK(queue.peek(&packets, 10) == 2);
+        CHECK(queue.commit(2) == 2);
+        CHECK(queue.empty());
+    }
+}
+
+TEST_CASE("US8::Broadcasts::DataPacket::SEEDLink::PublishingQueue",
+          "[publishingQueue]")
+{
+    using namespace std::chrono_literals;
+    using Queue = USL::PublishingQueue;
+    using Times = std::vector<int64_t>;
+    std::vector<US8::MessageFormats::Broadcasts::DataPacket> packets;
+    SECTION("Drop oldest")
+    {
+        Queue queue(3, Queue::OverflowPolicy::DropOldest);
+        CHECK(queue.push(::createPackets({0, 1, 2, 3, 4}),
+                         Queue::Priority::RealTime) == 2);
+        CHECK(queue.isFull(Queue::Priority::RealTime));
+        CHECK(queue.pop(&packets, 10, 0ms) == 3);
+        CHECK(::toStartTimes(packets) == Times {2, 3, 4});
+        CHECK(queue.getNumberOfDroppedPackets() == 2);
+    }
+    SECTION("Drop newest")
+    {
+        Queue queue(3, Queue::OverflowPolicy::DropNewest);
+        CHECK(queue.push(::createPackets({0, 1}),
+                         Queue::Priority::RealTime) == 0);
+        CHECK(queue.push(::createPackets({2, 3, 4}),
+                         Queue::Priority::RealTime) == 2);
+        CHECK(queue.pop(&packets, 10, 0ms) == 3);
+        CHECK(::toStartTimes(packets) == Times {0, 1, 2});
+        CHECK(queue.getNumberOfDroppedPackets() == 2);
+    }
+    SECTION("Block")
+    {
+        Queue queue(2, Queue::OverflowPolicy::Block);
+        auto producer = std::async(std::launch::async, [&queue]()
+        {
+            return queue.push(::createPackets({0, 1, 2, 3, 4}),
+                              Queue::Priority::RealTime);
+        });
+        Times startTimes;
+        while (startTimes.size() < 5)
+        {
+            packets.clear();
+            queue.pop(&packets, 1, 100ms);
+            for (const auto startTime : ::toStartTimes(packets))
+            {
+                startTimes.push_back(startTime);
+            }
+        }
+        CHECK(producer.get() == 0);
+        CHECK(startTimes == Times {0, 1, 2, 3, 4});
+        CHECK(queue.getNumberOfDroppedPackets() == 0);
+    }
+    SECTION("Real-time packets go first")
+    {
+        Queue queue(4, Queue::OverflowPolicy::DropOldest);
+        queue.push(::createPackets({100, 101}), Queue::Priority::BackFill);
+        queue.push(::createPackets({0, 1}), Queue::Priority::RealTime);
+        CHECK(queue.size() == 4);
+        CHECK(queue.pop(&packets, 3, 0ms) == 3);
+        CHECK(::toStartTimes(packets) == Times {0, 1, 100});
+        queue.push(::createPackets({2}), Queue::Priority::RealTime);
+        packets.clear();
+        CHECK(queue.pop(&packets, 3, 0ms) == 2);
+        CHECK(::toStartTimes(packets) == Times {2, 101});
+        CHECK(queue.pop(&packets, 3, 10ms) == 0);
+    }
+    SECTION("Back-fill is not dropped")
+    {
+        Queue queue(2, Queue::OverflowPolicy::DropOldest);
+        // A producer that cannot wait overruns the lane and watches isFull
+        CHECK(queue.push(::createPackets({0, 1, 2}),
+                         Queue::Priority::BackFill, false) == 0);
+        CHECK(queue.isFull(Queue::Priority::BackFill));
+        CHECK(!queue.isFull(Queue::Priority::RealTime));
+        CHECK(queue.pop(&packets, 10, 0ms) == 3);
+        CHECK(!queue.isFull(Queue::Priority::BackFill));
+        CHECK(queue.getNumberOfDroppedPackets() == 0);
+    }
+    SECTION("Close wakes a blocked producer")
+    {
+        Queue queue(1, Queue::OverflowPolicy::Block);
+        queue.push(::createPackets({0}), Queue::Priority::RealTime);
+        queue.push(::createPackets({100}), Queue::Priority::BackFill);
+        // Both lanes are full so the producer waits
+        auto producer = std::async(std::launch::async, [&queue]()
+        {
+            return queue.push(::createPackets({1, 2, 3}),
+                              Queue::Priority::RealTime);
+        });
+        CHECK(producer.wait_for(50ms) == std::future_status::timeout);
+        queue.close();
+        REQUIRE(producer.wait_for(5s) == std::future_status::ready);
+        CHECK(producer.get() == 3);
+        // Nothing more is accepted until the queue is re-opened
+        CHECK(queue.push(::createPackets({4}),
+                         Queue::Priority::BackFill, false) == 1);
+        CHECK(queue.getNumberOfDroppedPackets() == 4);
+        queue.open();
+        CHECK(queue.pop(&packets, 10, 0ms) == 2);
+        CHECK(::toStartTimes(packets) == Times {0, 100});
+    }
+    SECTION("Overflow policy")
+    {
+        CHECK(Queue::toOverflowPolicy(" DropOldest ")
+              == Queue::OverflowPolicy::DropOldest);
+        CHECK(Queue::toOverflowPolicy("dropnewest")
+              == Queue::OverflowPolicy::DropNewest);
+        CHECK(Queue::toOverflowPolicy("BLOCK")
+              == Queue::OverflowPolicy::Block);
+        CHECK_THROWS_AS(Queue::toOverflowPolicy("dropAll"),
+                        std::invalid_argument);
+        CHECK_THROWS_AS(Queue(0, Queue::OverflowPolicy::Block),
+                        std::invalid_argument);
+    }
+}
@@ -0,0 +1,148 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "us8/utilities/clock.hpp"
+
+using namespace US8::Utilities;
+
+namespace
+{
+[[nodiscard]] std::chrono::microseconds getSystemTime() noexcept
+{
+    return std::chrono::time_point_cast<std::chrono::microseconds>
+           (std::chrono::system_clock::now()).time_since_epoch();
+}
+}
+
+/// Destructor
+IClock::~IClock() = default;
+
+///--------------------------------------------------------------------------///
+///                                Wall Clock                                ///
+///--------------------------------------------------------------------------///
+
+/// Time
+std::chrono::microseconds WallClock::now() const noexcept
+{
+    return ::getSystemTime();
+}
+
+/// Destructor
+WallClock::~WallClock() = default;
+
+///--------------------------------------------------------------------------///
+///                               Coarse Clock                               ///
+///--------------------------------------------------------------------------///
+
+class CoarseClock::CoarseClockImpl
+{
+public:
+    explicit CoarseClockImpl(const std::chrono::milliseconds &resolution) :
+        mResolution(resolution)
+    {
+        mNow = ::getSystemTime().count();
+        mTickerThread = std::thread(&CoarseClockImpl::tick, this);
+    }
+    ~CoarseClockImpl()
+    {
+        {
+        std::lock_guard<std::mutex> lockGuard(mMutex);
+        mKeepRunning = false;
+        }
+        mConditionVariable.notify_all();
+        if (mTickerThread.joinable()){mTickerThread.join();}
+    }
+    /// Updates the time until told to stop
+    void tick()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (mKeepRunning)
+        {
+            mConditionVariable.wait_for(lock, mResolution,
+                                        [this] {return !mKeepRunning;});
+            mNow.store(::getSystemTime().count(), std::memory_order_relaxed);
+        }
+    }
+//private:
+    std::mutex mMutex;
+    std::condition_variable mConditionVariable;
+    std::thread mTickerThread;
+    std::atomic<int64_t> mNow{0};
+    std::chrono::milliseconds mResolution{1};
+    bool mKeepRunning{true};
+};
+
+/// Constructor
+CoarseClock::CoarseClock(const std::chrono::milliseconds &resolution)
+{
+    if (resolution.count() <= 0)
+    {
+        throw std::invalid_argument("Resolution must be positive");
+    }
+    pImpl = std::make_unique<CoarseClockImpl> (resolution);
+}
+
+/// Time
+std::chrono::microseconds CoarseClock::now() const noexcept
+{
+    return std::chrono::microseconds
+           {pImpl->mNow.load(std::memory_order_relaxed)};
+}
+
+/// Resolution
+std::chrono::milliseconds CoarseClock::getResolution() const noexcept
+{
+    return pImpl->mResolution;
+}
+
+/// Destructor
+CoarseClock::~CoarseClock() = default;
+
+///--------------------------------------------------------------------------///
+///                             Simulated Clock                              ///
+///--------------------------------------------------------------------------///
+
+class SimulatedClock::SimulatedClockImpl
+{
+public:
+    std::atomic<int64_t> mNow{0};
+};
+
+/// Constructor
+SimulatedClock::SimulatedClock() :
+    pImpl(std::make_unique<SimulatedClockImpl> ())
+{
+}
+
+/// Constructor with time
+SimulatedClock::SimulatedClock(const std::chrono::microseconds &startTime) :
+    pImpl(std::make_unique<SimulatedClockImpl> ())
+{
+    pImpl->mNow = startTime.count();
+}
+
+/// Advance
+void SimulatedClock::advance(const std::chrono::microseconds &time) noexcept
+{
+    auto newTime = time.count();
+    auto currentTime = pImpl->mNow.load(std::memory_order_relaxed);
+    // Another thread may have advanced the clock further
+    while (newTime > currentTime &&
+           !pImpl->mNow.compare_exchange_weak(currentTime, newTime,
+                                              std::memory_order_relaxed))
+    {
+    }
+}
+
+/// Time
+std::chrono::microseconds SimulatedClock::now() const noexcept
+{
+    return std::chrono::microseconds
+           {pImpl->mNow.load(std::memory_order_relaxed)};
+}
+
+/// Destructor
+SimulatedClock::~SimulatedClock() = default;
@@ -0,0 +1,64 @@
+#include <string>
+#include <filesystem>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include "us8/utilities/writeAtomically.hpp"
+
+/// Write the file with a temporary file and rename
+void US8::Utilities::writeAtomically(const std::filesystem::path &fileName,
+                                     const std::string &contents)
+{
+    auto temporaryFileName = fileName.string() + ".tmp";
+    auto fileDescriptor = open(temporaryFileName.c_str(),
+                               O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                               0644);
+    if (fileDescriptor < 0)
+    {
+        throw std::runtime_error("Failed to open " + temporaryFileName
+                               + ": " + std::strerror(errno));
+    }
+    size_t offset{0};
+    while (offset < contents.size())
+    {
+        auto nWritten = write(fileDescriptor, contents.data() + offset,
+                              contents.size() - offset);
+        if (nWritten < 0)
+        {
+            if (errno == EINTR){continue;}
+            auto error = std::string {std::strerror(errno)};
+            close(fileDescriptor);
+            throw std::runtime_error("Failed to write " + temporaryFileName
+                                   + ": " + error);
+        }
+        offset = offset + static_cast<size_t> (nWritten);
+    }
+    // The data must be on disk before the rename makes it visible
+    if (fsync(fileDescriptor) != 0)
+    {
+        auto error = std::string {std::strerror(errno)};
+        close(fileDescriptor);
+        throw std::runtime_error("Failed to sync " + temporaryFileName
+                               + ": " + error);
+    }
+    close(fileDescriptor);
+    if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+    {
+        throw std::runtime_error("Failed to rename " + temporaryFileName
+                               + " to " + fileName.string() + ": "
+                               + std::strerror(errno));
+    }
+    // Persist the rename
+    auto directory = fileName.parent_path();
+    if (directory.empty()){directory = ".";}
+    auto directoryDescriptor = open(directory.c_str(),
+                                    O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryDescriptor >= 0)
+    {
+        fsync(directoryDescriptor);
+        close(directoryDescriptor);
+    }
+}